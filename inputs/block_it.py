@@ -61,7 +61,26 @@ class branson_run_param:
         self.bc_top = bc_top
         self.bc_bottom = bc_bottom
 
-def generate_input(block_list, run_param):
+def write_material_file(file_name, block_list, region_ids, x_levels, y_levels, z_levels):
+    # per-cell region IDs and initial temperatures in the binary format read by
+    # src/material_file.h, cells ordered x fastest, then y, then z
+    cell_ids = numpy.array(region_ids, dtype=numpy.uint32).transpose()
+    cell_ids = numpy.repeat(cell_ids, z_levels, axis=0)
+    cell_ids = numpy.repeat(cell_ids, y_levels, axis=1)
+    cell_ids = numpy.repeat(cell_ids, x_levels, axis=2).ravel()
+    T_e = numpy.zeros(cell_ids.size)
+    T_r = numpy.zeros(cell_ids.size)
+    for block in block_list:
+        T_e[cell_ids == block.mat["id"]] = block.mat["initial_T_e"]
+        T_r[cell_ids == block.mat["id"]] = block.mat["initial_T_r"]
+    with open(file_name, "wb") as f:
+        f.write(b"BRNMATL\0")
+        numpy.array([1, cell_ids.size], dtype=numpy.uint32).tofile(f)
+        cell_ids.tofile(f)
+        T_e.tofile(f)
+        T_r.tofile(f)
+
+def generate_input(block_list, run_param, material_file=None):
     # build a list of divisions
     x_division=[]
     y_division=[]
@@ -180,16 +199,21 @@ def generate_input(block_list, run_param):
         print()
     
     
-    for x_i in range(0,nx):
-        for y_i in range(0,ny):
-            for z_i in range(0,nz):
-                print("    <region_map>")   
-                print("       <x_div_ID>", x_i, "</x_div_ID>")   
-                print("       <y_div_ID>", y_i, "</y_div_ID>")   
-                print("       <z_div_ID>", z_i, "</z_div_ID>")   
-                print("       <region_ID>", region_ids[x_i][y_i][z_i], "</region_ID>")   
-                print("    </region_map>")   
-                print()
+    # large layouts put the regions in a binary per-cell file instead of region maps
+    if material_file is not None:
+        write_material_file(material_file, block_list, region_ids, x_levels, y_levels, z_levels)
+        print("    <material_file>"+material_file+"</material_file>")
+    else:
+        for x_i in range(0,nx):
+            for y_i in range(0,ny):
+                for z_i in range(0,nz):
+                    print("    <region_map>")   
+                    print("       <x_div_ID>", x_i, "</x_div_ID>")   
+                    print("       <y_div_ID>", y_i, "</y_div_ID>")   
+                    print("       <z_div_ID>", z_i, "</z_div_ID>")   
+                    print("       <region_ID>", region_ids[x_i][y_i][z_i], "</region_ID>")   
+                    print("    </region_map>")   
+                    print()
     
     print("  </spatial>")   
     
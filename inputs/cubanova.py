@@ -84,5 +84,7 @@ cubanova_dim = [cubanova_size]*3
 cubanova = block(cubanova_dim, [0.0]*3, cubanova_material, 8)
 block_list.append(cubanova)
 
-generate_input(block_list, run_param)
+# pass a file name as the first argument to write the regions to a binary material file
+material_file = sys.argv[1] if len(sys.argv) > 1 else None
+generate_input(block_list, run_param, material_file)
 
@@ -7,6 +7,7 @@ import numpy as np
 def method_to_num(method_str):
   if (method_str=="CELL_PASS"): return 0
   if (method_str=="PARTICLE_PASS"): return 1
+  if (method_str=="REPLICATED"): return 2
 ###############################################################################
 def get_scaling_from_file(filename):
   data = np.loadtxt(filename, converters={3:method_to_num})
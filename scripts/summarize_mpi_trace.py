@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+# Summarize the per-rank MPI traces written by Branson with <mpi_trace>TRUE</mpi_trace>
+#
+# usage: summarize_mpi_trace.py [--step N] [mpi_trace_0.bin mpi_trace_1.bin ...]
+#
+# Prints the neighbor traffic matrix, message sizes, time from post to completion of
+# non-blocking calls and where each rank's time went. The record layout matches
+# MPI_Trace::Record in src/mpi_trace.h.
+
+import argparse
+import glob
+import re
+import sys
+
+import numpy as np
+
+ops = ["send", "recv", "isend", "irecv", "send complete", "recv complete", "wait", "barrier",
+       "allreduce", "iallreduce", "iallreduce complete", "rma", "idle"]
+SEND, RECV, ISEND, IRECV, SEND_COMPLETE, RECV_COMPLETE, WAIT, BARRIER, ALLREDUCE, IALLREDUCE, \
+  IALLREDUCE_COMPLETE, RMA, IDLE = range(len(ops))
+blocking_ops = [SEND, RECV, WAIT, BARRIER, ALLREDUCE]
+
+record_type = np.dtype([("begin", "<u8"), ("end", "<u8"), ("bytes", "<u8"), ("op", "<u4"),
+                        ("peer", "<i4"), ("count", "<u4"), ("phase", "<u4")])
+
+###############################################################################
+def read_trace(file_name):
+  with open(file_name, "rb") as f:
+    magic = f.read(8)
+    header = np.frombuffer(f.read(16), dtype="<u4")
+    if magic != b"BRNTRCE\0" or header[0] != 1 or header[3] != record_type.itemsize:
+      sys.exit("{0} is not a Branson MPI trace".format(file_name))
+    records = np.frombuffer(f.read(), dtype=record_type)
+  return int(header[1]), int(header[2]), records
+###############################################################################
+def seconds(records):
+  return (records["end"] - records["begin"]).sum() * 1.0e-9
+###############################################################################
+
+parser = argparse.ArgumentParser(description="Summarize Branson MPI traces")
+parser.add_argument("files", nargs="*", help="trace files (default mpi_trace_*.bin)")
+parser.add_argument("--step", type=int, help="only this time step (0 is setup)")
+args = parser.parse_args()
+
+files = args.files
+if not files:
+  files = sorted(glob.glob("mpi_trace_*.bin"),
+                 key=lambda name: int(re.findall(r"\d+", name)[-1]))
+if not files:
+  sys.exit("no trace files found")
+
+traces = {}
+n_ranks = 0
+for name in files:
+  rank, n_ranks, records = read_trace(name)
+  if args.step is not None:
+    records = records[records["phase"] == args.step]
+  traces[rank] = records
+
+# bytes and messages sent from each rank (row) to each rank (column)
+traffic = np.zeros((n_ranks, n_ranks))
+messages = np.zeros((n_ranks, n_ranks), dtype=int)
+sizes = []
+for rank, records in traces.items():
+  sent = records[np.isin(records["op"], [SEND, ISEND])]
+  np.add.at(traffic[rank], sent["peer"], sent["bytes"])
+  np.add.at(messages[rank], sent["peer"], 1)
+  sizes.append(sent["bytes"])
+sizes = np.concatenate(sizes)
+
+print("Traffic in MB (row sends to column), {0} of {1} ranks traced".format(len(traces),
+                                                                          n_ranks))
+print("      " + "".join("{0:>10d}".format(j) for j in range(n_ranks)))
+for i in range(n_ranks):
+  print("{0:>6d}".format(i) + "".join("{0:>10.3f}".format(b / 1.0e6) for b in traffic[i]))
+print("Messages (row sends to column)")
+print("      " + "".join("{0:>10d}".format(j) for j in range(n_ranks)))
+for i in range(n_ranks):
+  print("{0:>6d}".format(i) + "".join("{0:>10d}".format(m) for m in messages[i]))
+
+print("\nMessage sizes, {0} sends".format(len(sizes)))
+if len(sizes):
+  bins = np.floor(np.log2(np.maximum(sizes, 1))).astype(int)
+  for b in range(bins.min(), bins.max() + 1):
+    n = np.count_nonzero(bins == b)
+    if n:
+      print("  [{0:>10d}, {1:>10d}) bytes: {2}".format(2**b, 2**(b + 1), n))
+
+# completions are seen at the first test after they happen, so these are upper bounds
+print("\nPost to completion (ms)        count      mean       max")
+for op in [SEND_COMPLETE, RECV_COMPLETE, IALLREDUCE_COMPLETE]:
+  times = np.concatenate([(r["end"] - r["begin"])[r["op"] == op] for r in traces.values()])
+  if len(times):
+    print("  {0:<22s}{1:>11d}{2:>10.4f}{3:>10.4f}".format(ops[op], len(times),
+                                                           times.mean() * 1.0e-6,
+                                                           times.max() * 1.0e-6))
+
+print("\nTime per rank (s)    traced   blocking  idle poll  idle iters   other")
+for rank in sorted(traces):
+  records = traces[rank]
+  if not len(records):
+    continue
+  span = (records["end"].max() - records["begin"].min()) * 1.0e-9
+  blocking = seconds(records[np.isin(records["op"], blocking_ops)])
+  idle = records[records["op"] == IDLE]
+  idle_s = seconds(idle)
+  print("{0:>6d}          {1:>10.4f} {2:>10.4f} {3:>10.4f} {4:>11d} {5:>9.4f}".format(
+      rank, span, blocking, idle_s, int(idle["count"].sum()), span - blocking - idle_s))
+
+print("\nBlocking time by call (s, summed over ranks)")
+for op in blocking_ops:
+  total = sum(seconds(r[r["op"] == op]) for r in traces.values())
+  calls = sum(np.count_nonzero(r["op"] == op) for r in traces.values())
+  if calls:
+    print("  {0:<10s}{1:>10d} calls {2:>10.4f}".format(ops[op], calls, total))
@@ -329,10 +329,22 @@ public:
   data[3] = 0;
   }
 
+  //! Construct a generator on a spawned key, independent of the (seed, streamnum) stream
+  RNG(const uint32_t seed, const uint64_t streamnum, const uint64_t spawn) : RNG(seed, streamnum) {
+    data[3] = spawn;
+  }
+
   //! Return a random double in the interval (0, 1).
   GPU_HOST_DEVICE
   double generate_random_number() const { return _ran(data); }
 
+  //! Return a generator on a new spawn key drawn from this stream (for split particles)
+  RNG spawn() const {
+    RNG child(*this);
+    child.data[3] ^= static_cast<uint64_t>(generate_random_number() * 9007199254740992.0);
+    return child;
+  }
+
   //! Return the stream number.
   uint64_t get_num() const { return data[2]; }
 
@@ -0,0 +1,119 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   async_writer.h
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Background thread that runs output tasks with a bounded queue
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#ifndef async_writer_h_
+#define async_writer_h_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+//==============================================================================
+/*!
+ * \class Async_Writer
+ * \brief Runs output tasks on one I/O thread while the caller continues
+ *
+ * Tasks run in the order they are submitted. At most max_pending tasks are
+ * queued or running at once, submit only blocks when that many are outstanding.
+ * With max_pending of zero no thread is started and tasks run in submit. Tasks
+ * should own their data (copy it into a staging buffer) and must not make MPI
+ * calls. The destructor finishes all outstanding tasks.
+ */
+//==============================================================================
+class Async_Writer {
+public:
+  //! Constructor, starts the I/O thread unless max_pending is zero
+  explicit Async_Writer(const uint32_t _max_pending)
+      : max_pending(_max_pending), n_outstanding(0), n_blocked(0), stop(false) {
+    if (max_pending > 0)
+      worker = std::thread(&Async_Writer::run, this);
+  }
+
+  //! Destructor, runs the remaining tasks and joins the I/O thread
+  ~Async_Writer() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    changed.notify_all();
+    if (worker.joinable())
+      worker.join();
+  }
+
+  Async_Writer(const Async_Writer &) = delete;
+  Async_Writer &operator=(const Async_Writer &) = delete;
+
+  //! Queue a task, waiting first if max_pending tasks are outstanding
+  void submit(std::function<void()> task) {
+    if (max_pending == 0) {
+      task();
+      return;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    if (n_outstanding >= max_pending) {
+      n_blocked++;
+      changed.wait(lock, [this] { return n_outstanding < max_pending; });
+    }
+    tasks.push_back(std::move(task));
+    n_outstanding++;
+    changed.notify_all();
+  }
+
+  //! Wait until every submitted task has finished
+  void wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this] { return n_outstanding == 0; });
+  }
+
+  //! Return the most tasks that can be outstanding, zero when tasks run in submit
+  uint32_t get_max_pending() const { return max_pending; }
+
+  //! Return the number of submits that had to wait for the queue
+  uint32_t get_n_blocked() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return n_blocked;
+  }
+
+private:
+  //! Body of the I/O thread, exits when stopped and the queue is empty
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      changed.wait(lock, [this] { return stop || !tasks.empty(); });
+      if (tasks.empty())
+        return;
+      std::function<void()> task = std::move(tasks.front());
+      tasks.pop_front();
+      lock.unlock();
+      task();
+      lock.lock();
+      n_outstanding--;
+      changed.notify_all();
+    }
+  }
+
+  const uint32_t max_pending; //!< Most tasks queued or running at once
+  uint32_t n_outstanding;     //!< Tasks queued or running
+  uint32_t n_blocked;         //!< Submits that waited for the queue
+  bool stop;                  //!< Set by the destructor to end the thread
+  std::deque<std::function<void()>> tasks; //!< Queued tasks, oldest first
+  mutable std::mutex mutex;                //!< Guards everything above
+  std::condition_variable changed;         //!< Signals queue and count changes
+  std::thread worker;                      //!< I/O thread
+};
+
+#endif // async_writer_h_
+//---------------------------------------------------------------------------//
+// end of async_writer.h
+//---------------------------------------------------------------------------//
@@ -0,0 +1,141 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   benchmark_functions.h
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Timing loop and JSON output for the kernel microbenchmarks
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#ifndef benchmark_functions_h_
+#define benchmark_functions_h_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+//! Timings of one benchmark
+struct Benchmark_Result {
+  std::string name;          //!< Benchmark name
+  uint64_t items;            //!< Work items (photons, numbers, cells...) in one repetition
+  std::vector<double> times; //!< Seconds of each timed repetition
+
+  //! Return the fastest repetition
+  double get_min() const { return *std::min_element(times.begin(), times.end()); }
+
+  //! Return the slowest repetition
+  double get_max() const { return *std::max_element(times.begin(), times.end()); }
+
+  //! Return the mean time of a repetition
+  double get_mean() const {
+    return std::accumulate(times.begin(), times.end(), 0.0) / times.size();
+  }
+
+  //! Return the median time of a repetition
+  double get_median() const {
+    std::vector<double> sorted(times);
+    std::sort(sorted.begin(), sorted.end());
+    const size_t n = sorted.size();
+    return (n % 2) ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+  }
+};
+
+//==============================================================================
+/*!
+ * \class Benchmark_Runner
+ * \brief Runs benchmarks with warm-up and repetitions and collects their times
+ *
+ * Each repetition calls setup untimed, then times run. Benchmarks whose name
+ * doesn't contain the filter are skipped.
+ */
+//==============================================================================
+class Benchmark_Runner {
+public:
+  //! Constructor
+  Benchmark_Runner(const uint32_t _n_warmup, const uint32_t _n_reps, const std::string &_filter)
+      : n_warmup(_n_warmup), n_reps(std::max(_n_reps, 1U)), filter(_filter) {}
+
+  //! Return true if a benchmark passes the filter
+  bool selected(const std::string &name) const { return name.find(filter) != std::string::npos; }
+
+  //! Time run after setup n_reps times, after n_warmup untimed repetitions
+  template <typename Setup, typename Run>
+  void run(const std::string &name, const uint64_t items, Setup setup, Run run) {
+    if (!selected(name))
+      return;
+    Benchmark_Result result{name, items, {}};
+    for (uint32_t i = 0; i < n_warmup + n_reps; ++i) {
+      setup();
+      const auto start = std::chrono::steady_clock::now();
+      run();
+      const auto stop = std::chrono::steady_clock::now();
+      if (i >= n_warmup)
+        result.times.push_back(std::chrono::duration<double>(stop - start).count());
+    }
+    print(result);
+    results.push_back(result);
+  }
+
+  //! Time run with no setup
+  template <typename Run> void run(const std::string &name, const uint64_t items, Run run) {
+    this->run(name, items, [] {}, run);
+  }
+
+  //! Print one result as a table row
+  static void print(const Benchmark_Result &r) {
+    std::cout << std::left << std::setw(28) << r.name << std::right << std::setw(12) << r.items
+              << std::scientific << std::setprecision(4) << std::setw(13) << r.get_min()
+              << std::setw(13) << r.get_median() << std::setw(13) << r.get_max() << std::setw(13)
+              << r.items / r.get_median() << std::defaultfloat << std::endl;
+  }
+
+  //! Print the table header
+  static void print_header() {
+    std::cout << std::left << std::setw(28) << "Benchmark" << std::right << std::setw(12)
+              << "Items" << std::setw(13) << "Min (s)" << std::setw(13) << "Median (s)"
+              << std::setw(13) << "Max (s)" << std::setw(13) << "Items/s" << std::endl;
+  }
+
+  //! Write the results and run settings as JSON
+  void write_json(const std::string &file_name, const std::vector<std::string> &settings) const {
+    std::ofstream out(file_name);
+    out << std::setprecision(9) << "{\n  \"suite\": \"branson_bench\",\n  \"warmup\": " << n_warmup
+        << ",\n  \"repetitions\": " << n_reps << ",\n";
+    for (auto const &setting : settings)
+      out << "  " << setting << ",\n";
+    out << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+      const Benchmark_Result &r = results[i];
+      out << (i ? "," : "") << "\n    {\"name\": \"" << r.name << "\", \"items\": " << r.items
+          << ", \"min_s\": " << r.get_min() << ", \"median_s\": " << r.get_median()
+          << ", \"mean_s\": " << r.get_mean() << ", \"max_s\": " << r.get_max()
+          << ", \"items_per_s\": " << r.items / r.get_median() << ", \"times_s\": [";
+      for (size_t t = 0; t < r.times.size(); ++t)
+        out << (t ? ", " : "") << r.times[t];
+      out << "]}";
+    }
+    out << "\n  ]\n}\n";
+  }
+
+  //! Return the results so far
+  const std::vector<Benchmark_Result> &get_results() const { return results; }
+
+private:
+  uint32_t n_warmup;                    //!< Untimed repetitions before timing
+  uint32_t n_reps;                      //!< Timed repetitions
+  std::string filter;                   //!< Substring of the benchmarks to run
+  std::vector<Benchmark_Result> results; //!< Results of the benchmarks run
+};
+
+#endif // benchmark_functions_h_
+//---------------------------------------------------------------------------//
+// end of benchmark_functions.h
+//---------------------------------------------------------------------------//
@@ -0,0 +1,228 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   branson_bench.cc
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Microbenchmarks of the transport kernels on a synthetic mesh and bank
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#include <cstdlib>
+#include <iostream>
+#include <mpi.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "../RNG.h"
+#include "../cell_tally.h"
+#include "../comb_photons.h"
+#include "../imc_parameters.h"
+#include "../imc_state.h"
+#include "../info.h"
+#include "../input.h"
+#include "../mesh.h"
+#include "../mpi_types.h"
+#include "../sampling_functions.h"
+#include "../source.h"
+#include "../transport_photon.h"
+#include "benchmark_functions.h"
+
+//! Return the input for a cube of n_cells^3 scattering and absorbing cells with reflecting faces
+std::string make_bench_input(const uint32_t n_cells, const uint64_t n_photons) {
+  std::ostringstream out;
+  out << "<prototype>\n  <common>\n    <t_start>0.0</t_start>\n    <t_stop>0.01</t_stop>\n"
+      << "    <dt_start>0.01</dt_start>\n    <t_mult>1.0</t_mult>\n    <dt_max>1.0</dt_max>\n"
+      << "    <photons>" << n_photons << "</photons>\n    <seed>14706</seed>\n"
+      << "    <dd_transport_type>REPLICATED</dd_transport_type>\n"
+      << "    <use_gpu_transporter>FALSE</use_gpu_transporter>\n"
+      << "    <use_combing>TRUE</use_combing>\n"
+      << "    <stratified_sampling>FALSE</stratified_sampling>\n  </common>\n"
+      << "  <debug_options>\n    <print_verbose>FALSE</print_verbose>\n"
+      << "    <print_mesh_info>FALSE</print_mesh_info>\n  </debug_options>\n  <spatial>\n";
+  for (auto d : {"x", "y", "z"}) {
+    out << "    <" << d << "_division>\n      <" << d << "_start>0.0</" << d << "_start>\n      <"
+        << d << "_end>10.0</" << d << "_end>\n      <n_" << d << "_cells>" << n_cells << "</n_"
+        << d << "_cells>\n    </" << d << "_division>\n";
+  }
+  out << "    <region_map>\n      <x_div_ID>0</x_div_ID>\n      <y_div_ID>0</y_div_ID>\n"
+      << "      <z_div_ID>0</z_div_ID>\n      <region_ID>1</region_ID>\n    </region_map>\n"
+      << "  </spatial>\n  <boundary>\n";
+  for (auto bc : {"left", "right", "down", "up", "bottom", "top"})
+    out << "    <bc_" << bc << ">REFLECT</bc_" << bc << ">\n";
+  out << "  </boundary>\n  <regions>\n    <region>\n      <ID>1</ID>\n"
+      << "      <density>1.0</density>\n      <CV>1.0</CV>\n      <opacA>0.5</opacA>\n"
+      << "      <opacB>0.0</opacB>\n      <opacC>0.0</opacC>\n      <opacS>0.5</opacS>\n"
+      << "      <initial_T_e>1.0</initial_T_e>\n      <initial_T_r>1.0</initial_T_r>\n"
+      << "    </region>\n  </regions>\n</prototype>\n";
+  return out.str();
+}
+
+//! Return the value after a command line flag, or a default
+std::string get_option(int argc, char *argv[], const std::string &flag,
+                       const std::string &default_value) {
+  for (int i = 1; i < argc - 1; ++i) {
+    if (flag == argv[i])
+      return argv[i + 1];
+  }
+  return default_value;
+}
+
+int main(int argc, char *argv[]) {
+
+  MPI_Init(&argc, &argv);
+
+  using std::cout;
+  using std::endl;
+  using std::vector;
+
+  const Info mpi_info;
+  if (mpi_info.get_n_rank() != 1) {
+    if (mpi_info.get_rank() == 0)
+      cout << "ERROR: branson_bench runs on one rank, exiting..." << endl;
+    MPI_Finalize();
+    return EXIT_FAILURE;
+  }
+
+  // objects holding MPI types are destroyed before MPI_Finalize
+  {
+    const uint32_t n_warmup = std::stoul(get_option(argc, argv, "--warmup", "2"));
+    const uint32_t n_reps = std::stoul(get_option(argc, argv, "--reps", "10"));
+    const uint32_t n_cells = std::stoul(get_option(argc, argv, "--cells", "20"));
+    const uint64_t n_photons = std::stoull(get_option(argc, argv, "--photons", "100000"));
+    const int n_threads = std::stoi(get_option(argc, argv, "--threads", "1"));
+    const std::string json_file = get_option(argc, argv, "--json", "branson_bench.json");
+    const std::string filter = get_option(argc, argv, "--filter", "");
+#ifdef USE_OPENMP
+    omp_set_num_threads(n_threads);
+#endif
+
+    // synthetic mesh of n_cells^3 cells on one rank
+    MPI_Types mpi_types;
+    Input input(make_bench_input(n_cells, n_photons), mpi_types, true);
+    IMC_Parameters imc_p(input);
+    IMC_State imc_state(input, mpi_info.get_rank());
+    Mesh mesh(input, mpi_types, mpi_info, imc_p);
+    mesh.initialize_physical_properties(input);
+    mesh.calculate_photon_energy(imc_state, n_photons);
+    const Cell_Vector &cells = mesh.get_cells();
+    const uint32_t n_local_cells = mesh.get_n_local_cells();
+    const Population_Control pop_ctrl = imc_p.get_population_control();
+
+    // keeps results of the timed loops live
+    volatile double sink = 0.0;
+    const uint64_t n_samples = 1000000;
+
+    cout << "branson_bench: " << n_local_cells << " cells, " << n_photons << " photons, "
+         << n_threads << " threads, " << n_warmup << " warm-up and " << n_reps
+         << " timed repetitions" << endl;
+    Benchmark_Runner runner(n_warmup, n_reps, filter);
+    Benchmark_Runner::print_header();
+
+    runner.run("rng", n_samples, [&] {
+      RNG rng(14706U, 1UL);
+      double sum = 0.0;
+      for (uint64_t i = 0; i < n_samples; ++i)
+        sum += rng.generate_random_number();
+      sink = sum;
+    });
+
+    // positions and angles in one cell
+    const Cell &cell = cells[n_local_cells / 2];
+    vector<std::array<double, 3>> positions(n_samples / 10);
+    vector<std::array<double, 3>> angles(n_samples / 10);
+    {
+      RNG rng(14706U, 2UL);
+      for (uint64_t i = 0; i < positions.size(); ++i) {
+        positions[i] = get_uniform_position_in_cell(cell, rng);
+        angles[i] = get_uniform_angle(rng);
+      }
+    }
+    runner.run("get_distance_to_boundary", positions.size(), [&] {
+      double sum = 0.0;
+      uint32_t surface_cross = 0;
+      for (uint64_t i = 0; i < positions.size(); ++i)
+        sum += cell.get_distance_to_boundary<3>(positions[i], angles[i], surface_cross);
+      sink = sum + surface_cross;
+    });
+
+    runner.run("sampling/uniform_angle", n_samples, [&] {
+      RNG rng(14706U, 3UL);
+      double sum = 0.0;
+      for (uint64_t i = 0; i < n_samples; ++i)
+        sum += get_uniform_angle(rng)[2];
+      sink = sum;
+    });
+    runner.run("sampling/position_in_cell", n_samples, [&] {
+      RNG rng(14706U, 4UL);
+      double sum = 0.0;
+      for (uint64_t i = 0; i < n_samples; ++i)
+        sum += get_uniform_position_in_cell(cell, rng)[0];
+      sink = sum;
+    });
+    runner.run("sampling/emission_group", n_samples, [&] {
+      RNG rng(14706U, 5UL);
+      uint64_t sum = 0;
+      for (uint64_t i = 0; i < n_samples; ++i)
+        sum += sample_emission_group(rng, cell);
+      sink = sum;
+    });
+
+    // the emission bank is also the transport and comb bank
+    auto make_bank = [&] {
+      return make_photons(imc_state.get_dt(), mesh, mpi_info.get_rank(), imc_state.get_step(),
+                          imc_p.get_rng_seed(), n_photons, mesh.get_total_photon_E(),
+                          imc_p.get_sampling_mode());
+    };
+    const Photon_Vector bank = make_bank();
+    runner.run("make_photons", bank.size(), [&] { sink = make_bank().size(); });
+
+    Photon_Vector photons;
+    Cell_Tally_Vector cell_tallies(n_local_cells);
+    auto copy_bank = [&] {
+      photons = bank;
+      cell_tallies.assign(n_local_cells, Cell_Tally());
+    };
+    runner.run("transport_photon", bank.size(), copy_bank, [&] {
+      for (auto &phtn : photons)
+        transport_photon<3>(0, phtn, cells.data(), cell_tallies.data(), pop_ctrl, nullptr, nullptr);
+    });
+    runner.run("cpu_transport_photons", bank.size(), copy_bank, [&] {
+      cpu_transport_photons(0, photons, cells, cell_tallies, n_threads, pop_ctrl, nullptr, nullptr,
+                            mesh.get_n_dim());
+    });
+
+    // comb the bank to half its size
+    runner.run("comb_photons", bank.size(), copy_bank, [&] {
+      comb_photons(photons, bank.size() / 2, n_local_cells, mesh.get_offset(),
+                   imc_p.get_rng_seed(), imc_state.get_step(), mpi_info.get_rank());
+    });
+
+    // merge per-thread tallies as after threaded transport
+    constexpr uint32_t n_tally_threads = 8;
+    vector<Cell_Tally_Vector> thread_tallies(n_tally_threads, Cell_Tally_Vector(n_local_cells));
+    for (auto &thread_tally : thread_tallies) {
+      for (auto &tally : thread_tally)
+        tally.accumulate_absorbed_E(1.0);
+    }
+    runner.run("tally_reduction", uint64_t(n_local_cells) * n_tally_threads,
+               [&] { cell_tallies.assign(n_local_cells, Cell_Tally()); },
+               [&] { merge_thread_tallies(cell_tallies, thread_tallies); });
+
+    runner.write_json(json_file,
+                      {"\"n_cells\": " + std::to_string(n_local_cells),
+                       "\"n_photons\": " + std::to_string(n_photons),
+                       "\"n_threads\": " + std::to_string(n_threads),
+                       "\"n_groups\": " + std::to_string(BRANSON_N_GROUPS)});
+    cout << "Results written to " << json_file << endl;
+  }
+
+  MPI_Finalize();
+  return EXIT_SUCCESS;
+}
+//---------------------------------------------------------------------------//
+// end of branson_bench.cc
+//---------------------------------------------------------------------------//
@@ -0,0 +1,218 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   benchmark_problem.h
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Synthetic weak and strong scaling problems and their JSON record
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#ifndef benchmark_problem_h_
+#define benchmark_problem_h_
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mpi.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "imc_state.h"
+#include "memory_tracker.h"
+#include "profiler.h"
+
+//==============================================================================
+/*!
+ * \struct Benchmark_Problem
+ * \brief Parameters of a synthetic scaling problem given on the command line
+ *
+ * The problem is a reflecting box of one material at a uniform temperature, so
+ * every cell emits and the work per cell is set by the optical thickness. For
+ * weak scaling each rank owns a cube of cells^3 cells and photons photons and
+ * the ranks are arranged in a near-cubic grid. For strong scaling the whole
+ * problem is a cube of cells^3 cells with photons photons.
+ */
+//==============================================================================
+struct Benchmark_Problem {
+  bool weak = true;                                 //!< Weak (true) or strong scaling
+  uint32_t cells = 20;                              //!< Cells per dimension, per rank if weak
+  double tau = 1.0;                                 //!< Optical thickness of one cell
+  double scatter_fraction = 0.5;                    //!< Fraction of the opacity that scatters
+  uint64_t photons = 100000;                        //!< Photons per step, per rank if weak
+  uint32_t steps = 5;                               //!< Time steps to run
+  std::string dd_mode = "PARTICLE_PASS";            //!< Transport method
+  uint32_t n_threads = 1;                           //!< OpenMP threads per rank
+  std::string json_file = "branson_benchmark.json"; //!< Output record
+
+  //! Return the rank grid, a near-cubic factoring of n_ranks (all ones if strong)
+  std::array<uint32_t, 3> get_rank_grid(const int n_ranks) const {
+    std::array<uint32_t, 3> grid = {1, 1, 1};
+    if (!weak)
+      return grid;
+    // largest prime factors first, each onto the smallest dimension so far
+    std::vector<uint32_t> factors;
+    uint32_t n = n_ranks;
+    for (uint32_t f = 2; f * f <= n; ++f) {
+      while (n % f == 0) {
+        factors.push_back(f);
+        n /= f;
+      }
+    }
+    if (n > 1)
+      factors.push_back(n);
+    for (auto f = factors.rbegin(); f != factors.rend(); ++f)
+      *std::min_element(grid.begin(), grid.end()) *= *f;
+    return grid;
+  }
+
+  //! Return the total photons per step
+  uint64_t get_total_photons(const int n_ranks) const {
+    return weak ? photons * n_ranks : photons;
+  }
+
+  //! Return the input deck for this problem on n_ranks ranks as XML text
+  std::string make_input(const int n_ranks) const {
+    const std::array<uint32_t, 3> grid = get_rank_grid(n_ranks);
+    // unit cells, the opacity sets the optical thickness
+    const double dt = 0.01;
+    std::ostringstream xml;
+    xml << "<prototype>\n  <common>\n    <t_start>0.0</t_start>\n    <t_stop>" << steps * dt
+        << "</t_stop>\n    <dt_start>" << dt << "</dt_start>\n    <t_mult>1.0</t_mult>\n"
+        << "    <dt_max>" << dt << "</dt_max>\n    <photons>" << get_total_photons(n_ranks)
+        << "</photons>\n    <seed>14706</seed>\n    <use_combing>TRUE</use_combing>\n"
+        << "    <stratified_sampling>FALSE</stratified_sampling>\n"
+        << "    <use_gpu_transporter>FALSE</use_gpu_transporter>\n"
+        << "    <dd_transport_type>" << dd_mode << "</dd_transport_type>\n"
+        << "    <n_omp_threads>" << n_threads << "</n_omp_threads>\n"
+        << "    <output_frequency>" << steps + 1 << "</output_frequency>\n  </common>\n"
+        << "  <debug_options>\n    <print_verbose>FALSE</print_verbose>\n"
+        << "    <print_mesh_info>FALSE</print_mesh_info>\n  </debug_options>\n  <spatial>\n";
+    const char *dims[3] = {"x", "y", "z"};
+    for (int d = 0; d < 3; ++d) {
+      const std::string n(dims[d]);
+      xml << "    <" << n << "_division>\n      <" << n << "_start>0.0</" << n << "_start>\n"
+          << "      <" << n << "_end>" << grid[d] * cells << "</" << n << "_end>\n"
+          << "      <n_" << n << "_cells>" << grid[d] * cells << "</n_" << n << "_cells>\n"
+          << "    </" << n << "_division>\n";
+    }
+    xml << "    <region_map>\n      <x_div_ID>0</x_div_ID>\n      <y_div_ID>0</y_div_ID>\n"
+        << "      <z_div_ID>0</z_div_ID>\n      <region_ID>1</region_ID>\n    </region_map>\n"
+        << "  </spatial>\n  <boundary>\n";
+    for (auto bc : {"left", "right", "down", "up", "bottom", "top"})
+      xml << "    <bc_" << bc << ">REFLECT</bc_" << bc << ">\n";
+    xml << "  </boundary>\n  <regions>\n    <region>\n      <ID>1</ID>\n"
+        << "      <density>1.0</density>\n      <CV>1.0</CV>\n"
+        << "      <opacA>" << (1.0 - scatter_fraction) * tau << "</opacA>\n"
+        << "      <opacB>0.0</opacB>\n      <opacC>0.0</opacC>\n"
+        << "      <opacS>" << scatter_fraction * tau << "</opacS>\n"
+        << "      <initial_T_e>1.0</initial_T_e>\n      <initial_T_r>1.0</initial_T_r>\n"
+        << "    </region>\n  </regions>\n</prototype>\n";
+    return xml.str();
+  }
+};
+
+//! Read "--benchmark <weak|strong> [--option value ...]", exit with a message on bad arguments
+inline Benchmark_Problem parse_benchmark_args(int argc, char **argv) {
+  using std::cout;
+  using std::endl;
+  Benchmark_Problem problem;
+  const std::string mode = (argc > 2) ? argv[2] : "";
+  if (mode != "weak" && mode != "strong") {
+    cout << "Benchmark mode must be weak or strong" << endl;
+    exit(EXIT_FAILURE);
+  }
+  problem.weak = (mode == "weak");
+  if ((argc - 3) % 2 != 0) {
+    cout << "Benchmark options are --name value pairs" << endl;
+    exit(EXIT_FAILURE);
+  }
+  for (int i = 3; i < argc; i += 2) {
+    const std::string option(argv[i]);
+    const std::string value(argv[i + 1]);
+    if (option == "--cells")
+      problem.cells = std::stoul(value);
+    else if (option == "--tau")
+      problem.tau = std::stod(value);
+    else if (option == "--scatter")
+      problem.scatter_fraction = std::stod(value);
+    else if (option == "--photons")
+      problem.photons = std::stoull(value);
+    else if (option == "--steps")
+      problem.steps = std::stoul(value);
+    else if (option == "--dd")
+      problem.dd_mode = value;
+    else if (option == "--threads")
+      problem.n_threads = std::stoul(value);
+    else if (option == "--json")
+      problem.json_file = value;
+    else {
+      cout << "Unknown benchmark option: " << option << endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+  if (problem.cells == 0 || problem.photons == 0 || problem.steps == 0 || problem.tau <= 0.0 ||
+      problem.scatter_fraction < 0.0 || problem.scatter_fraction > 1.0 ||
+      (problem.dd_mode != "PARTICLE_PASS" && problem.dd_mode != "REPLICATED")) {
+    cout << "Benchmark needs positive cells, photons, steps and tau, a scatter fraction in [0,1]"
+         << " and dd PARTICLE_PASS or REPLICATED" << endl;
+    exit(EXIT_FAILURE);
+  }
+  return problem;
+}
+
+//! Write one JSON record of the run on rank zero, collective for the memory reduction
+inline void write_benchmark_record(const Benchmark_Problem &problem, const int rank,
+                                   const int n_ranks, IMC_State &imc_state,
+                                   const double setup_time, const double run_time,
+                                   const Profiler::Summary &profile) {
+  // peak resident set, max and mean over ranks
+  const double rss_peak = Memory::get_process_memory().hwm;
+  double max_rss_peak, sum_rss_peak;
+  MPI_Reduce(&rss_peak, &max_rss_peak, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&rss_peak, &sum_rss_peak, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  if (rank != 0)
+    return;
+
+  const std::array<uint32_t, 3> grid = problem.get_rank_grid(n_ranks);
+  const uint64_t n_cells = uint64_t(grid[0]) * grid[1] * grid[2] * problem.cells *
+                           problem.cells * problem.cells;
+  const uint64_t n_photons = problem.get_total_photons(n_ranks);
+  std::ofstream out(problem.json_file);
+  out << std::setprecision(9) << "{\"mode\": \"" << (problem.weak ? "weak" : "strong")
+      << "\", \"n_ranks\": " << n_ranks << ", \"n_threads\": " << problem.n_threads
+      << ", \"dd_mode\": \"" << problem.dd_mode << "\", \"rank_grid\": [" << grid[0] << ", "
+      << grid[1] << ", " << grid[2] << "], \"n_cells\": " << n_cells
+      << ", \"n_photons\": " << n_photons << ", \"tau\": " << problem.tau
+      << ", \"scatter_fraction\": " << problem.scatter_fraction
+      << ", \"steps\": " << problem.steps
+      << ",\n \"fom\": " << imc_state.get_photons_per_second_fom(n_photons)
+      << ", \"transport_s\": " << imc_state.get_total_transport_time()
+      << ", \"setup_s\": " << setup_time << ", \"run_s\": " << run_time
+      << ",\n \"phases\": {";
+  // imbalance is the slowest rank over the mean
+  bool first = true;
+  for (int r = 0; r < Profiler::N_REGIONS; ++r) {
+    if (profile.calls[r] == 0.0)
+      continue;
+    const double imbalance = profile.mean[r] > 0.0 ? profile.max[r] / profile.mean[r] : 1.0;
+    out << (first ? "\n" : ",\n") << "  \"" << Profiler::get_name(Profiler::Region(r))
+        << "\": {\"min_s\": " << profile.min[r] << ", \"mean_s\": " << profile.mean[r]
+        << ", \"max_s\": " << profile.max[r] << ", \"imbalance\": " << imbalance << "}";
+    first = false;
+  }
+  out << "},\n \"particles_sent\": " << imc_state.get_total_particles_sent()
+      << ", \"particle_messages\": " << imc_state.get_total_particle_messages()
+      << ",\n \"rss_peak_max_gb\": " << max_rss_peak * 1.0e-9
+      << ", \"rss_peak_mean_gb\": " << sum_rss_peak * 1.0e-9 / n_ranks << "}\n";
+  std::cout << "Benchmark record written to " << problem.json_file << std::endl;
+}
+
+#endif // benchmark_problem_h_
+//---------------------------------------------------------------------------//
+// end of benchmark_problem.h
+//---------------------------------------------------------------------------//
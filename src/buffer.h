@@ -15,9 +15,14 @@
 #include <mpi.h>
 #include <vector>
 
+#include "memory_tracker.h"
+
 template <class T> class Buffer {
 
 public:
+  //! Buffer storage, counted as MPI buffer memory
+  typedef tracked_vector<T, Memory::MPI_BUFFERS> Vector;
+
   //! Default constructor
   Buffer() : status(EMPTY), buffer_recv_size(0), rank(MPI_PROC_NULL) {}
 
@@ -25,8 +30,8 @@ public:
   ~Buffer() {}
 
   //! Fill the underlying buffer data with input vector
-  void fill(std::vector<T> _object) {
-    object = _object;
+  template <typename V> void fill(const V &_object) {
+    object.assign(_object.begin(), _object.end());
     status = READY;
   }
 
@@ -39,10 +44,10 @@ public:
   }
 
   //! Return const reference to buffer's vector object
-  const std::vector<T> &get_object(void) const { return object; }
+  const Vector &get_object(void) const { return object; }
 
   //! Return reference to buffer's vector object
-  std::vector<T> &get_object_ref(void) { return object; }
+  Vector &get_object_ref(void) { return object; }
 
   //! Resize internal buffer vector
   void resize(uint32_t new_size) { object.resize(new_size); }
@@ -118,7 +123,7 @@ private:
   //! Grips received or sent, used for convenience in mesh passing
   std::vector<uint32_t> grip_IDs;
 
-  std::vector<T> object; //!< Where sent/received data is stored
+  Vector object; //!< Where sent/received data is stored
 
   //! Buffer statuses, used in completion routine
   enum { EMPTY, READY, SENT, AWAITING, RECEIVED };
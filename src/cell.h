@@ -12,12 +12,14 @@
 #ifndef cell_h_
 #define cell_h_
 
+#include <algorithm>
 #include <iostream>
 #include <mpi.h>
 
 #include "RNG.h"
 #include "config.h"
 #include "constants.h"
+#include "memory_tracker.h"
 #include "proto_cell.h"
 
 template <typename T>
@@ -53,13 +55,9 @@ public:
     e_next(proto_cell.get_e_next()),
     bc(proto_cell.get_bc()),
     nodes(proto_cell.get_nodes()),
-    abs_groups(),
-    sct_groups(),
-    op_a(0.0), op_s(0.0), f(0.0), rho(0.0), T_e(0.0), T_r(0.0), T_s(0.0)
-  {
-    abs_groups.fill(0.0);
-    sct_groups.fill(0.0);
-  }
+    op_a(0.0), op_s(0.0), f(0.0), rho(0.0), T_e(proto_cell.get_T_e()),
+    T_r(proto_cell.get_T_r()), T_s(0.0)
+  {}
 
   ~Cell(void) {}
 
@@ -112,7 +110,8 @@ public:
   }
 
   //! Return a distance to boundary and set surface crossing given
-  // position and angle
+  // position and angle, only faces in the first n_dim dimensions are checked
+  template <uint32_t n_dim = 3>
   GPU_HOST_DEVICE
   inline double get_distance_to_boundary(const std::array<double,3> &pos, const std::array<double,3> &angle,
                                          uint32_t &surface_cross) const {
@@ -120,7 +119,7 @@ public:
     double dist = 0.0;
     uint32_t index;
     // only check the positive or negative surface
-    for (uint32_t i = 0; i < 3; i++) {
+    for (uint32_t i = 0; i < n_dim; i++) {
       index = 2 * i + sgn(angle[i]);
       dist = (nodes[index] - pos[i]) / angle[i];
       if (dist < min_dist) {
@@ -131,6 +130,18 @@ public:
     return min_dist;
   }
 
+  //! Return the distance from a point inside the cell to the closest face
+  GPU_HOST_DEVICE
+  inline double get_distance_to_nearest_face(const std::array<double, 3> &pos) const {
+    double min_dist = 1.0e16;
+    for (uint32_t i = 0; i < 3; i++) {
+      const double dist = std::min(pos[i] - nodes[2 * i], nodes[2 * i + 1] - pos[i]);
+      if (dist < min_dist)
+        min_dist = dist;
+    }
+    return min_dist;
+  }
+
   //! Set position array given an RNG
   inline void uniform_position_in_cell(RNG *rng, double *pos) const {
     pos[0] = nodes[0] + rng->generate_random_number() * (nodes[1] - nodes[0]);
@@ -163,17 +174,19 @@ public:
   GPU_HOST_DEVICE
   inline double get_op_a(void) const { return op_a; }
 
-  //! Return multigroup absorption opacity
+  //! Return multigroup absorption opacity, the gray value if no row is set
   GPU_HOST_DEVICE
-  inline double get_op_a(uint32_t g) const { return abs_groups[g]; }
+  inline double get_op_a(uint32_t g) const { return opacity_row ? opacity_row[g] : op_a; }
 
   //! Retrun scattering opacity
   GPU_HOST_DEVICE
   inline double get_op_s(void) const { return op_s; }
 
-  //! Return multigroup scattering opacity
+  //! Return multigroup scattering opacity, the gray value if no row is set
   GPU_HOST_DEVICE
-  inline double get_op_s(uint32_t g) const { return sct_groups[g]; }
+  inline double get_op_s(uint32_t g) const {
+    return opacity_row ? opacity_row[BRANSON_N_GROUPS + g] : op_s;
+  }
 
   //! Retrun fleck factor
   GPU_HOST_DEVICE
@@ -202,6 +215,26 @@ public:
   GPU_HOST_DEVICE
   inline double get_T_s(void) const { return T_s; }
 
+  //! Return weight window importance
+  GPU_HOST_DEVICE
+  inline double get_importance(void) const { return importance; }
+
+  //! Return true if photons in this cell take discrete diffusion steps
+  GPU_HOST_DEVICE
+  inline bool is_ddmc(void) const { return ddmc; }
+
+  //! Return the DDMC leakage opacity through a face (1/cm)
+  GPU_HOST_DEVICE
+  inline double get_leakage_op(const uint32_t face) const { return leakage_op[face]; }
+
+  //! Return the DDMC leakage opacity summed over faces (1/cm)
+  GPU_HOST_DEVICE
+  inline double get_total_leakage_op(void) const { return total_leakage_op; }
+
+  //! Return the cell width in a dimension (0, 1 or 2)
+  GPU_HOST_DEVICE
+  inline double get_dx(const uint32_t dim) const { return nodes[2 * dim + 1] - nodes[2 * dim]; }
+
   // Return global cell index
   GPU_HOST_DEVICE
   inline uint32_t get_global_index(void) const { return global_index; }
@@ -239,7 +272,7 @@ public:
     cout<<"Temperatures: "<<T_e<<" "<<T_r<<" "<<T_s<<endl;
     cout<<"Density: "<<rho<<" cV: "<<cV<<" f: "<<f<<endl;
     for(int i=0;i<BRANSON_N_GROUPS;++i)
-      cout<<"group: "<<i<<"/"<<BRANSON_N_GROUPS<<" abs: "<<abs_groups[i]<<" sct: "<<sct_groups[i]<<std::endl;
+      cout<<"group: "<<i<<"/"<<BRANSON_N_GROUPS<<" abs: "<<get_op_a(i)<<" sct: "<<get_op_s(i)<<std::endl;
   }
 
   //--------------------------------------------------------------------------//
@@ -256,23 +289,15 @@ public:
     bc[direction] = _bc;
   }
 
-  //! Set absorption opacity
-  void set_op_a(double _op_a) {
-    op_a = _op_a;
-    // set "multigroup" data
-    for (uint32_t i = 0; i < BRANSON_N_GROUPS; ++i) {
-      abs_groups[i] = _op_a;
-    }
-  }
+  //! Set gray absorption opacity
+  void set_op_a(double _op_a) { op_a = _op_a; }
 
-  //! Set scattering opacity
-  void set_op_s(double _op_s) {
-    op_s = _op_s;
-    // set "multigroup" data
-    for (uint32_t i = 0; i < BRANSON_N_GROUPS; ++i) {
-      sct_groups[i] = _op_s;
-    }
-  }
+  //! Set gray scattering opacity
+  void set_op_s(double _op_s) { op_s = _op_s; }
+
+  //! Set the shared row of group opacities, BRANSON_N_GROUPS absorption then scattering values,
+  // null to use the gray opacities in every group
+  void set_opacity_row(const double *_opacity_row) { opacity_row = _opacity_row; }
 
   //! Set fleck factor
   void set_f(double _f) { f = _f; }
@@ -292,6 +317,20 @@ public:
   //! Set source temperature
   void set_T_s(double _T_s) { T_s = _T_s; }
 
+  //! Set weight window importance
+  void set_importance(double _importance) { importance = _importance; }
+
+  //! Set the DDMC flag
+  void set_ddmc(bool _ddmc) { ddmc = _ddmc; }
+
+  //! Set the DDMC leakage opacities for all faces
+  void set_leakage_op(const std::array<double, 6> &_leakage_op) {
+    leakage_op = _leakage_op;
+    total_leakage_op = 0.0;
+    for (auto op : leakage_op)
+      total_leakage_op += op;
+  }
+
   //! Set global cell index
   void set_global_index(uint32_t _global_index) { global_index = _global_index; }
 
@@ -320,11 +359,11 @@ private:
 
   uint32_t region_ID; //!< region cell is in (for setting physical properties)
   uint32_t silo_index;      //!< Global index not remappaed, for SILO plotting
+  bool ddmc{false};         //!< Discrete diffusion cell
   std::array<uint32_t, 6> e_next; //!< Bordering cell, given as global ID
   std::array<Constants::bc_type, 6>  bc; //!< Boundary conditions for each face
   std::array<double, 6> nodes;          //!< x_low, x_high, y_low, y_high, z_low, z_high
-  std::array<double, BRANSON_N_GROUPS> abs_groups; //!< Absorption groups
-  std::array<double, BRANSON_N_GROUPS> sct_groups; //!< Scattering groups
+  const double *opacity_row{nullptr}; //!< Shared group opacities (see Opacity_Rows)
 
   double cV;   //!< Heat capacity  GJ/g/KeV
   double op_a; //!< Absorption opacity  (1/cm)
@@ -334,8 +373,14 @@ private:
   double T_e;  //!< Material temperature
   double T_r;  //!< Radiation temperature
   double T_s;  //!< Source temperature
+  double importance{1.0}; //!< Weight window importance
+  std::array<double, 6> leakage_op{}; //!< DDMC leakage opacity through each face (1/cm)
+  double total_leakage_op{0.0};       //!< Sum of the leakage opacities (1/cm)
 };
 
+//! Cells on a rank, counted as mesh memory
+typedef tracked_vector<Cell, Memory::MESH> Cell_Vector;
+
 #endif // cell_h_
 //---------------------------------------------------------------------------//
 // end of cell.h
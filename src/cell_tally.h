@@ -14,8 +14,10 @@
 
 #include <iostream>
 #include <mpi.h>
+#include <vector>
 
 #include "config.h"
+#include "memory_tracker.h"
 
 //==============================================================================
 /*!
@@ -30,7 +32,7 @@ class Cell_Tally {
 
 public:
   Cell_Tally()
-    :abs_E{0.0}, track_E{0.0}
+    :abs_E{0.0}, track_E{0.0}, pop_ctrl_E{0.0}
   {}
 
   GPU_HOST_DEVICE
@@ -43,20 +45,46 @@ public:
     accumulate(track_E, delta_track_E);
   }
 
+  //! Add energy created (positive) or destroyed (negative) by population control
+  GPU_HOST_DEVICE
+  inline void accumulate_pop_ctrl_E(const double delta_pop_ctrl_E) {
+    accumulate(pop_ctrl_E, delta_pop_ctrl_E);
+  }
+
   GPU_HOST_DEVICE
   double get_abs_E() const {return abs_E;}
 
   double get_track_E() const {return track_E;}
 
+  double get_pop_ctrl_E() const {return pop_ctrl_E;}
+
   double abs_E;  //!< Absorbed energy in jerks
   double track_E;  //!< Track energy used for estimate of radiation temperature
+  double pop_ctrl_E; //!< Net energy added by roulette
 
   void merge_in_tally(const Cell_Tally &other_cell_tally) {
     abs_E+= other_cell_tally.get_abs_E();
     track_E+= other_cell_tally.get_track_E();
+    pop_ctrl_E+= other_cell_tally.get_pop_ctrl_E();
   }
 };
 
+//! Tallies of each cell, counted as tally memory
+typedef tracked_vector<Cell_Tally, Memory::TALLIES> Cell_Tally_Vector;
+
+//! Energy tallied in each cell, counted as tally memory
+typedef tracked_vector<double, Memory::TALLIES> Energy_Tally_Vector;
+
+//! Add the tallies of each thread into cell_tallies
+inline void merge_thread_tallies(Cell_Tally_Vector &cell_tallies,
+                                 const std::vector<Cell_Tally_Vector> &thread_tallies) {
+  for (size_t cell = 0; cell < cell_tallies.size(); ++cell) {
+    auto &cell_tally{cell_tallies[cell]};
+    for (auto const &thread_tally : thread_tallies)
+      cell_tally.merge_in_tally(thread_tally[cell]);
+  }
+}
+
 #endif // cell_tally_h_
 //---------------------------------------------------------------------------//
 // end of cell_tally.h
@@ -0,0 +1,369 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   census_store.h
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Spills census photons beyond a memory bound to a memory-mapped file
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#ifndef census_store_h_
+#define census_store_h_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fcntl.h>
+#include <iostream>
+#include <mpi.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+#include "photon.h"
+#include "timer.h"
+
+//==============================================================================
+/*!
+ * \class Census_Store
+ * \brief Holds the census photons that don't fit in memory between time steps
+ *
+ * Each rank has two files in a (preferably node local) directory. While transport
+ * reads back last step's spilled census in chunks of max_in_memory with read_chunk,
+ * new census photons are flushed to the other file whenever the in-memory census
+ * reaches max_in_memory. At the end of the step spill adds the photons past
+ * max_in_memory and the files swap roles. The file being read is mapped into
+ * memory so the kernel can write back and drop the pages, and the resident memory
+ * of the spilled photons is not counted against the process. Photons are written
+ * as compact records without the event descriptors and completion token, which
+ * census photons don't need. A max_in_memory of zero never spills.
+ */
+//==============================================================================
+class Census_Store {
+public:
+  //! Spilled state of one census photon
+  struct Record {
+    std::array<double, 3> pos;
+    std::array<double, 3> angle;
+    double E;
+    double E0;
+    double life_dx;
+    RNG rng;
+    uint32_t cell;
+    uint16_t group;
+    uint8_t source_type;
+    uint8_t ddmc;
+  };
+  static_assert(std::is_trivially_copyable<Record>::value, "spill records are raw bytes");
+  static_assert(BRANSON_N_GROUPS <= UINT16_MAX, "group doesn't fit in a spill record");
+
+  //! Constructor
+  Census_Store(const uint64_t _max_in_memory, const std::string &directory, const int rank)
+      : max_in_memory(_max_in_memory), fds{{-1, -1}}, next(0), mapped(nullptr), n_mapped(0),
+        n_spilled(0), n_read(0), spilled_E(0.0), n_flushed(0), flushed_E(0.0) {
+    for (int f = 0; f < 2; ++f) {
+      file_names[f] = directory + "/census_spill_" + std::to_string(rank) + "_" +
+                      std::to_string(f) + ".bin";
+    }
+    reset_step_io();
+  }
+
+  //! Destructor, removes the spill files
+  ~Census_Store() {
+    unmap();
+    for (int f = 0; f < 2; ++f) {
+      if (fds[f] >= 0) {
+        close(fds[f]);
+        unlink(file_names[f].c_str());
+      }
+    }
+  }
+
+  Census_Store(const Census_Store &) = delete;
+  Census_Store &operator=(const Census_Store &) = delete;
+
+  //! Write the census to the next step's file and empty it once it holds max_in_memory photons,
+  // transport calls this as census photons are added so they never all sit in memory
+  void flush(Photon_Vector &census) {
+    if (max_in_memory == 0 || census.size() < max_in_memory)
+      return;
+    append(census.data(), census.size());
+    census.clear();
+  }
+
+  //! Add the photons past max_in_memory to those flushed this step, then make them the spilled
+  // census that the next step reads, replacing any spilled photons
+  void spill(Photon_Vector &census) {
+    if (max_in_memory && census.size() > max_in_memory) {
+      append(census.data() + max_in_memory, census.size() - max_in_memory);
+      // give the memory back, not just the elements
+      census.resize(max_in_memory);
+      census.shrink_to_fit();
+    }
+
+    // the file written this step is read next step, the other one is reused for writing
+    unmap();
+    n_spilled = n_flushed;
+    spilled_E = flushed_E;
+    n_read = 0;
+    if (n_spilled)
+      map(next, n_spilled);
+    next = 1 - next;
+    n_flushed = 0;
+    flushed_E = 0.0;
+    if (fds[next] >= 0 && ftruncate(fds[next], 0) != 0)
+      fail("truncate");
+  }
+
+  //! Pass the photons flushed this step through process in chunks of at most max_in_memory and
+  // keep what it leaves in the chunk, e.g. to comb them. Called as process(chunk, chunk_index).
+  template <typename Process> void process_flushed(Process process) {
+    Timer t_process;
+    t_process.start_timer("process");
+    Photon_Vector chunk;
+    std::vector<Record> records;
+    uint64_t n_kept = 0;
+    double kept_E = 0.0;
+    uint64_t chunk_index = 0;
+    for (uint64_t begin = 0; begin < n_flushed; begin += max_in_memory, ++chunk_index) {
+      const uint64_t n = std::min(max_in_memory, n_flushed - begin);
+      records.resize(n);
+      transfer(fds[next], records.data(), n, begin, false);
+      chunk.resize(n);
+      for (uint64_t i = 0; i < n; ++i)
+        chunk[i] = make_photon(records[i]);
+      process(chunk, chunk_index);
+      // kept photons are written back over the ones already read
+      records.resize(chunk.size());
+      for (uint64_t i = 0; i < chunk.size(); ++i) {
+        records[i] = make_record(chunk[i]);
+        kept_E += chunk[i].get_E();
+      }
+      transfer(fds[next], records.data(), chunk.size(), n_kept, true);
+      step_bytes_read += n * sizeof(Record);
+      step_bytes_written += chunk.size() * sizeof(Record);
+      n_kept += chunk.size();
+    }
+    if (fds[next] >= 0 && ftruncate(fds[next], n_kept * sizeof(Record)) != 0)
+      fail("size");
+    n_flushed = n_kept;
+    flushed_E = kept_E;
+    t_process.stop_timer("process");
+    step_write_time += t_process.get_time("process");
+  }
+
+  //! Replace the contents of photons with the next chunk of spilled photons, returns the number
+  // read (zero when every spilled photon has been read this step)
+  uint64_t read_chunk(Photon_Vector &photons) {
+    photons.clear();
+    if (n_read == n_spilled)
+      return 0;
+    Timer t_read;
+    t_read.start_timer("read");
+    const uint64_t n = std::min(max_in_memory, n_spilled - n_read);
+    photons.resize(n);
+    for (uint64_t i = 0; i < n; ++i)
+      photons[i] = make_photon(mapped[n_read + i]);
+    // these pages won't be read again
+    const uint64_t page = sysconf(_SC_PAGESIZE);
+    const uint64_t done_bytes = ((n_read + n) * sizeof(Record) / page) * page;
+    if (done_bytes)
+      madvise(const_cast<Record *>(mapped), done_bytes, MADV_DONTNEED);
+    n_read += n;
+    t_read.stop_timer("read");
+    step_bytes_read += n * sizeof(Record);
+    step_read_time += t_read.get_time("read");
+    return n;
+  }
+
+  //! Append count spilled photons starting at begin to a vector without consuming them, e.g. to
+  // checkpoint the census a chunk at a time
+  void append_spilled(const uint64_t begin, const uint64_t count, Photon_Vector &photons) const {
+    photons.reserve(photons.size() + count);
+    for (uint64_t i = begin; i < begin + count; ++i)
+      photons.push_back(make_photon(mapped[i]));
+  }
+
+  //! Return the number of photons in the spill file
+  uint64_t get_n_spilled(void) const { return n_spilled; }
+
+  //! Return the energy of the photons in the spill file
+  double get_spilled_E(void) const { return spilled_E; }
+
+  //! Return the number of census photons flushed this step
+  uint64_t get_n_flushed(void) const { return n_flushed; }
+
+  //! Return the energy of the census photons flushed this step
+  double get_flushed_E(void) const { return flushed_E; }
+
+  //! Return true if photons can be spilled
+  bool is_enabled(void) const { return max_in_memory > 0; }
+
+  //! Return bytes written to the spill files since reset_step_io
+  uint64_t get_step_bytes_written(void) const { return step_bytes_written; }
+
+  //! Return bytes read from the spill files since reset_step_io
+  uint64_t get_step_bytes_read(void) const { return step_bytes_read; }
+
+  //! Return seconds spent writing the spill files since reset_step_io
+  double get_step_write_time(void) const { return step_write_time; }
+
+  //! Return seconds spent reading the spill files since reset_step_io
+  double get_step_read_time(void) const { return step_read_time; }
+
+  //! Reduce the spill I/O since the last reset over ranks, print it on rank zero and reset
+  void print_step_io(const int rank) {
+    double sums[3] = {double(n_spilled), double(step_bytes_written), double(step_bytes_read)};
+    double max_times[2] = {step_write_time, step_read_time};
+    double g_sums[3], g_max_times[2];
+    MPI_Reduce(sums, g_sums, 3, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(max_times, g_max_times, 2, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+      constexpr double MB = 1024.0 * 1024.0;
+      std::cout << "Census spill: " << uint64_t(g_sums[0]) << " photons, wrote "
+                << g_sums[1] / MB << " MB in " << g_max_times[0] << " s, read " << g_sums[2] / MB
+                << " MB in " << g_max_times[1] << " s (max time over ranks)" << std::endl;
+    }
+    reset_step_io();
+  }
+
+  //! Zero the I/O counters reported each step
+  void reset_step_io(void) {
+    step_bytes_written = 0;
+    step_bytes_read = 0;
+    step_write_time = 0.0;
+    step_read_time = 0.0;
+  }
+
+private:
+  //! Return the spill record of a census photon
+  static Record make_record(const Photon &phtn) {
+    Record r;
+    r.pos = phtn.get_position();
+    r.angle = phtn.get_angle();
+    r.E = phtn.get_E();
+    r.E0 = phtn.get_E0();
+    r.life_dx = phtn.get_distance_remaining();
+    r.rng = phtn.get_rng();
+    r.cell = phtn.get_cell();
+    r.group = static_cast<uint16_t>(phtn.get_group());
+    r.source_type = static_cast<uint8_t>(phtn.get_source_type());
+    r.ddmc = phtn.is_ddmc();
+    return r;
+  }
+
+  //! Return the census photon of a spill record
+  static Photon make_photon(const Record &r) {
+    Photon phtn;
+    phtn.set_position(r.pos);
+    phtn.set_angle(r.angle);
+    phtn.set_E0(r.E0);
+    phtn.set_E(r.E);
+    phtn.set_distance_to_census(r.life_dx);
+    phtn.set_rng(r.rng);
+    phtn.set_cell(r.cell);
+    phtn.set_group(r.group);
+    phtn.set_source_type(r.source_type);
+    phtn.set_ddmc(r.ddmc);
+    phtn.set_descriptor(Constants::CENSUS);
+    return phtn;
+  }
+
+  //! Exit after a failed operation on the file being written
+  void fail(const std::string &operation) const {
+    std::cout << "ERROR: could not " << operation << " census spill file " << file_names[next]
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  //! Write or read n records at record index offset of a file, retrying partial transfers
+  void transfer(const int fd, Record *records, const uint64_t n, const uint64_t offset,
+                const bool write) const {
+    char *bytes = reinterpret_cast<char *>(records);
+    uint64_t done = 0;
+    const uint64_t total = n * sizeof(Record);
+    while (done < total) {
+      const off_t at = offset * sizeof(Record) + done;
+      const ssize_t moved = write ? pwrite(fd, bytes + done, total - done, at)
+                                  : pread(fd, bytes + done, total - done, at);
+      if (moved <= 0)
+        fail(write ? "write" : "read");
+      done += moved;
+    }
+  }
+
+  //! Append n photons to the file written this step, a staging chunk at a time
+  void append(const Photon *photons, const uint64_t n) {
+    Timer t_spill;
+    t_spill.start_timer("write");
+    if (fds[next] < 0) {
+      fds[next] = open(file_names[next].c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+      if (fds[next] < 0)
+        fail("create");
+    }
+    std::vector<Record> staging(std::min(n, staging_size));
+    for (uint64_t begin = 0; begin < n; begin += staging_size) {
+      const uint64_t count = std::min(staging_size, n - begin);
+      for (uint64_t i = 0; i < count; ++i) {
+        staging[i] = make_record(photons[begin + i]);
+        flushed_E += photons[begin + i].get_E();
+      }
+      transfer(fds[next], staging.data(), count, n_flushed + begin, true);
+    }
+    n_flushed += n;
+    t_spill.stop_timer("write");
+    step_bytes_written += n * sizeof(Record);
+    step_write_time += t_spill.get_time("write");
+  }
+
+  //! Map the first n records of a file for reading
+  void map(const int f, const uint64_t n) {
+    void *address = mmap(nullptr, n * sizeof(Record), PROT_READ, MAP_SHARED, fds[f], 0);
+    if (address == MAP_FAILED) {
+      std::cout << "ERROR: could not map census spill file " << file_names[f] << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    mapped = static_cast<const Record *>(address);
+    n_mapped = n;
+  }
+
+  //! Unmap the file being read if it's mapped
+  void unmap(void) {
+    if (mapped)
+      munmap(const_cast<Record *>(mapped), n_mapped * sizeof(Record));
+    mapped = nullptr;
+    n_mapped = 0;
+  }
+
+  //! Records converted at a time when writing
+  static constexpr uint64_t staging_size = 1 << 16;
+
+  const uint64_t max_in_memory;          //!< Census photons kept in memory, zero for no spilling
+  std::array<std::string, 2> file_names; //!< Spill files of this rank
+  std::array<int, 2> fds;                //!< Descriptors of the spill files
+  int next;                              //!< File written this step, the other one is read
+  const Record *mapped;                  //!< Mapped file being read
+  uint64_t n_mapped;                     //!< Photons the mapping holds
+  uint64_t n_spilled;                    //!< Photons spilled after the last step
+  uint64_t n_read;                       //!< Spilled photons read back this step
+  double spilled_E;                      //!< Energy of the spilled photons
+  uint64_t n_flushed;                    //!< Census photons written this step
+  double flushed_E;                      //!< Energy of the census photons written this step
+  uint64_t step_bytes_written;           //!< Bytes spilled since the last reset
+  uint64_t step_bytes_read;              //!< Bytes read back since the last reset
+  double step_write_time;                //!< Seconds spilling since the last reset
+  double step_read_time;                 //!< Seconds reading back since the last reset
+};
+
+// out-of-class definition, staging_size is passed by reference (needed before C++17)
+constexpr uint64_t Census_Store::staging_size;
+
+#endif // census_store_h_
+//---------------------------------------------------------------------------//
+// end of census_store.h
+//---------------------------------------------------------------------------//
@@ -0,0 +1,415 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   checkpoint.h
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Parallel checkpoint and restart of the census and material state with MPI-IO
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#ifndef checkpoint_h_
+#define checkpoint_h_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <mpi.h>
+#include <string>
+#include <sys/stat.h>
+#include <utility>
+#include <vector>
+
+#include "census_store.h"
+#include "imc_state.h"
+#include "info.h"
+#include "mesh.h"
+#include "photon.h"
+
+//! Checkpoint files hold the state at the start of a step:
+//
+// Header                      written by rank zero
+// Rank_Entry[n_ranks]         cells and photons written by each rank
+// Cell_Record[total cells]    each rank's records at the prefix sum of the cell counts
+// Photon[total photons]       census photons at the prefix sum of the photon counts
+//
+// Cells and photon cell IDs use the index in the undecomposed mesh (the SILO index) so a
+// checkpoint can be read with any decomposition. Photons are stored as raw bytes and can only be
+// read by builds with the same Photon layout.
+namespace Checkpoint {
+
+//! Fixed size header at the start of a checkpoint file
+struct Header {
+  char magic[8];                     //!< "BRNCHKP" and a null
+  uint32_t version;                  //!< Format version
+  uint32_t n_ranks;                  //!< Ranks that wrote the file
+  uint32_t n_global_cells;           //!< Cells in the mesh
+  uint32_t replicated;               //!< One if written in replicated mode
+  uint32_t photon_size;              //!< Bytes in each photon
+  uint32_t unused;                   //!< Padding
+  IMC_State::Checkpoint_Data state;  //!< Time, step and running totals
+};
+
+//! Number of cells and photons one rank wrote
+struct Rank_Entry {
+  uint64_t n_cells;   //!< Cell records
+  uint64_t n_photons; //!< Census photons
+};
+
+//! Material state of one cell
+struct Cell_Record {
+  uint32_t silo_index; //!< Index of the cell in the undecomposed mesh
+  uint32_t unused;     //!< Padding
+  double T_e;          //!< Material temperature
+  double T_r;          //!< Radiation temperature
+};
+
+//! Owner of a cell, found through a directory spread over the ranks by cell index
+struct Directory_Entry {
+  uint32_t silo_index; //!< Index of the cell in the undecomposed mesh
+  int32_t owner;       //!< Rank that owns the cell, -1 if no rank does
+  int32_t asker;       //!< Rank looking for the owner
+};
+
+//! Version of the format written
+constexpr uint32_t version = 1;
+
+//! Most items moved in one MPI-IO call, keeps counts in int range
+constexpr uint64_t max_chunk = 1 << 20;
+
+//! Return the string at the start of every checkpoint file
+inline const char *file_magic() { return "BRNCHKP"; }
+
+//! Return the name of the checkpoint for the start of a step
+inline std::string get_file_name(const std::string &directory, const uint32_t step) {
+  return directory + "/checkpoint_" + std::to_string(step) + ".brn";
+}
+
+//! Return a committed MPI type of size contiguous bytes, the caller frees it
+inline MPI_Datatype make_byte_type(const size_t size) {
+  MPI_Datatype byte_type;
+  MPI_Type_contiguous(size, MPI_BYTE, &byte_type);
+  MPI_Type_commit(&byte_type);
+  return byte_type;
+}
+
+//! Exit with a message from rank zero, every rank calls this with the same condition
+inline void check(const bool condition, const std::string &message, const int rank) {
+  if (!condition) {
+    if (rank == 0)
+      std::cout << "ERROR: " << message << ". Exiting..." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+//! Collective read of n items starting at an offset, every rank makes the same number of calls
+template <typename T>
+void read_chunks(MPI_File file, const MPI_Offset offset, T *items, const uint64_t n) {
+  MPI_Datatype item_type = make_byte_type(sizeof(T));
+  uint64_t n_chunks = (n + max_chunk - 1) / max_chunk;
+  MPI_Allreduce(MPI_IN_PLACE, &n_chunks, 1, MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD);
+  for (uint64_t c = 0; c < n_chunks; ++c) {
+    const uint64_t begin = std::min(c * max_chunk, n);
+    const uint64_t count = std::min(max_chunk, n - begin);
+    MPI_File_read_at_all(file, offset + begin * sizeof(T), items + begin, count, item_type,
+                         MPI_STATUS_IGNORE);
+  }
+  MPI_Type_free(&item_type);
+}
+
+//! Send each item to the rank returned by dest_of, items from one rank stay in order
+template <typename T, typename A, typename Dest>
+std::vector<T, A> redistribute(const std::vector<T, A> &items, Dest dest_of, const int n_ranks) {
+  std::vector<int> send_counts(n_ranks, 0), send_displs(n_ranks, 0);
+  std::vector<int> recv_counts(n_ranks, 0), recv_displs(n_ranks, 0);
+  std::vector<int> dest(items.size());
+  for (size_t i = 0; i < items.size(); ++i) {
+    dest[i] = dest_of(items[i]);
+    send_counts[dest[i]]++;
+  }
+  MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+  for (int r = 1; r < n_ranks; ++r) {
+    send_displs[r] = send_displs[r - 1] + send_counts[r - 1];
+    recv_displs[r] = recv_displs[r - 1] + recv_counts[r - 1];
+  }
+
+  std::vector<T, A> send(items.size());
+  std::vector<int> next(send_displs);
+  for (size_t i = 0; i < items.size(); ++i)
+    send[next[dest[i]]++] = items[i];
+  std::vector<T, A> recv(recv_displs.back() + recv_counts.back());
+
+  MPI_Datatype item_type = make_byte_type(sizeof(T));
+  MPI_Alltoallv(send.data(), send_counts.data(), send_displs.data(), item_type, recv.data(),
+                recv_counts.data(), recv_displs.data(), item_type, MPI_COMM_WORLD);
+  MPI_Type_free(&item_type);
+  return recv;
+}
+
+//! Return the owner of each of the sorted, unique cell indices in wanted
+//
+// Rank silo_index % n_ranks keeps the owners of its indices, every rank registers its cells
+// there and asks it about the ones it wants, so no rank holds a global-size array.
+inline std::vector<int32_t> find_owners(const std::vector<uint32_t> &wanted, const Mesh &mesh,
+                                        const int rank, const int n_ranks) {
+  auto directory_rank = [n_ranks](const Directory_Entry &entry) {
+    return int(entry.silo_index % n_ranks);
+  };
+  std::vector<Directory_Entry> local(mesh.get_n_local_cells());
+  for (uint32_t i = 0; i < local.size(); ++i)
+    local[i] = {mesh.get_cell_ref(i).get_silo_index(), rank, rank};
+  std::vector<Directory_Entry> directory = redistribute(local, directory_rank, n_ranks);
+  auto by_index = [](const Directory_Entry &a, const Directory_Entry &b) {
+    return a.silo_index < b.silo_index;
+  };
+  std::sort(directory.begin(), directory.end(), by_index);
+
+  // questions go to the directory rank of each index and come back answered
+  std::vector<Directory_Entry> questions(wanted.size());
+  for (size_t i = 0; i < wanted.size(); ++i)
+    questions[i] = {wanted[i], -1, rank};
+  std::vector<Directory_Entry> answers = redistribute(questions, directory_rank, n_ranks);
+  for (auto &answer : answers) {
+    auto found = std::lower_bound(directory.begin(), directory.end(), answer, by_index);
+    if (found != directory.end() && found->silo_index == answer.silo_index)
+      answer.owner = found->owner;
+  }
+  answers = redistribute(answers, [](const Directory_Entry &entry) { return entry.asker; },
+                         n_ranks);
+  std::sort(answers.begin(), answers.end(), by_index);
+
+  std::vector<int32_t> owners(wanted.size());
+  for (size_t i = 0; i < wanted.size(); ++i)
+    owners[i] = answers[i].owner;
+  return owners;
+}
+
+//! Write the state at the start of the current step, returns the file name
+//
+// In domain decomposed mode each rank writes its cells and census. In replicated mode every rank
+// holds every cell so only rank zero writes cells, all ranks write their census. The census is
+// census_photons followed by the photons spilled to census_store, if given, which are copied a
+// chunk at a time.
+inline std::string write(const std::string &directory, const Mesh &mesh,
+                         const IMC_State &imc_state, const Photon_Vector &census_photons,
+                         const Info &mpi_info, const bool replicated,
+                         const Census_Store *census_store = nullptr) {
+  const int rank = mpi_info.get_rank();
+  const int n_ranks = mpi_info.get_n_rank();
+  const std::string file_name = get_file_name(directory, imc_state.get_step());
+
+  std::vector<Cell_Record> cells;
+  if (!replicated || rank == 0) {
+    cells.reserve(mesh.get_n_local_cells());
+    for (uint32_t i = 0; i < mesh.get_n_local_cells(); ++i) {
+      const Cell &cell = mesh.get_cell_ref(i);
+      cells.push_back({cell.get_silo_index(), 0, cell.get_T_e(), mesh.get_T_r(i)});
+    }
+  }
+
+  // where this rank's cells and photons go
+  const uint64_t n_in_memory = census_photons.size();
+  const uint64_t n_spilled = census_store ? census_store->get_n_spilled() : 0;
+  const Rank_Entry entry = {cells.size(), n_in_memory + n_spilled};
+  uint64_t counts[2] = {entry.n_cells, entry.n_photons};
+  uint64_t starts[2] = {0, 0};
+  uint64_t totals[2] = {0, 0};
+  MPI_Exscan(counts, starts, 2, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+  if (rank == 0)
+    starts[0] = starts[1] = 0;
+  MPI_Allreduce(counts, totals, 2, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+  const MPI_Offset table_offset = sizeof(Header);
+  const MPI_Offset cells_offset = table_offset + n_ranks * sizeof(Rank_Entry);
+  const MPI_Offset photons_offset = cells_offset + totals[0] * sizeof(Cell_Record);
+
+  if (rank == 0)
+    mkdir(directory.c_str(), 0755);
+  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_File file;
+  const int err = MPI_File_open(MPI_COMM_WORLD, file_name.c_str(),
+                                MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file);
+  check(err == MPI_SUCCESS, "could not create checkpoint " + file_name, rank);
+  MPI_File_set_size(file, 0);
+
+  // the running transport time total is only kept on rank zero
+  if (rank == 0) {
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    std::strncpy(header.magic, file_magic(), sizeof(header.magic));
+    header.version = version;
+    header.n_ranks = n_ranks;
+    header.n_global_cells = mesh.get_n_global_cells();
+    header.replicated = replicated;
+    header.photon_size = sizeof(Photon);
+    header.state = imc_state.get_checkpoint_data();
+    MPI_File_write_at(file, 0, &header, sizeof(Header), MPI_BYTE, MPI_STATUS_IGNORE);
+  }
+  MPI_File_write_at_all(file, table_offset + rank * sizeof(Rank_Entry), &entry,
+                        sizeof(Rank_Entry), MPI_BYTE, MPI_STATUS_IGNORE);
+
+  MPI_Datatype cell_type = make_byte_type(sizeof(Cell_Record));
+  MPI_File_write_at_all(file, cells_offset + starts[0] * sizeof(Cell_Record), cells.data(),
+                        cells.size(), cell_type, MPI_STATUS_IGNORE);
+  MPI_Type_free(&cell_type);
+
+  // photons are written in chunks with their cell replaced by the undecomposed index
+  MPI_Datatype photon_type = make_byte_type(sizeof(Photon));
+  uint64_t n_chunks = (entry.n_photons + max_chunk - 1) / max_chunk;
+  MPI_Allreduce(MPI_IN_PLACE, &n_chunks, 1, MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD);
+  Photon_Vector chunk;
+  for (uint64_t c = 0; c < n_chunks; ++c) {
+    const uint64_t begin = std::min(c * max_chunk, entry.n_photons);
+    const uint64_t count = std::min(max_chunk, entry.n_photons - begin);
+    const uint64_t end = begin + count;
+    const uint64_t memory_end = std::min(end, n_in_memory);
+    chunk.clear();
+    if (begin < memory_end)
+      chunk.assign(census_photons.begin() + begin, census_photons.begin() + memory_end);
+    if (end > n_in_memory) {
+      const uint64_t spilled_begin = std::max(begin, n_in_memory) - n_in_memory;
+      census_store->append_spilled(spilled_begin, end - n_in_memory - spilled_begin, chunk);
+    }
+    for (auto &photon : chunk)
+      photon.set_cell(mesh.get_cell_ref(mesh.get_local_index(photon.get_cell())).get_silo_index());
+    MPI_File_write_at_all(file, photons_offset + (starts[1] + begin) * sizeof(Photon),
+                          chunk.data(), count, photon_type, MPI_STATUS_IGNORE);
+  }
+  MPI_Type_free(&photon_type);
+
+  MPI_File_close(&file);
+  return file_name;
+}
+
+//! Restore the census, cell temperatures and state from a checkpoint
+//
+// With the rank count of the writer each rank reads the chunk at its own offset. Otherwise each
+// rank reads an even share and the cells and photons are sent to the ranks that own them, found
+// through find_owners, so the mesh is never repartitioned. In replicated mode every rank reads
+// all cells.
+inline void read(const std::string &file_name, Mesh &mesh, IMC_State &imc_state,
+                 Photon_Vector &census_photons, const Info &mpi_info, const bool replicated) {
+  const int rank = mpi_info.get_rank();
+  const int n_ranks = mpi_info.get_n_rank();
+  const uint32_t n_global = mesh.get_n_global_cells();
+
+  MPI_File file;
+  const int err =
+      MPI_File_open(MPI_COMM_WORLD, file_name.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &file);
+  check(err == MPI_SUCCESS, "could not open checkpoint " + file_name, rank);
+
+  Header header;
+  MPI_File_read_at_all(file, 0, &header, sizeof(Header), MPI_BYTE, MPI_STATUS_IGNORE);
+  check(std::strncmp(header.magic, file_magic(), sizeof(header.magic)) == 0 &&
+            header.version == version,
+        file_name + " is not a version " + std::to_string(version) + " checkpoint", rank);
+  check(header.photon_size == sizeof(Photon),
+        file_name + " was written by a build with a different photon layout", rank);
+  check(header.n_global_cells == n_global, file_name + " is for a different mesh", rank);
+  check(bool(header.replicated) == replicated,
+        file_name + " was written in a different transport mode", rank);
+
+  std::vector<Rank_Entry> table(header.n_ranks);
+  read_chunks(file, sizeof(Header), table.data(), table.size());
+  std::vector<uint64_t> cell_starts(header.n_ranks + 1, 0), photon_starts(header.n_ranks + 1, 0);
+  for (uint32_t r = 0; r < header.n_ranks; ++r) {
+    cell_starts[r + 1] = cell_starts[r] + table[r].n_cells;
+    photon_starts[r + 1] = photon_starts[r] + table[r].n_photons;
+  }
+  const uint64_t total_cells = cell_starts.back();
+  const uint64_t total_photons = photon_starts.back();
+  const MPI_Offset cells_offset = sizeof(Header) + header.n_ranks * sizeof(Rank_Entry);
+  const MPI_Offset photons_offset = cells_offset + total_cells * sizeof(Cell_Record);
+
+  // this rank's chunk if the rank count matches, otherwise an even share
+  uint64_t cell_begin, cell_end, photon_begin, photon_end;
+  if (header.n_ranks == uint32_t(n_ranks)) {
+    cell_begin = cell_starts[rank];
+    cell_end = cell_starts[rank + 1];
+    photon_begin = photon_starts[rank];
+    photon_end = photon_starts[rank + 1];
+  } else {
+    cell_begin = total_cells * rank / n_ranks;
+    cell_end = total_cells * (rank + 1) / n_ranks;
+    photon_begin = total_photons * rank / n_ranks;
+    photon_end = total_photons * (rank + 1) / n_ranks;
+  }
+  if (replicated) {
+    cell_begin = 0;
+    cell_end = total_cells;
+  }
+
+  std::vector<Cell_Record> cells(cell_end - cell_begin);
+  read_chunks(file, cells_offset + cell_begin * sizeof(Cell_Record), cells.data(), cells.size());
+  Photon_Vector photons(photon_end - photon_begin);
+  read_chunks(file, photons_offset + photon_begin * sizeof(Photon), photons.data(),
+              photons.size());
+  MPI_File_close(&file);
+
+  // local index of each undecomposed cell index on this rank, found by binary search
+  const uint32_t not_local = UINT32_MAX;
+  std::vector<std::pair<uint32_t, uint32_t>> by_silo(mesh.get_n_local_cells());
+  for (uint32_t i = 0; i < by_silo.size(); ++i)
+    by_silo[i] = {mesh.get_cell_ref(i).get_silo_index(), i};
+  std::sort(by_silo.begin(), by_silo.end());
+  auto local_index = [&by_silo, not_local](const uint32_t silo_index) {
+    auto found = std::lower_bound(by_silo.begin(), by_silo.end(),
+                                  std::make_pair(silo_index, uint32_t(0)));
+    return (found != by_silo.end() && found->first == silo_index) ? found->second : not_local;
+  };
+
+  // in domain decomposed mode move anything read on the wrong rank to its owner, with the
+  // writer's rank count and decomposition every record is already local
+  if (!replicated) {
+    std::vector<uint32_t> wanted;
+    for (auto const &cell : cells) {
+      if (local_index(cell.silo_index) == not_local)
+        wanted.push_back(cell.silo_index);
+    }
+    for (auto const &photon : photons) {
+      if (local_index(photon.get_cell()) == not_local)
+        wanted.push_back(photon.get_cell());
+    }
+    int misplaced = !wanted.empty();
+    MPI_Allreduce(MPI_IN_PLACE, &misplaced, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    if (misplaced) {
+      std::sort(wanted.begin(), wanted.end());
+      wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+      const std::vector<int32_t> wanted_owner = find_owners(wanted, mesh, rank, n_ranks);
+      int all_owned = std::find(wanted_owner.begin(), wanted_owner.end(), -1) ==
+                      wanted_owner.end();
+      MPI_Allreduce(MPI_IN_PLACE, &all_owned, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+      check(all_owned, file_name + " has cells that are not in this mesh", rank);
+      auto owner = [&](const uint32_t silo_index) {
+        if (local_index(silo_index) != not_local)
+          return int(rank);
+        auto found = std::lower_bound(wanted.begin(), wanted.end(), silo_index);
+        return int(wanted_owner[found - wanted.begin()]);
+      };
+      cells = redistribute(
+          cells, [&owner](const Cell_Record &cell) { return owner(cell.silo_index); }, n_ranks);
+      photons = redistribute(
+          photons, [&owner](const Photon &photon) { return owner(photon.get_cell()); }, n_ranks);
+    }
+  }
+
+  // every local cell gets exactly one record
+  int all_cells = cells.size() == mesh.get_n_local_cells();
+  MPI_Allreduce(MPI_IN_PLACE, &all_cells, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+  check(all_cells, file_name + " does not match the cells of this mesh", rank);
+  for (auto const &cell : cells)
+    mesh.set_temperatures(local_index(cell.silo_index), cell.T_e, cell.T_r);
+  for (auto &photon : photons)
+    photon.set_cell(mesh.get_offset() + local_index(photon.get_cell()));
+  census_photons.swap(photons);
+
+  imc_state.set_checkpoint_data(header.state);
+}
+
+} // namespace Checkpoint
+
+#endif // checkpoint_h_
+//---------------------------------------------------------------------------//
+// end of checkpoint.h
+//---------------------------------------------------------------------------//
@@ -12,53 +12,187 @@
 #ifndef comb_photons_h_
 #define comb_photons_h_
 
-#include <unordered_map>
+#include <algorithm>
+#include <mpi.h>
+#include <vector>
 
-void comb_photons(std::vector<Photon> &census_photons,
-                  int64_t max_census_photons, RNG *rng) {
-  std::unordered_map<uint32_t, uint32_t> cell_census_count;
-  std::unordered_map<uint32_t, double> cell_census_E;
-  std::unordered_map<uint32_t, double> cell_corrected_E;
+#include "RNG.h"
+#include "census_store.h"
+#include "census_creation.h"
+#include "config.h"
+#include "photon.h"
 
-  std::vector<Photon> post_comb_photons;
+//! Spawn key base for comb generators, the step number is added to it
+constexpr uint64_t comb_rng_spawn_base = 1UL << 32;
 
-  double census_total_E = get_photon_list_E(census_photons);
-  double global_census_E = census_total_E;
-  MPI_Allreduce(MPI_IN_PLACE, &global_census_E, 1, MPI_DOUBLE, MPI_SUM,
-                MPI_COMM_WORLD);
-  double comb_photon_E = global_census_E / double(max_census_photons);
+//----------------------------------------------------------------------------//
+//! Comb the photons of one cell down to about cell_E / comb_E photons, return the number kept
+//
+// The number of teeth is cell_E / comb_E rounded up or down at random and the teeth are placed at
+// (k + xi) * cell_E / n_teeth along the cumulative energy of the cell's photons. A photon hit by n
+// teeth is kept with n / n_teeth of the cell's energy, so the cell energy is conserved exactly and
+// the expected energy of each photon is unchanged. A cell with no teeth keeps one photon, chosen
+// with probability proportional to its energy. Dropped photons have their energy set to zero.
+inline uint64_t comb_cell(Photon *photons, const uint64_t n_photons, const double comb_E,
+                          RNG &rng) {
+  double cell_E = 0.0;
+  for (uint64_t i = 0; i < n_photons; ++i)
+    cell_E += photons[i].get_E();
+  const double xi = rng.generate_random_number();
+  const uint64_t n_teeth = static_cast<uint64_t>(cell_E / comb_E + xi);
+  // combing can't reduce this cell, leave it alone
+  if (n_teeth >= n_photons)
+    return n_photons;
 
-  for (auto &p : census_photons) {
-    cell_census_count[p.get_cell()]++;
-    cell_census_E[p.get_cell()] += p.get_E();
+  // one tooth per cell at least, spread over the cell's energy
+  const uint64_t n_cell_teeth = std::max(n_teeth, uint64_t(1));
+  const double tooth_E = cell_E / n_cell_teeth;
+  double next_tooth = rng.generate_random_number() * tooth_E;
+  double running_E = 0.0;
+  uint64_t n_hits_total = 0;
+  uint64_t n_kept = 0;
+  for (uint64_t i = 0; i < n_photons; ++i) {
+    running_E += photons[i].get_E();
+    uint64_t n_hits = 0;
+    while (next_tooth < running_E && n_hits_total < n_cell_teeth) {
+      n_hits++;
+      n_hits_total++;
+      next_tooth += tooth_E;
+    }
+    // roundoff in the running sum can leave the last tooth past the end
+    if (i == n_photons - 1) {
+      n_hits += n_cell_teeth - n_hits_total;
+      n_hits_total = n_cell_teeth;
+    }
+    photons[i].set_E(n_hits * tooth_E);
+    if (n_hits)
+      n_kept++;
+  }
+  return n_kept;
+}
+
+//----------------------------------------------------------------------------//
+//! Order photons by local cell with a stable counting sort and set cell_start to the start of
+// each cell's photons (n_local_cells + 1 entries)
+//
+// Each thread counts the cells of a contiguous chunk of photons, and the prefix sum over cells,
+// then chunks, gives every (cell, chunk) pair its own range of the output, so the scatter runs in
+// parallel and photons of a cell keep their order. An already sorted list isn't copied.
+inline void sort_by_cell(Photon_Vector &photons, const uint32_t n_local_cells,
+                         const uint32_t rank_cell_offset, std::vector<uint64_t> &cell_start) {
+  const uint64_t n_photons = photons.size();
+#ifdef USE_OPENMP
+  const int n_chunks = omp_get_max_threads();
+#else
+  const int n_chunks = 1;
+#endif
+  auto chunk_begin = [&](const int k) { return n_photons * k / n_chunks; };
+
+  // count[c * n_chunks + k] is the number of chunk k photons in local cell c, turned into the
+  // output position of the first of them
+  std::vector<uint64_t> count(static_cast<uint64_t>(n_local_cells) * n_chunks, 0);
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (int k = 0; k < n_chunks; ++k) {
+    for (uint64_t i = chunk_begin(k); i < chunk_begin(k + 1); ++i)
+      count[static_cast<uint64_t>(photons[i].get_cell() - rank_cell_offset) * n_chunks + k]++;
+  }
+  cell_start.assign(n_local_cells + 1, 0);
+  uint64_t position = 0;
+  for (uint32_t c = 0; c < n_local_cells; ++c) {
+    cell_start[c] = position;
+    for (int k = 0; k < n_chunks; ++k) {
+      const uint64_t n = count[static_cast<uint64_t>(c) * n_chunks + k];
+      count[static_cast<uint64_t>(c) * n_chunks + k] = position;
+      position += n;
+    }
+  }
+  cell_start[n_local_cells] = position;
+
+  if (std::is_sorted(photons.begin(), photons.end()))
+    return;
+
+  Photon_Vector sorted(n_photons);
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (int k = 0; k < n_chunks; ++k) {
+    for (uint64_t i = chunk_begin(k); i < chunk_begin(k + 1); ++i) {
+      const uint64_t slot = static_cast<uint64_t>(photons[i].get_cell() - rank_cell_offset);
+      sorted[count[slot * n_chunks + k]++] = photons[i];
+    }
   }
+  photons.swap(sorted);
+}
 
-  for (auto ip = census_photons.begin(); ip != census_photons.end(); ++ip) {
-    uint32_t cell = ip->get_cell();
-    double p_kill = 1.0 - ip->get_E() / comb_photon_E;
-    double rand_check = rng->generate_random_number();
-    // save the photon probabilistically or if there is only one photon
-    // remaining in the cell
-    if (rand_check > p_kill || cell_census_count[cell] == 1) {
-      ip->set_E(comb_photon_E);
-      cell_corrected_E[cell] += comb_photon_E;
-      post_comb_photons.push_back(*ip);
-    } else {
-      cell_census_count[cell]--;
+//----------------------------------------------------------------------------//
+//! Comb each cell of a list of census photons with the given comb energy and drop the photons
+// that lose their energy. Cells use their own RNG stream, spawn separates lists of one step.
+inline void comb_list(Photon_Vector &census_photons, const double comb_E,
+                      const uint32_t n_local_cells, const uint32_t rank_cell_offset,
+                      const uint32_t seed, const uint64_t spawn, const int rank) {
+  // start of each local cell's photons in the sorted census
+  std::vector<uint64_t> cell_start;
+  sort_by_cell(census_photons, n_local_cells, rank_cell_offset, cell_start);
+
+  Photon *photons = census_photons.data();
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(guided)
+#endif
+  for (int i = 0; i < static_cast<int>(n_local_cells); ++i) {
+    const uint64_t n_cell_photons = cell_start[i + 1] - cell_start[i];
+    if (n_cell_photons > 1) {
+      const uint64_t stream = (static_cast<uint64_t>(rank) << 32) + rank_cell_offset + i;
+      RNG rng(seed, stream, spawn);
+      comb_cell(photons + cell_start[i], n_cell_photons, comb_E, rng);
     }
   }
 
-  // correct energy for conservation
-  double new_E;
-  uint32_t cell;
-  for (auto &p : post_comb_photons) {
-    cell = p.get_cell();
-    new_E = p.get_E() + (cell_census_E[cell] - cell_corrected_E[cell]) /
-                            double(cell_census_count[cell]);
-    p.set_E(new_E);
+  // compact the kept photons in place, kept photons never move to a later index
+  uint64_t n_kept = 0;
+  for (uint64_t i = 0; i < census_photons.size(); ++i) {
+    if (photons[i].get_E() > 0.0)
+      photons[n_kept++] = photons[i];
+  }
+  census_photons.resize(n_kept);
+}
+
+//----------------------------------------------------------------------------//
+//! Comb the census if the global census is larger than max_census_photons
+//
+// Photons must be on this rank's cells. Each cell is combed independently on its own RNG stream
+// (keyed by rank, global cell and step) so the result does not depend on the thread count. Census
+// photons flushed to the census store during transport are combed a chunk at a time with the same
+// comb energy, each chunk conserves the energy of its cells so the census does too.
+void comb_photons(Photon_Vector &census_photons, const uint64_t max_census_photons,
+                  const uint32_t n_local_cells, const uint32_t rank_cell_offset,
+                  const uint32_t seed, const uint32_t step, const int rank,
+                  Census_Store *census_store = nullptr) {
+  // global census size and energy
+  double census_info[2] = {static_cast<double>(census_photons.size()),
+                           get_photon_list_E(census_photons)};
+  if (census_store) {
+    census_info[0] += census_store->get_n_flushed();
+    census_info[1] += census_store->get_flushed_E();
   }
+  MPI_Allreduce(MPI_IN_PLACE, census_info, 2, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+  if (census_info[0] <= static_cast<double>(max_census_photons) || census_info[1] <= 0.0)
+    return;
+  const double comb_E = census_info[1] / static_cast<double>(max_census_photons);
 
-  census_photons = post_comb_photons;
+  comb_list(census_photons, comb_E, n_local_cells, rank_cell_offset, seed,
+            comb_rng_spawn_base + step, rank);
+  // flushed chunks get their own spawn keys, after the one of the in-memory census
+  if (census_store) {
+    census_store->process_flushed([&](Photon_Vector &chunk, const uint64_t chunk_index) {
+      comb_list(chunk, comb_E, n_local_cells, rank_cell_offset, seed,
+                comb_rng_spawn_base * (chunk_index + 2) + step, rank);
+    });
+  }
 }
 
 #endif // comb_photons_h_
+//---------------------------------------------------------------------------//
+// end of comb_photons.h
+//---------------------------------------------------------------------------//
@@ -12,6 +12,8 @@
 #ifndef constants_h_
 #define constants_h_
 
+#include <cstdint>
+
 namespace Constants {
 constexpr double pi(3.1415926535897932384626433832795); //!< Pi
 constexpr double c(299.792458); //!< speed of light in cm/shake
@@ -21,16 +23,17 @@ constexpr double h(6.62606957e-34 * 1.0e-9 /
 constexpr double k(1.60219e-31); //!< energy conversion constant GJ/keV
 constexpr double a(0.01372);     //!< Boltzmann constant in GJ/cm^3/keV^4
 constexpr double a_SO(1.0);      //!< Boltzmann constant for SO problems
-constexpr double cutoff_fraction = 0.01; // note: get this from IMC_state in the future
+constexpr uint64_t history_token(1UL << 24); //!< Completion token of one unsplit history
 
 enum bc_type { REFLECT, VACUUM, ELEMENT, SOURCE, PROCESSOR }; //!< Boundary conditions
 enum dir_type { X_NEG, X_POS, Y_NEG, Y_POS, Z_NEG, Z_POS }; //!< Directions
-enum event_type : unsigned char { EXIT, PASS, CENSUS, SCATTER, KILLED, BOUND };         //!< Events
+enum event_type : unsigned char { EXIT, PASS, CENSUS, SCATTER, KILLED, BOUND, SPLIT }; //!< Events
 enum {
   PARTICLE_PASS,
   REPLICATED
 };                                 //!< Parallel types
 enum { NO_DECOMP, METIS, CUBE };   //!< Mesh decomposition method
+enum { UNIFORM_SAMPLING, STRATIFIED_SAMPLING, SOBOL_SAMPLING }; //!< Source sampling methods
 constexpr int grip_id_tag(1);          //!< MPI tag for grip ID messages
 constexpr int cell_id_tag(2);          //!< MPI tag for requested cell ID messages
 constexpr int count_tag(3);            //!< MPI tag for completion count messages
@@ -0,0 +1,110 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   ddmc.h
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Discrete diffusion Monte Carlo leakage and interface functions
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#ifndef ddmc_h_
+#define ddmc_h_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "RNG.h"
+#include "cell.h"
+#include "config.h"
+#include "constants.h"
+
+//! Extrapolation distance in mean free paths for the Marshak interface condition
+constexpr double ddmc_extrapolation = 0.7104;
+
+//----------------------------------------------------------------------------//
+//! Leakage opacity (1/cm) from DDMC cell i to DDMC cell j across a shared face
+//
+// From the diffusion current between two cell averages with a continuous current at the face,
+// sigma is the total opacity and dx the width normal to the face
+inline double get_ddmc_interior_leakage(const double dx_i, const double sigma_i, const double dx_j,
+                                        const double sigma_j) {
+  return 2.0 / (3.0 * dx_i) / (sigma_i * dx_i + sigma_j * dx_j);
+}
+
+//----------------------------------------------------------------------------//
+//! Leakage opacity (1/cm) from a DDMC cell through a face to IMC cells or a boundary
+inline double get_ddmc_interface_leakage(const double dx, const double sigma) {
+  return 2.0 / (3.0 * dx) / (sigma * dx + 2.0 * ddmc_extrapolation);
+}
+
+//----------------------------------------------------------------------------//
+//! Probability an IMC photon entering a DDMC cell with direction cosine mu (to the face) is kept
+GPU_HOST_DEVICE
+inline double get_ddmc_acceptance(const double mu, const double sigma, const double dx) {
+  const double p = 4.0 * (1.0 + 1.5 * mu) / (3.0 * sigma * dx + 6.0 * ddmc_extrapolation);
+  return p < 1.0 ? p : 1.0;
+}
+
+//----------------------------------------------------------------------------//
+//! Sample the face a DDMC photon leaks through, proportional to the face leakage opacities
+GPU_HOST_DEVICE
+inline uint32_t sample_leakage_face(const Cell &cell, RNG &rng) {
+  double target = rng.generate_random_number() * cell.get_total_leakage_op();
+  uint32_t face = 0;
+  // skip zero faces so roundoff can't select a reflecting face
+  for (uint32_t i = 0; i < 6; ++i) {
+    if (cell.get_leakage_op(i) > 0.0) {
+      face = i;
+      target -= cell.get_leakage_op(i);
+      if (target <= 0.0)
+        break;
+    }
+  }
+  return face;
+}
+
+//----------------------------------------------------------------------------//
+//! Direction of a photon leaving a DDMC cell through a face
+//
+// The cosine to the outward normal has the asymptotic diffusion distribution mu (1 + 3/2 mu),
+// sampled by rejection, and the azimuth is uniform
+GPU_HOST_DEVICE
+inline std::array<double, 3> get_ddmc_exit_angle(const uint32_t face, RNG &rng) {
+  double mu = 0.0;
+  do {
+    mu = rng.generate_random_number();
+  } while (2.5 * rng.generate_random_number() > mu * (1.0 + 1.5 * mu));
+  const double phi = 2.0 * Constants::pi * rng.generate_random_number();
+  const double sin_theta = std::sqrt(1.0 - mu * mu);
+  const uint32_t d = face / 2;
+  std::array<double, 3> angle;
+  angle[d] = (face % 2) ? mu : -mu;
+  angle[(d + 1) % 3] = sin_theta * std::cos(phi);
+  angle[(d + 2) % 3] = sin_theta * std::sin(phi);
+  return angle;
+}
+
+//----------------------------------------------------------------------------//
+//! Return the face of the cell a point on its surface lies on
+GPU_HOST_DEVICE
+inline uint32_t get_face_at_position(const Cell &cell, const std::array<double, 3> &pos) {
+  const double *nodes = cell.get_node_array();
+  uint32_t face = 0;
+  double min_dist = 1.0e100;
+  for (uint32_t i = 0; i < 6; ++i) {
+    const double dist = std::abs(pos[i / 2] - nodes[i]);
+    if (dist < min_dist) {
+      min_dist = dist;
+      face = i;
+    }
+  }
+  return face;
+}
+
+#endif // ddmc_h_
+//---------------------------------------------------------------------------//
+// end of ddmc.h
+//---------------------------------------------------------------------------//
@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "buffer.h"
+#include "mpi_trace.h"
 #include "mpi_types.h"
 #include "proto_mesh.h"
 #include "timer.h"
@@ -37,7 +38,7 @@ void print_MPI_out(const Proto_Mesh &mesh, const uint32_t rank,
                    const uint32_t size) {
   using std::cout;
   cout.flush();
-  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Trace::Barrier(MPI_COMM_WORLD);
 
   for (uint32_t p_rank = 0; p_rank < size; ++p_rank) {
     if (rank == p_rank) {
@@ -45,7 +46,7 @@ void print_MPI_out(const Proto_Mesh &mesh, const uint32_t rank,
       cout.flush();
     }
     usleep(100);
-    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Trace::Barrier(MPI_COMM_WORLD);
     usleep(100);
   }
 }
@@ -80,8 +81,8 @@ std::vector<int> metis_partition(Proto_Mesh &mesh, int &edgecut, const int rank,
   uint32_t ncell_on_rank = mesh.get_n_local_cells();
   start_ncells[rank] = ncell_on_rank;
 
-  MPI_Allreduce(MPI_IN_PLACE, &start_ncells[0], n_rank, MPI_INT, MPI_SUM,
-                MPI_COMM_WORLD);
+  MPI_Trace::Allreduce(MPI_IN_PLACE, &start_ncells[0], n_rank, MPI_INT, MPI_SUM,
+                       MPI_COMM_WORLD);
   partial_sum(start_ncells.begin(), start_ncells.end(), vtxdist.begin());
   vtxdist.insert(vtxdist.begin(), 0);
 
@@ -94,10 +95,10 @@ std::vector<int> metis_partition(Proto_Mesh &mesh, int &edgecut, const int rank,
   if (rank != 0) {
     const std::vector<Proto_Cell> send_cells =
         mesh.get_pre_window_allocation_cells();
-    MPI_Send(send_cells.data(), ncell_on_rank, MPI_Proto_Cell, 0, cell_tag,
-             MPI_COMM_WORLD);
-    MPI_Recv(part.data(), ncell_on_rank, MPI_INT, 0, part_tag, MPI_COMM_WORLD,
-             MPI_STATUS_IGNORE);
+    MPI_Trace::Send(send_cells.data(), ncell_on_rank, MPI_Proto_Cell, 0, cell_tag,
+                    MPI_COMM_WORLD);
+    MPI_Trace::Recv(part.data(), ncell_on_rank, MPI_INT, 0, part_tag, MPI_COMM_WORLD,
+                    MPI_STATUS_IGNORE);
     edgecut = 1;
   }
   // root rank gathers all cells and uses METIS to setup partitions
@@ -107,8 +108,8 @@ std::vector<int> metis_partition(Proto_Mesh &mesh, int &edgecut, const int rank,
         mesh.get_pre_window_allocation_cells();
     std::copy(send_cells.begin(), send_cells.end(), all_cells.begin());
     for (int irank = 1; irank < n_rank; ++irank) {
-      MPI_Recv(&all_cells[vtxdist[irank]], start_ncells[irank], MPI_Proto_Cell,
-               irank, cell_tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+      MPI_Trace::Recv(&all_cells[vtxdist[irank]], start_ncells[irank], MPI_Proto_Cell,
+                      irank, cell_tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
     }
 
     // do partitioning
@@ -199,8 +200,8 @@ std::vector<int> metis_partition(Proto_Mesh &mesh, int &edgecut, const int rank,
 
     // send partitioning to other ranks
     for (int irank = 1; irank < n_rank; ++irank) {
-      MPI_Send(&global_part[vtxdist[irank]], start_ncells[irank], MPI_INT,
-               irank, part_tag, MPI_COMM_WORLD);
+      MPI_Trace::Send(&global_part[vtxdist[irank]], start_ncells[irank], MPI_INT,
+                      irank, part_tag, MPI_COMM_WORLD);
     }
 
     // copy out root ranks partitioning
@@ -291,16 +292,16 @@ void exchange_cells_post_partitioning(const int rank,
   MPI_Win_allocate(1 * sizeof(int), 1 * sizeof(int), MPI_INFO_NULL,
                    MPI_COMM_WORLD, &n_donors_win, &win);
   n_donors_win[0] = 0;
-  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Trace::Barrier(MPI_COMM_WORLD);
   int assert = MPI_MODE_NOCHECK; // no conflicting locks on this window
   MPI_Win_lock_all(assert, win);
   for (auto ir : acceptor_ranks) {
     // increment the remote number of receives
-    MPI_Raccumulate(&one, 1, MPI_INT, ir, 0, 1, MPI_INT, MPI_SUM, win, &req);
-    MPI_Wait(&req, MPI_STATUS_IGNORE);
+    MPI_Trace::Raccumulate(&one, 1, MPI_INT, ir, 0, 1, MPI_INT, MPI_SUM, win, &req);
+    MPI_Trace::Wait(&req, MPI_STATUS_IGNORE);
   }
   MPI_Win_unlock_all(win);
-  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Trace::Barrier(MPI_COMM_WORLD);
   n_donors = n_donors_win[0];
   MPI_Win_free(&win);
 
@@ -325,19 +326,19 @@ void exchange_cells_post_partitioning(const int rank,
     send_to_rank[isend] = send_list.size();
     send_cell[isend].fill(send_list);
 
-    MPI_Isend(&send_to_rank[isend], 1, MPI_UNSIGNED, ir, 0, MPI_COMM_WORLD,
-              &reqs[isend]);
+    MPI_Trace::Isend(&send_to_rank[isend], 1, MPI_UNSIGNED, ir, 0, MPI_COMM_WORLD,
+                     &reqs[isend]);
     isend++;
   }
 
   // receive sizes, ranks
   for (int i = 0; i < n_donors; ++i) {
-    MPI_Irecv(&recv_from_rank[i], 1, MPI_UNSIGNED, MPI_ANY_SOURCE, 0,
-              MPI_COMM_WORLD, &reqs[n_acceptors + i]);
+    MPI_Trace::Irecv(&recv_from_rank[i], 1, MPI_UNSIGNED, MPI_ANY_SOURCE, 0,
+                     MPI_COMM_WORLD, &reqs[n_acceptors + i]);
   }
 
-  MPI_Waitall(reqs.size(), &reqs[0], &status[0]);
-  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Trace::Waitall(reqs.size(), &reqs[0], &status[0]);
+  MPI_Trace::Barrier(MPI_COMM_WORLD);
 
   // map donor rank to message size
   for (int i = 0; i < n_donors; ++i)
@@ -346,23 +347,23 @@ void exchange_cells_post_partitioning(const int rank,
   // now send the buffers and post receives
   isend = 0;
   for (auto &ir : acceptor_ranks) {
-    MPI_Isend(send_cell[isend].get_buffer(), send_to_rank[isend],
-              MPI_Proto_Cell, ir, 0, MPI_COMM_WORLD, &reqs[isend]);
+    MPI_Trace::Isend(send_cell[isend].get_buffer(), send_to_rank[isend],
+                     MPI_Proto_Cell, ir, 0, MPI_COMM_WORLD, &reqs[isend]);
     isend++;
   }
   int ireceive = 0;
   for (auto &ir : donor_rank_size) {
     recv_cell[ireceive].resize(ir.second);
-    MPI_Irecv(recv_cell[ireceive].get_buffer(), ir.second, MPI_Proto_Cell,
-              ir.first, 0, MPI_COMM_WORLD, &reqs[n_acceptors + ireceive]);
+    MPI_Trace::Irecv(recv_cell[ireceive].get_buffer(), ir.second, MPI_Proto_Cell,
+                     ir.first, 0, MPI_COMM_WORLD, &reqs[n_acceptors + ireceive]);
     ireceive++;
   }
 
-  MPI_Waitall(reqs.size(), &reqs[0], MPI_STATUS_IGNORE);
-  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Trace::Waitall(reqs.size(), &reqs[0], MPI_STATUS_IGNORE);
+  MPI_Trace::Barrier(MPI_COMM_WORLD);
 
   for (int i = 0; i < n_donors; ++i) {
-    vector<Proto_Cell> new_cells = recv_cell[i].get_object();
+    const Buffer<Proto_Cell>::Vector &new_cells = recv_cell[i].get_object();
     for (uint32_t i = 0; i < new_cells.size(); ++i) {
       mesh.add_mesh_cell(new_cells[i]);
     }
@@ -384,8 +385,8 @@ void remap_cell_and_grip_indices_rma(Proto_Mesh &mesh, const int rank,
   uint32_t n_cell_post_decomp = mesh.get_n_local_cells();
   vector<uint32_t> out_cells_proc(n_rank, 0);
   out_cells_proc[rank] = mesh.get_n_local_cells();
-  MPI_Allreduce(MPI_IN_PLACE, &out_cells_proc[0], n_rank, MPI_UNSIGNED, MPI_SUM,
-                MPI_COMM_WORLD);
+  MPI_Trace::Allreduce(MPI_IN_PLACE, &out_cells_proc[0], n_rank, MPI_UNSIGNED, MPI_SUM,
+                       MPI_COMM_WORLD);
 
   // prefix sum on out_cells to get global numbering
   vector<uint32_t> prefix_cells_proc(n_rank, 0);
@@ -424,7 +425,7 @@ void remap_cell_and_grip_indices_rma(Proto_Mesh &mesh, const int rank,
     new_index[i] = UINT32_MAX;
   }
 
-  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Trace::Barrier(MPI_COMM_WORLD);
   int assert = MPI_MODE_NOCHECK; // no conflicting locks on this window
   //int assert = 0;
   MPI_Win_lock_all(assert, index_win);
@@ -435,16 +436,16 @@ void remap_cell_and_grip_indices_rma(Proto_Mesh &mesh, const int rank,
     remapped_index = imap.second;
     target_rank = mesh.get_rank(imap.first);
     local_index = imap.first - prefix_cells_proc[target_rank];
-    MPI_Put(&remapped_index, 1, MPI_UNSIGNED, target_rank, local_index, 1,
-            MPI_UNSIGNED, index_win);
+    MPI_Trace::Put(&remapped_index, 1, MPI_UNSIGNED, target_rank, local_index, 1,
+                   MPI_UNSIGNED, index_win);
   }
 
-  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Trace::Barrier(MPI_COMM_WORLD);
   // make the memory visible to all ranks
   MPI_Win_flush_all(index_win);
-  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Trace::Barrier(MPI_COMM_WORLD);
   MPI_Win_sync(index_win);
-  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Trace::Barrier(MPI_COMM_WORLD);
 
   std::vector<uint32_t> new_boundary_indices(boundary_indices.size());
   std::vector<MPI_Request> i_reqs(boundary_indices.size());
@@ -454,13 +455,13 @@ void remap_cell_and_grip_indices_rma(Proto_Mesh &mesh, const int rank,
   for (auto &iset : boundary_indices) {
     target_rank = mesh.get_rank(iset);
     local_index = iset - prefix_cells_proc[target_rank];
-    MPI_Rget(&new_boundary_indices[ib], 1, MPI_UNSIGNED, target_rank,
-             local_index, 1, MPI_UNSIGNED, index_win, &i_reqs[ib]);
+    MPI_Trace::Rget(&new_boundary_indices[ib], 1, MPI_UNSIGNED, target_rank,
+                    local_index, 1, MPI_UNSIGNED, index_win, &i_reqs[ib]);
     ib++;
   }
 
-  MPI_Waitall(i_reqs.size(), &i_reqs[0], MPI_STATUS_IGNORE);
-  MPI_Waitall(g_reqs.size(), &g_reqs[0], MPI_STATUS_IGNORE);
+  MPI_Trace::Waitall(i_reqs.size(), &i_reqs[0], MPI_STATUS_IGNORE);
+  MPI_Trace::Waitall(g_reqs.size(), &g_reqs[0], MPI_STATUS_IGNORE);
 
   // make sure that all new boundary indices were set
   // correctly (not equal to the dummy initial value of UINT32_MAX)
@@ -504,8 +505,8 @@ void remap_cell_and_grip_indices_allreduce(Proto_Mesh &mesh, const int rank,
   uint32_t n_cell_post_decomp = mesh.get_n_local_cells();
   vector<uint32_t> out_cells_proc(n_rank, 0);
   out_cells_proc[rank] = mesh.get_n_local_cells();
-  MPI_Allreduce(MPI_IN_PLACE, &out_cells_proc[0], n_rank, MPI_UNSIGNED, MPI_SUM,
-                MPI_COMM_WORLD);
+  MPI_Trace::Allreduce(MPI_IN_PLACE, &out_cells_proc[0], n_rank, MPI_UNSIGNED, MPI_SUM,
+                       MPI_COMM_WORLD);
 
   // prefix sum on out_cells to get global numbering
   vector<uint32_t> prefix_cells_proc(n_rank, 0);
@@ -531,8 +532,8 @@ void remap_cell_and_grip_indices_allreduce(Proto_Mesh &mesh, const int rank,
   vector<uint32_t> out_bcells_proc(n_rank, 0);
   vector<uint32_t> prefix_bcells_proc(n_rank, 0);
   out_bcells_proc[rank] = n_boundary;
-  MPI_Allreduce(MPI_IN_PLACE, &out_bcells_proc[0], n_rank, MPI_UNSIGNED,
-                MPI_SUM, MPI_COMM_WORLD);
+  MPI_Trace::Allreduce(MPI_IN_PLACE, &out_bcells_proc[0], n_rank, MPI_UNSIGNED,
+                       MPI_SUM, MPI_COMM_WORLD);
 
   partial_sum(out_bcells_proc.begin(), out_bcells_proc.end(),
               prefix_bcells_proc.begin());
@@ -545,8 +546,8 @@ void remap_cell_and_grip_indices_allreduce(Proto_Mesh &mesh, const int rank,
   uint32_t start = prefix_bcells_proc[rank];
   for (auto &imap : local_boundary_map)
     original_b_indices[start++] = imap.first;
-  MPI_Allreduce(MPI_IN_PLACE, &original_b_indices[0], n_global_bcells,
-                MPI_UNSIGNED, MPI_SUM, MPI_COMM_WORLD);
+  MPI_Trace::Allreduce(MPI_IN_PLACE, &original_b_indices[0], n_global_bcells,
+                       MPI_UNSIGNED, MPI_SUM, MPI_COMM_WORLD);
 
   // find the indices in this global array for your boundary cells
   auto b_nodes = mesh.get_boundary_neighbors();
@@ -562,8 +563,8 @@ void remap_cell_and_grip_indices_allreduce(Proto_Mesh &mesh, const int rank,
   std::fill(original_b_indices.begin(), original_b_indices.end(), 0);
   for (auto &imap : local_boundary_map)
     original_b_indices[start++] = imap.second;
-  MPI_Allreduce(MPI_IN_PLACE, &original_b_indices[0], n_global_bcells,
-                MPI_UNSIGNED, MPI_SUM, MPI_COMM_WORLD);
+  MPI_Trace::Allreduce(MPI_IN_PLACE, &original_b_indices[0], n_global_bcells,
+                       MPI_UNSIGNED, MPI_SUM, MPI_COMM_WORLD);
 
   // iterate through the indices required by your rank
   std::unordered_map<uint32_t, uint32_t> id_old_to_new;
@@ -692,8 +693,8 @@ void replicate_mesh(Proto_Mesh &mesh, const MPI_Types &mpi_types,
   uint32_t ncell_on_rank = mesh.get_n_local_cells();
   start_ncells[rank] = ncell_on_rank;
 
-  MPI_Allreduce(MPI_IN_PLACE, &start_ncells[0], n_rank, MPI_INT, MPI_SUM,
-                MPI_COMM_WORLD);
+  MPI_Trace::Allreduce(MPI_IN_PLACE, &start_ncells[0], n_rank, MPI_INT, MPI_SUM,
+                       MPI_COMM_WORLD);
 
   vector<int> recv_from_rank(n_off_rank, 0);
   vector<int> send_to_rank(n_off_rank, 0);
@@ -712,33 +713,33 @@ void replicate_mesh(Proto_Mesh &mesh, const MPI_Types &mpi_types,
     send_to_rank[ir] = send_list.size();
     send_cell[ir].fill(send_list);
 
-    MPI_Isend(&send_to_rank[ir], 1, MPI_UNSIGNED, off_rank, 0, MPI_COMM_WORLD,
-              &reqs[ir]);
+    MPI_Trace::Isend(&send_to_rank[ir], 1, MPI_UNSIGNED, off_rank, 0, MPI_COMM_WORLD,
+                     &reqs[ir]);
 
-    MPI_Irecv(&recv_from_rank[ir], 1, MPI_UNSIGNED, off_rank, 0, MPI_COMM_WORLD,
-              &reqs[ir + n_off_rank]);
+    MPI_Trace::Irecv(&recv_from_rank[ir], 1, MPI_UNSIGNED, off_rank, 0, MPI_COMM_WORLD,
+                     &reqs[ir + n_off_rank]);
   }
 
-  MPI_Waitall(n_off_rank * 2, reqs, MPI_STATUS_IGNORE);
+  MPI_Trace::Waitall(n_off_rank * 2, reqs, MPI_STATUS_IGNORE);
 
   // now send the buffers and post receives
   for (uint32_t ir = 0; ir < n_off_rank; ++ir) {
     int off_rank = proc_map[ir];
-    MPI_Isend(send_cell[ir].get_buffer(), send_to_rank[ir], MPI_Proto_Cell,
-              off_rank, 0, MPI_COMM_WORLD, &reqs[ir]);
+    MPI_Trace::Isend(send_cell[ir].get_buffer(), send_to_rank[ir], MPI_Proto_Cell,
+                     off_rank, 0, MPI_COMM_WORLD, &reqs[ir]);
 
     recv_cell[ir].resize(recv_from_rank[ir]);
 
-    MPI_Irecv(recv_cell[ir].get_buffer(), recv_from_rank[ir], MPI_Proto_Cell,
-              off_rank, 0, MPI_COMM_WORLD, &reqs[ir + n_off_rank]);
+    MPI_Trace::Irecv(recv_cell[ir].get_buffer(), recv_from_rank[ir], MPI_Proto_Cell,
+                     off_rank, 0, MPI_COMM_WORLD, &reqs[ir + n_off_rank]);
   }
 
-  MPI_Waitall(n_off_rank * 2, reqs, MPI_STATUS_IGNORE);
+  MPI_Trace::Waitall(n_off_rank * 2, reqs, MPI_STATUS_IGNORE);
 
   send_cell.clear();
 
   for (uint32_t ir = 0; ir < n_off_rank; ++ir) {
-    vector<Proto_Cell> new_cells = recv_cell[ir].get_object();
+    const Buffer<Proto_Cell>::Vector &new_cells = recv_cell[ir].get_object();
     for (uint32_t i = 0; i < new_cells.size(); ++i) {
       mesh.add_mesh_cell(new_cells[i]);
     }
@@ -0,0 +1,239 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   event_counters.h
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Counts of photon events per history, per cell and flight lengths
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#ifndef event_counters_h_
+#define event_counters_h_
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "config.h"
+
+//==============================================================================
+/*!
+ * \struct Event_Counters
+ * \brief Photon event statistics gathered in the transport kernel
+ *
+ * The kernel counts only when compiled with count_events, each OpenMP thread
+ * has its own copy that is merged after the transport loop. A history here is
+ * one call of the kernel, so a photon passed between ranks or split is counted
+ * again where it continues. Events per history are binned by powers of two
+ * (bin b holds [2^(b-1), 2^b) events) and flights by their length in mean free
+ * paths (bin b holds [2^(b-9), 2^(b-8)), the first and last bins are open). The
+ * step's counts are reduced without blocking and printed after the conservation
+ * block, like the conservation quantities.
+ */
+//==============================================================================
+struct Event_Counters {
+
+  //! Counted photon events
+  enum Event {
+    SCATTER,
+    CELL_CROSS,
+    REFLECT,
+    RANK_PASS,
+    EXIT,
+    CENSUS,
+    ROULETTE_KILL,
+    SPLIT,
+    RANDOM_WALK,
+    DDMC_LEAK,
+    N_EVENTS
+  };
+
+  static constexpr uint32_t n_history_bins = 16; //!< Events per history bins
+  static constexpr uint32_t n_flight_bins = 16;  //!< Flight length bins
+  static constexpr int flight_bin_offset = 8;    //!< Bin of flights shorter than 2^-8 mfp
+
+  //! Constructor, sized for the cells the kernel sees
+  explicit Event_Counters(const uint32_t n_cells = 0) : pending(false) { resize(n_cells); }
+
+  //! Size the per-cell counts and zero everything
+  void resize(const uint32_t n_cells) {
+    cell_events.assign(n_cells, 0);
+    reset();
+  }
+
+  //! Zero the counts, keeps the number of cells
+  void reset(void) {
+    std::fill(events, events + N_EVENTS, 0);
+    std::fill(history_hist, history_hist + n_history_bins, 0);
+    std::fill(flight_hist, flight_hist + n_flight_bins, 0);
+    n_histories = 0;
+    n_flights = 0;
+    flight_length = 0.0;
+    flight_mfp = 0.0;
+    history_events = 0;
+    std::fill(cell_events.begin(), cell_events.end(), 0);
+  }
+
+  //! Count an event in a local cell
+  GPU_HOST_DEVICE void count(const Event event, const uint32_t cell) {
+    events[event]++;
+    cell_events[cell]++;
+    history_events++;
+  }
+
+  //! Count a flight of a length and optical depth
+  GPU_HOST_DEVICE void add_flight(const double length, const double mfp) {
+    n_flights++;
+    flight_length += length;
+    flight_mfp += mfp;
+    int bin = (mfp > 0.0) ? int(std::floor(std::log2(mfp))) + flight_bin_offset + 1 : 0;
+    bin = std::max(0, std::min(bin, int(n_flight_bins) - 1));
+    flight_hist[bin]++;
+  }
+
+  //! Bin the events of the history that just finished
+  GPU_HOST_DEVICE void end_history(void) {
+    uint32_t bin = 0;
+    while (bin < n_history_bins - 1 && (history_events >> bin))
+      bin++;
+    history_hist[bin]++;
+    n_histories++;
+    history_events = 0;
+  }
+
+  //! Add another set of counts over the same cells
+  void merge(const Event_Counters &other) {
+    for (uint32_t i = 0; i < N_EVENTS; ++i)
+      events[i] += other.events[i];
+    for (uint32_t i = 0; i < n_history_bins; ++i)
+      history_hist[i] += other.history_hist[i];
+    for (uint32_t i = 0; i < n_flight_bins; ++i)
+      flight_hist[i] += other.flight_hist[i];
+    n_histories += other.n_histories;
+    n_flights += other.n_flights;
+    flight_length += other.flight_length;
+    flight_mfp += other.flight_mfp;
+    for (size_t i = 0; i < cell_events.size(); ++i)
+      cell_events[i] += other.cell_events[i];
+  }
+
+  //! Start the non-blocking reduction of this step's counts to rank zero
+  //
+  // With a replicated mesh every rank counts in every cell, so the per-cell counts are summed
+  // before the busiest cell is found. Otherwise each rank sends its busiest cell.
+  void start_reduction(const bool replicated) {
+    sums.clear();
+    sums.insert(sums.end(), events, events + N_EVENTS);
+    sums.insert(sums.end(), history_hist, history_hist + n_history_bins);
+    sums.insert(sums.end(), flight_hist, flight_hist + n_flight_bins);
+    sums.push_back(n_histories);
+    sums.push_back(n_flights);
+    uint64_t n_cell_events = 0;
+    for (auto n : cell_events)
+      n_cell_events += n;
+    sums.push_back(n_cell_events);
+    sums.push_back(replicated ? 0 : cell_events.size());
+    g_sums.resize(sums.size());
+    flight_sums = {flight_length, flight_mfp};
+    if (replicated) {
+      g_cell_events.resize(cell_events.size());
+      MPI_Ireduce(cell_events.data(), g_cell_events.data(), cell_events.size(),
+                  MPI_UNSIGNED_LONG, MPI_SUM, 0, MPI_COMM_WORLD, &reqs[2]);
+      n_global_cells = cell_events.size();
+    } else {
+      g_cell_events.resize(1);
+      cell_max = cell_events.empty() ? 0 : *std::max_element(cell_events.begin(), cell_events.end());
+      MPI_Ireduce(&cell_max, g_cell_events.data(), 1, MPI_UNSIGNED_LONG, MPI_MAX, 0,
+                  MPI_COMM_WORLD, &reqs[2]);
+      n_global_cells = 0;
+    }
+    MPI_Ireduce(sums.data(), g_sums.data(), sums.size(), MPI_UNSIGNED_LONG, MPI_SUM, 0,
+                MPI_COMM_WORLD, &reqs[0]);
+    MPI_Ireduce(flight_sums.data(), g_flight_sums.data(), 2, MPI_DOUBLE, MPI_SUM, 0,
+                MPI_COMM_WORLD, &reqs[1]);
+    pending = true;
+  }
+
+  //! Complete the reduction started by start_reduction, print on rank zero and zero the counts
+  // for the next step, does nothing if no reduction is pending
+  void finish_reduction(const int rank) {
+    using std::cout;
+    using std::endl;
+    if (!pending)
+      return;
+    MPI_Waitall(3, reqs.data(), MPI_STATUSES_IGNORE);
+    pending = false;
+    reset();
+    if (rank != 0)
+      return;
+
+    static const char *names[N_EVENTS] = {"scatter", "cell cross", "reflect", "rank pass",
+                                          "exit",    "census",     "roulette", "split",
+                                          "random walk", "DDMC leak"};
+    const uint64_t *g_events = g_sums.data();
+    const uint64_t *g_history_hist = g_events + N_EVENTS;
+    const uint64_t *g_flight_hist = g_history_hist + n_history_bins;
+    const uint64_t g_histories = g_flight_hist[n_flight_bins];
+    const uint64_t g_flights = g_flight_hist[n_flight_bins + 1];
+    const uint64_t g_cell_total = g_flight_hist[n_flight_bins + 2];
+    const uint64_t n_cells = n_global_cells ? n_global_cells : g_flight_hist[n_flight_bins + 3];
+    const uint64_t g_cell_max =
+        n_global_cells ? *std::max_element(g_cell_events.begin(), g_cell_events.end())
+                       : g_cell_events[0];
+
+    cout << "Events in " << g_histories << " histories (";
+    uint64_t g_total = 0;
+    for (uint32_t i = 0; i < N_EVENTS; ++i) {
+      cout << (i ? ", " : "") << names[i] << ": " << g_events[i];
+      g_total += g_events[i];
+    }
+    cout << ")" << endl;
+    cout << "Events per history: " << (g_histories ? double(g_total) / g_histories : 0.0)
+         << ", by powers of two:";
+    for (uint32_t i = 0; i < n_history_bins; ++i)
+      cout << " " << g_history_hist[i];
+    cout << endl;
+    cout << "Flights: " << g_flights << ", mean length "
+         << (g_flights ? g_flight_sums[0] / g_flights : 0.0) << " cm, mean "
+         << (g_flights ? g_flight_sums[1] / g_flights : 0.0) << " mfp, by powers of two mfp from 2^-"
+         << flight_bin_offset << ":";
+    for (uint32_t i = 0; i < n_flight_bins; ++i)
+      cout << " " << g_flight_hist[i];
+    cout << endl;
+    cout << "Events per cell: mean " << (n_cells ? double(g_cell_total) / n_cells : 0.0)
+         << ", max " << g_cell_max << endl;
+  }
+
+  uint64_t events[N_EVENTS];             //!< Count of each event
+  uint64_t history_hist[n_history_bins]; //!< Histories by events, powers of two
+  uint64_t flight_hist[n_flight_bins];   //!< Flights by mean free paths, powers of two
+  uint64_t n_histories;                  //!< Kernel calls finished
+  uint64_t n_flights;                    //!< Flights between events
+  double flight_length;                  //!< Sum of flight lengths (cm)
+  double flight_mfp;                     //!< Sum of flight lengths in mean free paths
+  uint64_t history_events;               //!< Events of the history in progress
+  std::vector<uint64_t> cell_events;     //!< Events in each cell the kernel sees
+
+private:
+  bool pending;                          //!< A reduction has been started and not finished
+  std::array<MPI_Request, 3> reqs;       //!< Requests of the pending reduction
+  std::vector<uint64_t> sums;            //!< Counts sent in the reduction
+  std::vector<uint64_t> g_sums;          //!< Reduced counts on rank zero
+  std::array<double, 2> flight_sums;     //!< Flight sums sent in the reduction
+  std::array<double, 2> g_flight_sums;   //!< Reduced flight sums on rank zero
+  uint64_t cell_max;                     //!< Busiest local cell sent in the reduction
+  std::vector<uint64_t> g_cell_events;   //!< Reduced per-cell counts or busiest cell
+  uint64_t n_global_cells;               //!< Cells in g_cell_events, zero when not replicated
+};
+
+#endif // event_counters_h_
+//---------------------------------------------------------------------------//
+// end of event_counters.h
+//---------------------------------------------------------------------------//
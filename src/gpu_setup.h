@@ -20,7 +20,7 @@ class GPU_Setup {
 
 public:
   //! Constructor
-  GPU_Setup(const int rank, const int n_ranks, const bool use_gpu_transporter, const std::vector<Cell> &cpu_cells)
+  GPU_Setup(const int rank, const int n_ranks, const bool use_gpu_transporter, const Cell_Vector &cpu_cells)
     : m_use_gpu_transporter(use_gpu_transporter), device_cells_ptr(nullptr)
   {
 #ifdef USE_CUDA
@@ -29,10 +29,14 @@ public:
       set_device_ID(rank, n_ranks);
 
       std::cout<<"Allocating and transferring "<<cpu_cells.size()<<" cell(s) to the GPU"<<std::endl;
-      // allocate and copy cells
+      // allocate and copy cells, shared opacity rows are host memory so device cells use the
+      // gray opacities
+      Cell_Vector device_cells(cpu_cells);
+      for (auto &cell : device_cells)
+        cell.set_opacity_row(nullptr);
       cudaError_t err = cudaMalloc((void **)&device_cells_ptr, sizeof(Cell) * cpu_cells.size());
       Insist(!err, "CUDA error in allocating cells data");
-      err = cudaMemcpy(device_cells_ptr, cpu_cells.data(), sizeof(Cell) * cpu_cells.size(),
+      err = cudaMemcpy(device_cells_ptr, device_cells.data(), sizeof(Cell) * cpu_cells.size(),
                        cudaMemcpyHostToDevice);
       Insist(!err, "CUDA error in copying cells data");
     }
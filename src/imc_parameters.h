@@ -13,6 +13,8 @@
 #define imc_parameters_h_
 
 #include "input.h"
+#include "population_control.h"
+#include "random_walk.h"
 
 //==============================================================================
 /*!
@@ -29,14 +31,31 @@ public:
   //! constructor
   IMC_Parameters(const Input &input)
       : n_user_photons(input.get_number_photons()),
+        max_census_photons(input.get_max_census_photons()),
+        max_census_in_memory(input.get_max_census_in_memory()),
+        census_spill_directory(input.get_census_spill_directory()),
         seed(input.get_rng_seed()),
         dd_mode(input.get_dd_mode()), batch_size(input.get_batch_size()),
         particle_message_size(input.get_particle_message_size()),
         output_frequency(input.get_output_freq()),
+        n_silo_files(input.get_n_silo_files()),
+        output_queue_size(input.get_output_queue_size()),
+        checkpoint_frequency(input.get_checkpoint_freq()),
+        checkpoint_directory(input.get_checkpoint_directory()),
+        restart_file(input.get_restart_file()),
         n_omp_threads(input.get_n_omp_threads()),
         write_silo_flag(input.get_write_silo_bool()),
         use_gpu_transporter_flag(input.get_use_gpu_transporter_bool()),
-        use_comb_flag(input.get_comb_bool()) {}
+        use_comb_flag(input.get_comb_bool()),
+        sampling_mode(input.get_sampling_mode()),
+        use_tilt_flag(input.get_tilt_bool()),
+        pop_ctrl{input.get_roulette_weight(), input.get_survival_weight(),
+                 input.get_weight_windows_bool()},
+        use_random_walk_flag(input.get_random_walk_bool()),
+        random_walk(input.get_random_walk_mfp()),
+        use_macro_boxes_flag(input.get_macro_boxes_bool()),
+        count_events_flag(input.get_count_events_bool()),
+        ddmc_threshold(input.get_ddmc_threshold()) {}
 
   //! destructor
   ~IMC_Parameters() {}
@@ -48,6 +67,15 @@ public:
   //! Return total photons specified by the user
   uint64_t get_n_user_photons() const { return n_user_photons; }
 
+  //! Return the global census size above which the census is combed
+  uint64_t get_max_census_photons() const { return max_census_photons; }
+
+  //! Return census photons kept in memory on each rank (zero for no spilling)
+  uint64_t get_max_census_in_memory() const { return max_census_in_memory; }
+
+  //! Return directory for census spill files
+  const std::string &get_census_spill_directory() const { return census_spill_directory; }
+
   //! Return the user-set RNG seed
   uint32_t get_rng_seed() const {return seed;}
 
@@ -71,9 +99,47 @@ public:
   //! Get the combing flag
   bool get_use_comb_flag() const {return use_comb_flag;}
 
+  //! Get the emission and boundary source sampling method
+  uint32_t get_sampling_mode() const { return sampling_mode; }
+
+  //! Get the tilted emission sampling flag
+  bool get_use_tilt_flag() const { return use_tilt_flag; }
+
+  //! Get the roulette and weight window settings for transport
+  const Population_Control &get_population_control() const { return pop_ctrl; }
+
+  //! Get the random walk table, null if random walks are off
+  const Random_Walk *get_random_walk() const {
+    return use_random_walk_flag ? &random_walk : nullptr;
+  }
+
+  //! Get the macro box tracking flag
+  bool get_use_macro_boxes_flag() const { return use_macro_boxes_flag; }
+
+  //! Get the transport event counting flag
+  bool get_count_events_flag() const { return count_events_flag; }
+
+  //! Get the optical thickness in mean free paths above which cells use DDMC (zero for off)
+  double get_ddmc_threshold() const { return ddmc_threshold; }
+
   //! Get output frequency (print when cycle % frequency == 0)
   uint32_t get_output_frequency() const { return output_frequency; }
 
+  //! Get number of files for multi-block SILO output (zero for one reduced file)
+  uint32_t get_n_silo_files() const { return n_silo_files; }
+
+  //! Get most output files queued for the background writer (zero to write in the driver)
+  uint32_t get_output_queue_size() const { return output_queue_size; }
+
+  //! Get number of steps between checkpoints (zero for no checkpoints)
+  uint32_t get_checkpoint_frequency() const { return checkpoint_frequency; }
+
+  //! Get directory checkpoint files are written to
+  const std::string &get_checkpoint_directory() const { return checkpoint_directory; }
+
+  //! Get checkpoint file to restart from (empty to start at the beginning)
+  const std::string &get_restart_file() const { return restart_file; }
+
   //! Get number of OpenMP threads to use (set by user in input)
   uint32_t get_n_omp_threads() const { return n_omp_threads; }
 
@@ -82,16 +148,32 @@ public:
   //--------------------------------------------------------------------------//
 private:
   uint64_t n_user_photons; //!< User requested number of photons per timestep
+  uint64_t max_census_photons; //!< Global census size above which the census is combed
+  uint64_t max_census_in_memory; //!< Census photons kept in memory on each rank
+  std::string census_spill_directory; //!< Directory for census spill files
   uint32_t seed;       //!< Random number seed
   uint32_t dd_mode;    //!< Mode of domain decomposed transport algorithm
   uint32_t batch_size; //!< How often to check for MPI passed data
   uint32_t
       particle_message_size; //!< Preferred number of particles in MPI sends
   uint32_t output_frequency; //!< Frequency to dump output files
+  uint32_t n_silo_files; //!< Number of files for multi-block SILO output
+  uint32_t output_queue_size; //!< Most output files queued for the I/O thread
+  uint32_t checkpoint_frequency; //!< Steps between checkpoints
+  std::string checkpoint_directory; //!< Directory for checkpoint files
+  std::string restart_file; //!< Checkpoint file to restart from
   uint32_t n_omp_threads; //!< Number of OpenMP threads, set by user
   bool write_silo_flag;      //!< Write SILO output files flag
   bool use_gpu_transporter_flag;      //!< Write SILO output files flag
   bool use_comb_flag;                 //!< Comb the census if great than  n_user_photon after cycle 
+  uint32_t sampling_mode; //!< Emission and boundary source sampling method
+  bool use_tilt_flag;     //!< Tilt emission position with the emission density gradient
+  Population_Control pop_ctrl; //!< Roulette and weight window settings
+  bool use_random_walk_flag;   //!< Random walk photons deep in thick cells
+  Random_Walk random_walk;     //!< Escape time table for random walks
+  bool use_macro_boxes_flag;   //!< Track photons through boxes of identical cells
+  bool count_events_flag;      //!< Count photon events in the transport kernel
+  double ddmc_threshold;       //!< Cells at least this many mean free paths thick use DDMC
 };
 
 #endif // imc_parameters_h_
@@ -12,16 +12,19 @@
 #ifndef imc_state_h_
 #define imc_state_h_
 
+#include <array>
 #include <cmath>
 #include <functional>
 #include <iostream>
 #include <mpi.h>
+#include <string>
 #include <vector>
 
 #include "RNG.h"
 #include "constants.h"
 #include "input.h"
 #include "message_counter.h"
+#include "memory_tracker.h"
 #include "photon.h"
 #include "cell.h"
 #include <iomanip>
@@ -51,6 +54,7 @@ public:
     exit_E = 0.0;
     absorbed_E = 0.0;
     source_E = 0.0;
+    pop_ctrl_E = 0.0;
 
     // 64 bit
     trans_particles = 0;
@@ -75,7 +79,13 @@ public:
   }
 
   //! Destructor
-  ~IMC_State() { }
+  ~IMC_State() {
+    if (node_comm != MPI_COMM_NULL)
+      MPI_Comm_free(&node_comm);
+  }
+
+  IMC_State(const IMC_State &) = delete;
+  IMC_State &operator=(const IMC_State &) = delete;
 
   //--------------------------------------------------------------------------//
   // const functions                                                          //
@@ -159,6 +169,9 @@ public:
   //! Get transport time for this rank on current timestep
   double get_rank_transport_runtime(void) { return rank_transport_runtime; }
 
+  //! Get number of particle messages sent over all timesteps
+  uint32_t get_total_particle_messages(void) const { return total_particle_messages; }
+
   //! Get total transport time (max time summed across all timesteps)
   double get_total_transport_time(void) { return total_transport_time; }
 
@@ -170,89 +183,80 @@ public:
   // non-const functions                                                      //
   //--------------------------------------------------------------------------//
 
-  //! Perform reduction on diagnostic and conservation quantities and print
+  //! Reduce diagnostic and conservation quantities and print, blocking
   void print_conservation(uint32_t dd_type) {
+    start_conservation_reduction();
+    finish_conservation_reduction(dd_type);
+  }
+
+  //! Start the non-blocking reduction of this step's diagnostic and conservation quantities
+  //
+  // All sums go in one buffer and the transport time max and min in another (min as the max of
+  // the negative). Counters are reduced as doubles, exact below 2^53.
+  void start_conservation_reduction(void) {
+    conservation_sums = {absorbed_E,
+                         emission_E,
+                         source_E,
+                         pre_census_E,
+                         pre_mat_E,
+                         post_census_E,
+                         post_mat_E,
+                         exit_E,
+                         pop_ctrl_E,
+                         double(trans_particles),
+                         double(step_particles_sent),
+                         double(census_size),
+                         double(step_cells_requested),
+                         double(step_particle_messages),
+                         double(step_cell_messages),
+                         double(step_cells_sent),
+                         double(step_sends_posted),
+                         double(step_sends_completed),
+                         double(step_receives_posted),
+                         double(step_receives_completed)};
+    conservation_max = {rank_transport_runtime, -rank_transport_runtime};
+    MPI_Iallreduce(MPI_IN_PLACE, conservation_sums.data(), n_conservation_sums, MPI_DOUBLE,
+                   MPI_SUM, MPI_COMM_WORLD, &conservation_reqs[0]);
+    MPI_Iallreduce(MPI_IN_PLACE, conservation_max.data(), 2, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD,
+                   &conservation_reqs[1]);
+    conservation_pending = true;
+  }
+
+  //! Complete the reduction started by start_conservation_reduction and print, does nothing if
+  // no reduction is pending
+  void finish_conservation_reduction(uint32_t dd_type) {
     using Constants::PARTICLE_PASS;
-    using Constants::REPLICATED;
     using std::cout;
     using std::endl;
-    using std::plus;
-
-    // define global value
-    double g_absorbed_E = 0.0;
-    double g_emission_E = 0.0;
-    double g_source_E = 0.0;
-    double g_pre_census_E = 0.0;
-    double g_pre_mat_E = 0.0;
-    double g_post_census_E = 0.0;
-    double g_post_mat_E = 0.0;
-    double g_exit_E = 0.0;
-    // timing values
-    double max_transport_time = 0.0;
-    double min_transport_time = 0.0;
-    // 64 bit global integers
-    uint64_t g_census_size = 0;
-    uint64_t g_trans_particles = 0;
-    uint64_t g_step_particles_sent = 0;
-    uint64_t g_step_particle_messages = 0;
-    uint64_t g_step_cells_requested = 0;
-    uint64_t g_step_cell_messages = 0;
-    uint64_t g_step_cells_sent = 0;
-    uint64_t g_step_sends_posted = 0;
-    uint64_t g_step_sends_completed = 0;
-    uint64_t g_step_receives_posted = 0;
-    uint64_t g_step_receives_completed = 0;
-
-    // reduce energy conservation values (double)
-    MPI_Allreduce(&absorbed_E, &g_absorbed_E, 1, MPI_DOUBLE, MPI_SUM,
-                  MPI_COMM_WORLD);
-    MPI_Allreduce(&emission_E, &g_emission_E, 1, MPI_DOUBLE, MPI_SUM,
-                  MPI_COMM_WORLD);
-    MPI_Allreduce(&source_E, &g_source_E, 1, MPI_DOUBLE, MPI_SUM,
-                  MPI_COMM_WORLD);
-    MPI_Allreduce(&pre_census_E, &g_pre_census_E, 1, MPI_DOUBLE, MPI_SUM,
-                  MPI_COMM_WORLD);
-    MPI_Allreduce(&pre_mat_E, &g_pre_mat_E, 1, MPI_DOUBLE, MPI_SUM,
-                  MPI_COMM_WORLD);
-    MPI_Allreduce(&post_census_E, &g_post_census_E, 1, MPI_DOUBLE, MPI_SUM,
-                  MPI_COMM_WORLD);
-    MPI_Allreduce(&post_mat_E, &g_post_mat_E, 1, MPI_DOUBLE, MPI_SUM,
-                  MPI_COMM_WORLD);
-    MPI_Allreduce(&exit_E, &g_exit_E, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
-
-    // reduce timestep values
-    MPI_Allreduce(&rank_transport_runtime, &max_transport_time, 1, MPI_DOUBLE,
-                  MPI_MAX, MPI_COMM_WORLD);
-    MPI_Allreduce(&rank_transport_runtime, &min_transport_time, 1, MPI_DOUBLE,
-                  MPI_MIN, MPI_COMM_WORLD);
-
-    // reduce diagnostic values
-    // 64 bit integer reductions
-    MPI_Allreduce(&trans_particles, &g_trans_particles, 1, MPI_UNSIGNED_LONG,
-                  MPI_SUM, MPI_COMM_WORLD);
-    MPI_Allreduce(&step_particles_sent, &g_step_particles_sent, 1,
-                  MPI_UNSIGNED_LONG, MPI_SUM, MPI_COMM_WORLD);
-    MPI_Allreduce(&census_size, &g_census_size, 1, MPI_UNSIGNED_LONG, MPI_SUM,
-                  MPI_COMM_WORLD);
-    MPI_Allreduce(&step_cells_requested, &g_step_cells_requested, 1,
-                  MPI_UNSIGNED_LONG, MPI_SUM, MPI_COMM_WORLD);
-    MPI_Allreduce(&step_particle_messages, &g_step_particle_messages, 1,
-                  MPI_UNSIGNED_LONG, MPI_SUM, MPI_COMM_WORLD);
-    MPI_Allreduce(&step_cell_messages, &g_step_cell_messages, 1,
-                  MPI_UNSIGNED_LONG, MPI_SUM, MPI_COMM_WORLD);
-    MPI_Allreduce(&step_cells_sent, &g_step_cells_sent, 1, MPI_UNSIGNED_LONG,
-                  MPI_SUM, MPI_COMM_WORLD);
-    MPI_Allreduce(&step_sends_posted, &g_step_sends_posted, 1,
-                  MPI_UNSIGNED_LONG, MPI_SUM, MPI_COMM_WORLD);
-    MPI_Allreduce(&step_sends_completed, &g_step_sends_completed, 1,
-                  MPI_UNSIGNED_LONG, MPI_SUM, MPI_COMM_WORLD);
-    MPI_Allreduce(&step_receives_posted, &g_step_receives_posted, 1,
-                  MPI_UNSIGNED_LONG, MPI_SUM, MPI_COMM_WORLD);
-    MPI_Allreduce(&step_receives_completed, &g_step_receives_completed, 1,
-                  MPI_UNSIGNED_LONG, MPI_SUM, MPI_COMM_WORLD);
+
+    if (!conservation_pending)
+      return;
+    MPI_Waitall(2, conservation_reqs.data(), MPI_STATUSES_IGNORE);
+    conservation_pending = false;
+
+    const std::array<double, n_conservation_sums> &g = conservation_sums;
+    const double g_absorbed_E = g[0];
+    const double g_emission_E = g[1];
+    const double g_source_E = g[2];
+    const double g_pre_census_E = g[3];
+    const double g_pre_mat_E = g[4];
+    const double g_post_census_E = g[5];
+    const double g_post_mat_E = g[6];
+    const double g_exit_E = g[7];
+    const double g_pop_ctrl_E = g[8];
+    const uint64_t g_trans_particles = g[9];
+    const uint64_t g_step_particles_sent = g[10];
+    const uint64_t g_census_size = g[11];
+    const uint64_t g_step_particle_messages = g[13];
+    const uint64_t g_step_sends_posted = g[16];
+    const uint64_t g_step_sends_completed = g[17];
+    const uint64_t g_step_receives_posted = g[18];
+    const uint64_t g_step_receives_completed = g[19];
+    const double max_transport_time = conservation_max[0];
+    const double min_transport_time = -conservation_max[1];
 
     double rad_conservation = (g_absorbed_E + g_post_census_E + g_exit_E) -
-                              (g_pre_census_E + g_emission_E + g_source_E);
+                              (g_pre_census_E + g_emission_E + g_source_E + g_pop_ctrl_E);
 
     double mat_conservation =
         g_post_mat_E - (g_pre_mat_E + g_absorbed_E - g_emission_E);
@@ -265,7 +269,7 @@ public:
       cout << "Total Photons transported: " << g_trans_particles << endl;
       cout << "Emission E: " << g_emission_E << ", Source E: " <<g_source_E
            << ", Absorption E: " << g_absorbed_E;
-      cout << ", Exit E: " << g_exit_E << endl;
+      cout << ", Exit E: " << g_exit_E << ", Roulette E: " << g_pop_ctrl_E << endl;
       cout << "Pre census E: " << g_pre_census_E << " Post census E: ";
       cout << g_post_census_E << " Post census Size: " << g_census_size << endl;
       cout << "Pre mat E: " << g_pre_mat_E << " Post mat E: " << g_post_mat_E
@@ -288,6 +292,32 @@ public:
     } // if rank==0
   }
 
+  //! Time, step and running totals carried between steps, saved in checkpoints
+  struct Checkpoint_Data {
+    double time;                      //!< Start of the step (sh)
+    double dt;                        //!< Step size (sh)
+    double total_transport_time;      //!< Max transport time summed over steps (rank 0)
+    uint32_t step;                    //!< Step
+    uint32_t total_particle_messages; //!< Particle messages over all steps
+    uint64_t total_particles_sent;    //!< Particles sent over all steps
+  };
+
+  //! Return the state needed to continue from the start of the current step
+  Checkpoint_Data get_checkpoint_data(void) const {
+    return {m_time, m_dt, total_transport_time, m_step, total_particle_messages,
+            total_particles_sent};
+  }
+
+  //! Continue from a checkpoint written at the start of a step
+  void set_checkpoint_data(const Checkpoint_Data &data) {
+    m_time = data.time;
+    m_dt = data.dt;
+    total_transport_time = data.total_transport_time;
+    m_step = data.step;
+    total_particle_messages = data.total_particle_messages;
+    total_particles_sent = data.total_particles_sent;
+  }
+
   //! Increment time and step counter
   void next_time_step(void) {
     m_time += m_dt;
@@ -321,6 +351,9 @@ public:
   //! Set exit energy from transport (diagnostic)
   void set_exit_E(double _exit_E) { exit_E = _exit_E; }
 
+  //! Set net energy added by roulette in transport (diagnostic)
+  void set_pop_ctrl_E(double _pop_ctrl_E) { pop_ctrl_E = _pop_ctrl_E; }
+
   //! set particles transported for current timestep (diagnostic, 64 bit)
   void set_transported_particles(uint64_t _trans_particles) {
     trans_particles = _trans_particles;
@@ -356,92 +389,83 @@ public:
     rank_rebalance_time = _rebalance_time;
   }
 
-  void print_memory_estimate(int rank, int n_ranks, uint32_t n_rank_cells, uint64_t n_rank_photons) {
-
-    // rank statistics on memory and photons
-    uint64_t max_n_rank_photons = n_rank_photons;
-    uint64_t mean_n_rank_photons = n_rank_photons;
-    double rank_memory =(n_rank_photons*sizeof(Photon) + n_rank_cells*sizeof(Cell))/1.0e9 ;
-    double max_rank_memory = rank_memory;
-    double mean_rank_memory = rank_memory;
-    MPI_Allreduce(MPI_IN_PLACE, &max_n_rank_photons, 1, MPI_UNSIGNED_LONG, MPI_MAX, MPI_COMM_WORLD);
-    MPI_Allreduce(MPI_IN_PLACE, &mean_n_rank_photons, 1, MPI_UNSIGNED_LONG, MPI_SUM, MPI_COMM_WORLD);
-    MPI_Allreduce(MPI_IN_PLACE, &max_rank_memory, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
-    MPI_Allreduce(MPI_IN_PLACE, &mean_rank_memory, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
-    mean_n_rank_photons /= static_cast<double>(n_ranks);
-    mean_rank_memory/= static_cast<double>(n_ranks);
-
-    // node statistics on memory and photons
-    // Create the node-level communicator(s) by splitting the original COMM_WORLD (every rank) into
-    // node groupings:
-    MPI_Comm node_comm;
-    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL,
-      &node_comm);
-    // Get this rank's ID WITHIN THE NODE-LOCAL COMMUNICATOR
-    int node_rank{0};
-    int n_node_ranks{0};
-    MPI_Comm_rank(node_comm, &node_rank);
-    MPI_Comm_size(node_comm, &n_node_ranks);
-    int n_nodes = n_ranks / n_node_ranks; 
-
-    uint32_t n_node_cells = n_rank_cells;
-    uint64_t n_node_photons = n_rank_photons;
-    MPI_Allreduce(MPI_IN_PLACE, &n_node_cells, 1, MPI_UNSIGNED, MPI_SUM, node_comm);
-    MPI_Allreduce(MPI_IN_PLACE, &n_node_photons, 1, MPI_UNSIGNED_LONG, MPI_SUM, node_comm);
-
-    double node_memory= (n_node_photons*sizeof(Photon) + n_node_cells*sizeof(Cell))/1.0e9;
-    double max_node_memory = node_memory;
-    double mean_node_memory = (node_rank ==0) ? node_memory: 0.0; 
-    uint64_t max_n_node_photons = n_node_photons;
-    uint64_t mean_n_node_photons = (node_rank == 0) ? n_node_photons: 0;
-
-    MPI_Allreduce(MPI_IN_PLACE, &max_n_node_photons, 1, MPI_UNSIGNED_LONG, MPI_MAX, MPI_COMM_WORLD);
-    MPI_Allreduce(MPI_IN_PLACE, &mean_n_node_photons, 1, MPI_UNSIGNED_LONG, MPI_SUM, MPI_COMM_WORLD);
-    MPI_Allreduce(MPI_IN_PLACE, &max_node_memory, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
-    MPI_Allreduce(MPI_IN_PLACE, &mean_node_memory, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
-    mean_n_node_photons /= static_cast<double>(n_nodes);
-    mean_node_memory /= static_cast<double>(n_nodes);
-
-    if (rank == 0) {
+  //! Print per-rank and per-node maxima and means of the photon count, tracked allocations by
+  // subsystem and process memory, then start a new high-water interval for tracked memory
+  void print_memory_report(uint64_t n_rank_photons) {
+    using std::cout;
+    using std::endl;
+    using std::setw;
+
+    // the node communicator is made once and kept
+    if (node_comm == MPI_COMM_NULL) {
+      MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);
+      MPI_Comm_rank(node_comm, &node_rank);
+      int node_leader = (node_rank == 0);
+      MPI_Allreduce(&node_leader, &n_nodes, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+      MPI_Comm_size(MPI_COMM_WORLD, &n_world_ranks);
+    }
 
-      std::cout << std::right;
-      std::cout << std::setw(32) << "proc_max";
-      std::cout << std::setw(13) << "proc_mean";
-      std::cout << std::setw(2) << "|";
-      std::cout << std::setw(13) << "node_max";
-      std::cout << std::setw(13) << "node_mean";
-      std::cout << std::setw(2) << "|" << std::endl;
-
-      std::cout << "---------------------------------------------------------------------------"
-                    << std::endl;
-
-      // Photons
-      //std::cout << std::setprecision(9) << std::fixed;
-      std::cout << std::left << std::setw(17) << "Photons";
-      std::cout << std::setw(2) << "|" << std::right;
-      std::cout << std::setw(13) << max_n_rank_photons;
-      std::cout << std::setw(13) << mean_n_rank_photons;
-      std::cout << std::setw(2) << "|";
-      std::cout << std::setw(13) << max_n_node_photons;
-      std::cout << std::setw(13) << mean_n_node_photons;
-      std::cout << std::setw(2) << "|" << std::endl;
-
-      // Memory
-      //std::cout << std::setprecision(9) << std::fixed;
-      std::cout << std::left << std::setw(17) << "Memory (GB)";
-      std::cout << std::setw(2) << "|" << std::right;
-      std::cout << std::setw(13) << max_rank_memory;
-      std::cout << std::setw(13) << mean_rank_memory;
-      std::cout << std::setw(2) << "|";
-      std::cout << std::setw(13) << max_node_memory;
-      std::cout << std::setw(13) << mean_node_memory;
-      std::cout << std::setw(2) << "|"<< std::endl;
-
-      std::cout << "---------------------------------------------------------------------------"
-                    << std::endl;
+    // photons, then bytes: each subsystem, tracked peak, resident set and its high-water mark
+    constexpr int n_values = Memory::N_SUBSYSTEMS + 4;
+    const Memory::Process_Memory process = Memory::get_process_memory();
+    std::array<double, n_values> rank_values;
+    rank_values[0] = n_rank_photons;
+    for (int i = 0; i < Memory::N_SUBSYSTEMS; ++i)
+      rank_values[1 + i] = Memory::get_current_bytes(Memory::Subsystem(i));
+    rank_values[n_values - 3] = Memory::get_total_peak_bytes();
+    rank_values[n_values - 2] = process.rss;
+    rank_values[n_values - 1] = process.hwm;
+
+    std::array<double, n_values> node_values;
+    MPI_Allreduce(rank_values.data(), node_values.data(), n_values, MPI_DOUBLE, MPI_SUM,
+                  node_comm);
+
+    // maxima and sums over ranks and nodes in two reductions, one node leader adds each node
+    std::array<double, 2 * n_values> max_values, sum_values;
+    for (int i = 0; i < n_values; ++i) {
+      max_values[i] = sum_values[i] = rank_values[i];
+      max_values[n_values + i] = node_values[i];
+      sum_values[n_values + i] = (node_rank == 0) ? node_values[i] : 0.0;
     }
+    MPI_Allreduce(MPI_IN_PLACE, max_values.data(), 2 * n_values, MPI_DOUBLE, MPI_MAX,
+                  MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, sum_values.data(), 2 * n_values, MPI_DOUBLE, MPI_SUM,
+                  MPI_COMM_WORLD);
+
+    Memory::reset_peaks();
 
+    if (rank == 0) {
+      auto print_row = [&](const std::string &name, const int i, const double scale) {
+        cout << std::left << setw(17) << name;
+        cout << setw(2) << "|" << std::right;
+        cout << setw(13) << max_values[i] * scale;
+        cout << setw(13) << sum_values[i] * scale / n_world_ranks;
+        cout << setw(2) << "|";
+        cout << setw(13) << max_values[n_values + i] * scale;
+        cout << setw(13) << sum_values[n_values + i] * scale / n_nodes;
+        cout << setw(2) << "|" << endl;
+      };
+
+      cout << std::right;
+      cout << setw(32) << "proc_max";
+      cout << setw(13) << "proc_mean";
+      cout << setw(2) << "|";
+      cout << setw(13) << "node_max";
+      cout << setw(13) << "node_mean";
+      cout << setw(2) << "|" << endl;
+      cout << "---------------------------------------------------------------------------"
+           << endl;
+      print_row("Photons", 0, 1.0);
+      for (int i = 0; i < Memory::N_SUBSYSTEMS; ++i)
+        print_row(std::string(Memory::get_name(Memory::Subsystem(i))) + " (GB)", 1 + i, 1.0e-9);
+      print_row("Tracked peak (GB)", n_values - 3, 1.0e-9);
+      print_row("RSS (GB)", n_values - 2, 1.0e-9);
+      print_row("RSS peak (GB)", n_values - 1, 1.0e-9);
+      cout << "---------------------------------------------------------------------------"
+           << endl;
+    }
   }
+
   //--------------------------------------------------------------------------//
   // member data                                                              //
   //--------------------------------------------------------------------------//
@@ -464,6 +488,7 @@ private:
   double exit_E;        //!< Energy exiting problem
   double absorbed_E;    //!< Total absorbed energy
   double source_E;      //!< Sourced energy
+  double pop_ctrl_E;    //!< Net energy added by roulette
 
   // diagnostic 64 bit integers relating to particle and cell counts
   uint64_t trans_particles; //!< Particles transported
@@ -492,6 +517,18 @@ private:
   double rank_transport_runtime; //!< Transport step runtime for this rank
   double rank_rebalance_time;    //!< Time to rebalance census after transport
   double total_transport_time;    //!< Max transport time summed across all timesteps
+
+  //! Number of summed diagnostic and conservation quantities
+  static constexpr int n_conservation_sums = 20;
+  std::array<double, n_conservation_sums> conservation_sums; //!< Buffer of summed quantities
+  std::array<double, 2> conservation_max; //!< Transport time and its negative, reduced by max
+  std::array<MPI_Request, 2> conservation_reqs; //!< Requests of the pending reductions
+  bool conservation_pending{false}; //!< A conservation reduction has been started
+
+  MPI_Comm node_comm{MPI_COMM_NULL}; //!< Ranks on this node, made by the first memory report
+  int node_rank{0};     //!< Rank in node_comm
+  int n_nodes{1};       //!< Number of nodes
+  int n_world_ranks{1}; //!< Number of ranks
 };
 
 #endif // imc_state_h_
@@ -39,8 +39,8 @@
 //==============================================================================
 class Input {
 public:
-  //! Constructor
-  Input(std::string fileName, const MPI_Types &mpi_types) {
+  //! Constructor, reads fileName or, if is_xml_text is true, parses it as the XML itself
+  Input(std::string fileName, const MPI_Types &mpi_types, const bool is_xml_text = false) {
     using Constants::ELEMENT;
     using Constants::REFLECT;
     using Constants::VACUUM;
@@ -57,6 +57,10 @@ public:
     using Constants::NO_DECOMP;
     using Constants::PARTICLE_PASS;
     using Constants::REPLICATED;
+    // source sampling methods
+    using Constants::UNIFORM_SAMPLING;
+    using Constants::STRATIFIED_SAMPLING;
+    using Constants::SOBOL_SAMPLING;
     using std::cout;
     using std::endl;
     using std::vector;
@@ -79,7 +83,8 @@ public:
       vector<float> z;
 
       pugi::xml_document doc;
-      pugi::xml_parse_result load_result = doc.load_file(fileName.c_str());
+      pugi::xml_parse_result load_result =
+          is_xml_text ? doc.load_string(fileName.c_str()) : doc.load_file(fileName.c_str());
 
       // error checking
       if (!load_result) {
@@ -132,6 +137,19 @@ public:
       n_photons = static_cast<uint64_t>(n_photons_long);
       seed = settings_node.child("seed").text().as_int();
 
+      // cap on the global census size when combing, default to the source photon count
+      if (settings_node.child("max_census_photons"))
+        max_census_photons = settings_node.child("max_census_photons").text().as_ullong();
+      else
+        max_census_photons = n_photons;
+
+      // census photons kept in memory on each rank, the rest are spilled to a file (zero for no
+      // spilling)
+      max_census_in_memory = settings_node.child("max_census_in_memory").text().as_ullong();
+      census_spill_directory = ".";
+      if (settings_node.child("census_spill_directory"))
+        census_spill_directory = settings_node.child_value("census_spill_directory");
+
       output_freq = settings_node.child("output_frequency").text().as_int();
 
       // use gpu transporter if available
@@ -158,12 +176,133 @@ public:
         use_comb = 1;
       }
 
+      // stratified or quasi-Monte Carlo sampling of emission and boundary photons
+      tempString = settings_node.child_value("stratified_sampling");
+      if (tempString == "FALSE")
+        sampling_mode = UNIFORM_SAMPLING;
+      else if (tempString == "TRUE")
+        sampling_mode = STRATIFIED_SAMPLING;
+      else if (tempString == "SOBOL")
+        sampling_mode = SOBOL_SAMPLING;
+      else {
+        cout << "\"stratified_sampling\" not found or recognized, defaulting to FALSE"
+             << endl;
+        sampling_mode = UNIFORM_SAMPLING;
+      }
+
+      // linear tilted emission sampling
+      use_tilt = false;
+      tempString = settings_node.child_value("tilt");
+      if (tempString == "TRUE")
+        use_tilt = true;
+
+      // Russian roulette weight and survival weight, as fractions of birth energy
+      roulette_weight = 0.01;
+      if (settings_node.child("roulette_weight"))
+        roulette_weight = settings_node.child("roulette_weight").text().as_double();
+      survival_weight = 5.0 * roulette_weight;
+      if (settings_node.child("survival_weight"))
+        survival_weight = settings_node.child("survival_weight").text().as_double();
+      if (roulette_weight < 0.0 || roulette_weight >= 1.0 || survival_weight <= roulette_weight) {
+        cout << "ERROR: roulette_weight must be in [0, 1) and survival_weight must be";
+        cout << " larger than it. Exiting..." << endl;
+        exit(EXIT_FAILURE);
+      }
+
+      // weight window splitting with region importances
+      use_weight_windows = false;
+      tempString = settings_node.child_value("weight_windows");
+      if (tempString == "TRUE")
+        use_weight_windows = true;
+
+      // random walk acceleration in optically thick cells
+      use_random_walk = false;
+      tempString = settings_node.child_value("random_walk");
+      if (tempString == "TRUE")
+        use_random_walk = true;
+      random_walk_mfp = 5.0;
+      if (settings_node.child("random_walk_mfp"))
+        random_walk_mfp = settings_node.child("random_walk_mfp").text().as_double();
+
+      // fly through boxes of identical cells in one step
+      use_macro_boxes = false;
+      tempString = settings_node.child_value("macro_boxes");
+      if (tempString == "TRUE")
+        use_macro_boxes = true;
+
+      // discrete diffusion in cells at least this many mean free paths thick (zero for off)
+      ddmc_threshold = 0.0;
+      if (settings_node.child("ddmc_threshold"))
+        ddmc_threshold = settings_node.child("ddmc_threshold").text().as_double();
+
+      // tabulated opacities are reused while the relative temperature change is at most this
+      opacity_cache_tolerance = 0.0;
+      if (settings_node.child("opacity_cache_tolerance"))
+        opacity_cache_tolerance =
+            settings_node.child("opacity_cache_tolerance").text().as_double();
+
+      // multigroup opacity rows are shared by cells in the same log temperature bin
+      opacity_bins_per_decade = 100.0;
+      if (settings_node.child("opacity_bins_per_decade"))
+        opacity_bins_per_decade =
+            settings_node.child("opacity_bins_per_decade").text().as_double();
+      if (opacity_bins_per_decade <= 0.0) {
+        cout << "opacity_bins_per_decade must be positive" << endl;
+        exit(EXIT_FAILURE);
+      }
+
       // write silo flag
       write_silo = false;
       tempString = settings_node.child_value("write_silo");
       if (tempString == "TRUE")
         write_silo = true;
 
+      // region profiler with per-rank trace files
+      profile = false;
+      tempString = settings_node.child_value("profile");
+      if (tempString == "TRUE")
+        profile = true;
+
+      // photon event statistics from the transport kernel
+      count_events = false;
+      tempString = settings_node.child_value("count_events");
+      if (tempString == "TRUE")
+        count_events = true;
+
+      // per-rank trace of the MPI calls in decomposition and particle passing
+      mpi_trace = false;
+      tempString = settings_node.child_value("mpi_trace");
+      if (tempString == "TRUE")
+        mpi_trace = true;
+
+      // hardware counters per phase, with an optional raw event code for floating point ops
+      perf_counters = false;
+      tempString = settings_node.child_value("perf_counters");
+      if (tempString == "TRUE")
+        perf_counters = true;
+      perf_fp_event = 0;
+      if (settings_node.child("perf_fp_event"))
+        perf_fp_event = strtoull(settings_node.child_value("perf_fp_event"), nullptr, 0);
+
+      // files for multi-block SILO output in domain decomposed mode (zero for one reduced file)
+      n_silo_files = 0;
+      if (settings_node.child("silo_files"))
+        n_silo_files = settings_node.child("silo_files").text().as_uint();
+
+      // output files written by a background thread at once, zero writes them in the driver
+      output_queue_size = 2;
+      if (settings_node.child("output_queue_size"))
+        output_queue_size = settings_node.child("output_queue_size").text().as_uint();
+
+      // checkpoint every this many steps (zero for never) into a directory, restart from a file
+      checkpoint_freq = 0;
+      if (settings_node.child("checkpoint_frequency"))
+        checkpoint_freq = settings_node.child("checkpoint_frequency").text().as_uint();
+      checkpoint_directory = ".";
+      if (settings_node.child("checkpoint_directory"))
+        checkpoint_directory = settings_node.child_value("checkpoint_directory");
+      restart_file = settings_node.child_value("restart_file");
+
       // domain decomposed transport aglorithm
       tempString = settings_node.child_value("dd_transport_type");
       if (tempString == "PARTICLE_PASS")
@@ -307,6 +446,10 @@ public:
         }
       }
 
+      // optional binary per-cell regions and temperatures, replaces region_map
+      if (spatial_node.child("material_file"))
+        material_file = spatial_node.child_value("material_file");
+
       // read in boundary conditions
       bool b_error = false;
       bool source_on = false;
@@ -410,6 +553,18 @@ public:
           temp_region.set_T_e(it->child("initial_T_e").text().as_double());
           // default T_r to T_e if not specified
           temp_region.set_T_r(it->child("initial_T_r").text().as_double());
+          if (it->child("importance"))
+            temp_region.set_importance(it->child("importance").text().as_double());
+          if (!(temp_region.get_importance() > 0.0)) {
+            cout << "ERROR: region " << temp_region.get_ID();
+            cout << " importance must be positive. Exiting..." << endl;
+            exit(EXIT_FAILURE);
+          }
+          // discrete diffusion for the whole region
+          if (std::string(it->child_value("ddmc")) == "TRUE")
+            temp_region.set_ddmc(true);
+          // tabulated absorption opacity replaces A + B * T ^ C
+          region_opacity_files.push_back(it->child_value("opacity_table"));
           // map user defined ID to index in region vector
           region_ID_to_index[temp_region.get_ID()] = regions.size();
           // add to list of regions
@@ -432,7 +587,7 @@ public:
       }
 
       // the total number of divisions  must equal the number of unique region maps
-      if (n_divisions != region_map.size()) {
+      if (material_file.empty() && n_divisions != region_map.size()) {
         cout << "ERROR: Number of total divisions must match the number of ";
         cout << "unique region maps. Exiting..." << endl;
         exit(EXIT_FAILURE);
@@ -458,9 +613,9 @@ public:
         batch_size = 100000000;
     } // end xml parse
 
-    const int n_bools = 5;
-    const int n_uint = 15;
-    const int n_doubles = 6;
+    const int n_bools = 13;
+    const int n_uint = 19;
+    const int n_doubles = 12;
     MPI_Datatype MPI_Region = mpi_types.get_region_type();
 
     // root rank broadcasts read values
@@ -473,7 +628,9 @@ public:
 
       // bools
       vector<int> all_bools = {write_silo, use_comb,
-                               print_verbose, print_mesh_info, use_gpu_transporter};
+                               print_verbose, print_mesh_info, use_gpu_transporter, use_tilt,
+                               use_weight_windows, use_random_walk, use_macro_boxes, profile,
+                               count_events, mpi_trace, perf_counters};
       MPI_Bcast(all_bools.data(), n_bools, MPI_INT, 0, MPI_COMM_WORLD);
 
       // bcs
@@ -495,7 +652,11 @@ public:
                                    n_regions,
                                    n_x_div,
                                    n_y_div,
-                                   n_z_div};
+                                   n_z_div,
+                                   sampling_mode,
+                                   n_silo_files,
+                                   output_queue_size,
+                                   checkpoint_freq};
 
       if (all_uint.size() != n_uint) {
         std::cout<<"SIZE MISMATCH IN UINT COMMUNICATION, EXITING..."<<std::endl;
@@ -506,28 +667,50 @@ public:
 
       // uint64
       MPI_Bcast(&n_photons, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+      MPI_Bcast(&max_census_photons, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+      MPI_Bcast(&max_census_in_memory, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+      MPI_Bcast(&perf_fp_event, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
 
       // double
       vector<double> all_doubles = {tStart, dt,    tFinish,
-                                    tMult,  dtMax, T_source};
+                                    tMult,  dtMax, T_source,
+                                    roulette_weight, survival_weight, random_walk_mfp,
+                                    ddmc_threshold, opacity_cache_tolerance,
+                                    opacity_bins_per_decade};
       MPI_Bcast(all_doubles.data(), n_doubles, MPI_DOUBLE, 0, MPI_COMM_WORLD);
 
       // region processing
       MPI_Bcast(regions.data(), n_regions, MPI_Region, 0, MPI_COMM_WORLD);
-      vector<uint32_t> division_key;
-      vector<uint32_t> region_at_division;
-      for (auto rmap : region_map) {
-        division_key.push_back(rmap.first);
-        region_at_division.push_back(rmap.second);
+      for (auto &file_name : region_opacity_files) {
+        uint32_t length = file_name.size();
+        MPI_Bcast(&length, 1, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+        MPI_Bcast(&file_name[0], length, MPI_CHAR, 0, MPI_COMM_WORLD);
       }
-      if (division_key.size() != n_divisions ||
-          region_at_division.size() != n_divisions)
-        std::cout << "something went wrong in division key communication"
-                  << std::endl;
 
-      MPI_Bcast(&division_key[0], n_divisions, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
-      MPI_Bcast(&region_at_division[0], n_divisions, MPI_UNSIGNED, 0,
-                MPI_COMM_WORLD);
+      // checkpoint and material paths
+      for (auto path :
+           {&checkpoint_directory, &restart_file, &census_spill_directory, &material_file}) {
+        uint32_t length = path->size();
+        MPI_Bcast(&length, 1, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+        MPI_Bcast(&(*path)[0], length, MPI_CHAR, 0, MPI_COMM_WORLD);
+      }
+      // the region map isn't used with a material file
+      if (material_file.empty()) {
+        vector<uint32_t> division_key;
+        vector<uint32_t> region_at_division;
+        for (auto rmap : region_map) {
+          division_key.push_back(rmap.first);
+          region_at_division.push_back(rmap.second);
+        }
+        if (division_key.size() != n_divisions ||
+            region_at_division.size() != n_divisions)
+          std::cout << "something went wrong in division key communication"
+                    << std::endl;
+
+        MPI_Bcast(&division_key[0], n_divisions, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+        MPI_Bcast(&region_at_division[0], n_divisions, MPI_UNSIGNED, 0,
+                  MPI_COMM_WORLD);
+      }
 
       // mesh spacing and coordinate processing
       MPI_Bcast(&x_start[0], n_x_div, MPI_DOUBLE, 0, MPI_COMM_WORLD);
@@ -541,7 +724,7 @@ public:
       MPI_Bcast(&n_z_cells[0], n_z_div, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
     } else {
       // set bools
-      vector<int> all_bools(8);
+      vector<int> all_bools(n_bools);
 
       MPI_Bcast(&all_bools[0], n_bools, MPI_INT, 0, MPI_COMM_WORLD);
       write_silo = all_bools[0];
@@ -549,6 +732,14 @@ public:
       print_verbose = all_bools[2];
       print_mesh_info = all_bools[3];
       use_gpu_transporter = all_bools[4];
+      use_tilt = all_bools[5];
+      use_weight_windows = all_bools[6];
+      use_random_walk = all_bools[7];
+      use_macro_boxes = all_bools[8];
+      profile = all_bools[9];
+      count_events = all_bools[10];
+      mpi_trace = all_bools[11];
+      perf_counters = all_bools[12];
 
       // set bcs
       vector<int> bcast_bcs(6);
@@ -574,9 +765,16 @@ public:
       const uint32_t n_x_div = all_uint[12];
       const uint32_t n_y_div = all_uint[13];
       const uint32_t n_z_div = all_uint[14];
+      sampling_mode = all_uint[15];
+      n_silo_files = all_uint[16];
+      output_queue_size = all_uint[17];
+      checkpoint_freq = all_uint[18];
 
       // uint64
       MPI_Bcast(&n_photons, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+      MPI_Bcast(&max_census_photons, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+      MPI_Bcast(&max_census_in_memory, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+      MPI_Bcast(&perf_fp_event, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
 
       vector<double> all_doubles(n_doubles);
       MPI_Bcast(&all_doubles[0], n_doubles, MPI_DOUBLE, 0, MPI_COMM_WORLD);
@@ -586,18 +784,42 @@ public:
       tMult = all_doubles[3];
       dtMax = all_doubles[4];
       T_source = all_doubles[5];
+      roulette_weight = all_doubles[6];
+      survival_weight = all_doubles[7];
+      random_walk_mfp = all_doubles[8];
+      ddmc_threshold = all_doubles[9];
+      opacity_cache_tolerance = all_doubles[10];
+      opacity_bins_per_decade = all_doubles[11];
 
       // region processing (broadcast directly into member variable)
       regions.resize(n_regions);
       MPI_Bcast(&regions[0], n_regions, MPI_Region, 0, MPI_COMM_WORLD);
+      region_opacity_files.resize(n_regions);
+      for (auto &file_name : region_opacity_files) {
+        uint32_t length;
+        MPI_Bcast(&length, 1, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+        file_name.resize(length);
+        MPI_Bcast(&file_name[0], length, MPI_CHAR, 0, MPI_COMM_WORLD);
+      }
 
-      vector<uint32_t> division_key(n_divisions);
-      vector<uint32_t> region_at_division(n_divisions);
-      MPI_Bcast(&division_key[0], n_divisions, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
-      MPI_Bcast(&region_at_division[0], n_divisions, MPI_UNSIGNED, 0,
-                MPI_COMM_WORLD);
-      for (uint32_t i = 0; i < n_divisions; ++i) {
-        region_map[division_key[i]] = region_at_division[i];
+      // checkpoint and material paths
+      for (auto path :
+           {&checkpoint_directory, &restart_file, &census_spill_directory, &material_file}) {
+        uint32_t length;
+        MPI_Bcast(&length, 1, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+        path->resize(length);
+        MPI_Bcast(&(*path)[0], length, MPI_CHAR, 0, MPI_COMM_WORLD);
+      }
+
+      if (material_file.empty()) {
+        vector<uint32_t> division_key(n_divisions);
+        vector<uint32_t> region_at_division(n_divisions);
+        MPI_Bcast(&division_key[0], n_divisions, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+        MPI_Bcast(&region_at_division[0], n_divisions, MPI_UNSIGNED, 0,
+                  MPI_COMM_WORLD);
+        for (uint32_t i = 0; i < n_divisions; ++i) {
+          region_map[division_key[i]] = region_at_division[i];
+        }
       }
       for (uint32_t i = 0; i < n_regions; ++i)
         region_ID_to_index[regions[i].get_ID()] = i;
@@ -665,10 +887,47 @@ public:
     cout << " , output frequency: " << output_freq << endl;
 
     if (use_comb)
-      cout << "Combing census enabled (default)" << endl;
+      cout << "Combing census enabled (default), max census photons: " << max_census_photons << endl;
     else
       cout << "No combing" << endl;
 
+    if (use_tilt)
+      cout << "Tilted emission sampling enabled" << endl;
+
+    cout << "Roulette weight: " << roulette_weight << ", survival weight: " << survival_weight;
+    if (use_weight_windows)
+      cout << ", weight window splitting enabled";
+    cout << endl;
+
+    if (use_random_walk)
+      cout << "Random walk in thick cells, minimum sphere radius: " << random_walk_mfp << " mfp" << endl;
+
+    if (use_macro_boxes)
+      cout << "Macro box tracking through identical cells" << endl;
+
+    if (ddmc_threshold > 0.0)
+      cout << "DDMC in cells at least " << ddmc_threshold << " mfp thick" << endl;
+    for (auto const &region : regions) {
+      if (region.get_ddmc())
+        cout << "DDMC in region " << region.get_ID() << endl;
+    }
+    for (uint32_t i = 0; i < regions.size(); ++i) {
+      if (!region_opacity_files[i].empty())
+        cout << "Region " << regions[i].get_ID() << " opacity table: " << region_opacity_files[i]
+             << endl;
+    }
+    if (opacity_cache_tolerance > 0.0)
+      cout << "Opacity table cache tolerance: " << opacity_cache_tolerance << endl;
+    if (BRANSON_N_GROUPS > 1)
+      cout << "Group opacity temperature bins per decade: " << opacity_bins_per_decade << endl;
+
+    if (sampling_mode == Constants::STRATIFIED_SAMPLING)
+      cout << "Stratified source sampling" << endl;
+    else if (sampling_mode == Constants::SOBOL_SAMPLING)
+      cout << "Scrambled Sobol source sampling" << endl;
+    else
+      cout << "Uniform source sampling (default)" << endl;
+
     if(bc[0] == SOURCE || bc[1] == SOURCE || bc[2] == SOURCE || bc[3] == SOURCE || bc[4] == SOURCE || bc[5] == SOURCE)
       std::cout<<"Source boundary on, T_source: "<<T_source<<std::endl;
 
@@ -678,18 +937,41 @@ public:
       cout << "Terse printing mode (default)" << endl;
 
 #ifdef VIZ_LIBRARIES_FOUND
-    if (write_silo)
+    if (write_silo && n_silo_files > 0)
+      cout << "SILO output enabled, multi-block in " << n_silo_files << " files" << endl;
+    else if (write_silo)
       cout << "SILO output enabled" << endl;
     else
       cout << "SILO output disabled (default)" << endl;
+    if (write_silo && output_queue_size > 0)
+      cout << "SILO files written in the background, at most " << output_queue_size << " queued"
+           << endl;
 #else
     if (write_silo)
       cout << "NOTE: SILO libraries not linked... no visualization" << endl;
 #endif
+    if (checkpoint_freq > 0)
+      cout << "Checkpoint every " << checkpoint_freq << " steps in " << checkpoint_directory
+           << endl;
+    if (!restart_file.empty())
+      cout << "Restarting from " << restart_file << endl;
+    if (profile)
+      cout << "Profiling regions, traces written to profile_<rank>.json" << endl;
+    if (count_events)
+      cout << "Counting photon events in transport" << endl;
+    if (mpi_trace)
+      cout << "Tracing MPI calls, traces written to mpi_trace_<rank>.bin" << endl;
+    if (perf_counters)
+      cout << "Hardware counters per phase, written to perf_counters_<rank>.csv" << endl;
+    if (max_census_in_memory > 0)
+      cout << "Census photons past " << max_census_in_memory << " per rank spilled to "
+           << census_spill_directory << endl;
     cout << "Spatial Information -- cells x,y,z: " << n_global_x_cells << " ";
     cout << n_global_y_cells << " " << n_global_z_cells << endl;
 
     cout << "--Material Information--" << endl;
+    if (!material_file.empty())
+      cout << "Cell regions and initial temperatures from " << material_file << endl;
     for (uint32_t r = 0; r < regions.size(); ++r) {
       cout << " heat capacity: " << regions[r].get_cV();
       cout << " opacity constants: " << regions[r].get_opac_A() << " + "
@@ -795,14 +1077,44 @@ public:
   bool get_comb_bool() const { return use_comb; }
   //! Return the value of the write SILO option
   bool get_write_silo_bool() const { return write_silo; }
+  //! Return the value of the region profiler option
+  bool get_profile_bool() const { return profile; }
+  //! Return the value of the event counting option
+  bool get_count_events_bool() const { return count_events; }
+  //! Return the value of the MPI tracing option
+  bool get_mpi_trace_bool() const { return mpi_trace; }
+  //! Return the value of the hardware counter option
+  bool get_perf_counters_bool() const { return perf_counters; }
+  //! Return the raw perf event code counting floating point operations, zero for none
+  uint64_t get_perf_fp_event() const { return perf_fp_event; }
   //! Return the value of the verbose printing option
   bool get_verbose_print_bool() const { return print_verbose; }
   //! Return the value of the mesh print option
   bool get_print_mesh_info_bool() const { return print_mesh_info; }
+  //! Return the tilted emission sampling option
+  bool get_tilt_bool() const { return use_tilt; }
+  //! Return the weight window splitting option
+  bool get_weight_windows_bool() const { return use_weight_windows; }
+  //! Return the random walk acceleration option
+  bool get_random_walk_bool() const { return use_random_walk; }
+  //! Return true if photons fly through boxes of identical cells in one step
+  bool get_macro_boxes_bool() const { return use_macro_boxes; }
   //! Return the use_gpu_transporter option
   bool get_use_gpu_transporter_bool() const { return use_gpu_transporter; }
+  //! Return the emission and boundary source sampling method
+  uint32_t get_sampling_mode() const { return sampling_mode; }
   //! Return the frequency of timestep summary printing
   uint32_t get_output_freq() const { return output_freq; }
+  //! Return the number of files for multi-block SILO output, zero for one reduced file
+  uint32_t get_n_silo_files() const { return n_silo_files; }
+  //! Return the most output files queued for the background writer, zero for no thread
+  uint32_t get_output_queue_size() const { return output_queue_size; }
+  //! Return the number of steps between checkpoints, zero for no checkpoints
+  uint32_t get_checkpoint_freq() const { return checkpoint_freq; }
+  //! Return the directory checkpoint files are written to
+  const std::string &get_checkpoint_directory() const { return checkpoint_directory; }
+  //! Return the checkpoint file to restart from, empty to start at the beginning
+  const std::string &get_restart_file() const { return restart_file; }
 
   //! Return the timestep size (shakes)
   double get_dt() const { return dt; }
@@ -814,10 +1126,32 @@ public:
   double get_time_mult() const { return tMult; }
   //! Return the maximum timestep size (shakes)
   double get_dt_max() const { return dtMax; }
+  //! Return the weight below which photons play roulette (fraction of birth energy)
+  double get_roulette_weight() const { return roulette_weight; }
+  //! Return the weight given to roulette survivors (fraction of birth energy)
+  double get_survival_weight() const { return survival_weight; }
+  //! Return the smallest random walk sphere radius in mean free paths
+  double get_random_walk_mfp() const { return random_walk_mfp; }
+  //! Return the optical thickness in mean free paths above which cells use DDMC (zero for off)
+  double get_ddmc_threshold() const { return ddmc_threshold; }
+  //! Return the opacity table file of each region, empty for the analytic law
+  const std::vector<std::string> &get_region_opacity_files() const {
+    return region_opacity_files;
+  }
+  //! Return the relative temperature change below which tabulated opacities are reused
+  double get_opacity_cache_tolerance() const { return opacity_cache_tolerance; }
+  //! Return the log temperature bins per decade that share a multigroup opacity row
+  double get_opacity_bins_per_decade() const { return opacity_bins_per_decade; }
   //! Return the input seed for the RNG
   int get_rng_seed() const { return seed; }
   //! Return the number of photons set in the input file to run
   uint64_t get_number_photons() const { return n_photons; }
+  //! Return the global census size above which the census is combed
+  uint64_t get_max_census_photons() const { return max_census_photons; }
+  //! Return the census photons kept in memory on each rank, zero for no spilling
+  uint64_t get_max_census_in_memory() const { return max_census_in_memory; }
+  //! Return the directory for census spill files
+  const std::string &get_census_spill_directory() const { return census_spill_directory; }
   //! Return the batch size (particles to run between parallel processing)
   uint32_t get_batch_size() const { return batch_size; }
   //! Return the user requested number of particles in a message
@@ -835,6 +1169,9 @@ public:
   //! Return the temperature of the face source
   double get_source_T() const { return T_source; }
 
+  //! Return the binary per-cell material file, empty to use the region map
+  const std::string &get_material_file() const { return material_file; }
+
   //! Return the number of material regions
   uint32_t get_n_regions() const { return regions.size(); }
 
@@ -875,10 +1212,13 @@ private:
 
   // material
   std::vector<Region> regions; //!< Vector of regions in the problem
+  std::vector<std::string> region_opacity_files; //!< Opacity table file of each region
 
   //! Maps unique key to user set ID for a region
   std::map<uint32_t, uint32_t> region_map;
 
+  std::string material_file; //!< Binary per-cell regions and temperatures, empty for region_map
+
   //! Maps user set region ID to the index in the regions vector
   std::map<uint32_t, uint32_t> region_ID_to_index;
 
@@ -887,7 +1227,18 @@ private:
 
   // Monte Carlo parameters
   uint64_t n_photons; //!< Photons to source each timestep
+  uint64_t max_census_photons; //!< Global census size above which the census is combed
+  uint64_t max_census_in_memory; //!< Census photons kept in memory on a rank, zero for all
+  uint64_t perf_fp_event;        //!< Raw perf event code for floating point ops, zero for none
+  std::string census_spill_directory; //!< Directory for census spill files
   uint32_t seed;      //!< Random number seed
+  uint32_t sampling_mode; //!< Emission and boundary source sampling method
+  double roulette_weight; //!< Roulette photons below this fraction of birth energy
+  double survival_weight; //!< Fraction of birth energy given to roulette survivors
+  double random_walk_mfp; //!< Smallest random walk sphere radius in mean free paths
+  double ddmc_threshold;  //!< Cells at least this many mean free paths thick use DDMC
+  double opacity_cache_tolerance; //!< Relative temperature change that recomputes table opacity
+  double opacity_bins_per_decade; //!< Log temperature bins per decade of the opacity rows
 
   // Parallel parameters
   uint32_t dd_mode;     //!< Mode of domain decomposed transport algorithm
@@ -896,6 +1247,11 @@ private:
 
   // Debug parameters
   uint32_t output_freq; //!< How often to print temperature information
+  uint32_t n_silo_files; //!< Files for multi-block SILO output, zero for one reduced file
+  uint32_t output_queue_size; //!< Most output files queued for the background writer
+  uint32_t checkpoint_freq; //!< Steps between checkpoints, zero for none
+  std::string checkpoint_directory; //!< Directory for checkpoint files
+  std::string restart_file; //!< Checkpoint file to restart from, empty for none
 
   // Bools
   bool use_comb;        //!< Comb census photons
@@ -903,6 +1259,14 @@ private:
   bool print_verbose;   //!< Verbose printing flag
   bool print_mesh_info; //!< Mesh information printing flag
   bool use_gpu_transporter; //!< Run on GPU if availabile
+  bool use_tilt;        //!< Tilt emission position toward the hotter neighbors
+  bool use_weight_windows; //!< Split photons entering important regions
+  bool use_random_walk;  //!< Random walk photons deep in thick cells
+  bool use_macro_boxes;  //!< Track photons through boxes of identical cells
+  bool profile;          //!< Time code regions and write trace files
+  bool count_events;     //!< Count photon events in the transport kernel
+  bool mpi_trace;        //!< Trace MPI calls and write per-rank trace files
+  bool perf_counters;    //!< Read hardware counters in each phase
 
   // parallel performance parameters
   uint32_t batch_size; //!< Particles to run between MPI message checks
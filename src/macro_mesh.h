@@ -0,0 +1,274 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   macro_mesh.h
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Boxes of identical cells that photons can cross in one flight
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#ifndef macro_mesh_h_
+#define macro_mesh_h_
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "cell.h"
+#include "constants.h"
+
+//==============================================================================
+/*!
+ * \struct Macro_Box
+ * \brief A block of structured cells with identical transport properties
+ *
+ * Plane coordinates are stored in the owning Macro_Mesh, n[d] + 1 per
+ * dimension starting at plane_offset (x, then y, then z). Cells are stored
+ * x fastest starting at cell_offset.
+ */
+//==============================================================================
+struct Macro_Box {
+  std::array<double, 6> nodes; //!< x_low, x_high, y_low, y_high, z_low, z_high
+  std::array<uint32_t, 3> n;   //!< Cells in x, y and z
+  uint32_t plane_offset;       //!< Index of the first x plane
+  uint32_t cell_offset;        //!< Index of the first cell
+};
+
+//==============================================================================
+/*!
+ * \class Macro_Mesh
+ * \brief Acceleration structure of macro boxes over runs of identical cells
+ *
+ * Cells on this rank with the same opacities, Fleck factor and importance are
+ * grouped greedily into boxes (grown in x, then y, then z). Photons in a box
+ * fly to the box surface, a scatter or census in one step, and the absorbed
+ * energy is deposited in each cell crossed from the plane intersections, so
+ * tallies are the same as the cell-by-cell path up to roundoff. DDMC cells
+ * are never in a box.
+ */
+//==============================================================================
+class Macro_Mesh {
+public:
+  //! Index returned for cells that aren't in a box
+  static constexpr uint32_t no_box = std::numeric_limits<uint32_t>::max();
+
+  //! Constructor, no boxes until build is called
+  Macro_Mesh() {}
+
+  //! Build boxes over local cells of a structured ngx by ngy by ngz mesh
+  Macro_Mesh(const Cell_Vector &cells, const uint32_t ngx, const uint32_t ngy,
+             const uint32_t ngz) {
+    build(cells, ngx, ngy, ngz);
+  }
+
+  //! Rebuild boxes if a cell's transport properties changed since the last build. Memory and
+  // time scale with the local cells, not the global mesh.
+  void build(const Cell_Vector &cells, const uint32_t ngx, const uint32_t ngy,
+             const uint32_t ngz) {
+    if (!update_properties(cells))
+      return;
+    boxes.clear();
+    planes.clear();
+    box_cells.clear();
+    cell_box.assign(cells.size(), no_box);
+    cell_ijk.assign(cells.size(), {0, 0, 0});
+
+    // local cells in structured order, other structured indices are found by binary search
+    std::vector<std::pair<uint32_t, uint32_t>> by_index(cells.size());
+    for (uint32_t i = 0; i < cells.size(); ++i)
+      by_index[i] = {cells[i].get_silo_index(), i};
+    std::sort(by_index.begin(), by_index.end());
+    auto local_at = [&](const uint32_t index) {
+      auto found = std::lower_bound(by_index.begin(), by_index.end(),
+                                    std::make_pair(index, uint32_t(0)));
+      return (found != by_index.end() && found->first == index) ? found->second : no_box;
+    };
+
+    for (auto const &entry : by_index) {
+      const uint32_t g = entry.first;
+      const uint32_t first = entry.second;
+      if (cell_box[first] != no_box || cells[first].is_ddmc())
+        continue;
+      const Cell &ref = cells[first];
+      auto matches = [&](uint32_t index) {
+        const uint32_t l = local_at(index);
+        return l != no_box && cell_box[l] == no_box && same_properties(cells[l], ref);
+      };
+      const uint32_t x0 = g % ngx;
+      const uint32_t y0 = (g / ngx) % ngy;
+      const uint32_t z0 = g / (ngx * ngy);
+      uint32_t nx = 1, ny = 1, nz = 1;
+      while (x0 + nx < ngx && matches(g + nx))
+        nx++;
+      auto row_matches = [&](uint32_t start) {
+        for (uint32_t i = 0; i < nx; ++i) {
+          if (!matches(start + i))
+            return false;
+        }
+        return true;
+      };
+      while (y0 + ny < ngy && row_matches(g + ny * ngx))
+        ny++;
+      auto slab_matches = [&](uint32_t start) {
+        for (uint32_t j = 0; j < ny; ++j) {
+          if (!row_matches(start + j * ngx))
+            return false;
+        }
+        return true;
+      };
+      while (z0 + nz < ngz && slab_matches(g + nz * ngx * ngy))
+        nz++;
+      // a single cell box saves nothing
+      if (nx * ny * nz < 2)
+        continue;
+
+      Macro_Box box;
+      box.n = {nx, ny, nz};
+      box.plane_offset = static_cast<uint32_t>(planes.size());
+      box.cell_offset = static_cast<uint32_t>(box_cells.size());
+      const std::array<uint32_t, 3> stride = {1, ngx, ngx * ngy};
+      for (uint32_t d = 0; d < 3; ++d) {
+        for (uint32_t i = 0; i < box.n[d]; ++i)
+          planes.push_back(cells[local_at(g + i * stride[d])].get_node_array()[2 * d]);
+        planes.push_back(cells[local_at(g + (box.n[d] - 1) * stride[d])].get_node_array()[2 * d + 1]);
+        box.nodes[2 * d] = planes[box.plane_offset + (d > 0 ? box.n[0] + 1 : 0) +
+                                  (d > 1 ? box.n[1] + 1 : 0)];
+        box.nodes[2 * d + 1] = planes.back();
+      }
+      const uint32_t box_index = static_cast<uint32_t>(boxes.size());
+      for (uint32_t k = 0; k < nz; ++k) {
+        for (uint32_t j = 0; j < ny; ++j) {
+          for (uint32_t i = 0; i < nx; ++i) {
+            const uint32_t l = local_at(g + i + j * ngx + k * ngx * ngy);
+            cell_box[l] = box_index;
+            cell_ijk[l] = {i, j, k};
+            box_cells.push_back(l);
+          }
+        }
+      }
+      boxes.push_back(box);
+    }
+  }
+
+  //! Return the box a local cell is in, no_box if it isn't in one
+  uint32_t get_box_index(const uint32_t local_cell) const { return cell_box[local_cell]; }
+
+  //! Return the number of boxes
+  uint32_t get_n_boxes() const { return static_cast<uint32_t>(boxes.size()); }
+
+  //! Return a box
+  const Macro_Box &get_box(const uint32_t box_index) const { return boxes[box_index]; }
+
+  //! Return the distance to the surface of a box and the face crossed, in the first n_dim
+  // dimensions
+  template <uint32_t n_dim = 3>
+  double get_distance_to_boundary(const uint32_t box_index, const std::array<double, 3> &pos,
+                                  const std::array<double, 3> &angle,
+                                  uint32_t &surface_cross) const {
+    const Macro_Box &box = boxes[box_index];
+    double min_dist = 1.0e16;
+    for (uint32_t i = 0; i < n_dim; i++) {
+      const uint32_t index = 2 * i + sgn(angle[i]);
+      const double dist = (box.nodes[index] - pos[i]) / angle[i];
+      if (dist < min_dist) {
+        min_dist = dist;
+        surface_cross = index;
+      }
+    }
+    return min_dist;
+  }
+
+  //! Call deposit(local_cell, length) for each cell a straight flight of length dist crosses, in
+  // order, and return the local cell the flight ends in. The flight must stay in the box and
+  // planes past the first n_dim dimensions are never crossed.
+  template <uint32_t n_dim = 3, typename Deposit>
+  uint32_t trace(const uint32_t local_cell, const std::array<double, 3> &pos,
+                 const std::array<double, 3> &angle, const double dist, Deposit &&deposit) const {
+    const Macro_Box &box = boxes[cell_box[local_cell]];
+    const std::array<uint32_t, 3> plane_start = {box.plane_offset, box.plane_offset + box.n[0] + 1,
+                                                 box.plane_offset + box.n[0] + box.n[1] + 2};
+    std::array<uint32_t, 3> ijk = cell_ijk[local_cell];
+    std::array<double, 3> t_next;
+    for (uint32_t d = 0; d < 3; ++d) {
+      if (d >= n_dim)
+        t_next[d] = 1.0e100;
+      else if (angle[d] > 0.0)
+        t_next[d] = (planes[plane_start[d] + ijk[d] + 1] - pos[d]) / angle[d];
+      else if (angle[d] < 0.0)
+        t_next[d] = (planes[plane_start[d] + ijk[d]] - pos[d]) / angle[d];
+      else
+        t_next[d] = 1.0e100;
+    }
+    uint32_t cell = local_cell;
+    double t = 0.0;
+    while (true) {
+      const uint32_t d = (t_next[0] < t_next[1]) ? (t_next[0] < t_next[2] ? 0 : 2)
+                                                 : (t_next[1] < t_next[2] ? 1 : 2);
+      // stop at the end of the flight, or at the box surface if roundoff says otherwise
+      const bool leaving = (angle[d] > 0.0) ? ijk[d] + 1 == box.n[d] : ijk[d] == 0;
+      if (t_next[d] >= dist || leaving) {
+        deposit(cell, std::max(dist - t, 0.0));
+        return cell;
+      }
+      deposit(cell, std::max(t_next[d] - t, 0.0));
+      t = std::max(t, t_next[d]);
+      if (angle[d] > 0.0) {
+        ijk[d]++;
+        t_next[d] = (planes[plane_start[d] + ijk[d] + 1] - pos[d]) / angle[d];
+      } else {
+        ijk[d]--;
+        t_next[d] = (planes[plane_start[d] + ijk[d]] - pos[d]) / angle[d];
+      }
+      cell = box_cells[box.cell_offset + ijk[0] + box.n[0] * (ijk[1] + box.n[1] * ijk[2])];
+    }
+  }
+
+private:
+  //! Properties that decide which cells share a box
+  typedef std::array<double, 5> Box_Properties;
+
+  //! Return the properties of a cell that decide its box
+  static Box_Properties get_properties(const Cell &cell) {
+    return {cell.get_op_a(), cell.get_op_s(), cell.get_f(), cell.get_importance(),
+            cell.is_ddmc() ? 1.0 : 0.0};
+  }
+
+  //! Store the box properties of every cell, return true if any changed since the last call
+  bool update_properties(const Cell_Vector &cells) {
+    bool changed = built_properties.size() != cells.size();
+    built_properties.resize(cells.size());
+    for (uint32_t i = 0; i < cells.size(); ++i) {
+      const Box_Properties p = get_properties(cells[i]);
+      if (p != built_properties[i]) {
+        built_properties[i] = p;
+        changed = true;
+      }
+    }
+    return changed;
+  }
+
+  //! Return true if photons see the same properties in two cells
+  static bool same_properties(const Cell &a, const Cell &b) {
+    return !a.is_ddmc() && a.get_op_a() == b.get_op_a() && a.get_op_s() == b.get_op_s() &&
+           a.get_f() == b.get_f() && a.get_importance() == b.get_importance();
+  }
+
+  std::vector<Macro_Box> boxes;                 //!< Boxes on this rank
+  std::vector<double> planes;                   //!< Cell plane coordinates of each box
+  std::vector<uint32_t> box_cells;              //!< Local cell indices of each box, x fastest
+  std::vector<uint32_t> cell_box;               //!< Box of each local cell
+  std::vector<std::array<uint32_t, 3>> cell_ijk; //!< Position of each local cell in its box
+  std::vector<Box_Properties> built_properties;  //!< Box properties of each cell at the last build
+};
+
+// out-of-class definition, build passes no_box by reference (needed before C++17)
+constexpr uint32_t Macro_Mesh::no_box;
+
+#endif // macro_mesh_h_
+//---------------------------------------------------------------------------//
+// end of macro_mesh.h
+//---------------------------------------------------------------------------//
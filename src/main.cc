@@ -15,6 +15,7 @@
 #include <time.h>
 #include <vector>
 
+#include "benchmark_problem.h"
 #include "config.h"
 #include "constants.h"
 #include "imc_parameters.h"
@@ -22,8 +23,11 @@
 #include "info.h"
 #include "input.h"
 #include "mesh.h"
+#include "mpi_trace.h"
 #include "mpi_types.h"
 #include "particle_pass_driver.h"
+#include "perf_counters.h"
+#include "profiler.h"
 #include "replicated_driver.h"
 #include "timer.h"
 
@@ -38,8 +42,12 @@ int main(int argc, char **argv) {
   MPI_Init(&argc, &argv);
 
   // check to see if number of arguments is correct
-  if (argc != 2) {
+  const bool benchmark = (argc > 1 && string(argv[1]) == "--benchmark");
+  if (argc != 2 && !benchmark) {
     cout << "Usage: BRANSON <path_to_input_file>" << endl;
+    cout << "       BRANSON --benchmark <weak|strong> [--cells N] [--tau X] [--scatter X]"
+         << " [--photons N] [--steps N] [--dd PARTICLE_PASS|REPLICATED] [--threads N]"
+         << " [--json file]" << endl;
     exit(EXIT_FAILURE);
   }
 
@@ -64,12 +72,24 @@ int main(int argc, char **argv) {
     // make MPI types object
     MPI_Types mpi_types;
 
-    // get input object from filename
+    // get input object from filename, or generate the synthetic benchmark problem
+    Benchmark_Problem problem;
+    if (benchmark)
+      problem = parse_benchmark_args(argc, argv);
     std::string filename(argv[1]);
-    Input input(filename, mpi_types);
+    Input input(benchmark ? problem.make_input(mpi_info.get_n_rank()) : filename, mpi_types,
+                benchmark);
     if (mpi_info.get_rank() == 0)
       input.print_problem_info();
 
+    // time regions from here on if requested, benchmarks always report phase times
+    if (input.get_profile_bool() || benchmark)
+      Profiler::enable();
+    if (input.get_mpi_trace_bool())
+      MPI_Trace::enable();
+    if (input.get_perf_counters_bool())
+      Perf_Counters::enable(mpi_info.get_rank(), input.get_perf_fp_event());
+
     // IMC paramters setup
     IMC_Parameters imc_p(input);
 
@@ -83,8 +103,10 @@ int main(int argc, char **argv) {
     timers.start_timer("Total setup");
 
     wrapped_cali_mark_begin("mesh setup");
+    Profiler::Scope setup_scope(Profiler::SETUP);
     Mesh mesh(input, mpi_types, mpi_info, imc_p);
     mesh.initialize_physical_properties(input);
+    setup_scope.stop();
     wrapped_cali_mark_end("mesh setup");
 
     timers.stop_timer("Total setup");
@@ -124,6 +146,16 @@ int main(int argc, char **argv) {
         imc_state.get_photons_per_second_fom(imc_p.get_n_user_photons())<<endl;
     }
 
+    // write traces and print the region table
+    const Profiler::Summary profile =
+        Profiler::finalize(mpi_info.get_rank(), input.get_profile_bool());
+    MPI_Trace::finalize();
+    Perf_Counters::finalize(mpi_info.get_rank());
+    if (benchmark)
+      write_benchmark_record(problem, mpi_info.get_rank(), mpi_info.get_n_rank(), imc_state,
+                             timers.get_time("Total setup"), timers.get_time("Total non-setup"),
+                             profile);
+
   } // end main loop scope, objects destroyed here
 
   MPI_Barrier(MPI_COMM_WORLD);
@@ -0,0 +1,144 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   material_file.h
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Per-cell region IDs and initial temperatures read from a mapped binary file
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#ifndef material_file_h_
+#define material_file_h_
+
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+//==============================================================================
+/*!
+ * \class Material_File
+ * \brief Region ID and initial temperatures of every cell in the global mesh
+ *
+ * Replaces the XML region_map for large material layouts. The binary format is a
+ * header followed by one array per field, each in global cell order (x fastest,
+ * then y, then z):
+ *
+ *   char[8]   magic "BRNMATL"
+ *   uint32_t  version, n_cells
+ *   uint32_t  region_ID[n_cells]
+ *   double    T_e[n_cells]
+ *   double    T_r[n_cells]
+ *
+ * The file is mapped read-only, so a rank only pages in the slice of each array
+ * it asks for and nothing is broadcast.
+ */
+//==============================================================================
+class Material_File {
+public:
+  //! Map a material file and check it describes n_global cells
+  Material_File(const std::string &file_name, const uint32_t n_global)
+      : mapped(nullptr), n_bytes(0), n_cells(0) {
+    const int fd = open(file_name.c_str(), O_RDONLY);
+    struct stat file_stat;
+    if (fd < 0 || fstat(fd, &file_stat) != 0) {
+      std::cout << "ERROR: could not open material file " << file_name << ", exiting..."
+                << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    n_bytes = file_stat.st_size;
+    if (n_bytes >= header_size) {
+      void *address = mmap(nullptr, n_bytes, PROT_READ, MAP_SHARED, fd, 0);
+      if (address != MAP_FAILED)
+        mapped = static_cast<const char *>(address);
+    }
+    close(fd);
+
+    uint32_t version = 0;
+    if (mapped) {
+      std::memcpy(&version, mapped + 8, sizeof(uint32_t));
+      std::memcpy(&n_cells, mapped + 12, sizeof(uint32_t));
+    }
+    if (!mapped || std::strncmp(mapped, file_magic(), 8) != 0 || version != file_version ||
+        n_cells != n_global || n_bytes != file_size(n_cells)) {
+      std::cout << "ERROR: " << file_name << " is not a material file for " << n_global
+                << " cells, exiting..." << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  //! Destructor, unmaps the file
+  ~Material_File() {
+    if (mapped)
+      munmap(const_cast<char *>(mapped), n_bytes);
+  }
+
+  Material_File(const Material_File &) = delete;
+  Material_File &operator=(const Material_File &) = delete;
+
+  //! Return the region ID of a global cell
+  uint32_t get_region_ID(const uint32_t global_index) const {
+    uint32_t region_ID;
+    std::memcpy(&region_ID, mapped + header_size + global_index * sizeof(uint32_t),
+                sizeof(uint32_t));
+    return region_ID;
+  }
+
+  //! Return the initial material temperature of a global cell
+  double get_T_e(const uint32_t global_index) const {
+    return get_double(header_size + n_cells * sizeof(uint32_t), global_index);
+  }
+
+  //! Return the initial radiation temperature of a global cell
+  double get_T_r(const uint32_t global_index) const {
+    return get_double(header_size + n_cells * (sizeof(uint32_t) + sizeof(double)),
+                      global_index);
+  }
+
+  //! Write a material file, the vectors are indexed by global cell
+  static void write(const std::string &file_name, const std::vector<uint32_t> &region_ID,
+                    const std::vector<double> &T_e, const std::vector<double> &T_r) {
+    const uint32_t header[2] = {file_version, static_cast<uint32_t>(region_ID.size())};
+    std::ofstream out(file_name, std::ios::binary);
+    out.write(file_magic(), 8);
+    out.write(reinterpret_cast<const char *>(header), 2 * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char *>(region_ID.data()),
+              region_ID.size() * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char *>(T_e.data()), T_e.size() * sizeof(double));
+    out.write(reinterpret_cast<const char *>(T_r.data()), T_r.size() * sizeof(double));
+  }
+
+private:
+  //! Read a double from an array starting at offset (arrays after region_ID may be unaligned)
+  double get_double(const size_t offset, const uint32_t global_index) const {
+    double value;
+    std::memcpy(&value, mapped + offset + global_index * sizeof(double), sizeof(double));
+    return value;
+  }
+
+  //! Return the expected size in bytes of a file with n cells
+  static size_t file_size(const uint32_t n) {
+    return header_size + size_t(n) * (sizeof(uint32_t) + 2 * sizeof(double));
+  }
+
+  static const char *file_magic() { return "BRNMATL"; }
+  static constexpr uint32_t file_version = 1; //!< Current file format
+  static constexpr size_t header_size = 8 + 2 * sizeof(uint32_t); //!< Magic, version, n_cells
+
+  const char *mapped; //!< Mapped file
+  size_t n_bytes;     //!< Size of the mapping
+  uint32_t n_cells;   //!< Cells in the file
+};
+
+#endif // material_file_h_
+//---------------------------------------------------------------------------//
+// end of material_file.h
+//---------------------------------------------------------------------------//
@@ -0,0 +1,168 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   memory_tracker.h
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Allocation counters by subsystem, a tracking allocator and process memory
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#ifndef memory_tracker_h_
+#define memory_tracker_h_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Memory {
+
+//! Subsystems whose allocations are counted
+enum Subsystem { PHOTONS, TALLIES, MPI_BUFFERS, MESH, N_SUBSYSTEMS };
+
+//! Return the name of a subsystem for printing
+inline const char *get_name(const Subsystem subsystem) {
+  static const char *names[N_SUBSYSTEMS] = {"Photon banks", "Tallies", "MPI buffers", "Mesh"};
+  return names[subsystem];
+}
+
+//! Bytes currently allocated and the high-water mark of each subsystem and the total
+struct Counters {
+  std::array<std::atomic<int64_t>, N_SUBSYSTEMS> current;
+  std::array<std::atomic<int64_t>, N_SUBSYSTEMS> peak;
+  std::atomic<int64_t> total_current;
+  std::atomic<int64_t> total_peak;
+};
+
+//! Return the process-wide counters, zero until the first allocation
+inline Counters &get_counters() {
+  static Counters counters{};
+  return counters;
+}
+
+//! Raise a high-water mark to at least a value
+inline void raise_peak(std::atomic<int64_t> &peak, const int64_t value) {
+  int64_t old_peak = peak.load(std::memory_order_relaxed);
+  while (value > old_peak && !peak.compare_exchange_weak(old_peak, value, std::memory_order_relaxed)) {
+  }
+}
+
+//! Count an allocation
+inline void record_allocation(const Subsystem subsystem, const int64_t bytes) {
+  Counters &c = get_counters();
+  raise_peak(c.peak[subsystem], c.current[subsystem].fetch_add(bytes, std::memory_order_relaxed) + bytes);
+  raise_peak(c.total_peak, c.total_current.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+}
+
+//! Count a deallocation
+inline void record_deallocation(const Subsystem subsystem, const int64_t bytes) {
+  Counters &c = get_counters();
+  c.current[subsystem].fetch_sub(bytes, std::memory_order_relaxed);
+  c.total_current.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+//! Return bytes currently allocated by a subsystem
+inline int64_t get_current_bytes(const Subsystem subsystem) {
+  return get_counters().current[subsystem].load(std::memory_order_relaxed);
+}
+
+//! Return the most bytes a subsystem had allocated since the last reset_peaks
+inline int64_t get_peak_bytes(const Subsystem subsystem) {
+  return get_counters().peak[subsystem].load(std::memory_order_relaxed);
+}
+
+//! Return bytes currently allocated by all subsystems
+inline int64_t get_total_current_bytes() {
+  return get_counters().total_current.load(std::memory_order_relaxed);
+}
+
+//! Return the most bytes allocated by all subsystems at once since the last reset_peaks
+inline int64_t get_total_peak_bytes() {
+  return get_counters().total_peak.load(std::memory_order_relaxed);
+}
+
+//! Lower the high-water marks to the current allocations, so the next peaks are per step
+inline void reset_peaks() {
+  Counters &c = get_counters();
+  for (int s = 0; s < N_SUBSYSTEMS; ++s)
+    c.peak[s].store(c.current[s].load(std::memory_order_relaxed), std::memory_order_relaxed);
+  c.total_peak.store(c.total_current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+//! Resident set size and its high-water mark of this process in bytes
+struct Process_Memory {
+  int64_t rss; //!< Resident set size
+  int64_t hwm; //!< Peak resident set size
+};
+
+//! Read VmRSS and VmHWM from /proc/self/status, zero where it isn't available
+inline Process_Memory get_process_memory() {
+  Process_Memory memory = {0, 0};
+  std::ifstream status("/proc/self/status");
+  std::string key;
+  while (status >> key) {
+    if (key == "VmRSS:")
+      status >> memory.rss;
+    else if (key == "VmHWM:")
+      status >> memory.hwm;
+    status.ignore(256, '\n');
+  }
+  // reported in kB
+  memory.rss *= 1024;
+  memory.hwm *= 1024;
+  return memory;
+}
+
+} // namespace Memory
+
+//==============================================================================
+/*!
+ * \class Tracking_Allocator
+ * \brief Standard allocator that counts bytes against a subsystem
+ */
+//==============================================================================
+template <typename T, Memory::Subsystem S> class Tracking_Allocator {
+public:
+  typedef T value_type;
+
+  //! Same allocator for another type, needed by containers that allocate nodes
+  template <typename U> struct rebind { typedef Tracking_Allocator<U, S> other; };
+
+  Tracking_Allocator() noexcept {}
+
+  template <typename U> Tracking_Allocator(const Tracking_Allocator<U, S> &) noexcept {}
+
+  //! Allocate and count n objects
+  T *allocate(const std::size_t n) {
+    T *p = std::allocator<T>().allocate(n);
+    Memory::record_allocation(S, n * sizeof(T));
+    return p;
+  }
+
+  //! Free and uncount n objects
+  void deallocate(T *p, const std::size_t n) noexcept {
+    Memory::record_deallocation(S, n * sizeof(T));
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  template <typename U> bool operator==(const Tracking_Allocator<U, S> &) const noexcept {
+    return true;
+  }
+  template <typename U> bool operator!=(const Tracking_Allocator<U, S> &) const noexcept {
+    return false;
+  }
+};
+
+//! Vector whose storage is counted against a subsystem
+template <typename T, Memory::Subsystem S>
+using tracked_vector = std::vector<T, Tracking_Allocator<T, S>>;
+
+#endif // memory_tracker_h_
+//---------------------------------------------------------------------------//
+// end of memory_tracker.h
+//---------------------------------------------------------------------------//
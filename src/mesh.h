@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <memory>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -21,15 +22,22 @@
 #include <vector>
 #include <iostream>
 #include <iomanip>
+#include <limits>
+#include <cmath>
 
 #include "cell.h"
+#include "cell_tally.h"
 #include "constants.h"
+#include "ddmc.h"
 #include "decompose_mesh.h"
 #include "imc_parameters.h"
 #include "imc_state.h"
 #include "info.h"
 #include "input.h"
+#include "macro_mesh.h"
 #include "mpi_types.h"
+#include "opacity_rows.h"
+#include "opacity_table.h"
 #include "proto_cell.h"
 #include "proto_mesh.h"
 #include "timer.h"
@@ -57,10 +65,13 @@ public:
         ngz(input.get_global_n_z_cells()), n_global(ngz * ngy * ngx),
         rank(mpi_info.get_rank()), n_ranks(mpi_info.get_n_rank()),
         verbose_print(input.get_verbose_print_bool()), replicated(false),
+        use_tilt(imc_p.get_use_tilt_flag()), ddmc_threshold(imc_p.get_ddmc_threshold()),
+        use_macro_boxes(imc_p.get_use_macro_boxes_flag()),
+        opacity_cache_tolerance(input.get_opacity_cache_tolerance()),
         silo_x(input.get_silo_x_ptr()),
         silo_y(input.get_silo_y_ptr()), silo_z(input.get_silo_z_ptr()),
         total_photon_E(0.0), replicated_factor(1.0),
-        regions(input.get_regions()) {
+        regions(input.get_regions()), opacity_rows(input.get_opacity_bins_per_decade()) {
     using Constants::bc_type;
     using Constants::CUBE;
     using Constants::ELEMENT;
@@ -111,6 +122,8 @@ public:
     m_emission_E.resize(n_cell);
     m_source_E.resize(n_cell);
     T_r.resize(n_cell);
+    if (use_tilt)
+      m_emission_tilt.resize(n_cell);
 
     // for replicated mode, set the factor that reduces the emission energy and initial census
     // energy
@@ -124,6 +137,67 @@ public:
     // map region IDs to index in the region
     for (uint32_t i = 0; i < regions.size(); i++)
       region_ID_to_index[regions[i].get_ID()] = i;
+
+    // region data used in the per-cell physics loops, looked up by index instead of copying
+    // Region objects through the ID map for every cell
+    cell_region.resize(n_cell);
+    for (uint32_t i = 0; i < n_cell; ++i)
+      cell_region[i] = region_ID_to_index[cells[i].get_region_ID()];
+    for (auto const &region : regions) {
+      region_opac_A.push_back(region.get_opac_A());
+      region_opac_B.push_back(region.get_opac_B());
+      region_opac_C.push_back(region.get_opac_C());
+      region_opac_S.push_back(region.get_scattering_opacity());
+      region_cV.push_back(region.get_cV());
+      region_rho.push_back(region.get_rho());
+      // most opacity laws use small integer exponents, those avoid pow in the cell loop
+      const double C = region.get_opac_C();
+      const bool small_int = C == std::floor(C) && std::abs(C) <= max_int_exponent;
+      region_opac_C_int.push_back(small_int ? static_cast<int>(C) : not_int_exponent);
+    }
+
+    // load each opacity table file once, every rank takes part so node memory can be shared
+    const std::vector<std::string> &opacity_files = input.get_region_opacity_files();
+    std::unordered_map<std::string, int> file_to_table;
+    region_table.assign(regions.size(), no_table);
+    region_rho_point.resize(regions.size());
+    for (uint32_t r = 0; r < regions.size(); ++r) {
+      if (opacity_files[r].empty())
+        continue;
+      auto found = file_to_table.find(opacity_files[r]);
+      if (found == file_to_table.end()) {
+        opacity_tables.emplace_back(new Opacity_Table(opacity_files[r]));
+        const uint32_t table_groups = opacity_tables.back()->get_n_groups();
+        if (table_groups != 1 && table_groups != BRANSON_N_GROUPS) {
+          std::cout << "ERROR: opacity table " << opacity_files[r] << " has " << table_groups;
+          std::cout << " groups, it needs one or " << BRANSON_N_GROUPS << ". Exiting..."
+                    << std::endl;
+          exit(EXIT_FAILURE);
+        }
+        found = file_to_table.emplace(opacity_files[r], opacity_tables.size() - 1).first;
+      }
+      region_table[r] = found->second;
+      region_rho_point[r] = opacity_tables[found->second]->get_density_point(regions[r].get_rho());
+    }
+    if (!opacity_tables.empty() && BRANSON_N_GROUPS == 1) {
+      // negative temperatures force a lookup on the first step
+      table_T.assign(n_cell, -1.0);
+      table_op_a.assign(n_cell, 0.0);
+    }
+
+    // photons never cross a dimension with one cell and reflecting faces, z first then y
+    using Constants::REFLECT;
+    n_dim = 3;
+    if (ngz == 1 && input.get_bc(Z_NEG) == REFLECT && input.get_bc(Z_POS) == REFLECT) {
+      n_dim = 2;
+      if (ngy == 1 && input.get_bc(Y_NEG) == REFLECT && input.get_bc(Y_POS) == REFLECT)
+        n_dim = 1;
+    }
+
+    // discrete diffusion is used in flagged regions or in cells above the thickness threshold
+    use_ddmc = ddmc_threshold > 0.0;
+    for (auto const &region : regions)
+      use_ddmc = use_ddmc || region.get_ddmc();
   }
 
   // destructor
@@ -135,6 +209,12 @@ public:
   uint32_t get_n_local_cells(void) const { return n_cell; }
   uint32_t get_rank(void) const { return rank; }
   uint32_t get_offset(void) const { return on_rank_start; }
+
+  //! Return the number of dimensions photons move in (1, 2 or 3)
+  uint32_t get_n_dim(void) const { return n_dim; }
+
+  //! Return the macro boxes over identical cells, null if macro box tracking is off
+  const Macro_Mesh *get_macro_mesh(void) const { return use_macro_boxes ? &macro_mesh : nullptr; }
   uint32_t get_n_global_cells(void) const { return n_global; }
   std::unordered_map<uint32_t, uint32_t> get_proc_adjacency_list(void) const {
     return adjacent_procs;
@@ -209,7 +289,7 @@ public:
     return (index >= on_rank_start) && (index <= on_rank_end);
   }
 
-  const std::vector<Cell> &get_cells() const {
+  const Cell_Vector &get_cells() const {
     return cells;
   }
 
@@ -217,6 +297,11 @@ public:
   std::vector<double> get_emission_E(void) const { return m_emission_E; }
   std::vector<double> get_source_E(void) const { return m_source_E; }
 
+  //! Return the linear emission tilt in each dimension (empty when tilting is off)
+  const std::vector<std::array<double, 3>> &get_emission_tilt(void) const {
+    return m_emission_tilt;
+  }
+
   //! Get the radiation temperature in a cell (for plotting/diagnostics)
   double get_T_r(const uint32_t cell_index) const { return T_r[cell_index]; }
 
@@ -247,9 +332,33 @@ public:
     double tot_emission_E = 0.0;
     double tot_source_E = 0.0;
     double pre_mat_E = 0.0;
+    double total_E = 0.0;
 
-    uint32_t region_ID;
-    Region region;
+    // interpolate tabulated opacities for cells whose temperature moved past the tolerance
+    if (!opacity_tables.empty() && BRANSON_N_GROUPS == 1) {
+#ifdef USE_OPENMP
+#pragma omp parallel for simd schedule(static) private(T)
+#endif
+      for (uint32_t i = 0; i < n_cell; ++i) {
+        const uint32_t r = cell_region[i];
+        if (region_table[r] == no_table)
+          continue;
+        T = cells[i].get_T_e();
+        if (std::abs(T - table_T[i]) > opacity_cache_tolerance * table_T[i]) {
+          table_T[i] = T;
+          table_op_a[i] =
+              opacity_tables[region_table[r]]->get_absorption_opacity(T, region_rho_point[r]);
+        }
+      }
+    }
+
+    // with groups the Fleck factor and emission use the Planck mean of the row transport reads
+    update_opacity_rows();
+
+#ifdef USE_OPENMP
+#pragma omp parallel for simd schedule(static) private(op_a, op_s, f, cV, rho, vol, T, Tr, Ts) \
+    reduction(+ : tot_census_E, tot_emission_E, tot_source_E, pre_mat_E, total_E)
+#endif
     for (uint32_t i = 0; i < n_cell; ++i) {
       Cell &e = cells[i];
       vol = e.get_volume();
@@ -259,32 +368,49 @@ public:
       Ts = e.get_T_s();
       rho = e.get_rho();
 
-      region_ID = e.get_region_ID();
-      region = regions[region_ID_to_index[region_ID]];
-
-      op_a = region.get_absorption_opacity(T);
-      op_s = region.get_scattering_opacity();
-      f = 1.0 / (1.0 + dt * op_a * c * (4.0 * a * pow(T, 3) / (cV * rho)));
+      const uint32_t r = cell_region[i];
+      const int C_int = region_opac_C_int[r];
+      const double T_C = (C_int != not_int_exponent) ? integer_pow(T, C_int)
+                                                     : std::pow(T, region_opac_C[r]);
+      const double T3 = T * T * T;
+      if (BRANSON_N_GROUPS > 1)
+        op_a = cell_state[i]->planck_mean;
+      else
+        op_a = (region_table[r] == no_table) ? region_opac_A[r] + region_opac_B[r] * T_C
+                                             : table_op_a[i];
+      op_s = region_opac_S[r];
+      f = 1.0 / (1.0 + dt * op_a * c * (4.0 * a * T3 / (cV * rho)));
       e.set_op_a(op_a);
       e.set_op_s(op_s);
       e.set_f(f);
 
       m_emission_E[i] =
-           replicated_factor * dt * vol * f * op_a * a * c * pow(T, 4);
+           replicated_factor * dt * vol * f * op_a * a * c * T3 * T;
       if (step > 1)
         m_census_E[i] = 0.0;
       else
-        m_census_E[i] = replicated_factor * vol * a * pow(Tr, 4);
+        m_census_E[i] = replicated_factor * vol * a * (Tr * Tr) * (Tr * Tr);
 
       // source temperature will be zero
-      m_source_E[i] = replicated_factor * 0.25 * a * c *  e.get_source_area() * pow(Ts, 4) * dt;
+      m_source_E[i] = replicated_factor * 0.25 * a * c *  e.get_source_area() * (Ts * Ts) * (Ts * Ts) * dt;
 
       pre_mat_E += T * cV * vol * rho;
       tot_emission_E += m_emission_E[i];
       tot_census_E += m_census_E[i];
       tot_source_E += m_source_E[i];
-      total_photon_E += m_source_E[i] + m_census_E[i] + m_emission_E[i];
+      total_E += m_source_E[i] + m_census_E[i] + m_emission_E[i];
     }
+    total_photon_E = total_E;
+
+    if (use_tilt)
+      calculate_emission_tilt();
+
+    if (use_ddmc)
+      calculate_ddmc_leakage();
+
+    // properties changed, regroup identical cells
+    if (use_macro_boxes)
+      macro_mesh.build(cells, ngx, ngy, ngz);
 
     // adjust the census, emission and source energies for replicated mode to avoid having multiple
     // ranks make small energy photons, recaculculate total_photon_E on this rank
@@ -322,10 +448,71 @@ public:
       imc_state.set_pre_census_E(tot_census_E);
   }
 
+  //! Set the linear emission tilt in each cell from the emission density of its neighbors. The
+  // slope is a central difference of face values (one sided at boundaries and across ranks) and
+  // is limited so the emission density stays non-negative in the cell.
+  void calculate_emission_tilt() {
+    using Constants::ELEMENT;
+    std::vector<double> q(n_cell);
+    for (uint32_t i = 0; i < n_cell; ++i) {
+      const Cell &e = cells[i];
+      q[i] = e.get_f() * e.get_op_a() * pow(e.get_T_e(), 4);
+    }
+    for (uint32_t i = 0; i < n_cell; ++i) {
+      const Cell &e = cells[i];
+      for (uint32_t d = 0; d < 3; ++d) {
+        double q_face[2] = {q[i], q[i]};
+        for (uint32_t side = 0; side < 2; ++side) {
+          const uint32_t dir = 2 * d + side;
+          if (e.get_bc(dir) == ELEMENT && on_processor(e.get_next_cell(dir)))
+            q_face[side] = 0.5 * (q[i] + q[e.get_next_cell(dir) - on_rank_start]);
+        }
+        double b = (q[i] > 0.0) ? (q_face[1] - q_face[0]) / q[i] : 0.0;
+        m_emission_tilt[i][d] = std::max(-2.0, std::min(2.0, b));
+      }
+    }
+  }
+
+  //! Flag DDMC cells and set the leakage opacity through each of their faces. Leakage between
+  // DDMC cells comes from the diffusion current between cell averages, leakage to IMC cells and
+  // boundaries uses the Marshak condition with an extrapolation distance. Reflecting faces don't
+  // leak and DDMC neighbors across ranks are treated as IMC cells.
+  void calculate_ddmc_leakage() {
+    using Constants::ELEMENT;
+    using Constants::REFLECT;
+    for (auto &e : cells) {
+      // thickness for diffusion counts effective scattering, not absorption
+      const double sigma = (1.0 - e.get_f()) * e.get_op_a() + e.get_op_s();
+      const double min_dx = std::min(e.get_dx(0), std::min(e.get_dx(1), e.get_dx(2)));
+      const Region &region = regions[cell_region[&e - cells.data()]];
+      e.set_ddmc(region.get_ddmc() || (ddmc_threshold > 0.0 && sigma * min_dx >= ddmc_threshold));
+    }
+    for (auto &e : cells) {
+      std::array<double, 6> leakage_op{};
+      if (e.is_ddmc()) {
+        const double sigma = e.get_op_a() + e.get_op_s();
+        for (uint32_t face = 0; face < 6; ++face) {
+          const double dx = e.get_dx(face / 2);
+          const uint32_t next_cell = e.get_next_cell(face);
+          if (e.get_bc(face) == REFLECT)
+            leakage_op[face] = 0.0;
+          else if (e.get_bc(face) == ELEMENT && on_processor(next_cell) &&
+                   cells[next_cell - on_rank_start].is_ddmc()) {
+            const Cell &next = cells[next_cell - on_rank_start];
+            leakage_op[face] = get_ddmc_interior_leakage(dx, sigma, next.get_dx(face / 2),
+                                                         next.get_op_a() + next.get_op_s());
+          } else
+            leakage_op[face] = get_ddmc_interface_leakage(dx, sigma);
+        }
+      }
+      e.set_leakage_op(leakage_op);
+    }
+  }
+
   //! Use the absorbed energy and update the material temperature of each
   // cell on the mesh. Set diagnostic and conservation values.
-  void update_temperature(std::vector<double> &abs_E,
-                          std::vector<double> &track_E, IMC_State &imc_state) {
+  void update_temperature(Energy_Tally_Vector &abs_E,
+                          Energy_Tally_Vector &track_E, IMC_State &imc_state) {
     using Constants::a;
     using Constants::c;
     using std::setiosflags;
@@ -335,8 +522,7 @@ public:
     double total_abs_E = 0.0;
     double total_post_mat_E = 0.0;
     double vol, cV, rho, T, T_new;
-    uint32_t region_ID;
-    Region region;
+    const double dt = imc_state.get_dt();
 
     // in replicated mode reduce the emission energy as some ranks may have had their emission
     // energy zeroed out for some cells to try to keep photon counts close to n_user_photons
@@ -346,16 +532,19 @@ public:
 
 
     // calculate new temperatures, update global conservation quantities
+#ifdef USE_OPENMP
+#pragma omp parallel for simd schedule(static) private(vol, cV, rho, T, T_new) \
+    reduction(+ : total_abs_E, total_post_mat_E)
+#endif
     for (uint32_t i = 0; i < n_cell; ++i) {
-      region_ID = cells[i].get_region_ID();
-      region = regions[region_ID_to_index[region_ID]];
-      cV = region.get_cV();
-      rho = region.get_rho();
+      const uint32_t r = cell_region[i];
+      cV = region_cV[r];
+      rho = region_rho[r];
       Cell &e = cells[i];
       vol = e.get_volume();
       T = e.get_T_e();
       T_new = T + (abs_E[i] - m_emission_E[i]) / (cV * vol * rho);
-      T_r[i] = std::pow(track_E[i] / (vol * imc_state.get_dt() * a * c), 0.25);
+      T_r[i] = std::sqrt(std::sqrt(track_E[i] / (vol * dt * a * c)));
       e.set_T_e(T_new);
       total_abs_E += abs_E[i];
       total_post_mat_E += T_new * cV * vol * rho;
@@ -422,7 +611,8 @@ public:
     imc_state.set_post_mat_E(total_post_mat_E);
   }
 
-  //! Set the physical data for the cells on your rank
+  //! Set the physical data for the cells on your rank, initial temperatures come from the proto
+  // cells
   void initialize_physical_properties(const Input &input) {
     for (uint32_t i = 0; i < n_cell; ++i) {
       int region_ID = cells[i].get_region_ID();
@@ -430,15 +620,20 @@ public:
       Region region = input.get_region(region_ID);
       // set cell physical properties using region
       cells[i].set_cV(region.get_cV());
-      cells[i].set_T_e(region.get_T_e());
-      cells[i].set_T_r(region.get_T_r());
       cells[i].set_rho(region.get_rho());
+      cells[i].set_importance(region.get_importance());
       if (cells[i].get_source_face() != -1)
         cells[i].set_T_s(input.get_source_T());
     }
   }
 
 
+  //! Set the material and radiation temperature of a local cell (restart)
+  void set_temperatures(const uint32_t local_index, const double T_e, const double _T_r) {
+    cells[local_index].set_T_e(T_e);
+    T_r[local_index] = _T_r;
+  }
+
   std::array<int,3> get_xyz_index(int index) {
     int z = index/ngz;
     int y = (index - z*ngz)/ngy;
@@ -455,10 +650,23 @@ public:
   //! Get external source energy vector needed to source particles
   std::vector<double> &get_source_E_ref(void) { return m_source_E; }
 
-  std::vector<Cell>::iterator begin() {return cells.begin();}
-  std::vector<Cell>::iterator end() {return cells.end();}
-  std::vector<Cell>::const_iterator begin() const {return cells.cbegin();}
-  std::vector<Cell>::const_iterator end() const {return cells.cend();}
+  Cell_Vector::iterator begin() {return cells.begin();}
+  Cell_Vector::iterator end() {return cells.end();}
+  Cell_Vector::const_iterator begin() const {return cells.cbegin();}
+  Cell_Vector::const_iterator end() const {return cells.cend();}
+
+  //! Largest opacity exponent evaluated by repeated multiplication
+  static constexpr int max_int_exponent = 8;
+  //! Marks a region whose opacity exponent isn't a small integer
+  static constexpr int not_int_exponent = std::numeric_limits<int>::max();
+
+  //! Return x^n for |n| <= max_int_exponent by repeated multiplication
+  static inline double integer_pow(const double x, const int n) {
+    double result = 1.0;
+    for (int k = 0; k < std::abs(n); ++k)
+      result *= x;
+    return (n < 0) ? 1.0 / result : result;
+  }
 
   //--------------------------------------------------------------------------//
   // member variables
@@ -468,12 +676,18 @@ private:
   uint32_t ngy;      //!< Number of global y sizes
   uint32_t ngz;      //!< Number of global z sizes
   uint32_t n_global; //!< Nuber of global cells
+  uint32_t n_dim;    //!< Dimensions photons move in, collapsed ones have one reflecting cell
 
   int32_t rank;   //!< MPI rank of this mesh
   int32_t n_ranks; //!< Number of global ranks
 
   bool verbose_print;
   bool replicated; //!< Flag for replicated mode
+  bool use_tilt;   //!< Flag for linear tilted emission sampling
+  bool use_ddmc;   //!< Flag for discrete diffusion in thick cells or flagged regions
+  double ddmc_threshold; //!< Cells at least this many mean free paths thick use DDMC
+  bool use_macro_boxes;  //!< Flag for tracking through boxes of identical cells
+  double opacity_cache_tolerance; //!< Relative temperature change that recomputes table opacity
 
   float *silo_x; //!< Global array of x face locations for SILO
   float *silo_y; //!< Global array of y face locations for SILO
@@ -490,8 +704,9 @@ private:
   std::vector<double> m_emission_E; //!< Emission energy vector
   std::vector<double> m_source_E;   //!< Source energy vector
   std::vector<double> T_r;          //!< Diagnostic quantity
+  std::vector<std::array<double, 3>> m_emission_tilt; //!< Linear emission tilt in x, y, z
 
-  std::vector<Cell> cells; //!< Cell data allocated with MPI_Alloc
+  Cell_Vector cells; //!< Cell data allocated with MPI_Alloc
 
   std::vector<uint32_t> off_rank_bounds;    //!< Ending value of global ID for each rank
   uint32_t on_rank_start; //!< Start of global index on rank
@@ -500,9 +715,135 @@ private:
   std::unordered_map<uint32_t, uint32_t> adjacent_procs; //!< List of adjacent processors
   std::unordered_map<uint32_t, uint32_t> region_ID_to_index; //!< Maps region ID to index
 
+  //! Return the group opacities of a region at the center of a temperature bin
+  Opacity_Rows::Row make_opacity_row(const uint32_t r, const int32_t bin) const {
+    const double T = opacity_rows.get_bin_T(bin);
+    Opacity_Rows::Row row;
+    if (region_table[r] == no_table) {
+      // the analytic law is gray, every group has the same value
+      std::fill(row.begin(), row.begin() + BRANSON_N_GROUPS,
+                region_opac_A[r] + region_opac_B[r] * std::pow(T, region_opac_C[r]));
+    } else {
+      // a one group table is gray, otherwise each group has its own value
+      const Opacity_Table &table = *opacity_tables[region_table[r]];
+      const bool gray_table = table.get_n_groups() == 1;
+      for (uint32_t g = 0; g < BRANSON_N_GROUPS; ++g)
+        row[g] = table.get_absorption_opacity(T, region_rho_point[r], gray_table ? 0 : g);
+    }
+    std::fill(row.begin() + BRANSON_N_GROUPS, row.end(), region_opac_S[r]);
+    return row;
+  }
+
+  //! Point each cell at the shared state of its region and temperature bin. Only cells whose
+  // bin changed look up a state, rows are only made for states seen the first time, and states
+  // that lost all their cells are removed so their rows are reused.
+  void update_opacity_rows() {
+    // gray transport reads the cell's own opacities, rows only save memory with more groups
+    if (BRANSON_N_GROUPS == 1)
+      return;
+    if (cell_state.size() != n_cell)
+      cell_state.assign(n_cell, nullptr);
+
+    // stored states are found and their cell counts moved concurrently, cells in new states
+    // and states left empty are collected
+    std::vector<uint32_t> new_state_cells;
+    std::vector<uint64_t> emptied_keys;
+#ifdef USE_OPENMP
+#pragma omp parallel
+#endif
+    {
+      std::vector<uint32_t> thread_new_state_cells;
+      std::vector<uint64_t> thread_emptied_keys;
+#ifdef USE_OPENMP
+#pragma omp for schedule(static)
+#endif
+      for (uint32_t i = 0; i < n_cell; ++i) {
+        const uint64_t key =
+            Opacity_Rows::get_key(cell_region[i], opacity_rows.get_bin(cells[i].get_T_e()));
+        Opacity_Rows::State *old_state = cell_state[i];
+        if (old_state && old_state->key == key)
+          continue;
+        if (old_state) {
+          uint32_t n_left;
+#ifdef USE_OPENMP
+#pragma omp atomic capture
+#endif
+          n_left = --old_state->n_cells;
+          if (n_left == 0)
+            thread_emptied_keys.push_back(old_state->key);
+        }
+        Opacity_Rows::State *state = opacity_rows.find(key);
+        cell_state[i] = state;
+        if (state) {
+#ifdef USE_OPENMP
+#pragma omp atomic
+#endif
+          state->n_cells++;
+          cells[i].set_opacity_row(state->row);
+        } else {
+          cells[i].set_opacity_row(nullptr);
+          thread_new_state_cells.push_back(i);
+        }
+      }
+#ifdef USE_OPENMP
+#pragma omp critical
+#endif
+      {
+        new_state_cells.insert(new_state_cells.end(), thread_new_state_cells.begin(),
+                               thread_new_state_cells.end());
+        emptied_keys.insert(emptied_keys.end(), thread_emptied_keys.begin(),
+                            thread_emptied_keys.end());
+      }
+    }
+
+    for (auto i : new_state_cells) {
+      const int32_t bin = opacity_rows.get_bin(cells[i].get_T_e());
+      const uint64_t key = Opacity_Rows::get_key(cell_region[i], bin);
+      Opacity_Rows::State *state = opacity_rows.find(key);
+      if (!state)
+        state = opacity_rows.add(key, make_opacity_row(cell_region[i], bin));
+      state->n_cells++;
+      cell_state[i] = state;
+      cells[i].set_opacity_row(state->row);
+    }
+
+    // a state can empty and gain cells in the same pass, only drop it if it stayed empty
+    for (auto key : emptied_keys) {
+      const Opacity_Rows::State *state = opacity_rows.find(key);
+      if (state && state->n_cells == 0)
+        opacity_rows.remove(key);
+    }
+  }
+
+  std::vector<uint32_t> cell_region;    //!< Region index of each local cell
+  std::vector<double> region_opac_A;    //!< Opacity constant of each region
+  std::vector<double> region_opac_B;    //!< Opacity temperature coefficient of each region
+  std::vector<double> region_opac_C;    //!< Opacity temperature exponent of each region
+  std::vector<int> region_opac_C_int;   //!< Exponent as an integer, or not_int_exponent
+  std::vector<double> region_opac_S;    //!< Scattering opacity of each region
+  std::vector<double> region_cV;        //!< Heat capacity of each region
+  std::vector<double> region_rho;       //!< Density of each region
+
+  //! Table index of regions using the analytic opacity law
+  static constexpr int no_table = -1;
+
+  std::vector<std::unique_ptr<Opacity_Table>> opacity_tables; //!< Tables shared on each node
+  std::vector<int> region_table; //!< Opacity table of each region, or no_table
+  std::vector<Opacity_Table::Density_Point> region_rho_point; //!< Table density bin of each region
+  std::vector<double> table_T;    //!< Temperature of each cell's last table lookup
+  std::vector<double> table_op_a; //!< Tabulated absorption opacity of each cell at table_T
+
   Cell current_cell; //!< Off rank cell found in search
+
+  Macro_Mesh macro_mesh; //!< Boxes of identical cells for macro box tracking
+
+  Opacity_Rows opacity_rows;                     //!< Group opacities of each region and bin
+  std::vector<Opacity_Rows::State *> cell_state; //!< Opacity state of each cell
 };
 
+// out-of-class definition, the constructor passes no_table by reference (needed before C++17)
+constexpr int Mesh::no_table;
+
 #endif // mesh_h_
 //---------------------------------------------------------------------------//
 // end of mesh.h
@@ -0,0 +1,398 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   mpi_trace.h
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Traced wrappers for the MPI calls in mesh decomposition and particle passing
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#ifndef mpi_trace_h_
+#define mpi_trace_h_
+
+#include <mpi.h>
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//==============================================================================
+/*!
+ * \namespace MPI_Trace
+ * \brief Per-rank binary log of point-to-point and collective MPI calls
+ *
+ * The wrappers take the same arguments as the MPI calls they replace. While
+ * tracing is off they only check one flag. When on, each call appends a Record
+ * with its start and end time, peer rank and message size. Non-blocking sends
+ * and receives also get a completion record when a Test or Wait finds them
+ * done, it starts when the request was posted. Iterations of a polling loop
+ * that found no work are logged with idle and back-to-back idle iterations are
+ * merged. Window creation, locks and flushes aren't traced. Records are
+ * written to mpi_trace_<rank>.bin:
+ *
+ *   char[8]   magic "BRNTRCE"
+ *   uint32_t  version, rank, n_ranks, record size in bytes
+ *   Record    records[] until the end of the file
+ *
+ * scripts/summarize_mpi_trace.py reads the files of a run and prints the
+ * neighbor traffic matrix, message sizes, completion latency and where each
+ * rank's time went. Only the main thread may call the wrappers.
+ */
+//==============================================================================
+namespace MPI_Trace {
+
+//! Traced operations
+enum Op : uint32_t {
+  SEND,          //!< Blocking send
+  RECV,          //!< Blocking receive
+  ISEND,         //!< Send posted
+  IRECV,         //!< Receive posted
+  SEND_COMPLETE, //!< Posted send found complete, starts at the post
+  RECV_COMPLETE, //!< Posted receive found complete, starts at the post
+  WAIT,          //!< Blocking wait on one or more requests
+  BARRIER,       //!< Barrier
+  ALLREDUCE,     //!< Blocking allreduce
+  IALLREDUCE,    //!< Allreduce posted
+  IALLREDUCE_COMPLETE, //!< Posted allreduce found complete, starts at the post
+  RMA,           //!< One-sided put, get or accumulate
+  IDLE,          //!< Polling iterations that found no work
+  N_OPS
+};
+
+//! One traced call, times are nanoseconds since tracing was enabled
+struct Record {
+  uint64_t begin; //!< Start of the call (or post of the request)
+  uint64_t end;   //!< End of the call
+  uint64_t bytes; //!< Bytes sent or received (buffer size for posted receives)
+  uint32_t op;    //!< Op of the call
+  int32_t peer;   //!< Peer rank, -1 for collectives
+  uint32_t count; //!< Merged calls, only idle records are merged
+  uint32_t phase; //!< Time step, zero during setup
+};
+
+//! A posted request waiting for its completion record
+struct Pending {
+  uint64_t post;         //!< Post time
+  uint64_t bytes;        //!< Bytes posted
+  uint32_t op;           //!< Completion op
+  int32_t peer;          //!< Peer rank
+  MPI_Datatype datatype; //!< Type of a receive, to size the message received
+};
+
+//! Trace state of this rank
+struct State {
+  bool enabled;
+  int rank;
+  uint32_t phase;
+  std::chrono::steady_clock::time_point start;
+  std::vector<Record> records;
+  std::unordered_map<MPI_Request *, Pending> pending;
+  std::ofstream file;
+};
+
+constexpr uint32_t file_version = 1;                  //!< Current file format
+constexpr size_t flush_size = 1 << 16;                //!< Records buffered before a write
+
+//! Return the trace state, disabled until enable is called
+inline State &get_state() {
+  static State state{};
+  return state;
+}
+
+//! Return true if MPI calls are being traced
+inline bool is_enabled() { return get_state().enabled; }
+
+//! Return nanoseconds since tracing was enabled
+inline uint64_t now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                              get_state().start)
+      .count();
+}
+
+//! Open this rank's trace file and start tracing, collective so the ranks start together
+inline void enable() {
+  State &state = get_state();
+  int n_ranks;
+  MPI_Comm_rank(MPI_COMM_WORLD, &state.rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &n_ranks);
+  const std::string file_name = "mpi_trace_" + std::to_string(state.rank) + ".bin";
+  state.file.open(file_name, std::ios::binary);
+  if (!state.file) {
+    std::cout << "ERROR: could not open MPI trace file " << file_name << ", exiting..."
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  const uint32_t header[4] = {file_version, uint32_t(state.rank), uint32_t(n_ranks),
+                              uint32_t(sizeof(Record))};
+  state.file.write("BRNTRCE", 8);
+  state.file.write(reinterpret_cast<const char *>(header), sizeof(header));
+  state.records.reserve(flush_size);
+  MPI_Barrier(MPI_COMM_WORLD);
+  state.start = std::chrono::steady_clock::now();
+  state.phase = 0;
+  state.enabled = true;
+}
+
+//! Write the buffered records to the trace file
+inline void flush() {
+  State &state = get_state();
+  state.file.write(reinterpret_cast<const char *>(state.records.data()),
+                   state.records.size() * sizeof(Record));
+  state.records.clear();
+}
+
+//! Tag the following records with a time step
+inline void set_phase(const uint32_t phase) { get_state().phase = phase; }
+
+//! Append a record
+inline void add(const Op op, const uint64_t begin, const int peer, const uint64_t bytes) {
+  State &state = get_state();
+  state.records.push_back({begin, now(), bytes, op, peer, 1, state.phase});
+  if (state.records.size() >= flush_size)
+    flush();
+}
+
+//! Log a polling iteration that started at begin and found no work
+inline void idle(const uint64_t begin) {
+  if (!is_enabled())
+    return;
+  State &state = get_state();
+  if (!state.records.empty() && state.records.back().op == IDLE &&
+      state.records.back().phase == state.phase) {
+    state.records.back().end = now();
+    state.records.back().count++;
+  } else
+    add(IDLE, begin, -1, 0);
+}
+
+//! Return the bytes in count elements of a type
+inline uint64_t get_bytes(const int count, MPI_Datatype datatype) {
+  int type_size;
+  MPI_Type_size(datatype, &type_size);
+  return uint64_t(count) * type_size;
+}
+
+//! Log the completion of a request if it was posted while tracing
+inline void complete(MPI_Request *request, const MPI_Status *status, const uint64_t end) {
+  State &state = get_state();
+  auto it = state.pending.find(request);
+  if (it == state.pending.end())
+    return;
+  const Pending &p = it->second;
+  uint64_t bytes = p.bytes;
+  int32_t peer = p.peer;
+  // receives are sized by what arrived, wildcard receives learn their peer
+  if (p.op == RECV_COMPLETE && status) {
+    int count;
+    MPI_Get_count(status, p.datatype, &count);
+    bytes = get_bytes(count, p.datatype);
+    peer = status->MPI_SOURCE;
+  }
+  state.records.push_back({p.post, end, bytes, p.op, peer, 1, state.phase});
+  if (state.records.size() >= flush_size)
+    flush();
+  state.pending.erase(it);
+}
+
+//! Traced MPI_Send
+inline int Send(const void *buf, int count, MPI_Datatype datatype, int dest, int tag,
+                MPI_Comm comm) {
+  if (!is_enabled())
+    return MPI_Send(buf, count, datatype, dest, tag, comm);
+  const uint64_t begin = now();
+  const int err = MPI_Send(buf, count, datatype, dest, tag, comm);
+  add(SEND, begin, dest, get_bytes(count, datatype));
+  return err;
+}
+
+//! Traced MPI_Recv
+inline int Recv(void *buf, int count, MPI_Datatype datatype, int source, int tag, MPI_Comm comm,
+                MPI_Status *status) {
+  if (!is_enabled())
+    return MPI_Recv(buf, count, datatype, source, tag, comm, status);
+  const uint64_t begin = now();
+  MPI_Status local_status;
+  const int err = MPI_Recv(buf, count, datatype, source, tag, comm, &local_status);
+  int n_received;
+  MPI_Get_count(&local_status, datatype, &n_received);
+  add(RECV, begin, local_status.MPI_SOURCE, get_bytes(n_received, datatype));
+  if (status != MPI_STATUS_IGNORE)
+    *status = local_status;
+  return err;
+}
+
+//! Traced MPI_Isend
+inline int Isend(const void *buf, int count, MPI_Datatype datatype, int dest, int tag,
+                 MPI_Comm comm, MPI_Request *request) {
+  if (!is_enabled())
+    return MPI_Isend(buf, count, datatype, dest, tag, comm, request);
+  const uint64_t begin = now();
+  const int err = MPI_Isend(buf, count, datatype, dest, tag, comm, request);
+  const uint64_t bytes = get_bytes(count, datatype);
+  add(ISEND, begin, dest, bytes);
+  get_state().pending[request] = {begin, bytes, SEND_COMPLETE, dest, datatype};
+  return err;
+}
+
+//! Traced MPI_Irecv, the peer of a wildcard receive is unknown (-1)
+inline int Irecv(void *buf, int count, MPI_Datatype datatype, int source, int tag, MPI_Comm comm,
+                 MPI_Request *request) {
+  if (!is_enabled())
+    return MPI_Irecv(buf, count, datatype, source, tag, comm, request);
+  const uint64_t begin = now();
+  const int err = MPI_Irecv(buf, count, datatype, source, tag, comm, request);
+  const uint64_t bytes = get_bytes(count, datatype);
+  const int peer = (source == MPI_ANY_SOURCE) ? -1 : source;
+  add(IRECV, begin, peer, bytes);
+  get_state().pending[request] = {begin, bytes, RECV_COMPLETE, peer, datatype};
+  return err;
+}
+
+//! Traced MPI_Iallreduce
+inline int Iallreduce(const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype,
+                      MPI_Op op, MPI_Comm comm, MPI_Request *request) {
+  if (!is_enabled())
+    return MPI_Iallreduce(sendbuf, recvbuf, count, datatype, op, comm, request);
+  const uint64_t begin = now();
+  const int err = MPI_Iallreduce(sendbuf, recvbuf, count, datatype, op, comm, request);
+  const uint64_t bytes = get_bytes(count, datatype);
+  add(IALLREDUCE, begin, -1, bytes);
+  get_state().pending[request] = {begin, bytes, IALLREDUCE_COMPLETE, -1, datatype};
+  return err;
+}
+
+//! Traced MPI_Test, only a completed test is logged
+inline int Test(MPI_Request *request, int *flag, MPI_Status *status) {
+  if (!is_enabled())
+    return MPI_Test(request, flag, status);
+  MPI_Status local_status;
+  const int err = MPI_Test(request, flag, &local_status);
+  if (*flag)
+    complete(request, &local_status, now());
+  if (status != MPI_STATUS_IGNORE)
+    *status = local_status;
+  return err;
+}
+
+//! Traced MPI_Wait
+inline int Wait(MPI_Request *request, MPI_Status *status) {
+  if (!is_enabled())
+    return MPI_Wait(request, status);
+  const uint64_t begin = now();
+  MPI_Status local_status;
+  const int err = MPI_Wait(request, &local_status);
+  const uint64_t end = now();
+  add(WAIT, begin, -1, 0);
+  complete(request, &local_status, end);
+  if (status != MPI_STATUS_IGNORE)
+    *status = local_status;
+  return err;
+}
+
+//! Traced MPI_Waitall
+inline int Waitall(int count, MPI_Request requests[], MPI_Status statuses[]) {
+  if (!is_enabled())
+    return MPI_Waitall(count, requests, statuses);
+  const uint64_t begin = now();
+  std::vector<MPI_Status> local_statuses(count);
+  const int err = MPI_Waitall(count, requests, local_statuses.data());
+  const uint64_t end = now();
+  add(WAIT, begin, -1, 0);
+  for (int i = 0; i < count; ++i) {
+    complete(&requests[i], &local_statuses[i], end);
+    if (statuses != MPI_STATUSES_IGNORE)
+      statuses[i] = local_statuses[i];
+  }
+  return err;
+}
+
+//! Traced MPI_Barrier
+inline int Barrier(MPI_Comm comm) {
+  if (!is_enabled())
+    return MPI_Barrier(comm);
+  const uint64_t begin = now();
+  const int err = MPI_Barrier(comm);
+  add(BARRIER, begin, -1, 0);
+  return err;
+}
+
+//! Traced MPI_Allreduce
+inline int Allreduce(const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype,
+                     MPI_Op op, MPI_Comm comm) {
+  if (!is_enabled())
+    return MPI_Allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+  const uint64_t begin = now();
+  const int err = MPI_Allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+  add(ALLREDUCE, begin, -1, get_bytes(count, datatype));
+  return err;
+}
+
+//! Traced MPI_Put
+inline int Put(const void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+               int target_rank, MPI_Aint target_disp, int target_count,
+               MPI_Datatype target_datatype, MPI_Win win) {
+  if (!is_enabled())
+    return MPI_Put(origin_addr, origin_count, origin_datatype, target_rank, target_disp,
+                   target_count, target_datatype, win);
+  const uint64_t begin = now();
+  const int err = MPI_Put(origin_addr, origin_count, origin_datatype, target_rank, target_disp,
+                          target_count, target_datatype, win);
+  add(RMA, begin, target_rank, get_bytes(origin_count, origin_datatype));
+  return err;
+}
+
+//! Traced MPI_Raccumulate
+inline int Raccumulate(const void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+                       int target_rank, MPI_Aint target_disp, int target_count,
+                       MPI_Datatype target_datatype, MPI_Op op, MPI_Win win,
+                       MPI_Request *request) {
+  if (!is_enabled())
+    return MPI_Raccumulate(origin_addr, origin_count, origin_datatype, target_rank, target_disp,
+                           target_count, target_datatype, op, win, request);
+  const uint64_t begin = now();
+  const int err = MPI_Raccumulate(origin_addr, origin_count, origin_datatype, target_rank,
+                                  target_disp, target_count, target_datatype, op, win, request);
+  add(RMA, begin, target_rank, get_bytes(origin_count, origin_datatype));
+  return err;
+}
+
+//! Traced MPI_Rget
+inline int Rget(void *origin_addr, int origin_count, MPI_Datatype origin_datatype, int target_rank,
+                MPI_Aint target_disp, int target_count, MPI_Datatype target_datatype, MPI_Win win,
+                MPI_Request *request) {
+  if (!is_enabled())
+    return MPI_Rget(origin_addr, origin_count, origin_datatype, target_rank, target_disp,
+                    target_count, target_datatype, win, request);
+  const uint64_t begin = now();
+  const int err = MPI_Rget(origin_addr, origin_count, origin_datatype, target_rank, target_disp,
+                           target_count, target_datatype, win, request);
+  add(RMA, begin, target_rank, get_bytes(origin_count, origin_datatype));
+  return err;
+}
+
+//! Write the remaining records and close the trace file
+inline void finalize(void) {
+  State &state = get_state();
+  if (!state.enabled)
+    return;
+  state.enabled = false;
+  flush();
+  state.file.close();
+  state.pending.clear();
+  if (state.rank == 0)
+    std::cout << "MPI trace written to mpi_trace_<rank>.bin, summarize with "
+              << "scripts/summarize_mpi_trace.py" << std::endl;
+}
+
+} // namespace MPI_Trace
+
+#endif // mpi_trace_h_
+//---------------------------------------------------------------------------//
+// end of mpi_trace.h
+//---------------------------------------------------------------------------//
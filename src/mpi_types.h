@@ -37,8 +37,8 @@ public:
 
       // remake the MPI cell datatype from mesh
       const int cell_entry_count = 3;
-      // 16 uint32_t, 6 int, 6 doubles
-      int cell_array_of_block_length[3] = {10, 6, 6};
+      // 10 uint32_t, 6 int, 8 doubles
+      int cell_array_of_block_length[3] = {10, 6, 8};
       // Displacements of each type in the cell
       MPI_Aint cell_array_of_block_displace[3] = {
           0, 10 * sizeof(uint32_t), 10 * sizeof(uint32_t) + 6 * sizeof(int)};
@@ -64,8 +64,8 @@ public:
 
       const int particle_entry_count = 3;
 
-      // 2 uint32_t, 9 double
-      int particle_array_of_block_length[3] = {3, 4,  13};
+      // 3 uint32_t, 4 unsigned char, 9 double, token and RNG state (64-bit words)
+      int particle_array_of_block_length[3] = {3, 4,  14};
 
       // Displacements of each type in the cell
       MPI_Aint particle_array_of_block_displace[3] = {0, 3 * sizeof(uint32_t), 3*sizeof(uint32_t) + 4*sizeof(unsigned char)  };
@@ -145,8 +145,8 @@ public:
     {
       // make the Region
       const int region_entry_count = 2;
-      // 2 uint32_t, 9 doubles
-      int region_array_of_block_length[2] = {2, 9};
+      // 2 uint32_t, 10 doubles
+      int region_array_of_block_length[2] = {2, 10};
       // Displacements of each type in the cell
       MPI_Aint region_array_of_block_displace[2] = {0, 2 * sizeof(uint32_t)};
       //Type of each memory block
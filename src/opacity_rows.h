@@ -0,0 +1,140 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   opacity_rows.h
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Multigroup opacity rows shared by cells in the same region and temperature bin
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#ifndef opacity_rows_h_
+#define opacity_rows_h_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "config.h"
+
+//==============================================================================
+/*!
+ * \class Opacity_Rows
+ * \brief Storage for the group opacities of each material state on a rank
+ *
+ * A state is a region and a temperature bin, the bins are log-spaced with
+ * bins_per_decade bins in each factor of ten. A row is BRANSON_N_GROUPS
+ * absorption opacities followed by BRANSON_N_GROUPS scattering opacities,
+ * evaluated once at the log center of the bin, and every cell in that state
+ * points at it. The caller counts the cells in each state and removes states
+ * that lose all of them, their storage is reused, so memory scales with the
+ * number of states in use, not the number of cells or of states ever seen.
+ */
+//==============================================================================
+class Opacity_Rows {
+public:
+  //! Doubles in each row
+  static constexpr uint32_t row_size = 2 * BRANSON_N_GROUPS;
+
+  //! A row of absorption then scattering group opacities
+  typedef std::array<double, row_size> Row;
+
+  //! A stored state
+  struct State {
+    uint64_t key;       //!< Region and temperature bin
+    const double *row;  //!< Group opacities, valid until the state is removed
+    double planck_mean; //!< Gray absorption opacity for the Fleck factor and emission
+    uint32_t slot;      //!< Index of the row in storage
+    uint32_t n_cells;   //!< Cells in this state, kept by the caller
+  };
+
+  //! Constructor
+  explicit Opacity_Rows(const double _bins_per_decade = 100.0)
+      : bins_per_decade(_bins_per_decade) {}
+
+  //! Remove all states
+  void clear() {
+    rows.clear();
+    key_state.clear();
+    free_slots.clear();
+  }
+
+  //! Return the temperature bin of T, non-positive temperatures go in the lowest bin
+  int32_t get_bin(const double T) const {
+    const double log_T = std::log10(std::max(T, std::numeric_limits<double>::min()));
+    return static_cast<int32_t>(std::floor(log_T * bins_per_decade));
+  }
+
+  //! Return the temperature at the log center of a bin, where its row is evaluated
+  double get_bin_T(const int32_t bin) const {
+    return std::pow(10.0, (bin + 0.5) / bins_per_decade);
+  }
+
+  //! Return the key of a region and temperature bin
+  static uint64_t get_key(const uint32_t region, const int32_t bin) {
+    return (static_cast<uint64_t>(region) << 32) | static_cast<uint32_t>(bin);
+  }
+
+  //! Return the Planck mean of a row's absorption opacities. Groups are sampled uniformly so
+  // each carries the same share of the Planck spectrum and the mean is the group average.
+  static double get_planck_mean(const Row &row) {
+    double sum = 0.0;
+    for (uint32_t g = 0; g < BRANSON_N_GROUPS; ++g)
+      sum += row[g];
+    return sum / BRANSON_N_GROUPS;
+  }
+
+  //! Return a stored state, or null. Threads can search concurrently while no state is added
+  // or removed, states don't move when others are added.
+  State *find(const uint64_t key) {
+    auto found = key_state.find(key);
+    return (found == key_state.end()) ? nullptr : &found->second;
+  }
+
+  //! Store a new state with no cells and return it
+  State *add(const uint64_t key, const Row &row) {
+    uint32_t slot;
+    if (free_slots.empty()) {
+      slot = static_cast<uint32_t>(rows.size());
+      rows.push_back(row);
+    } else {
+      slot = free_slots.back();
+      free_slots.pop_back();
+      rows[slot] = row;
+    }
+    State state = {key, rows[slot].data(), get_planck_mean(row), slot, 0};
+    return &key_state.emplace(key, state).first->second;
+  }
+
+  //! Remove a state, the next new state reuses its row
+  void remove(const uint64_t key) {
+    auto found = key_state.find(key);
+    if (found == key_state.end())
+      return;
+    free_slots.push_back(found->second.slot);
+    key_state.erase(found);
+  }
+
+  //! Return the number of stored states
+  uint32_t get_n_rows() const { return static_cast<uint32_t>(key_state.size()); }
+
+  //! Return the number of rows allocated, stored states plus free rows
+  uint32_t get_n_slots() const { return static_cast<uint32_t>(rows.size()); }
+
+private:
+  double bins_per_decade;                        //!< Temperature bins per factor of ten
+  std::deque<Row> rows;                          //!< Rows, a deque so they never move
+  std::unordered_map<uint64_t, State> key_state; //!< Each stored state
+  std::vector<uint32_t> free_slots;              //!< Rows of removed states
+};
+
+#endif // opacity_rows_h_
+//---------------------------------------------------------------------------//
+// end of opacity_rows.h
+//---------------------------------------------------------------------------//
@@ -0,0 +1,210 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   opacity_table.h
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Tabulated absorption opacities on log-spaced temperature and density grids
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#ifndef opacity_table_h_
+#define opacity_table_h_
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//==============================================================================
+/*!
+ * \class Opacity_Table
+ * \brief Absorption opacity by temperature, density and group read from a binary file
+ *
+ * The binary format is a header followed by the opacities (1/cm), group fastest, then
+ * temperature, then density:
+ *
+ *   char[8]   magic "BRNOPAC"
+ *   uint32_t  version, n_T, n_rho, n_groups
+ *   double    T_min, T_max, rho_min, rho_max
+ *   double    opacity[n_rho][n_T][n_groups]
+ *
+ * Grid points are log-spaced between the minimum and maximum so the bin of a value is
+ * found in O(1) from its logarithm. Opacities are interpolated linearly in log-log space
+ * and values outside the grid are clamped to the edge. A mesh uses a one group table in
+ * every group, otherwise n_groups must match the build's group count. One rank on each node
+ * reads the file into an MPI shared memory window that the other ranks on that node map, so
+ * a table is stored once per node. Construction is collective over comm.
+ */
+//==============================================================================
+class Opacity_Table {
+public:
+  //! Bin and weight of a density, constant for a region so found once
+  struct Density_Point {
+    uint32_t index; //!< Lower density grid point
+    double weight;  //!< Weight of the upper density grid point
+  };
+
+  //! Read a table file with one reader per node
+  Opacity_Table(const std::string &file_name, MPI_Comm comm = MPI_COMM_WORLD)
+      : node_comm(MPI_COMM_NULL), window(MPI_WIN_NULL), log_opacity(nullptr) {
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm);
+    int node_rank;
+    MPI_Comm_rank(node_comm, &node_rank);
+
+    // the node reader checks the header and shares it
+    std::ifstream in;
+    std::vector<uint32_t> dims(3, 0);
+    std::vector<double> bounds(4, 0.0);
+    int ok = 1;
+    if (node_rank == 0) {
+      in.open(file_name, std::ios::binary);
+      char magic[8];
+      uint32_t version = 0;
+      in.read(magic, 8);
+      in.read(reinterpret_cast<char *>(&version), sizeof(uint32_t));
+      in.read(reinterpret_cast<char *>(dims.data()), 3 * sizeof(uint32_t));
+      in.read(reinterpret_cast<char *>(bounds.data()), 4 * sizeof(double));
+      ok = in && std::strncmp(magic, file_magic(), 8) == 0 && version == file_version &&
+           dims[0] > 1 && dims[1] > 0 && dims[2] > 0 && bounds[0] > 0.0 &&
+           bounds[1] > bounds[0] && bounds[2] > 0.0 && (dims[1] == 1 || bounds[3] > bounds[2]);
+    }
+    MPI_Bcast(&ok, 1, MPI_INT, 0, node_comm);
+    if (!ok) {
+      std::cout << "ERROR: could not read opacity table " << file_name << ", exiting..."
+                << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    MPI_Bcast(dims.data(), 3, MPI_UNSIGNED, 0, node_comm);
+    MPI_Bcast(bounds.data(), 4, MPI_DOUBLE, 0, node_comm);
+    n_T = dims[0];
+    n_rho = dims[1];
+    n_groups = dims[2];
+    log_T_min = std::log(bounds[0]);
+    inv_dlog_T = (n_T - 1) / (std::log(bounds[1]) - log_T_min);
+    log_rho_min = std::log(bounds[2]);
+    inv_dlog_rho = (n_rho > 1) ? (n_rho - 1) / (std::log(bounds[3]) - log_rho_min) : 0.0;
+
+    // only the node reader allocates, the others map its memory
+    const uint64_t n_values = uint64_t(n_rho) * n_T * n_groups;
+    const MPI_Aint local_size = (node_rank == 0) ? n_values * sizeof(double) : 0;
+    double *base;
+    MPI_Win_allocate_shared(local_size, sizeof(double), MPI_INFO_NULL, node_comm, &base,
+                            &window);
+    if (node_rank == 0) {
+      in.read(reinterpret_cast<char *>(base), n_values * sizeof(double));
+      ok = static_cast<bool>(in);
+      // opacities are stored as logarithms so lookups only need one exp
+      for (uint64_t i = 0; i < n_values; ++i) {
+        ok = ok && base[i] > 0.0;
+        base[i] = std::log(base[i]);
+      }
+    }
+    MPI_Bcast(&ok, 1, MPI_INT, 0, node_comm);
+    if (!ok) {
+      std::cout << "ERROR: opacity table " << file_name
+                << " is truncated or has non-positive values, exiting..." << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    MPI_Aint size;
+    int disp_unit;
+    MPI_Win_shared_query(window, 0, &size, &disp_unit, &log_opacity);
+  }
+
+  //! Release the shared window
+  ~Opacity_Table() {
+    if (window != MPI_WIN_NULL)
+      MPI_Win_free(&window);
+    if (node_comm != MPI_COMM_NULL)
+      MPI_Comm_free(&node_comm);
+  }
+
+  Opacity_Table(const Opacity_Table &) = delete;
+  Opacity_Table &operator=(const Opacity_Table &) = delete;
+
+  //! Return the number of groups in the table
+  uint32_t get_n_groups() const { return n_groups; }
+
+  //! Return the bin and weight of a density
+  Density_Point get_density_point(const double rho) const {
+    Density_Point point = {0, 0.0};
+    if (n_rho > 1)
+      get_bin(std::log(rho), log_rho_min, inv_dlog_rho, n_rho, point.index, point.weight);
+    return point;
+  }
+
+  //! Return the absorption opacity (1/cm) at a temperature (keV) and density point
+  inline double get_absorption_opacity(const double T, const Density_Point &rho_point,
+                                       const uint32_t group = 0) const {
+    uint32_t i_T;
+    double w_T;
+    get_bin(std::log(T), log_T_min, inv_dlog_T, n_T, i_T, w_T);
+    const double *low = log_opacity + (uint64_t(rho_point.index) * n_T + i_T) * n_groups + group;
+    double log_op = (1.0 - w_T) * low[0] + w_T * low[n_groups];
+    if (rho_point.weight > 0.0) {
+      const double *high = low + uint64_t(n_T) * n_groups;
+      log_op = (1.0 - rho_point.weight) * log_op +
+               rho_point.weight * ((1.0 - w_T) * high[0] + w_T * high[n_groups]);
+    }
+    return std::exp(log_op);
+  }
+
+  //! Write a table file, opacity holds n_rho * n_T * n_groups values group fastest
+  static void write(const std::string &file_name, const uint32_t n_T, const double T_min,
+                    const double T_max, const uint32_t n_rho, const double rho_min,
+                    const double rho_max, const uint32_t n_groups,
+                    const std::vector<double> &opacity) {
+    std::ofstream out(file_name, std::ios::binary);
+    const uint32_t header[4] = {file_version, n_T, n_rho, n_groups};
+    const double bounds[4] = {T_min, T_max, rho_min, rho_max};
+    out.write(file_magic(), 8);
+    out.write(reinterpret_cast<const char *>(header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(bounds), sizeof(bounds));
+    out.write(reinterpret_cast<const char *>(opacity.data()), opacity.size() * sizeof(double));
+  }
+
+  //! Return the i-th point of a log-spaced grid
+  static double get_grid_point(const uint32_t i, const uint32_t n, const double min,
+                               const double max) {
+    if (n < 2)
+      return min;
+    return min * std::pow(max / min, double(i) / (n - 1));
+  }
+
+private:
+  //! Lower grid index and upper weight of a log value, clamped to the grid
+  static inline void get_bin(const double log_x, const double log_min, const double inv_dlog,
+                             const uint32_t n, uint32_t &index, double &weight) {
+    const double s = std::min(std::max((log_x - log_min) * inv_dlog, 0.0), double(n - 1));
+    index = std::min(static_cast<uint32_t>(s), n - 2);
+    weight = s - index;
+  }
+
+  //! Tag at the start of every table file
+  static const char *file_magic() { return "BRNOPAC"; }
+  static constexpr uint32_t file_version = 1; //!< Current table format
+
+  MPI_Comm node_comm; //!< Ranks sharing memory with this one
+  MPI_Win window;     //!< Shared window holding the table
+  double *log_opacity; //!< Log opacities in the shared window
+
+  uint32_t n_T;        //!< Temperature grid points
+  uint32_t n_rho;      //!< Density grid points
+  uint32_t n_groups;   //!< Groups at each grid point
+  double log_T_min;    //!< Log of the first temperature
+  double inv_dlog_T;   //!< Inverse log temperature spacing
+  double log_rho_min;  //!< Log of the first density
+  double inv_dlog_rho; //!< Inverse log density spacing, zero for one density
+};
+
+#endif // opacity_table_h_
+//---------------------------------------------------------------------------//
+// end of opacity_table.h
+//---------------------------------------------------------------------------//
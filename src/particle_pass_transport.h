@@ -24,18 +24,23 @@
 #include "transport_photon.h"
 #include "gpu_setup.h"
 #include "buffer.h"
+#include "census_store.h"
 #include "constants.h"
+#include "event_counters.h"
 #include "info.h"
 #include "mesh.h"
 #include "message_counter.h"
+#include "mpi_trace.h"
 #include "mpi_types.h"
 #include "photon.h"
+#include "perf_counters.h"
+#include "profiler.h"
 #include "sampling_functions.h"
 
 
-std::vector<Photon> particle_pass_transport(
+Photon_Vector particle_pass_transport(
     const Mesh &mesh, const GPU_Setup &gpu_setup, const IMC_Parameters &imc_parameters, const Info &mpi_info, const MPI_Types &mpi_types,
-    IMC_State &imc_state, Message_Counter &mctr, std::vector<double> &rank_abs_E, std::vector<double> &rank_track_E, std::vector<Photon> &all_photons, const int n_omp_threads) {
+    IMC_State &imc_state, Message_Counter &mctr, Energy_Tally_Vector &rank_abs_E, Energy_Tally_Vector &rank_track_E, Photon_Vector &all_photons, Photon_Vector &census_photons, Census_Store &census_store, Event_Counters *event_counters, const int n_omp_threads) {
   using std::cout;
   using std::endl;
   using std::stack;
@@ -62,6 +67,8 @@ std::vector<Photon> particle_pass_transport(
   double next_dt = imc_state.get_next_dt(); //! Set for census photons
 
   // timing
+  Profiler::Scope transport_scope(Profiler::TRANSPORT);
+  Perf_Counters::Scope transport_counters(Perf_Counters::TRANSPORT);
   Timer t_transport;
   t_transport.start_timer("timestep_transport");
 
@@ -72,17 +79,26 @@ std::vector<Photon> particle_pass_transport(
   const uint32_t max_buffer_size = imc_parameters.get_particle_message_size();
   MPI_Datatype MPI_Particle = mpi_types.get_particle_type();
 
-  // get global photon count
-  uint64_t n_local = all_photons.size();
+  // get global photon count, including census photons still in the spill file
+  uint64_t n_local = all_photons.size() + census_photons.size() + census_store.get_n_spilled();
   uint64_t n_global;
   uint64_t last_global_complete_count = 0;
 
-  MPI_Allreduce(&n_local, &n_global, 1, MPI_UNSIGNED_LONG, MPI_SUM,
-                MPI_COMM_WORLD);
+  MPI_Trace::Allreduce(&n_local, &n_global, 1, MPI_UNSIGNED_LONG, MPI_SUM,
+                       MPI_COMM_WORLD);
+
+  // completion is counted in history tokens so photons split in transport don't add histories,
+  // every photon starts the step as one history
+  for (auto &phtn : all_photons)
+    phtn.set_token(Constants::history_token);
+  for (auto &phtn : census_photons)
+    phtn.set_token(Constants::history_token);
+  const uint64_t n_global_tokens = n_global * Constants::history_token;
+  const Population_Control pop_ctrl = imc_parameters.get_population_control();
 
   // This flag indicates that send processing is needed for target rank
-  vector<vector<Photon>> send_list;
-  vector<Cell_Tally> cell_tallies(mesh.get_n_local_cells());
+  vector<Photon_Vector> send_list;
+  Cell_Tally_Vector cell_tallies(mesh.get_n_local_cells());
 
   // Completion count request made flag
   bool req_made = false;
@@ -108,13 +124,13 @@ std::vector<Photon> particle_pass_transport(
       adj_rank = it.first;
       i_b = it.second;
       // push back send and receive lists
-      vector<Photon> empty_phtn_vec;
+      Photon_Vector empty_phtn_vec;
       send_list.push_back(empty_phtn_vec);
       // make receive buffer the appropriate size
       phtn_recv_buffer[i_b].resize(max_buffer_size);
-      MPI_Irecv(phtn_recv_buffer[i_b].get_buffer(), max_buffer_size,
-                MPI_Particle, adj_rank, Constants::photon_tag, MPI_COMM_WORLD,
-                &phtn_recv_request[i_b]);
+      MPI_Trace::Irecv(phtn_recv_buffer[i_b].get_buffer(), max_buffer_size,
+                       MPI_Particle, adj_rank, Constants::photon_tag, MPI_COMM_WORLD,
+                       &phtn_recv_request[i_b]);
       mctr.n_receives_posted++;
       phtn_recv_buffer[i_b].set_awaiting();
     } // end loop over adjacent processors
@@ -124,11 +140,11 @@ std::vector<Photon> particle_pass_transport(
   // main transport loop
   //------------------------------------------------------------------------//
 
-  vector<Photon> census_list;    //!< End of timestep census list
-  vector<Photon> phtn_recv_list; //!< Photons from received messages
+  Photon_Vector census_list;    //!< End of timestep census list
+  Photon_Vector phtn_recv_list; //!< Photons from received messages
 
   int send_rank;
-  uint64_t n_complete = 0; //!< Completed histories, regardless of origin
+  uint64_t n_complete = 0; //!< Completed history tokens, regardless of origin
   //! Send and receive buffers for complete count
   uint64_t s_global_complete, r_global_complete;
   const uint32_t rank_cell_offset{mesh.get_rank_cell_offset(rank)};
@@ -136,45 +152,77 @@ std::vector<Photon> particle_pass_transport(
   //------------------------------------------------------------------------//
   // first transport all photons from source (best for GPU)
   //------------------------------------------------------------------------//
-  if(gpu_setup.use_gpu_transporter() && gpu_available) {
-    gpu_transport_photons(rank_cell_offset, all_photons, gpu_setup.get_device_cells_ptr(), cell_tallies);
-  }
-  else
-    cpu_transport_photons(rank_cell_offset, all_photons, mesh.get_cells(), cell_tallies, n_omp_threads);
-
-  for (auto &phtn : all_photons) {
-    switch (phtn.get_descriptor()) {
-    // this case should never be reached
-    case Constants::KILLED:
-      n_complete++;
-      break;
-    case Constants::EXIT:
-      n_complete++;
-      exit_E+=phtn.get_E();
-      break;
-    case Constants::CENSUS:
-      phtn.set_distance_to_census(Constants::c*next_dt);
-      census_list.push_back(phtn);
-      census_E+=phtn.get_E();
-      n_complete++;
-      break;
-    case Constants::PASS:
-      send_rank = mesh.get_rank(phtn.get_cell());
-      int i_b = adjacent_procs[send_rank];
-      send_list[i_b].push_back(phtn);
+  auto transport_source_photons = [&](Photon_Vector &source_photons) {
+    if(gpu_setup.use_gpu_transporter() && gpu_available) {
+      gpu_transport_photons(rank_cell_offset, source_photons, gpu_setup.get_device_cells_ptr(), cell_tallies, pop_ctrl,
+                            mesh.get_n_dim());
     }
+    else
+      cpu_transport_photons(rank_cell_offset, source_photons, mesh.get_cells(), cell_tallies, n_omp_threads, pop_ctrl,
+                            imc_parameters.get_random_walk(), mesh.get_macro_mesh(), mesh.get_n_dim(),
+                            event_counters);
+
+    for (auto &phtn : source_photons) {
+      switch (phtn.get_descriptor()) {
+      // lost to roulette
+      case Constants::KILLED:
+        n_complete += phtn.get_token();
+        break;
+      case Constants::EXIT:
+        n_complete += phtn.get_token();
+        exit_E+=phtn.get_E();
+        break;
+      case Constants::CENSUS:
+        phtn.set_distance_to_census(Constants::c*next_dt);
+        census_list.push_back(phtn);
+        census_E+=phtn.get_E();
+        n_complete += phtn.get_token();
+        census_store.flush(census_list);
+        break;
+      case Constants::SPLIT:
+        // transport finishes split photons with their copies before returning
+        Insist(false, "photon still marked SPLIT after transport");
+        break;
+      case Constants::PASS:
+        send_rank = mesh.get_rank(phtn.get_cell());
+        int i_b = adjacent_procs[send_rank];
+        send_list[i_b].push_back(phtn);
+      }
+    }
+  };
+  // the last step's in-memory census is transported in place, not copied into all_photons, and
+  // both are released before the new census grows
+  transport_source_photons(all_photons);
+  Photon_Vector().swap(all_photons);
+  transport_source_photons(census_photons);
+  Photon_Vector().swap(census_photons);
+
+  // census photons spilled at the end of the last step are streamed back in chunks, each starts
+  // as one history
+  Photon_Vector spilled_photons;
+  while (census_store.read_chunk(spilled_photons)) {
+    for (auto &phtn : spilled_photons)
+      phtn.set_token(Constants::history_token);
+    transport_source_photons(spilled_photons);
   }
 
   //------------------------------------------------------------------------//
   // process photon send and receives
   //------------------------------------------------------------------------//
-  while (last_global_complete_count != n_global) {
+  // counters are read once around the polling loop, not every iteration, received photons are
+  // charged to transport by the kernel's nested scope
+  Perf_Counters::Scope progress_counters(Perf_Counters::COMMUNICATION);
+  while (last_global_complete_count != n_global_tokens) {
     int recv_req_flag;
     int recv_count; // recieve count is 32 bit
 
     MPI_Status recv_status;
     uint32_t i_b; // buffer index
     int adj_rank; // adjacent rank
+    // iterations that complete or post nothing are traced as idle
+    const uint64_t iteration_start = MPI_Trace::is_enabled() ? MPI_Trace::now() : 0;
+    bool found_work = false;
+    Profiler::Scope progress_scope(Profiler::MPI_PROGRESS);
     for (auto const &it : adjacent_procs) {
       adj_rank = it.first;
       i_b = it.second;
@@ -182,10 +230,11 @@ std::vector<Photon> particle_pass_transport(
       // test completion of send buffer
       if (phtn_send_buffer[i_b].sent()) {
         int send_req_flag;
-        MPI_Test(&phtn_send_request[i_b], &send_req_flag, MPI_STATUS_IGNORE);
+        MPI_Trace::Test(&phtn_send_request[i_b], &send_req_flag, MPI_STATUS_IGNORE);
         if (send_req_flag) {
           phtn_send_buffer[i_b].reset();
           mctr.n_sends_completed++;
+          found_work = true;
         }
       }
 
@@ -193,25 +242,26 @@ std::vector<Photon> particle_pass_transport(
       if (phtn_send_buffer[i_b].empty() && !send_list[i_b].empty()) {
         const uint32_t n_photons_to_send = (send_list[i_b].size() < max_buffer_size) ?
             send_list[i_b].size() : max_buffer_size;
-        vector<Photon>::iterator copy_start = send_list[i_b].begin();
-        vector<Photon>::iterator copy_end = send_list[i_b].begin() + n_photons_to_send;
-        vector<Photon> send_now_list(copy_start, copy_end);
+        Photon_Vector::iterator copy_start = send_list[i_b].begin();
+        Photon_Vector::iterator copy_end = send_list[i_b].begin() + n_photons_to_send;
+        Photon_Vector send_now_list(copy_start, copy_end);
         send_list[i_b].erase(copy_start, copy_end);
         phtn_send_buffer[i_b].fill(send_now_list);
-        MPI_Isend(phtn_send_buffer[i_b].get_buffer(), n_photons_to_send, MPI_Particle, adj_rank,
-          Constants::photon_tag, MPI_COMM_WORLD, &phtn_send_request[i_b]);
+        MPI_Trace::Isend(phtn_send_buffer[i_b].get_buffer(), n_photons_to_send, MPI_Particle, adj_rank,
+                 Constants::photon_tag, MPI_COMM_WORLD, &phtn_send_request[i_b]);
         phtn_send_buffer[i_b].set_sent();
         // update counters
          mctr.n_particles_sent += n_photons_to_send;
          mctr.n_sends_posted++;
          mctr.n_particle_messages++;
+         found_work = true;
       }
 
       // process receive buffer
       if (phtn_recv_buffer[i_b].awaiting()) {
-        MPI_Test(&phtn_recv_request[i_b], &recv_req_flag, &recv_status);
+        MPI_Trace::Test(&phtn_recv_request[i_b], &recv_req_flag, &recv_status);
         if (recv_req_flag) {
-          const vector<Photon> &receive_list =
+          const Buffer<Photon>::Vector &receive_list =
               phtn_recv_buffer[i_b].get_object();
           // only push the number of received photons onto the recv_list
           MPI_Get_count(&recv_status, MPI_Particle, &recv_count);
@@ -219,38 +269,48 @@ std::vector<Photon> particle_pass_transport(
             phtn_recv_list.push_back(receive_list[i]);
           phtn_recv_buffer[i_b].reset();
           // post receive again, don't resize--it's already set to maximum
-          MPI_Irecv(phtn_recv_buffer[i_b].get_buffer(), max_buffer_size,
-                    MPI_Particle, adj_rank, Constants::photon_tag, MPI_COMM_WORLD,
-                    &phtn_recv_request[i_b]);
+          MPI_Trace::Irecv(phtn_recv_buffer[i_b].get_buffer(), max_buffer_size,
+                           MPI_Particle, adj_rank, Constants::photon_tag, MPI_COMM_WORLD,
+                           &phtn_recv_request[i_b]);
           phtn_recv_buffer[i_b].set_awaiting();
           mctr.n_receives_completed++;
           mctr.n_receives_posted++;
+          found_work = true;
         }
       }
     } // end loop over adjacent processors
+    progress_scope.stop();
 
     if(!phtn_recv_list.empty()) {
       if(gpu_setup.use_gpu_transporter() && gpu_available)
-        gpu_transport_photons(rank_cell_offset, phtn_recv_list, gpu_setup.get_device_cells_ptr(), cell_tallies);
+        gpu_transport_photons(rank_cell_offset, phtn_recv_list, gpu_setup.get_device_cells_ptr(), cell_tallies, pop_ctrl,
+                          mesh.get_n_dim());
       else {
-        cpu_transport_photons(rank_cell_offset, phtn_recv_list, mesh.get_cells(), cell_tallies, n_omp_threads);
+        cpu_transport_photons(rank_cell_offset, phtn_recv_list, mesh.get_cells(), cell_tallies, n_omp_threads, pop_ctrl,
+                          imc_parameters.get_random_walk(), mesh.get_macro_mesh(), mesh.get_n_dim(),
+                          event_counters);
       }
 
       for (auto &phtn : phtn_recv_list) {
         switch (phtn.get_descriptor()) {
-        // this case should never be reached
+        // lost to roulette
         case Constants::KILLED:
-          n_complete++;
+          n_complete += phtn.get_token();
           break;
         case Constants::EXIT:
-          n_complete++;
+          n_complete += phtn.get_token();
           exit_E+=phtn.get_E();
           break;
         case Constants::CENSUS:
           phtn.set_distance_to_census(Constants::c*next_dt);
           census_list.push_back(phtn);
           census_E+=phtn.get_E();
-          n_complete++;
+          n_complete += phtn.get_token();
+          census_store.flush(census_list);
+          break;
+        case Constants::SPLIT:
+          // transport finishes split photons with their copies before returning
+          Insist(false, "photon still marked SPLIT after transport");
           break;
         case Constants::PASS:
           send_rank = mesh.get_rank(phtn.get_cell());
@@ -262,26 +322,30 @@ std::vector<Photon> particle_pass_transport(
 
     phtn_recv_list.clear();
 
+    Profiler::Scope completion_scope(Profiler::MPI_PROGRESS);
     if (!req_made) {
       s_global_complete = n_complete;
-      MPI_Iallreduce(&s_global_complete, &r_global_complete, 1,
-                     MPI_UNSIGNED_LONG, MPI_SUM, MPI_COMM_WORLD,
-                     &completion_request);
+      MPI_Trace::Iallreduce(&s_global_complete, &r_global_complete, 1,
+                            MPI_UNSIGNED_LONG, MPI_SUM, MPI_COMM_WORLD,
+                            &completion_request);
       req_made = true;
     } else {
-      MPI_Test(&completion_request, &recv_allreduce_flag, MPI_STATUS_IGNORE);
+      MPI_Trace::Test(&completion_request, &recv_allreduce_flag, MPI_STATUS_IGNORE);
       if (recv_allreduce_flag) {
         last_global_complete_count = r_global_complete;
         s_global_complete = n_complete;
-        if (last_global_complete_count != n_global) {
-          MPI_Iallreduce(&s_global_complete, &r_global_complete, 1,
-                         MPI_UNSIGNED_LONG, MPI_SUM, MPI_COMM_WORLD,
-                         &completion_request);
+        if (last_global_complete_count != n_global_tokens) {
+          MPI_Trace::Iallreduce(&s_global_complete, &r_global_complete, 1,
+                                MPI_UNSIGNED_LONG, MPI_SUM, MPI_COMM_WORLD,
+                                &completion_request);
         }
       }
     }
 
+    if (!found_work)
+      MPI_Trace::idle(iteration_start);
   } // end while
+  progress_counters.stop();
 
   // record time of transport work for this rank
   t_transport.stop_timer("timestep_transport");
@@ -290,17 +354,19 @@ std::vector<Photon> particle_pass_transport(
   // wait for all ranks to finish then send empty photon messages, do this because it's possible
   // for a rank to receive the empty message while it's still in the transport loop. In that case, it will post a
   // receive again, which will never have a matching send
-  MPI_Barrier(MPI_COMM_WORLD);
+  Profiler::Scope wait_scope(Profiler::WAIT);
+  Perf_Counters::Scope wait_counters(Perf_Counters::COMMUNICATION);
+  MPI_Trace::Barrier(MPI_COMM_WORLD);
 
   // finish off posted photon receives
   {
-    vector<Photon> one_photon(1);
+    Photon_Vector one_photon(1);
     int adj_rank; // adjacent rank
     for (auto const &it : adjacent_procs) {
       adj_rank = it.first;
       // send one photon vector to finish off receives, these photons will not be processed by the
       // receiving ranks (all ranks are out of transport)
-      MPI_Send(one_photon.data(), 1, MPI_Particle, adj_rank, Constants::photon_tag, MPI_COMM_WORLD);
+      MPI_Trace::Send(one_photon.data(), 1, MPI_Particle, adj_rank, Constants::photon_tag, MPI_COMM_WORLD);
       mctr.n_sends_posted++;
       mctr.n_sends_completed++;
     } // end loop over adjacent processors
@@ -308,11 +374,12 @@ std::vector<Photon> particle_pass_transport(
 
   // wait for receive requests
   for (uint32_t i_b = 0; i_b < n_adjacent; ++i_b) {
-    MPI_Wait(&phtn_recv_request[i_b], MPI_STATUS_IGNORE);
+    MPI_Trace::Wait(&phtn_recv_request[i_b], MPI_STATUS_IGNORE);
     mctr.n_receives_completed++;
   }
 
-  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Trace::Barrier(MPI_COMM_WORLD);
+  wait_scope.stop();
 
   std::sort(census_list.begin(), census_list.end());
 
@@ -321,15 +388,18 @@ std::vector<Photon> particle_pass_transport(
   delete[] phtn_send_request;
 
   // copy cell tallies back out to rank_abs_E and rank_track_E
+  double pop_ctrl_E = 0.0;
   for (size_t i = 0; i<cell_tallies.size();++i) {
+    pop_ctrl_E += cell_tallies[i].get_pop_ctrl_E();
     rank_abs_E[i] = cell_tallies[i].get_abs_E();
     rank_track_E[i] = cell_tallies[i].get_track_E();
   }
 
   // set diagnostic quantities
   imc_state.set_exit_E(exit_E);
+  imc_state.set_pop_ctrl_E(pop_ctrl_E);
   imc_state.set_post_census_E(census_E);
-  imc_state.set_census_size(census_list.size());
+  imc_state.set_census_size(census_list.size() + census_store.get_n_flushed());
   imc_state.set_network_message_counts(mctr);
   imc_state.set_rank_transport_runtime(t_transport.get_time("timestep_transport"));
 
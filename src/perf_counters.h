@@ -0,0 +1,429 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   perf_counters.h
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Hardware performance counters per thread in the major phases
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#ifndef perf_counters_h_
+#define perf_counters_h_
+
+#include <mpi.h>
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+//==============================================================================
+/*!
+ * \namespace Perf_Counters
+ * \brief Linux perf_event_open counter groups read at phase boundaries
+ *
+ * Each thread opens its own group (cycles, instructions, last level cache
+ * misses, branch misses and, if a raw event code is given, floating point
+ * operations) counting only that thread in user space. A Scope reads the group
+ * when it starts and stops and charges the counts in between to the innermost
+ * open phase on the thread, so nested phases are exclusive: communication inside
+ * transport isn't counted as transport. Events the machine doesn't have are left
+ * out of the group and reported as n/a. If the group can't be opened on some
+ * rank (no hardware counters in a virtual machine, or perf_event_paranoid too
+ * high) counting is off everywhere and a Scope only checks one flag. Each step
+ * the per-thread counts are summed on the rank, written to
+ * perf_counters_<rank>.csv with the per-thread counts and reduced without
+ * blocking for a min/mean/max over ranks table, like the event counters.
+ */
+//==============================================================================
+namespace Perf_Counters {
+
+//! Counted phases
+enum Phase { SOURCE, TRANSPORT, TALLY_REDUCTION, COMMUNICATION, MATERIAL_UPDATE, N_PHASES };
+
+//! Counted events
+enum Event { CYCLES, INSTRUCTIONS, LLC_MISSES, BRANCH_MISSES, FP_OPS, N_EVENTS };
+
+//! Return the name of a phase for printing
+inline const char *get_name(const Phase phase) {
+  static const char *names[N_PHASES] = {"Sourcing", "Transport", "Tally reduction",
+                                        "Communication", "Material update"};
+  return names[phase];
+}
+
+//! Return the name of an event for printing
+inline const char *get_name(const Event event) {
+  static const char *names[N_EVENTS] = {"cycles", "instructions", "llc_misses",
+                                        "branch_misses", "fp_ops"};
+  return names[event];
+}
+
+//! One group reading, times in nanoseconds for scaling multiplexed counts
+struct Reading {
+  uint64_t time_enabled;
+  uint64_t time_running;
+  std::array<uint64_t, N_EVENTS> values;
+};
+
+//! Counts charged to one phase
+struct Phase_Counts {
+  uint64_t time_enabled;
+  uint64_t time_running;
+  std::array<uint64_t, N_EVENTS> values;
+
+  //! Add the counts between two readings
+  void add(const Reading &begin, const Reading &end) {
+    time_enabled += end.time_enabled - begin.time_enabled;
+    time_running += end.time_running - begin.time_running;
+    for (int e = 0; e < N_EVENTS; ++e)
+      values[e] += end.values[e] - begin.values[e];
+  }
+
+  //! Return an event count scaled up for the time the group wasn't on the hardware
+  double get_scaled(const Event e) const {
+    if (!time_running)
+      return 0.0;
+    return values[e] * (double(time_enabled) / double(time_running));
+  }
+};
+
+//! Counter group and counts of one thread, only that thread writes to it while counting
+struct Thread_Counters {
+  int leader_fd;                             //!< Group leader, -1 if the group didn't open
+  int open_errno;                            //!< Error opening the leader
+  std::array<int, N_EVENTS> fds;             //!< Event descriptors, -1 if not available
+  std::array<int, N_EVENTS> slots;           //!< Position of each event in a group read
+  uint32_t n_open;                           //!< Events in the group
+  uint32_t thread_id;                        //!< Order the thread first counted
+  std::vector<Phase> open_phases;            //!< Phases open on this thread, innermost last
+  Reading last;                              //!< Reading at the last phase boundary
+  std::array<Phase_Counts, N_PHASES> counts; //!< Counts of this step
+};
+
+//! Process-wide counter state
+struct State {
+  std::atomic<bool> enabled;
+  std::mutex mutex; //!< Guards threads
+  std::vector<std::unique_ptr<Thread_Counters>> threads;
+  uint64_t fp_event;                   //!< Raw event code of floating point ops, zero for none
+  std::array<int, N_EVENTS> available; //!< Events opened on the main thread of every rank
+  uint32_t step;                       //!< Step of the counts being reduced
+  std::ofstream csv;                   //!< Per-thread counts of each step
+  std::vector<double> rank_values, min_values, max_values, sum_values;
+  std::array<MPI_Request, 3> reqs;
+  bool pending;
+};
+
+//! Return the counter state, disabled until enable succeeds
+inline State &get_state() {
+  static State state{};
+  return state;
+}
+
+//! Return true if scopes are reading counters
+inline bool is_enabled() { return get_state().enabled.load(std::memory_order_relaxed); }
+
+#ifdef __linux__
+//! Open one counter of the calling thread in user space, -1 if it isn't available
+inline int open_event(const uint32_t type, const uint64_t config, const int group_fd) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = (group_fd == -1);
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format =
+      PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+#endif
+
+//! Open the counter group of the calling thread, leader_fd is -1 if it can't be opened
+inline void open_group(Thread_Counters &t, const uint64_t fp_event) {
+  t.leader_fd = -1;
+  t.open_errno = ENOSYS;
+  t.fds.fill(-1);
+  t.slots.fill(-1);
+  t.n_open = 0;
+#ifdef __linux__
+  const std::array<uint32_t, N_EVENTS> types = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                                                PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                                                PERF_TYPE_RAW};
+  const std::array<uint64_t, N_EVENTS> configs = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+      PERF_COUNT_HW_BRANCH_MISSES, fp_event};
+  for (int e = 0; e < N_EVENTS; ++e) {
+    if (e == FP_OPS && !fp_event)
+      continue;
+    t.fds[e] = open_event(types[e], configs[e], t.leader_fd);
+    if (t.fds[e] == -1) {
+      // without cycles there is no group
+      if (e == CYCLES) {
+        t.open_errno = errno;
+        return;
+      }
+      continue;
+    }
+    if (e == CYCLES)
+      t.leader_fd = t.fds[e];
+    t.slots[e] = t.n_open++;
+  }
+  ioctl(t.leader_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(t.leader_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+//! Close the counter group of a thread
+inline void close_group(Thread_Counters &t) {
+#ifdef __linux__
+  for (auto &fd : t.fds) {
+    if (fd != -1)
+      close(fd);
+    fd = -1;
+  }
+#endif
+  t.leader_fd = -1;
+}
+
+//! Read the group of a thread
+inline Reading read_group(const Thread_Counters &t) {
+  Reading reading{};
+#ifdef __linux__
+  // number of events, time enabled, time running, then one value per event
+  std::array<uint64_t, 3 + N_EVENTS> buffer{};
+  if (read(t.leader_fd, buffer.data(), (3 + t.n_open) * sizeof(uint64_t)) > 0) {
+    reading.time_enabled = buffer[1];
+    reading.time_running = buffer[2];
+    for (int e = 0; e < N_EVENTS; ++e)
+      reading.values[e] = (t.slots[e] == -1) ? 0 : buffer[3 + t.slots[e]];
+  }
+#endif
+  return reading;
+}
+
+//! Return this thread's counters, opening its group on first use
+inline Thread_Counters &get_thread_counters() {
+  thread_local Thread_Counters *counters = nullptr;
+  if (!counters) {
+    State &state = get_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.threads.emplace_back(new Thread_Counters{});
+    counters = state.threads.back().get();
+    counters->thread_id = state.threads.size() - 1;
+    open_group(*counters, state.fp_event);
+  }
+  return *counters;
+}
+
+//==============================================================================
+/*!
+ * \class Scope
+ * \brief Charges the calling thread's counters to a phase for its lifetime,
+ * scopes on a thread must nest
+ */
+//==============================================================================
+class Scope {
+public:
+  //! Start charging to phase if counting is enabled
+  explicit Scope(const Phase phase) : counters(nullptr) {
+    if (is_enabled()) {
+      Thread_Counters &t = get_thread_counters();
+      if (t.leader_fd == -1)
+        return;
+      counters = &t;
+      const Reading now = read_group(t);
+      if (!t.open_phases.empty())
+        t.counts[t.open_phases.back()].add(t.last, now);
+      t.open_phases.push_back(phase);
+      t.last = now;
+    }
+  }
+
+  //! Stop charging if stop wasn't called
+  ~Scope() { stop(); }
+
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+
+  //! Stop charging before the end of the enclosing block
+  void stop() {
+    if (!counters)
+      return;
+    const Reading now = read_group(*counters);
+    counters->counts[counters->open_phases.back()].add(counters->last, now);
+    counters->open_phases.pop_back();
+    counters->last = now;
+    counters = nullptr;
+  }
+
+private:
+  Thread_Counters *counters; //!< Counters of this thread, null when not counting
+};
+
+//! Try to open counters on every rank, counting is enabled only if every rank can. Collective,
+// call from the main thread before any other thread counts.
+inline bool enable(const int rank, const uint64_t fp_event) {
+  State &state = get_state();
+  state.fp_event = fp_event;
+  Thread_Counters &main_thread = get_thread_counters();
+  int opened = (main_thread.leader_fd != -1);
+  MPI_Allreduce(MPI_IN_PLACE, &opened, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+  for (int e = 0; e < N_EVENTS; ++e)
+    state.available[e] = (main_thread.fds[e] != -1);
+  MPI_Allreduce(MPI_IN_PLACE, state.available.data(), N_EVENTS, MPI_INT, MPI_MIN,
+                MPI_COMM_WORLD);
+  if (!opened) {
+    if (rank == 0) {
+      std::cout << "WARNING: hardware counters not available";
+      if (main_thread.leader_fd == -1)
+        std::cout << " (perf_event_open: " << std::strerror(main_thread.open_errno) << ")";
+      std::cout << ", check /proc/sys/kernel/perf_event_paranoid, continuing without them"
+                << std::endl;
+    }
+    close_group(main_thread);
+    return false;
+  }
+  state.csv.open("perf_counters_" + std::to_string(rank) + ".csv");
+  state.csv << "step,phase,thread";
+  for (int e = 0; e < N_EVENTS; ++e)
+    state.csv << "," << get_name(Event(e));
+  state.csv << std::endl;
+  state.enabled.store(true, std::memory_order_relaxed);
+  return true;
+}
+
+//! Write this step's per-thread counts, zero them and post the reduction of the rank sums.
+// Collective, call outside parallel regions.
+inline void start_reduction(const uint32_t step) {
+  if (!is_enabled())
+    return;
+  State &state = get_state();
+  state.step = step;
+  // rank sums of each phase and event
+  std::vector<double> &rank_values = state.rank_values;
+  rank_values.assign(N_PHASES * N_EVENTS, 0.0);
+  {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    for (auto &t : state.threads) {
+      for (int p = 0; p < N_PHASES; ++p) {
+        Phase_Counts &c = t->counts[p];
+        if (!c.time_enabled)
+          continue;
+        state.csv << step << "," << get_name(Phase(p)) << "," << t->thread_id;
+        for (int e = 0; e < N_EVENTS; ++e) {
+          state.csv << ",";
+          if (state.available[e])
+            state.csv << uint64_t(c.get_scaled(Event(e)));
+          rank_values[p * N_EVENTS + e] += c.get_scaled(Event(e));
+        }
+        state.csv << "\n";
+        c = Phase_Counts{};
+      }
+    }
+  }
+  const int n = rank_values.size();
+  state.min_values.resize(n);
+  state.max_values.resize(n);
+  state.sum_values.resize(n);
+  MPI_Ireduce(rank_values.data(), state.min_values.data(), n, MPI_DOUBLE, MPI_MIN, 0,
+              MPI_COMM_WORLD, &state.reqs[0]);
+  MPI_Ireduce(rank_values.data(), state.max_values.data(), n, MPI_DOUBLE, MPI_MAX, 0,
+              MPI_COMM_WORLD, &state.reqs[1]);
+  MPI_Ireduce(rank_values.data(), state.sum_values.data(), n, MPI_DOUBLE, MPI_SUM, 0,
+              MPI_COMM_WORLD, &state.reqs[2]);
+  state.pending = true;
+}
+
+//! Complete the reduction started by start_reduction and print the table on rank zero, does
+// nothing if no reduction is pending
+inline void finish_reduction(const int rank) {
+  State &state = get_state();
+  if (!state.pending)
+    return;
+  MPI_Waitall(3, state.reqs.data(), MPI_STATUSES_IGNORE);
+  state.pending = false;
+  if (rank != 0)
+    return;
+
+  using std::setw;
+  int n_rank;
+  MPI_Comm_size(MPI_COMM_WORLD, &n_rank);
+  auto mean = [&](const int p, const Event e) {
+    return state.sum_values[p * N_EVENTS + e] / n_rank;
+  };
+  auto per_kilo_instruction = [&](const int p, const Event e) {
+    const double instructions = mean(p, INSTRUCTIONS);
+    return instructions > 0.0 ? 1000.0 * mean(p, e) / instructions : 0.0;
+  };
+  std::cout << "Hardware counters, step " << state.step
+            << " (summed over threads, cycles min/mean/max over ranks)" << std::endl;
+  std::cout << std::left << setw(17) << "Phase" << std::right << setw(12) << "Cycles min"
+            << setw(12) << "mean" << setw(12) << "max" << setw(8) << "IPC" << setw(12)
+            << "LLC MPKI" << setw(12) << "Br MPKI" << setw(12) << "FP ops" << std::endl;
+  std::cout << std::setprecision(4);
+  for (int p = 0; p < N_PHASES; ++p) {
+    if (state.max_values[p * N_EVENTS + CYCLES] == 0.0)
+      continue;
+    std::cout << std::left << setw(17) << get_name(Phase(p)) << std::right << std::scientific
+              << setw(12) << state.min_values[p * N_EVENTS + CYCLES] << setw(12)
+              << mean(p, CYCLES) << setw(12) << state.max_values[p * N_EVENTS + CYCLES]
+              << std::fixed << std::setprecision(3) << setw(8);
+    if (state.available[INSTRUCTIONS])
+      std::cout << mean(p, INSTRUCTIONS) / mean(p, CYCLES);
+    else
+      std::cout << "n/a";
+    for (auto e : {LLC_MISSES, BRANCH_MISSES}) {
+      std::cout << setw(12);
+      if (state.available[e] && state.available[INSTRUCTIONS])
+        std::cout << per_kilo_instruction(p, e);
+      else
+        std::cout << "n/a";
+    }
+    std::cout << setw(12);
+    if (state.available[FP_OPS])
+      std::cout << std::scientific << std::setprecision(4) << mean(p, FP_OPS);
+    else
+      std::cout << "n/a";
+    std::cout << std::defaultfloat << std::setprecision(4) << std::endl;
+  }
+  std::cout << std::setprecision(6);
+}
+
+//! Finish any pending reduction, close the counters and the CSV file, collective
+inline void finalize(const int rank) {
+  if (!is_enabled())
+    return;
+  finish_reduction(rank);
+  State &state = get_state();
+  state.enabled.store(false, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(state.mutex);
+  for (auto &t : state.threads)
+    close_group(*t);
+  state.csv.close();
+}
+
+} // namespace Perf_Counters
+
+#endif // perf_counters_h_
+//---------------------------------------------------------------------------//
+// end of perf_counters.h
+//---------------------------------------------------------------------------//
@@ -19,6 +19,7 @@
 
 #include "constants.h"
 #include "config.h"
+#include "memory_tracker.h"
 #include "RNG.h"
 
 //==============================================================================
@@ -79,6 +80,18 @@ public:
   GPU_HOST_DEVICE
   inline double get_distance_remaining(void) const { return m_life_dx; }
 
+  //! Get the share of the history's completion token carried by this photon
+  GPU_HOST_DEVICE
+  inline uint64_t get_token(void) const { return m_token; }
+
+  //! Get the number of photons to split into (valid when the descriptor is SPLIT)
+  GPU_HOST_DEVICE
+  inline uint32_t get_n_split(void) const { return descriptors[1]; }
+
+  //! Return true if this photon is taking discrete diffusion steps
+  GPU_HOST_DEVICE
+  inline bool is_ddmc(void) const { return descriptors[2]; }
+
   //! Print particle information
   void print_info(const uint32_t &rank) const {
     using std::cout;
@@ -104,12 +117,12 @@ public:
   // non-const functions                                                      //
   //--------------------------------------------------------------------------//
 
-  //! Update particle position by moving it a distance
+  //! Update particle position by moving it a distance, coordinates past n_dim don't change
+  template <uint32_t n_dim = 3>
   GPU_HOST_DEVICE
   inline void move(const double distance) {
-    m_pos[0] += m_angle[0] * distance;
-    m_pos[1] += m_angle[1] * distance;
-    m_pos[2] += m_angle[2] * distance;
+    for (uint32_t i = 0; i < n_dim; ++i)
+      m_pos[i] += m_angle[i] * distance;
     m_life_dx -= distance;
   }
 
@@ -138,6 +151,20 @@ public:
   GPU_HOST_DEVICE
   inline void set_distance_to_census(const double dist_remain) { m_life_dx = dist_remain; }
 
+  //! Set the share of the history's completion token
+  GPU_HOST_DEVICE
+  inline void set_token(const uint64_t token) { m_token = token; }
+
+  //! Set the discrete diffusion flag
+  GPU_HOST_DEVICE
+  inline void set_ddmc(const bool ddmc) { descriptors[2] = static_cast<unsigned char>(ddmc); }
+
+  //! Set the number of photons to split into (at most 255)
+  GPU_HOST_DEVICE
+  inline void set_n_split(const uint32_t n_split) {
+    descriptors[1] = static_cast<unsigned char>(n_split);
+  }
+
   //! Set the angle of the photon
   GPU_HOST_DEVICE
   inline void set_angle(const std::array<double,3> &new_angle) { m_angle = new_angle;}
@@ -160,6 +187,8 @@ public:
   GPU_HOST_DEVICE
   RNG &get_rng() {return m_rng;}
 
+  const RNG &get_rng() const {return m_rng;}
+
   void set_rng(const RNG &rng) { m_rng = rng;}
 
   //--------------------------------------------------------------------------//
@@ -169,14 +198,18 @@ private:
   uint32_t m_cell_ID; //!< Cell ID
   uint32_t group;     //!< Group of photon
   uint32_t source_type; //!< CENSUS, EMISSION, or SOURCE
-  std::array<unsigned char, 4> descriptors; //!< Only using one, but it fills out the padding
+  std::array<unsigned char, 4> descriptors{}; //!< Event, split count and DDMC flag (padding)
   std::array<double,3> m_pos;    //!< photon position
   std::array<double,3> m_angle;  //!< photon angle array
   double m_E;         //!< current photon energy
   double m_E0;        //!< photon energy at creation
   double m_life_dx;   //!< Distance remaining this time step
+  uint64_t m_token{Constants::history_token}; //!< Completion token share (split photons)
   RNG m_rng;          //!< Member RNG
 
 };
 
+//! Photon bank, counted as photon memory
+typedef tracked_vector<Photon, Memory::PHOTONS> Photon_Vector;
+
 #endif // photon_h_
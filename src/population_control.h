@@ -0,0 +1,103 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   population_control.h
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Russian roulette and weight window splitting for transport
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#ifndef population_control_h_
+#define population_control_h_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "cell_tally.h"
+#include "config.h"
+#include "constants.h"
+#include "photon.h"
+
+//==============================================================================
+/*!
+ * \struct Population_Control
+ * \brief Weight window settings used by the transport kernels
+ *
+ * Photon weight is the fraction of its birth energy it still carries. In a
+ * cell with importance I the window center is 1/I: photons below
+ * roulette_fraction/I play roulette and survive with survival_fraction/I, and
+ * with weight windows on, photons entering a cell above twice the center are
+ * split into copies at or below the center.
+ */
+//==============================================================================
+struct Population_Control {
+  double roulette_fraction; //!< Roulette below this weight (scaled by 1/importance)
+  double survival_fraction; //!< Weight given to roulette survivors (scaled by 1/importance)
+  bool use_weight_windows;  //!< Split photons above the window on entering a cell
+};
+
+//! Most photons a single split can make (stored in one photon descriptor byte)
+constexpr uint32_t max_n_split = 32;
+
+//----------------------------------------------------------------------------//
+//! Play roulette with a photon below the window, return false if it was killed
+//
+// Survivors are raised to survival_fraction of their birth energy with probability
+// fraction / survival_fraction, so the expected energy is unchanged. Energy made or lost is
+// tallied in the cell so conservation can be checked.
+GPU_HOST_DEVICE
+inline bool play_roulette(Photon &phtn, const double survival_fraction, Cell_Tally &cell_tally) {
+  const double E = phtn.get_E();
+  if (phtn.get_rng().generate_random_number() * survival_fraction < phtn.get_fraction()) {
+    phtn.set_E(survival_fraction * phtn.get_E0());
+    cell_tally.accumulate_pop_ctrl_E(phtn.get_E() - E);
+    return true;
+  }
+  cell_tally.accumulate_pop_ctrl_E(-E);
+  phtn.set_E(0.0);
+  return false;
+}
+
+//----------------------------------------------------------------------------//
+//! Return the number of photons this one should split into in a cell (one means no split)
+GPU_HOST_DEVICE
+inline uint32_t get_n_split(const Photon &phtn, const Population_Control &pop_ctrl,
+                            const double importance) {
+  if (!pop_ctrl.use_weight_windows)
+    return 1;
+  const double window_ratio = phtn.get_fraction() * importance;
+  if (window_ratio <= 2.0)
+    return 1;
+  // every copy needs a non-zero share of the completion token
+  const uint64_t n_split =
+      std::min(static_cast<uint64_t>(std::ceil(window_ratio)), static_cast<uint64_t>(max_n_split));
+  return static_cast<uint32_t>(std::min(n_split, phtn.get_token()));
+}
+
+//----------------------------------------------------------------------------//
+//! Split a photon marked SPLIT into equal copies, appending the new copies to split_list
+//
+// The parent keeps its place and random number stream, copies get spawned streams. Energy is
+// divided exactly and the completion token is divided with the remainder left on the parent.
+inline void split_photon(Photon &parent, Photon_Vector &split_list) {
+  const uint32_t n_split = parent.get_n_split();
+  const uint64_t token = parent.get_token() / n_split;
+  parent.set_E(parent.get_E() / n_split);
+  parent.set_token(parent.get_token() - token * (n_split - 1));
+  parent.set_n_split(1);
+  parent.set_descriptor(Constants::BOUND);
+  for (uint32_t i = 1; i < n_split; ++i) {
+    Photon copy = parent;
+    copy.set_token(token);
+    copy.set_rng(parent.get_rng().spawn());
+    split_list.push_back(copy);
+  }
+}
+
+#endif // population_control_h_
+//---------------------------------------------------------------------------//
+// end of population_control.h
+//---------------------------------------------------------------------------//
@@ -0,0 +1,289 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   profiler.h
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Nested region timers with per-thread buffers and Chrome trace output
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#ifndef profiler_h_
+#define profiler_h_
+
+#include <mpi.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+//==============================================================================
+/*!
+ * \namespace Profiler
+ * \brief Low overhead timing of nested code regions
+ *
+ * A Scope times a region from construction to destruction (or stop). Regions
+ * are an enum so nothing is looked up by name while timing. Each thread appends
+ * finished scopes to its own buffer. Timestamps are read from the time stamp
+ * counter where there is one and converted to seconds at the end of the run.
+ * While the profiler is disabled a Scope only checks one flag. Repeated
+ * back-to-back scopes of the same region, like the polling in the particle
+ * passing loop, are merged into one event that counts the calls. A scope inside
+ * another of the same region on its thread is traced but not counted again in
+ * the table. finalize
+ * writes a Chrome trace (chrome://tracing or Perfetto) for each rank and prints
+ * the min, mean and max over ranks of the time in each region.
+ */
+//==============================================================================
+namespace Profiler {
+
+//! Timed regions
+enum Region {
+  SETUP,
+  STEP,
+  SOURCE,
+  TRANSPORT,
+  TRANSPORT_THREAD,
+  MPI_PROGRESS,
+  WAIT,
+  TALLY_REDUCTION,
+  CENSUS,
+  OUTPUT,
+  N_REGIONS
+};
+
+//! Return the name of a region for printing
+inline const char *get_name(const Region region) {
+  static const char *names[N_REGIONS] = {
+      "Setup",   "Time step", "Sourcing",        "Transport", "Transport (thread)",
+      "MPI progress", "Waiting", "Tally reduction", "Census",    "Output"};
+  return names[region];
+}
+
+//! Return a timestamp in ticks (cycles with a time stamp counter, nanoseconds otherwise)
+inline uint64_t get_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+//! A finished scope, or a run of merged back-to-back scopes of one region
+struct Event {
+  uint64_t begin;  //!< Ticks at the start of the first scope
+  uint64_t end;    //!< Ticks at the end of the last scope
+  uint64_t ticks;  //!< Ticks inside the scopes
+  uint32_t calls;  //!< Scopes merged into this event
+  uint16_t region; //!< Region of the scopes
+  uint16_t depth;  //!< Scopes open on the thread when these started
+  bool nested;     //!< Started inside a scope of the same region
+};
+
+//! Events of one thread, only that thread writes to it
+struct Thread_Buffer {
+  std::vector<Event> events;
+  uint16_t depth;
+  uint32_t thread_id;
+  std::array<uint16_t, N_REGIONS> open; //!< Open scopes of each region
+};
+
+//! Process-wide profiler state
+struct State {
+  std::atomic<bool> enabled;
+  std::mutex mutex; //!< Guards buffers
+  std::vector<std::unique_ptr<Thread_Buffer>> buffers;
+  uint64_t start_ticks;
+  std::chrono::steady_clock::time_point start_time;
+};
+
+//! Return the profiler state, disabled until enable is called
+inline State &get_state() {
+  static State state{};
+  return state;
+}
+
+//! Return true if scopes are being recorded
+inline bool is_enabled() { return get_state().enabled.load(std::memory_order_relaxed); }
+
+//! Start recording scopes
+inline void enable() {
+  State &state = get_state();
+  state.start_time = std::chrono::steady_clock::now();
+  state.start_ticks = get_ticks();
+  state.enabled.store(true, std::memory_order_relaxed);
+}
+
+//! Return this thread's buffer, registering it on first use
+inline Thread_Buffer &get_thread_buffer() {
+  thread_local Thread_Buffer *buffer = nullptr;
+  if (!buffer) {
+    State &state = get_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.buffers.emplace_back(new Thread_Buffer{
+        std::vector<Event>(), 0, static_cast<uint32_t>(state.buffers.size()), {}});
+    buffer = state.buffers.back().get();
+    buffer->events.reserve(1024);
+  }
+  return *buffer;
+}
+
+//==============================================================================
+/*!
+ * \class Scope
+ * \brief Times a region for its lifetime, scopes on a thread must nest
+ */
+//==============================================================================
+class Scope {
+public:
+  //! Start timing a region if the profiler is enabled
+  explicit Scope(const Region _region) : buffer(nullptr), region(_region) {
+    if (is_enabled()) {
+      buffer = &get_thread_buffer();
+      depth = buffer->depth++;
+      nested = buffer->open[region]++ > 0;
+      begin = get_ticks();
+    }
+  }
+
+  //! Stop timing if stop wasn't called
+  ~Scope() { stop(); }
+
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+
+  //! Stop timing before the end of the enclosing block
+  void stop() {
+    if (!buffer)
+      return;
+    const uint64_t end = get_ticks();
+    buffer->depth--;
+    buffer->open[region]--;
+    std::vector<Event> &events = buffer->events;
+    // no scope ran between the last one and this, merge them
+    if (!events.empty() && events.back().region == region && events.back().depth == depth &&
+        events.back().nested == nested) {
+      events.back().end = end;
+      events.back().ticks += end - begin;
+      events.back().calls++;
+    } else
+      events.push_back({begin, end, end - begin, 1, static_cast<uint16_t>(region), depth, nested});
+    buffer = nullptr;
+  }
+
+private:
+  Thread_Buffer *buffer; //!< Buffer of this thread, null when not recording
+  Region region;         //!< Region being timed
+  uint16_t depth;        //!< Scopes already open on this thread
+  bool nested;           //!< A scope of the same region is already open on this thread
+  uint64_t begin;        //!< Ticks at construction
+};
+
+//! Seconds per rank in each region over ranks, filled on rank zero by finalize
+struct Summary {
+  std::array<double, N_REGIONS> min;   //!< Fewest seconds on a rank
+  std::array<double, N_REGIONS> mean;  //!< Mean seconds over ranks
+  std::array<double, N_REGIONS> max;   //!< Most seconds on a rank
+  std::array<double, N_REGIONS> calls; //!< Scopes summed over ranks
+};
+
+//! Write this rank's Chrome trace (unless write_trace is false) and print the region table on
+// rank zero, collective. Returns the table on rank zero.
+inline Summary finalize(const int rank, const bool write_trace = true) {
+  Summary summary{};
+  if (!is_enabled())
+    return summary;
+  State &state = get_state();
+  state.enabled.store(false, std::memory_order_relaxed);
+
+  // seconds per tick from the wall clock over the whole run
+  const double elapsed =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - state.start_time).count();
+  const uint64_t elapsed_ticks = get_ticks() - state.start_ticks;
+  const double seconds_per_tick = elapsed_ticks ? elapsed / double(elapsed_ticks) : 0.0;
+
+  std::array<double, N_REGIONS> seconds{};
+  std::array<double, N_REGIONS> calls{};
+  const std::string file_name = "profile_" + std::to_string(rank) + ".json";
+  {
+    std::ofstream trace;
+    if (write_trace)
+      trace.open(file_name);
+    trace << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    std::lock_guard<std::mutex> lock(state.mutex);
+    for (auto &buffer : state.buffers) {
+      for (auto &e : buffer->events) {
+        if (!e.nested) {
+          seconds[e.region] += e.ticks * seconds_per_tick;
+          calls[e.region] += e.calls;
+        }
+        if (!write_trace)
+          continue;
+        const double ts = (e.begin - state.start_ticks) * seconds_per_tick * 1.0e6;
+        const double dur = (e.end - e.begin) * seconds_per_tick * 1.0e6;
+        trace << (first ? "\n" : ",\n") << "{\"name\":\"" << get_name(Region(e.region))
+              << "\",\"ph\":\"X\",\"pid\":" << rank << ",\"tid\":" << buffer->thread_id
+              << ",\"ts\":" << std::fixed << std::setprecision(3) << ts << ",\"dur\":" << dur
+              << ",\"args\":{\"calls\":" << e.calls << "}}";
+        first = false;
+      }
+      buffer->events.clear();
+    }
+    trace << "\n]}\n";
+  }
+
+  int n_rank;
+  MPI_Comm_size(MPI_COMM_WORLD, &n_rank);
+  std::array<double, N_REGIONS> &min_s = summary.min;
+  std::array<double, N_REGIONS> &max_s = summary.max;
+  std::array<double, N_REGIONS> &sum_s = summary.mean;
+  std::array<double, N_REGIONS> &sum_calls = summary.calls;
+  MPI_Reduce(seconds.data(), min_s.data(), N_REGIONS, MPI_DOUBLE, MPI_MIN, 0, MPI_COMM_WORLD);
+  MPI_Reduce(seconds.data(), max_s.data(), N_REGIONS, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+  MPI_Reduce(seconds.data(), sum_s.data(), N_REGIONS, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(calls.data(), sum_calls.data(), N_REGIONS, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  if (rank == 0) {
+    using std::setw;
+    for (auto &s : sum_s)
+      s /= n_rank;
+    std::cout << "Region profile, seconds per rank (thread regions summed over threads)";
+    if (write_trace)
+      std::cout << ", traces in profile_<rank>.json";
+    std::cout << std::endl;
+    std::cout << std::left << setw(20) << "Region" << std::right << setw(14) << "Calls"
+              << setw(12) << "Min" << setw(12) << "Mean" << setw(12) << "Max" << std::endl;
+    std::cout << std::setprecision(4) << std::scientific;
+    for (int r = 0; r < N_REGIONS; ++r) {
+      if (sum_calls[r] == 0.0)
+        continue;
+      std::cout << std::left << setw(20) << get_name(Region(r)) << std::right << setw(14)
+                << uint64_t(sum_calls[r]) << setw(12) << min_s[r] << setw(12) << sum_s[r]
+                << setw(12) << max_s[r] << std::endl;
+    }
+    std::cout << std::defaultfloat;
+  }
+  return summary;
+}
+
+} // namespace Profiler
+
+#endif // profiler_h_
+//---------------------------------------------------------------------------//
+// end of profiler.h
+//---------------------------------------------------------------------------//
@@ -34,7 +34,7 @@
 class Proto_Cell {
 
 public:
-  Proto_Cell(void) {}
+  Proto_Cell(void) : T_e(0.0), T_r(0.0) {}
 
   ~Proto_Cell(void) {}
 
@@ -76,6 +76,12 @@ public:
   // Return region ID
   inline uint32_t get_region_ID(void) const { return region_ID; }
 
+  //! Return initial material temperature
+  inline double get_T_e(void) const { return T_e; }
+
+  //! Return initial radiation temperature
+  inline double get_T_r(void) const { return T_r; }
+
   //! Override great than operator to sort
   bool operator<(const Proto_Cell &compare) const {
     return global_index < compare.get_global_index();
@@ -120,6 +126,12 @@ public:
   //! Set region ID
   void set_region_ID(uint32_t _region_ID) { region_ID = _region_ID; }
 
+  //! Set initial material and radiation temperatures
+  void set_T(double _T_e, double _T_r) {
+    T_e = _T_e;
+    T_r = _T_r;
+  }
+
   //! Set node loactions
   void set_coor(double x_low, double x_high, double y_low, double y_high,
                 double z_low, double z_high) {
@@ -150,6 +162,8 @@ private:
 
   std::array<Constants::bc_type, 6> bc; //!< Boundary conditions for each face
   std::array<double, 6> nodes;          //!< x_low, x_high, y_low, y_high, z_low, z_high
+  double T_e; //!< Initial material temperature, from the region or the material file
+  double T_r; //!< Initial radiation temperature, from the region or the material file
 };
 
 #endif // cell_h_
@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <memory>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -25,6 +26,7 @@
 #include "imc_state.h"
 #include "info.h"
 #include "input.h"
+#include "material_file.h"
 #include "mpi_types.h"
 #include "proto_cell.h"
 
@@ -34,7 +36,9 @@
  * \brief Manages data access and decomposition for primitive mesh
  *
  * Using an Input class, make the mesh with the correct material properties
- * for each region. The mesh numbering and mapping between global indices and local
+ * for each region. Cell regions and initial temperatures come from the region map
+ * or, if the input names one, a binary material file that each rank maps and
+ * reads only its own cells from. The mesh numbering and mapping between global indices and local
  * indices are all determined with the aid of Metis in the decompose_mesh
  * function. The Proto_Mesh does not hold any physical data (i.e. opacity, heat
  * capacity, temperature).
@@ -92,8 +96,13 @@ public:
     uint32_t n_y_div = input.get_n_y_divisions();
     uint32_t n_z_div = input.get_n_z_divisions();
 
+    // per-cell regions and temperatures replace the division region map
+    std::unique_ptr<Material_File> material_file;
+    if (!input.get_material_file().empty())
+      material_file.reset(new Material_File(input.get_material_file(), n_global));
+
     Region region;
-    uint32_t region_index, nx, ny, nz;
+    uint32_t nx, ny, nz;
     double x_start, y_start, z_start;
     double x_cell_end;
     double y_cell_end;
@@ -123,9 +132,23 @@ public:
                 if (global_count >= cell_id_begin &&
                     global_count < cell_id_end) {
                   Proto_Cell e;
-                  // find the region for this cell
-                  region_index = input.get_region_index(ix_div, iy_div, iz_div);
-                  region = regions[region_index];
+                  // find the region and initial temperatures for this cell
+                  if (material_file) {
+                    const uint32_t region_ID = material_file->get_region_ID(global_count);
+                    if (!region_ID_to_index.count(region_ID)) {
+                      std::cout << "ERROR: material file region " << region_ID << " of cell "
+                                << global_count << " is not a region in the input, exiting..."
+                                << std::endl;
+                      exit(EXIT_FAILURE);
+                    }
+                    e.set_region_ID(region_ID);
+                    e.set_T(material_file->get_T_e(global_count),
+                            material_file->get_T_r(global_count));
+                  } else {
+                    region = regions[input.get_region_index(ix_div, iy_div, iz_div)];
+                    e.set_region_ID(region.get_ID());
+                    e.set_T(region.get_T_e(), region.get_T_r());
+                  }
 
                   // set ending coordinates explicity to match the start of
                   // the next division to avoid weird roundoff errors
@@ -147,7 +170,6 @@ public:
                   e.set_coor(x_start + i * dx, x_cell_end, y_start + j * dy,
                              y_cell_end, z_start + k * dz, z_cell_end);
                   e.set_global_index(global_count);
-                  e.set_region_ID(region.get_ID());
 
                   // set the global index for SILO plotting--this will always
                   // be the current global count (g_i +g_j*ngx + g_k*(ngy_*ngz))
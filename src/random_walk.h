@@ -0,0 +1,141 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   random_walk.h
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Random walk acceleration for photons deep in optically thick cells
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#ifndef random_walk_h_
+#define random_walk_h_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "RNG.h"
+#include "config.h"
+#include "constants.h"
+
+//==============================================================================
+/*!
+ * \class Random_Walk
+ * \brief Escape time table and settings for Fleck-Canfield random walks
+ *
+ * A photon diffusing from the center of a sphere of radius R with diffusion
+ * coefficient D has escaped by reduced time s = D t / R^2 with probability
+ * P(s) = 1 - 2 sum_n (-1)^(n+1) exp(-n^2 pi^2 s). The table holds P on a
+ * uniform grid in s and is inverted to sample the escape time. Spheres are
+ * limited so the reduced census time is at least min_census_s, where the
+ * position of a photon still inside the sphere at census follows the first
+ * diffusion mode, r sin(pi r / R), to a few parts in 10^4. Spheres are only
+ * used when they are min_mfp scattering mean free paths or larger.
+ */
+//==============================================================================
+class Random_Walk {
+public:
+  //! Constructor, tabulate the escape probability
+  explicit Random_Walk(const double _min_mfp) : min_mfp(_min_mfp) {
+    using Constants::pi;
+    for (uint32_t i = 0; i < n_table; ++i) {
+      const double s = i * ds;
+      double survival = 0.0;
+      // the series needs more terms for short times, stop when terms are negligible
+      for (uint32_t n = 1; n < 1000; ++n) {
+        const double term = std::exp(-double(n * n) * pi * pi * s);
+        survival += (n % 2 ? 2.0 : -2.0) * term;
+        if (term < 1.0e-17)
+          break;
+      }
+      escape_cdf[i] = std::min(std::max(1.0 - survival, 0.0), 1.0);
+    }
+    // series is slow at s = 0, the photon starts at the center so it can't have escaped
+    escape_cdf[0] = 0.0;
+  }
+
+  //! Return the minimum sphere radius in scattering mean free paths
+  double get_min_mfp() const { return min_mfp; }
+
+  //! Return the sphere radius to use given the distance to the nearest face (zero for no walk)
+  double get_radius(const double dist_to_face, const double sigma_s, const double D,
+                    const double t_census) const {
+    // stay just inside the cell so roundoff can't put the photon on the wrong side of a face
+    const double R = std::min(dist_to_face * (1.0 - 1.0e-10), std::sqrt(D * t_census / min_census_s));
+    return (R * sigma_s > min_mfp) ? R : 0.0;
+  }
+
+  //! Return the probability of escaping a sphere by reduced time s
+  double get_escape_probability(const double s) const {
+    if (s >= s_max)
+      return escape_cdf[n_table - 1];
+    const double x = s / ds;
+    const uint32_t i = static_cast<uint32_t>(x);
+    const double w = x - i;
+    return (1.0 - w) * escape_cdf[i] + w * escape_cdf[i + 1];
+  }
+
+  //! Return the reduced escape time for a probability in (0, P(s_max))
+  double sample_escape_time(const double xi) const {
+    const double *upper = std::upper_bound(escape_cdf.data(), escape_cdf.data() + n_table, xi);
+    if (upper == escape_cdf.data() + n_table)
+      return s_max;
+    const uint32_t i = static_cast<uint32_t>(upper - escape_cdf.data()) - 1;
+    const double dp = escape_cdf[i + 1] - escape_cdf[i];
+    const double w = dp > 0.0 ? (xi - escape_cdf[i]) / dp : 0.0;
+    return (i + w) * ds;
+  }
+
+  //! Return the radius at census, as a fraction of the sphere radius, for a photon that didn't escape
+  double sample_census_radius(RNG &rng) const {
+    // rejection from a uniform envelope, max of x sin(pi x) is below 0.59
+    while (true) {
+      const double x = rng.generate_random_number();
+      if (rng.generate_random_number() * 0.59 < x * std::sin(Constants::pi * x))
+        return x;
+    }
+  }
+
+  //! Smallest reduced census time, higher diffusion modes are below 3e-4 of the first from here
+  static constexpr double min_census_s = 0.3;
+
+private:
+  static constexpr uint32_t n_table = 1025; //!< Table entries
+  static constexpr double s_max = 2.0;       //!< Largest tabulated reduced time
+  static constexpr double ds = s_max / (n_table - 1); //!< Reduced time spacing
+
+  double min_mfp;                             //!< Smallest sphere in mean free paths
+  std::array<double, n_table> escape_cdf;     //!< Escape probability at i * ds
+};
+
+//----------------------------------------------------------------------------//
+//! Return a direction leaving a sphere through the point with outward normal n
+//
+// Exit directions are cosine distributed about the normal, as for a diffuse surface
+inline std::array<double, 3> get_sphere_exit_angle(const std::array<double, 3> &n, RNG &rng) {
+  using Constants::pi;
+  const double mu = std::sqrt(rng.generate_random_number());
+  const double phi = 2.0 * pi * rng.generate_random_number();
+  const double sin_theta = std::sqrt(1.0 - mu * mu);
+  // two unit vectors perpendicular to n
+  const std::array<double, 3> a =
+      (std::abs(n[0]) < 0.9) ? std::array<double, 3>{1.0, 0.0, 0.0} : std::array<double, 3>{0.0, 1.0, 0.0};
+  std::array<double, 3> u{n[1] * a[2] - n[2] * a[1], n[2] * a[0] - n[0] * a[2],
+                          n[0] * a[1] - n[1] * a[0]};
+  const double u_norm = std::sqrt(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+  for (auto &u_i : u)
+    u_i /= u_norm;
+  const std::array<double, 3> v{n[1] * u[2] - n[2] * u[1], n[2] * u[0] - n[0] * u[2],
+                                n[0] * u[1] - n[1] * u[0]};
+  std::array<double, 3> angle;
+  for (uint32_t i = 0; i < 3; ++i)
+    angle[i] = mu * n[i] + sin_theta * (std::cos(phi) * u[i] + std::sin(phi) * v[i]);
+  return angle;
+}
+
+#endif // random_walk_h_
+//---------------------------------------------------------------------------//
+// end of random_walk.h
+//---------------------------------------------------------------------------//
@@ -26,13 +26,14 @@
 //==============================================================================
 class Region {
 public:
-  Region(void) { T_s = 0.0; }
+  Region(void) : ddmc(0), T_s(0.0), importance(1.0) {}
   ~Region(void) {}
 
   //----------------------------------------------------------------------------//
   // const functions                                                            //
   //----------------------------------------------------------------------------//
   uint32_t get_ID(void) const { return ID; }
+  bool get_ddmc(void) const { return ddmc; }
   double get_cV(void) const { return cv; }
   double get_rho(void) const { return rho; }
   double get_opac_A(void) const { return opacA; }
@@ -45,10 +46,12 @@ public:
     return opacA + opacB * std::pow(T, opacC);
   }
   double get_scattering_opacity(void) const { return opacS; }
+  double get_importance(void) const { return importance; }
   //----------------------------------------------------------------------------//
   // non-const functions                                                        //
   //----------------------------------------------------------------------------//
   void set_ID(const uint32_t &_ID) { ID = _ID; }
+  void set_ddmc(const bool &_ddmc) { ddmc = _ddmc; }
   void set_cV(const double &_cv) { cv = _cv; }
   void set_rho(const double &_rho) { rho = _rho; }
   void set_opac_A(const double &_opacA) { opacA = _opacA; }
@@ -58,12 +61,14 @@ public:
   void set_T_e(const double &_T_e) { T_e = _T_e; }
   void set_T_r(const double &_T_r) { T_r = _T_r; }
   void set_T_s(const double &_T_s) { T_s = _T_s; }
+  void set_importance(const double &_importance) { importance = _importance; }
 
   //----------------------------------------------------------------------------//
   // member variables and private functions                                     //
   //----------------------------------------------------------------------------//
 private:
   uint32_t ID;  //!< User defined ID of this region
+  uint32_t ddmc; //!< Use discrete diffusion in this region (fills padding)
   double cv;    //!< Heat capacity in this region
   double rho;   //!< Density in this region (g/cc)
   double opacA; //!< A in A + B * T ^ C
@@ -73,6 +78,7 @@ private:
   double T_e;   //!< Initial electron temperature in region
   double T_r;   //!< Initial radiation temperature in region
   double T_s;   //!< Temperature of source in region
+  double importance; //!< Weight window importance, window center is 1/importance
 };
 
 #endif
@@ -17,7 +17,12 @@
 #include <mpi.h>
 #include <vector>
 
+#include "async_writer.h"
 #include "census_creation.h"
+#include "census_store.h"
+#include "checkpoint.h"
+#include "comb_photons.h"
+#include "event_counters.h"
 #include "info.h"
 #include "imc_parameters.h"
 #include "imc_state.h"
@@ -25,6 +30,8 @@
 #include "mesh.h"
 #include "message_counter.h"
 #include "mpi_types.h"
+#include "perf_counters.h"
+#include "profiler.h"
 #include "replicated_transport.h"
 #include "source.h"
 #include "timer.h"
@@ -34,19 +41,40 @@ void imc_replicated_driver(Mesh &mesh, IMC_State &imc_state,
                            const IMC_Parameters &imc_parameters,
                            const MPI_Types &mpi_types, const Info &mpi_info) {
   using std::vector;
-  vector<double> abs_E(mesh.get_n_global_cells(), 0.0);
-  vector<double> track_E(mesh.get_n_global_cells(), 0.0);
-  vector<Photon> census_photons;
+  Energy_Tally_Vector abs_E(mesh.get_n_global_cells(), 0.0);
+  Energy_Tally_Vector track_E(mesh.get_n_global_cells(), 0.0);
+  Photon_Vector census_photons;
   auto n_user_photons = imc_parameters.get_n_user_photons();
   Message_Counter mctr;
   const int rank = mpi_info.get_rank();
   const int n_ranks = mpi_info.get_n_rank();
 
   const uint32_t seed = imc_parameters.get_rng_seed();
-  while (!imc_state.finished()) {
-    if (rank == 0)
-      imc_state.print_timestep_header();
 
+  // SILO files are written on this thread while the next steps run, it finishes when destroyed
+  Async_Writer output_writer(
+      imc_parameters.get_write_silo_flag() ? imc_parameters.get_output_queue_size() : 0);
+
+  // continue from a checkpoint, the census replaces the initial one
+  constexpr bool replicated_flag = true;
+  if (!imc_parameters.get_restart_file().empty())
+    Checkpoint::read(imc_parameters.get_restart_file(), mesh, imc_state, census_photons, mpi_info,
+                     replicated_flag);
+  const uint32_t first_step = imc_state.get_step();
+
+  // census photons beyond the in-memory bound wait in a spill file between steps
+  Census_Store census_store(imc_parameters.get_max_census_in_memory(),
+                            imc_parameters.get_census_spill_directory(), rank);
+  census_store.spill(census_photons);
+
+  // photon event statistics, reduced with the conservation quantities
+  Event_Counters event_counters(mesh.get_n_local_cells());
+  Event_Counters *counters = imc_parameters.get_count_events_flag() ? &event_counters : nullptr;
+
+  while (!imc_state.finished()) {
+    Profiler::Scope step_scope(Profiler::STEP);
+    Profiler::Scope source_scope(Profiler::SOURCE);
+    Perf_Counters::Scope source_counters(Perf_Counters::SOURCE);
     mctr.reset_counters();
 
     // set opacity, Fleck factor, all energy to source
@@ -57,7 +85,7 @@ void imc_replicated_driver(Mesh &mesh, IMC_State &imc_state,
     MPI_Allreduce(MPI_IN_PLACE, &global_source_energy, 1, MPI_DOUBLE, MPI_SUM,
                   MPI_COMM_WORLD);
 
-    imc_state.set_pre_census_E(get_photon_list_E(census_photons));
+    imc_state.set_pre_census_E(get_photon_list_E(census_photons) + census_store.get_spilled_E());
 
     // make gpu setup object, may want to source on GPU later so make it before sourcing here
     GPU_Setup gpu_setup(rank, n_ranks, imc_parameters.get_use_gpu_transporter_flag(), mesh.get_cells());
@@ -67,32 +95,83 @@ void imc_replicated_driver(Mesh &mesh, IMC_State &imc_state,
     t_source.start_timer("source");
     if (imc_state.get_step() == 1)
       census_photons = make_initial_census_photons(imc_state.get_dt(), mesh, rank, seed, n_user_photons, global_source_energy);
-    imc_state.set_pre_census_E(get_photon_list_E(census_photons));
+    imc_state.set_pre_census_E(get_photon_list_E(census_photons) + census_store.get_spilled_E());
     // make emission and source photons
-    auto all_photons = make_photons(imc_state.get_dt(), mesh, rank, imc_state.get_step(), seed, n_user_photons, global_source_energy);
-    // add the census photons
-    all_photons.insert(all_photons.end(), census_photons.begin(), census_photons.end());
+    auto all_photons = make_photons(imc_state.get_dt(), mesh, rank, imc_state.get_step(), seed, n_user_photons, global_source_energy, imc_parameters.get_sampling_mode());
     t_source.stop_timer("source");
-    if (rank ==0)
+    source_counters.stop();
+    source_scope.stop();
+
+    // finish the last step's diagnostics, the reduction overlapped the material update and sourcing
+    {
+      Profiler::Scope reduction_scope(Profiler::TALLY_REDUCTION);
+      Perf_Counters::Scope reduction_counters(Perf_Counters::TALLY_REDUCTION);
+      imc_state.finish_conservation_reduction(imc_parameters.get_dd_mode());
+      event_counters.finish_reduction(rank);
+      Perf_Counters::finish_reduction(rank);
+    }
+    if (rank == 0) {
+      imc_state.print_timestep_header();
       std::cout<<"source time: "<<t_source.get_time("source")<<std::endl;
+    }
+
+    // checkpoint the start of this step every checkpoint_frequency steps, the census and
+    // temperatures are still as the last step left them
+    const uint32_t checkpoint_freq = imc_parameters.get_checkpoint_frequency();
+    if (checkpoint_freq && imc_state.get_step() > first_step &&
+        (imc_state.get_step() - 1) % checkpoint_freq == 0) {
+      Profiler::Scope output_scope(Profiler::OUTPUT);
+      // the checkpoint holds the whole census, spilled photons are streamed from the store
+      const std::string file_name =
+          Checkpoint::write(imc_parameters.get_checkpoint_directory(), mesh, imc_state,
+                            census_photons, mpi_info, replicated_flag, &census_store);
+      if (rank == 0)
+        std::cout << "Wrote checkpoint " << file_name << std::endl;
+    }
 
-    imc_state.set_transported_particles(all_photons.size());
+    // the census is transported from census_photons and the store, it isn't copied in
+    imc_state.set_transported_particles(all_photons.size() + census_photons.size() +
+                                        census_store.get_n_spilled());
 
-    imc_state.print_memory_estimate(rank, n_ranks,  mesh.get_n_local_cells(), all_photons.size());
+    imc_state.print_memory_report(all_photons.size() + census_photons.size());
 
     // add barrier here to make sure the transport timer starts at roughly the same time
-    MPI_Barrier(MPI_COMM_WORLD);
+    {
+      Profiler::Scope wait_scope(Profiler::WAIT);
+      Perf_Counters::Scope wait_counters(Perf_Counters::COMMUNICATION);
+      MPI_Barrier(MPI_COMM_WORLD);
+    }
 
     census_photons =
-        replicated_transport(mesh, gpu_setup, imc_state, abs_E, track_E, all_photons, imc_parameters.get_n_omp_threads());
+        replicated_transport(mesh, gpu_setup, imc_parameters, imc_state, abs_E, track_E, all_photons, census_photons, census_store, counters, imc_parameters.get_n_omp_threads());
+
+    // population control on the census, energy is conserved in each cell
+    Profiler::Scope census_scope(Profiler::CENSUS);
+    if (imc_parameters.get_use_comb_flag()) {
+      comb_photons(census_photons, imc_parameters.get_max_census_photons(),
+                   mesh.get_n_local_cells(), mesh.get_offset(), seed, imc_state.get_step(), rank,
+                   &census_store);
+      imc_state.set_census_size(census_photons.size() + census_store.get_n_flushed());
+    }
+
+    if (census_store.is_enabled()) {
+      census_store.spill(census_photons);
+      census_store.print_step_io(rank);
+    }
+    census_scope.stop();
 
     // reduce the abs_E and the track weighted energy (for T_r)
+    Profiler::Scope reduction_scope(Profiler::TALLY_REDUCTION);
+    Perf_Counters::Scope reduction_counters(Perf_Counters::TALLY_REDUCTION);
     MPI_Allreduce(MPI_IN_PLACE, &abs_E[0], mesh.get_n_global_cells(),
                   MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
     MPI_Allreduce(MPI_IN_PLACE, &track_E[0], mesh.get_n_global_cells(),
                   MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
 
-    mesh.update_temperature(abs_E, track_E, imc_state);
+    {
+      Perf_Counters::Scope material_counters(Perf_Counters::MATERIAL_UPDATE);
+      mesh.update_temperature(abs_E, track_E, imc_state);
+    }
 
     MPI_Barrier(MPI_COMM_WORLD);
     // for replicated, just let root do conservation
@@ -102,22 +181,31 @@ void imc_replicated_driver(Mesh &mesh, IMC_State &imc_state,
       imc_state.set_post_mat_E(0.0);
     }
 
-    imc_state.print_conservation(imc_parameters.get_dd_mode());
+    // reduced and printed during the next step
+    imc_state.start_conservation_reduction();
+    if (counters)
+      event_counters.start_reduction(true);
+    reduction_counters.stop();
+    reduction_scope.stop();
+    Perf_Counters::start_reduction(imc_state.get_step());
 
     // write SILO file if it's enabled and it's the right cycle
     if (imc_parameters.get_write_silo_flag() &&
         !(imc_state.get_step() % imc_parameters.get_output_frequency())) {
+      Profiler::Scope output_scope(Profiler::OUTPUT);
       // write SILO file
       double fake_mpi_runtime = 0.0;
-      constexpr bool replicated_flag = true;
       write_silo(mesh, imc_state.get_time(), imc_state.get_step(),
                  imc_state.get_rank_transport_runtime(), fake_mpi_runtime, rank,
-                 n_ranks, replicated_flag);
+                 n_ranks, replicated_flag, 0, &output_writer);
     }
 
     // update time for next step
     imc_state.next_time_step();
   }
+  imc_state.finish_conservation_reduction(imc_parameters.get_dd_mode());
+  event_counters.finish_reduction(rank);
+  Perf_Counters::finish_reduction(rank);
 }
 
 #endif // replicated_driver_h_
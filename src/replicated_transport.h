@@ -22,14 +22,18 @@
 #include "RNG.h"
 #include "constants.h"
 #include "gpu_setup.h"
+#include "census_store.h"
+#include "event_counters.h"
 #include "info.h"
 #include "mesh.h"
 #include "message_counter.h"
+#include "perf_counters.h"
 #include "transport_photon.h"
 #include "photon.h"
+#include "profiler.h"
 
-std::vector<Photon> replicated_transport(
-    const Mesh &mesh, const GPU_Setup &gpu_setup, IMC_State &imc_state, std::vector<double> &rank_abs_E, std::vector<double> &rank_track_E, std::vector<Photon> &all_photons, const int n_omp_threads) {
+Photon_Vector replicated_transport(
+    const Mesh &mesh, const GPU_Setup &gpu_setup, const IMC_Parameters &imc_parameters, IMC_State &imc_state, Energy_Tally_Vector &rank_abs_E, Energy_Tally_Vector &rank_track_E, Photon_Vector &all_photons, Photon_Vector &census_photons, Census_Store &census_store, Event_Counters *event_counters, const int n_omp_threads) {
   using std::cout;
   using std::endl;
   using std::vector;
@@ -54,6 +58,8 @@ std::vector<Photon> replicated_transport(
   }
 
   // timing
+  Profiler::Scope transport_scope(Profiler::TRANSPORT);
+  Perf_Counters::Scope transport_counters(Perf_Counters::TRANSPORT);
   Timer t_transport;
   t_transport.start_timer("timestep transport");
 
@@ -61,26 +67,46 @@ std::vector<Photon> replicated_transport(
   // main transport loop
   //------------------------------------------------------------------------//
 
-  vector<Photon> census_list;   //! End of timestep census list
-  vector<Cell_Tally> cell_tallies(mesh.get_n_local_cells());
+  Photon_Vector census_list;   //! End of timestep census list
+  Cell_Tally_Vector cell_tallies(mesh.get_n_local_cells());
   uint32_t rank_cell_offset{0}; // no offset in replicated mesh
-  if(gpu_setup.use_gpu_transporter() && gpu_available ) {
-    t_transport.start_timer("gpu transport");
-    gpu_transport_photons(rank_cell_offset, all_photons, gpu_setup.get_device_cells_ptr(), cell_tallies);
-    t_transport.stop_timer("gpu transport");
-    std::cout<<"gpu transport time: "<<t_transport.get_time("gpu transport")<<std::endl;
-  }
-  else {
-    cpu_transport_photons(rank_cell_offset, all_photons, mesh.get_cells(), cell_tallies, n_omp_threads);
-  }
-
-  // post process photons, account for escaped energy and add particles to census
-  post_process_photons(next_dt, all_photons, census_list, census_E, exit_E);
+  const Population_Control pop_ctrl = imc_parameters.get_population_control();
+  auto transport_photons = [&](Photon_Vector &photons) {
+    if(gpu_setup.use_gpu_transporter() && gpu_available ) {
+      t_transport.start_timer("gpu transport");
+      gpu_transport_photons(rank_cell_offset, photons, gpu_setup.get_device_cells_ptr(), cell_tallies, pop_ctrl,
+                            mesh.get_n_dim());
+      t_transport.stop_timer("gpu transport");
+      std::cout<<"gpu transport time: "<<t_transport.get_time("gpu transport")<<std::endl;
+    }
+    else {
+      cpu_transport_photons(rank_cell_offset, photons, mesh.get_cells(), cell_tallies, n_omp_threads, pop_ctrl,
+                            imc_parameters.get_random_walk(), mesh.get_macro_mesh(), mesh.get_n_dim(),
+                            event_counters);
+    }
+
+    // post process photons, account for escaped energy and add particles to census, flushing it
+    // to the census store as it fills
+    post_process_photons(next_dt, photons, census_list, census_E, exit_E, &census_store);
+  };
+  // the last step's in-memory census is transported in place, not copied into all_photons, and
+  // both are released before the new census grows
+  transport_photons(all_photons);
+  Photon_Vector().swap(all_photons);
+  transport_photons(census_photons);
+  Photon_Vector().swap(census_photons);
+
+  // census photons spilled at the end of the last step are streamed back in chunks
+  Photon_Vector spilled_photons;
+  while (census_store.read_chunk(spilled_photons))
+    transport_photons(spilled_photons);
 
   // copy cell tallies back out to rank_abs_E and rank_track_E
   double total_abs = 0;
+  double pop_ctrl_E = 0.0;
   for (size_t i = 0; i<cell_tallies.size();++i) {
     total_abs+=cell_tallies[i].get_abs_E();
+    pop_ctrl_E += cell_tallies[i].get_pop_ctrl_E();
     rank_abs_E[i] = cell_tallies[i].get_abs_E();
     rank_track_E[i] = cell_tallies[i].get_track_E();
   }
@@ -89,14 +115,19 @@ std::vector<Photon> replicated_transport(
   t_transport.stop_timer("timestep transport");
 
   // wait for all ranks to finish
-  MPI_Barrier(MPI_COMM_WORLD);
+  {
+    Profiler::Scope wait_scope(Profiler::WAIT);
+    Perf_Counters::Scope wait_counters(Perf_Counters::COMMUNICATION);
+    MPI_Barrier(MPI_COMM_WORLD);
+  }
 
   std::sort(census_list.begin(), census_list.end());
 
   // set diagnostic quantities
   imc_state.set_exit_E(exit_E);
+  imc_state.set_pop_ctrl_E(pop_ctrl_E);
   imc_state.set_post_census_E(census_E);
-  imc_state.set_census_size(census_list.size());
+  imc_state.set_census_size(census_list.size() + census_store.get_n_flushed());
   imc_state.set_rank_transport_runtime(
       t_transport.get_time("timestep transport"));
 
@@ -90,16 +90,69 @@ inline std::array<double,3> get_stratified_angle( RNG &rng, uint32_t isample,
   return angle;
 }
 
-//! Set angle on face given input array and RNG
-inline std::array<double, 3> get_source_angle_on_face( RNG &rng, int face) {
+//! Map a point in the unit cube to a position in a cell
+inline std::array<double, 3> get_position_in_cell(const Cell &cell, const double *u) {
+  auto nodes = cell.get_node_array();
+  std::array<double, 3> pos{0.0, 0.0, 0.0};
+  for (int d = 0; d < 3; ++d)
+    pos[d] = nodes[2 * d] + u[d] * (nodes[2 * d + 1] - nodes[2 * d]);
+  return pos;
+}
+
+//! Invert the CDF of the linear PDF 1 + b(t - 1/2) on [0,1], b in [-2,2]
+inline double get_tilted_coordinate(const double u, const double b) {
+  const double half_b = 0.5 * b;
+  return 2.0 * u / ((1.0 - half_b) + std::sqrt((1.0 - half_b) * (1.0 - half_b) + 2.0 * b * u));
+}
+
+//! Map a point in the unit cube to a position in a cell with a linear tilt in each dimension
+inline std::array<double, 3> get_tilted_position_in_cell(const Cell &cell, const double *u,
+                                                         const std::array<double, 3> &tilt) {
+  auto nodes = cell.get_node_array();
+  std::array<double, 3> pos{0.0, 0.0, 0.0};
+  for (int d = 0; d < 3; ++d)
+    pos[d] = nodes[2 * d] + get_tilted_coordinate(u[d], tilt[d]) * (nodes[2 * d + 1] - nodes[2 * d]);
+  return pos;
+}
+
+//! Map a point in the unit square to a position on a cell face
+inline std::array<double, 3> get_position_on_face(const Cell &cell, const double *u, int face) {
+  auto nodes = cell.get_node_array();
+  std::array<double, 3> face_pos{0.0, 0.0, 0.0};
+  const int face_dim = face / 2;
+  int i_u = 0;
+  for (int d = 0; d < 3; ++d) {
+    if (d == face_dim)
+      face_pos[d] = (face % 2) ? nodes[2 * d + 1] : nodes[2 * d];
+    else
+      face_pos[d] = nodes[2 * d] + u[i_u++] * (nodes[2 * d + 1] - nodes[2 * d]);
+  }
+  return face_pos;
+}
+
+//! Map a point in the unit square to an isotropic angle
+inline std::array<double, 3> get_angle(const double u_mu, const double u_phi) {
+  using Constants::pi;
+  std::array<double, 3> angle{0.0, 0.0, 0.0};
+  double mu = u_mu * 2.0 - 1.0;
+  double phi = u_phi * 2.0 * pi;
+  double sin_theta = std::sqrt(1.0 - mu * mu);
+  angle[0] = sin_theta * std::cos(phi);
+  angle[1] = sin_theta * std::sin(phi);
+  angle[2] = mu;
+  return angle;
+}
+
+//! Map a point in the unit square to a cosine distributed angle on a face
+inline std::array<double, 3> get_angle_on_face(const double u_theta, const double u_phi, int face) {
   using Constants::pi;
   using std::cos;
   using std::sin;
   using std::sqrt;
 
   std::array<double, 3> angle{0.0, 0.0, 0.0};
-  double theta = acos(sqrt(rng.generate_random_number()));
-  double phi = rng.generate_random_number() * 2.0 * pi;
+  double theta = acos(sqrt(u_theta));
+  double phi = u_phi * 2.0 * pi;
   double sign = (face % 2) ? -1.0 : 1.0;
   if( face == 0 || face ==1) {
     angle[0] = cos(theta) * sign;
@@ -120,17 +173,28 @@ inline std::array<double, 3> get_source_angle_on_face( RNG &rng, int face) {
   return angle;
 }
 
+//! Set angle on face given input array and RNG
+inline std::array<double, 3> get_source_angle_on_face( RNG &rng, int face) {
+  const double u_theta = rng.generate_random_number();
+  const double u_phi = rng.generate_random_number();
+  return get_angle_on_face(u_theta, u_phi, face);
+}
+
 
-//! Sample the group after an effective scattering event
+//! Sample the group of an emitted photon or of one after an effective scattering event
 GPU_HOST_DEVICE
 inline int sample_emission_group(RNG &rng, const Cell &cell_data) {
-  // Sample a new group from a uniform CDF (but mimc non-uniform CDF algorithm)
+  // Sample a new group from the CDF of the group absorption opacities, groups have equal
+  // Planck weight so the emission PDF is the opacity normalized by its sum
   double cdf_value = rng.generate_random_number();
-  int new_group = -1;
-  // normalizes the PDF (opacity is uniform, not weighting with spectrum so
-  // this is very simple)
-  double norm_factor = 1.0 / (cell_data.get_op_a(0) * BRANSON_N_GROUPS);
-  while (cdf_value > 0) {
+  double op_a_sum = 0.0;
+  for (int g = 0; g < BRANSON_N_GROUPS; ++g)
+    op_a_sum += cell_data.get_op_a(g);
+  double norm_factor = 1.0 / op_a_sum;
+  int new_group = 0;
+  cdf_value -= cell_data.get_op_a(0) * norm_factor;
+  // round off can leave a sliver of the CDF past the last group
+  while (cdf_value > 0 && new_group < BRANSON_N_GROUPS - 1) {
     new_group++;
     cdf_value -= cell_data.get_op_a(new_group) * norm_factor;
   }
@@ -21,6 +21,7 @@
 #include "mesh.h"
 #include "photon.h"
 #include "sampling_functions.h"
+#include "source_sampler.h"
 
 
 //! Set input photon to the next emission photon
@@ -34,7 +35,7 @@ inline Photon get_emission_photon(const Cell &cell, const double &phtn_E, const
   emission_photon.set_E0(phtn_E);
   emission_photon.set_distance_to_census(rng.generate_random_number() * c * dt);
   emission_photon.set_cell(cell.get_global_index());
-  emission_photon.set_group(std::floor(rng.generate_random_number() * double(BRANSON_N_GROUPS)));
+  emission_photon.set_group(sample_emission_group(rng, cell));
   emission_photon.set_rng(rng);
   return emission_photon;
 }
@@ -56,6 +57,46 @@ inline Photon get_boundary_source_photon(const Cell &cell, const double phtn_E,
   return source_photon;
 }
 
+//! Make an emission photon from the sampler's point for this sample index
+inline Photon get_sampled_emission_photon(const Cell &cell, const double &phtn_E, const double &dt,
+                                          const Source_Sampler &sampler, const uint32_t isample,
+                                          const std::array<double, 3> &tilt,
+                                          const uint32_t seed, const uint64_t stream_num) {
+  using Constants::c;
+  Photon emission_photon;
+  RNG rng(seed, stream_num);
+  const auto u = sampler.get_sample(isample, rng);
+  emission_photon.set_source_type(2);
+  emission_photon.set_position(get_tilted_position_in_cell(cell, &u[0], tilt));
+  emission_photon.set_angle(get_angle(u[3], u[4]));
+  emission_photon.set_E0(phtn_E);
+  emission_photon.set_distance_to_census(u[5] * c * dt);
+  emission_photon.set_cell(cell.get_global_index());
+  emission_photon.set_group(sample_emission_group(rng, cell));
+  emission_photon.set_rng(rng);
+  return emission_photon;
+}
+
+//! Make a boundary source photon from the sampler's point for this sample index
+inline Photon get_sampled_boundary_source_photon(const Cell &cell, const double phtn_E,
+                                                 const double dt, const Source_Sampler &sampler,
+                                                 const uint32_t isample, const uint32_t seed,
+                                                 const uint64_t stream_num, const int face) {
+  using Constants::c;
+  Photon source_photon;
+  RNG rng(seed, stream_num);
+  const auto u = sampler.get_sample(isample, rng);
+  source_photon.set_source_type(1);
+  source_photon.set_position(get_position_on_face(cell, &u[0], face));
+  source_photon.set_angle(get_angle_on_face(u[3], u[4], face));
+  source_photon.set_E0(phtn_E);
+  source_photon.set_distance_to_census(u[5] * c * dt);
+  source_photon.set_cell(cell.get_global_index());
+  source_photon.set_group(std::floor(rng.generate_random_number() * double(BRANSON_N_GROUPS)));
+  source_photon.set_rng(rng);
+  return source_photon;
+}
+
 //! Set input photon to the next intiial census photon
 inline Photon get_initial_census_photon(const Cell &cell, const double &phtn_E, const double &dt, const uint32_t seed, const uint64_t stream_num) {
   using Constants::c;
@@ -75,8 +116,8 @@ inline Photon get_initial_census_photon(const Cell &cell, const double &phtn_E,
 
 
 //! Make the census photons on cycle 0
-std::vector<Photon> make_initial_census_photons(const double dt, const Mesh &mesh, const int rank, const uint32_t seed, const uint64_t n_user_photons, const double total_E) {
-  std::vector<Photon> initial_census_photons;
+Photon_Vector make_initial_census_photons(const double dt, const Mesh &mesh, const int rank, const uint32_t seed, const uint64_t n_user_photons, const double total_E) {
+  Photon_Vector initial_census_photons;
   auto E_cell_census = mesh.get_census_E();
   const uint64_t rank_stream_num_offset{n_user_photons * rank};
   uint64_t ith_census = 0;
@@ -98,10 +139,14 @@ std::vector<Photon> make_initial_census_photons(const double dt, const Mesh &mes
   return initial_census_photons;
 }
 
-std::vector<Photon> make_photons(const double dt, const Mesh &mesh, const int rank, const uint32_t cycle, const uint32_t seed, const uint64_t n_user_photons, const double total_E) {
+Photon_Vector make_photons(const double dt, const Mesh &mesh, const int rank, const uint32_t cycle, const uint32_t seed, const uint64_t n_user_photons, const double total_E, const uint32_t sampling_mode) {
+  using Constants::UNIFORM_SAMPLING;
 
   auto E_cell_emission = mesh.get_emission_E();
   auto E_cell_source = mesh.get_source_E();
+  const auto &emission_tilt = mesh.get_emission_tilt();
+  const bool use_tilt = !emission_tilt.empty();
+  const std::array<double, 3> no_tilt{0.0, 0.0, 0.0};
   // for RNG offsets, each cycle allows for one hundred million particles across one hundred
   // thousand ranks, increment the ten trillon place for the next cycle, using cycle plus one for
   // the cycle offset gives the initial census their own space
@@ -132,7 +177,7 @@ std::vector<Photon> make_photons(const double dt, const Mesh &mesh, const int ra
     }
   }
 
-  std::vector<Photon> all_photons;
+  Photon_Vector all_photons;
   all_photons.reserve(photons_to_make);
 
   // use this to increment the seed for each particle
@@ -148,9 +193,22 @@ std::vector<Photon> make_photons(const double dt, const Mesh &mesh, const int ra
       if (t_num_emission == 0)
         t_num_emission = 1;
       const double photon_emission_E = E_cell_emission[i] / t_num_emission;
-      for (uint32_t p=0; p<t_num_emission;++p) {
-        all_photons.push_back(get_emission_photon(cell, photon_emission_E, dt, seed, (cycle_stream_num_offset + rank_stream_num_offset+ith_photon)));
-        ith_photon++;
+      if (sampling_mode == UNIFORM_SAMPLING && !use_tilt) {
+        for (uint32_t p=0; p<t_num_emission;++p) {
+          all_photons.push_back(get_emission_photon(cell, photon_emission_E, dt, seed, (cycle_stream_num_offset + rank_stream_num_offset+ith_photon)));
+          ith_photon++;
+        }
+      }
+      else {
+        // strata are keyed on the stream of the first photon in this cell, the uniform sampler
+        // draws in the same order as get_emission_photon
+        const uint64_t cell_stream_num = cycle_stream_num_offset + rank_stream_num_offset + ith_photon;
+        Source_Sampler sampler(sampling_mode, 3, t_num_emission, seed, cell_stream_num);
+        const auto &tilt = use_tilt ? emission_tilt[i] : no_tilt;
+        for (uint32_t p=0; p<t_num_emission;++p) {
+          all_photons.push_back(get_sampled_emission_photon(cell, photon_emission_E, dt, sampler, p, tilt, seed, (cycle_stream_num_offset + rank_stream_num_offset+ith_photon)));
+          ith_photon++;
+        }
       }
     }
     if (E_cell_source[i] > 0.0) {
@@ -162,9 +220,19 @@ std::vector<Photon> make_photons(const double dt, const Mesh &mesh, const int ra
         t_num_source = 1;
       const double photon_source_E = E_cell_source[i] / t_num_source;
       const int face = cell.get_source_face();
-      for (uint32_t p=0; p<t_num_source;++p) {
-        all_photons.push_back(get_boundary_source_photon(cell, photon_source_E, dt, seed, (cycle_stream_num_offset + rank_stream_num_offset+ith_photon), face));
-        ith_photon++;
+      if (sampling_mode == UNIFORM_SAMPLING) {
+        for (uint32_t p=0; p<t_num_source;++p) {
+          all_photons.push_back(get_boundary_source_photon(cell, photon_source_E, dt, seed, (cycle_stream_num_offset + rank_stream_num_offset+ith_photon), face));
+          ith_photon++;
+        }
+      }
+      else {
+        const uint64_t cell_stream_num = cycle_stream_num_offset + rank_stream_num_offset + ith_photon;
+        Source_Sampler sampler(sampling_mode, 2, t_num_source, seed, cell_stream_num);
+        for (uint32_t p=0; p<t_num_source;++p) {
+          all_photons.push_back(get_sampled_boundary_source_photon(cell, photon_source_E, dt, sampler, p, seed, (cycle_stream_num_offset + rank_stream_num_offset+ith_photon), face));
+          ith_photon++;
+        }
       }
     }
   }
@@ -0,0 +1,159 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   source_sampler.h
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Stratified and quasi-Monte Carlo sampling for sourced photons
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#ifndef source_sampler_h_
+#define source_sampler_h_
+
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include "RNG.h"
+#include "constants.h"
+
+//! Number of unit values needed per photon: position (3), angle (2), census time (1)
+constexpr uint32_t n_source_sample_dims = 6;
+
+//! Spawn key for the per-cell strata generator (photon streams use spawn zero)
+constexpr uint64_t source_strata_spawn = 1;
+
+//! Return the Sobol direction numbers for the six source dimensions (Joe-Kuo table)
+inline const std::array<std::array<uint32_t, 32>, n_source_sample_dims> &
+get_sobol_directions() {
+  static const std::array<std::array<uint32_t, 32>, n_source_sample_dims> directions = []() {
+    // primitive polynomial degree, coefficients and initial direction numbers for dimensions 2-6
+    const uint32_t s[5] = {1, 2, 3, 3, 4};
+    const uint32_t a[5] = {0, 1, 1, 2, 1};
+    const uint32_t m[5][4] = {{1, 0, 0, 0}, {1, 3, 0, 0}, {1, 3, 1, 0}, {1, 1, 1, 0}, {1, 1, 3, 3}};
+    std::array<std::array<uint32_t, 32>, n_source_sample_dims> v;
+    // first dimension is the van der Corput sequence
+    for (uint32_t k = 0; k < 32; ++k)
+      v[0][k] = 1u << (31 - k);
+    for (uint32_t d = 1; d < n_source_sample_dims; ++d) {
+      const uint32_t sd = s[d - 1];
+      for (uint32_t k = 0; k < sd; ++k)
+        v[d][k] = m[d - 1][k] << (31 - k);
+      for (uint32_t k = sd; k < 32; ++k) {
+        v[d][k] = v[d][k - sd] ^ (v[d][k - sd] >> sd);
+        for (uint32_t j = 1; j < sd; ++j)
+          v[d][k] ^= ((a[d - 1] >> (sd - 1 - j)) & 1u) * v[d][k - j];
+      }
+    }
+    return v;
+  }();
+  return directions;
+}
+
+//==============================================================================
+/*!
+ * \class Source_Sampler
+ * \brief Unit hypercube points for the photons sourced in one cell
+ *
+ * Stratified mode jitters samples in a grid of position strata, the eight
+ * octant-like angle strata and one census time stratum per photon. Each group
+ * of strata is visited through an independent random permutation, so every
+ * photon is still uniformly distributed and the estimate stays unbiased. Sobol
+ * mode uses a randomly digit-shifted Sobol sequence with the shift drawn once
+ * per cell. The per-cell randomness comes from a spawned stream so it is
+ * independent of the photon streams and reproducible on any rank count.
+ */
+//==============================================================================
+class Source_Sampler {
+public:
+  //! Constructor
+  Source_Sampler(const uint32_t _mode, const uint32_t _n_position_dims, const uint32_t _n_samples,
+                 const uint32_t seed, const uint64_t cell_stream_num)
+      : mode(_mode), n_position_dims(_n_position_dims), n_samples(_n_samples),
+        n_position_strata(1) {
+    RNG strata_rng(seed, cell_stream_num, source_strata_spawn);
+    if (mode == Constants::SOBOL_SAMPLING) {
+      for (auto &shift : sobol_shift)
+        shift = static_cast<uint32_t>(strata_rng.generate_random_number() * 4294967296.0);
+    } else if (mode == Constants::STRATIFIED_SAMPLING) {
+      // largest grid with at most one stratum per sample
+      n_position_strata =
+          static_cast<uint32_t>(std::pow(double(n_samples), 1.0 / double(n_position_dims)) + 1.0e-9);
+      if (n_position_strata == 0)
+        n_position_strata = 1;
+      uint32_t n_grid = 1;
+      for (uint32_t d = 0; d < n_position_dims; ++d)
+        n_grid *= n_position_strata;
+      position_perm = make_permutation(n_grid, strata_rng);
+      angle_perm = make_permutation(n_angle_strata, strata_rng);
+      time_perm = make_permutation(n_samples, strata_rng);
+    }
+  }
+
+  //! Return the unit point [position(3), angle(2), time(1)] for a sample in this cell
+  std::array<double, n_source_sample_dims> get_sample(const uint32_t isample, RNG &rng) const {
+    std::array<double, n_source_sample_dims> u;
+    if (mode == Constants::SOBOL_SAMPLING) {
+      const auto &v = get_sobol_directions();
+      const uint32_t gray = isample ^ (isample >> 1);
+      for (uint32_t d = 0; d < n_source_sample_dims; ++d) {
+        uint32_t x = sobol_shift[d];
+        for (uint32_t k = 0; k < 32; ++k) {
+          if ((gray >> k) & 1u)
+            x ^= v[d][k];
+        }
+        // center in the 2^-32 interval so values are never exactly 0 or 1
+        u[d] = (double(x) + 0.5) * 2.3283064365386963e-10;
+      }
+    } else if (mode == Constants::STRATIFIED_SAMPLING) {
+      uint32_t s = position_perm[isample % position_perm.size()];
+      for (uint32_t d = 0; d < 3; ++d) {
+        const uint32_t s_d = (d < n_position_dims) ? s % n_position_strata : 0;
+        const uint32_t n_d = (d < n_position_dims) ? n_position_strata : 1;
+        u[d] = (s_d + rng.generate_random_number()) / n_d;
+        if (d < n_position_dims)
+          s /= n_position_strata;
+      }
+      const uint32_t a = angle_perm[isample % n_angle_strata];
+      u[3] = ((a & 1u) + rng.generate_random_number()) * 0.5;
+      u[4] = ((a >> 1) + rng.generate_random_number()) * 0.25;
+      u[5] = (time_perm[isample % n_samples] + rng.generate_random_number()) / n_samples;
+    } else {
+      for (auto &u_d : u)
+        u_d = rng.generate_random_number();
+    }
+    return u;
+  }
+
+private:
+  //! Two polar by four azimuthal angle strata
+  static constexpr uint32_t n_angle_strata = 8;
+
+  //! Return a random permutation of 0..n-1 (Fisher-Yates)
+  static std::vector<uint32_t> make_permutation(const uint32_t n, RNG &rng) {
+    std::vector<uint32_t> perm(n);
+    std::iota(perm.begin(), perm.end(), 0);
+    for (uint32_t i = n; i > 1; --i) {
+      const uint32_t j = static_cast<uint32_t>(rng.generate_random_number() * i);
+      std::swap(perm[i - 1], perm[j < i ? j : i - 1]);
+    }
+    return perm;
+  }
+
+  uint32_t mode;              //!< Sampling method (see Constants)
+  uint32_t n_position_dims;   //!< Stratified position dimensions (3 in cell, 2 on face)
+  uint32_t n_samples;         //!< Photons sourced in this cell
+  uint32_t n_position_strata; //!< Position strata in each dimension
+  std::vector<uint32_t> position_perm; //!< Visiting order of position strata
+  std::vector<uint32_t> angle_perm;    //!< Visiting order of angle strata
+  std::vector<uint32_t> time_perm;     //!< Visiting order of census time strata
+  std::array<uint32_t, n_source_sample_dims> sobol_shift; //!< Random digital shift
+};
+
+#endif // source_sampler_h_
+//---------------------------------------------------------------------------//
+// end of source_sampler.h
+//---------------------------------------------------------------------------//
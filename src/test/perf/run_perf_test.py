@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+# Run one reduced problem and compare its FOM and conservation to this machine's baseline
+#
+# usage: run_perf_test.py --input file.xml --dd <REPLICATED|PARTICLE_PASS> --name NAME
+#          --baseline-file FILE [--fom-tolerance 0.15] [--conservation-tolerance 1e-10]
+#          [--repeat 3] [--update] -- <mpiexec ...> BRANSON
+#
+# The problem is run --repeat times and the best FOM kept, which filters out most of the noise
+# from other work on the machine. The baseline file has one "name fom conservation" line per
+# problem. The test fails when the FOM drops by more than the FOM tolerance (a fraction of the
+# baseline) or the relative conservation error grows by more than the conservation tolerance.
+# With --update the measured values replace the baseline. A problem without a baseline is
+# skipped (exit code 77).
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+SKIP = 77
+
+###############################################################################
+def read_baselines(file_name):
+  baselines = {}
+  if os.path.exists(file_name):
+    with open(file_name) as f:
+      for line in f:
+        fields = line.split()
+        if len(fields) == 3 and not line.startswith("#"):
+          baselines[fields[0]] = (float(fields[1]), float(fields[2]))
+  return baselines
+###############################################################################
+def write_baselines(file_name, baselines):
+  os.makedirs(os.path.dirname(os.path.abspath(file_name)), exist_ok=True)
+  with open(file_name, "w") as f:
+    f.write("# name fom conservation\n")
+    for name in sorted(baselines):
+      f.write("{0} {1:.6g} {2:.6g}\n".format(name, *baselines[name]))
+###############################################################################
+def max_relative_conservation(output):
+  # radiation error over the radiation energy in play, material error over material energy
+  number = r"([-+0-9.eE]+)"
+  emission = re.findall(r"Emission E: " + number + r", Source E: " + number +
+                        r", Absorption E: " + number, output)
+  pre_census = re.findall(r"Pre census E: " + number, output)
+  pre_mat = re.findall(r"Pre mat E: " + number, output)
+  rad = re.findall(r"Radiation conservation: " + number, output)
+  mat = re.findall(r"Material conservation: " + number, output)
+  if not rad or not (len(rad) == len(mat) == len(emission) == len(pre_census) == len(pre_mat)):
+    sys.exit("could not read conservation from the BRANSON output")
+  worst = 0.0
+  for i in range(len(rad)):
+    emission_E, source_E, absorbed_E = [float(e) for e in emission[i]]
+    rad_E = float(pre_census[i]) + emission_E + source_E
+    mat_E = float(pre_mat[i]) + absorbed_E
+    if rad_E > 0.0:
+      worst = max(worst, abs(float(rad[i])) / rad_E)
+    if mat_E > 0.0:
+      worst = max(worst, abs(float(mat[i])) / mat_E)
+  return worst
+###############################################################################
+
+parser = argparse.ArgumentParser(description="BRANSON performance regression test")
+parser.add_argument("--input", required=True, help="reduced input file")
+parser.add_argument("--dd", required=True, choices=["REPLICATED", "PARTICLE_PASS"])
+parser.add_argument("--name", required=True, help="name of this run in the baseline file")
+parser.add_argument("--baseline-file", required=True)
+parser.add_argument("--fom-tolerance", type=float, default=0.15)
+parser.add_argument("--conservation-tolerance", type=float, default=1.0e-10)
+parser.add_argument("--repeat", type=int, default=3, help="runs, the best FOM is kept")
+parser.add_argument("--update", action="store_true", help="record the baseline instead")
+parser.add_argument("command", nargs=argparse.REMAINDER, help="-- mpiexec ... BRANSON")
+args = parser.parse_args()
+command = args.command[1:] if args.command[:1] == ["--"] else args.command
+
+baselines = read_baselines(args.baseline_file)
+if not args.update and args.name not in baselines:
+  print("no baseline for {0} in {1}, configure with BRANSON_PERF_UPDATE_BASELINES=ON and run "
+        "ctest -L perf to record one".format(args.name, args.baseline_file))
+  sys.exit(SKIP)
+
+# same problem with the transport method of this run
+with open(args.input) as f:
+  deck = f.read()
+deck = re.sub(r"<dd_transport_type>[^<]*</dd_transport_type>",
+              "<dd_transport_type>{0}</dd_transport_type>".format(args.dd), deck)
+run_input = "{0}.xml".format(args.name)
+with open(run_input, "w") as f:
+  f.write(deck)
+
+fom = 0.0
+conservation = 0.0
+for i in range(max(args.repeat, 1)):
+  run = subprocess.run(command + [run_input], stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                       universal_newlines=True)
+  if run.returncode != 0:
+    print(run.stdout)
+    os.remove(run_input)
+    sys.exit("BRANSON exited with {0}".format(run.returncode))
+  fom_match = re.search(r"Photons Per Second \(FOM\): ([-+0-9.eE]+)", run.stdout)
+  if not fom_match:
+    print(run.stdout)
+    os.remove(run_input)
+    sys.exit("could not read the FOM from the BRANSON output")
+  fom = max(fom, float(fom_match.group(1)))
+  conservation = max(conservation, max_relative_conservation(run.stdout))
+os.remove(run_input)
+print("{0}: best FOM of {1} runs {2:.6g}, max relative conservation error {3:.3g}".format(
+  args.name, max(args.repeat, 1), fom, conservation))
+
+if args.update:
+  baselines[args.name] = (fom, conservation)
+  write_baselines(args.baseline_file, baselines)
+  print("baseline written to {0}".format(args.baseline_file))
+  sys.exit(0)
+
+base_fom, base_conservation = baselines[args.name]
+print("baseline: FOM {0:.6g}, max relative conservation error {1:.3g}".format(
+  base_fom, base_conservation))
+failed = False
+if fom < (1.0 - args.fom_tolerance) * base_fom:
+  print("FOM regressed by {0:.1f}% (tolerance {1:.1f}%)".format(
+    100.0 * (1.0 - fom / base_fom), 100.0 * args.fom_tolerance))
+  failed = True
+elif fom > (1.0 + args.fom_tolerance) * base_fom:
+  print("FOM improved by {0:.1f}%, consider updating the baseline".format(
+    100.0 * (fom / base_fom - 1.0)))
+if conservation > base_conservation + args.conservation_tolerance:
+  print("conservation error grew beyond the baseline by more than {0:.3g}".format(
+    args.conservation_tolerance))
+  failed = True
+sys.exit(1 if failed else 0)
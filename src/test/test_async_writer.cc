@@ -0,0 +1,109 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   test_async_writer.cc
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Test ordering and the queue bound of the background output writer
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "../async_writer.h"
+#include "testing_functions.h"
+
+int main(void) {
+
+  using std::cout;
+  using std::endl;
+  using std::vector;
+
+  int nfail = 0;
+
+  // tasks run in order on the I/O thread and never more than max_pending are outstanding
+  {
+    bool queue_pass = true;
+    const uint32_t max_pending = 2;
+    const int n_tasks = 8;
+    vector<int> order;
+    std::atomic<int> n_submitted(0), n_finished(0);
+    int max_outstanding = 0;
+    const std::thread::id caller = std::this_thread::get_id();
+    bool ran_on_caller = false;
+    {
+      Async_Writer writer(max_pending);
+      for (int i = 0; i < n_tasks; ++i) {
+        writer.submit([&, i] {
+          // only the I/O thread touches these
+          if (std::this_thread::get_id() == caller)
+            ran_on_caller = true;
+          std::this_thread::sleep_for(std::chrono::milliseconds(5));
+          order.push_back(i);
+          n_finished++;
+        });
+        // tasks still counted here are queued or running
+        n_submitted++;
+        max_outstanding = std::max(max_outstanding, n_submitted - n_finished);
+      }
+      // slow tasks fill the queue so later submits wait
+      if (writer.get_n_blocked() == 0)
+        queue_pass = false;
+      writer.wait();
+      if (n_finished != n_tasks)
+        queue_pass = false;
+    }
+    if (ran_on_caller || max_outstanding > int(max_pending))
+      queue_pass = false;
+    for (int i = 0; i < n_tasks; ++i) {
+      if (order.size() != size_t(n_tasks) || order[i] != i)
+        queue_pass = false;
+    }
+
+    if (queue_pass)
+      cout << "TEST PASSED: Async_Writer ordered and bounded queue" << endl;
+    else {
+      cout << "TEST FAILED: Async_Writer ordered and bounded queue" << endl;
+      nfail++;
+    }
+  }
+
+  // the destructor finishes outstanding tasks and a zero queue runs tasks in submit
+  {
+    bool drain_pass = true;
+    std::atomic<int> n_finished(0);
+    {
+      Async_Writer writer(4);
+      for (int i = 0; i < 3; ++i)
+        writer.submit([&] {
+          std::this_thread::sleep_for(std::chrono::milliseconds(5));
+          n_finished++;
+        });
+    }
+    if (n_finished != 3)
+      drain_pass = false;
+
+    Async_Writer inline_writer(0);
+    bool ran = false;
+    inline_writer.submit([&] { ran = true; });
+    if (!ran || inline_writer.get_n_blocked() != 0)
+      drain_pass = false;
+
+    if (drain_pass)
+      cout << "TEST PASSED: Async_Writer drains on destruction and runs inline" << endl;
+    else {
+      cout << "TEST FAILED: Async_Writer drains on destruction and runs inline" << endl;
+      nfail++;
+    }
+  }
+
+  return nfail;
+}
+//---------------------------------------------------------------------------//
+// end of test_async_writer.cc
+//---------------------------------------------------------------------------//
@@ -0,0 +1,92 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   test_benchmark_problem.cc
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Test the rank grid and generated input of the synthetic benchmark
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+#include "../benchmark_problem.h"
+#include "../constants.h"
+#include "../input.h"
+#include "../mpi_types.h"
+#include "testing_functions.h"
+
+int main(int argc, char *argv[]) {
+
+  MPI_Init(&argc, &argv);
+
+  using std::cout;
+  using std::endl;
+
+  int nfail = 0;
+
+  // weak scaling factors the ranks into a near-cubic grid, strong scaling uses one block
+  {
+    bool grid_pass = true;
+    Benchmark_Problem problem;
+    auto sorted_grid = [&](const int n_ranks) {
+      std::array<uint32_t, 3> grid = problem.get_rank_grid(n_ranks);
+      std::sort(grid.begin(), grid.end());
+      return grid;
+    };
+    if (sorted_grid(1) != std::array<uint32_t, 3>{1, 1, 1} ||
+        sorted_grid(8) != std::array<uint32_t, 3>{2, 2, 2} ||
+        sorted_grid(12) != std::array<uint32_t, 3>{2, 2, 3} ||
+        sorted_grid(7) != std::array<uint32_t, 3>{1, 1, 7} ||
+        sorted_grid(36) != std::array<uint32_t, 3>{3, 3, 4})
+      grid_pass = false;
+    if (problem.get_total_photons(12) != 12 * problem.photons)
+      grid_pass = false;
+    problem.weak = false;
+    if (sorted_grid(12) != std::array<uint32_t, 3>{1, 1, 1} ||
+        problem.get_total_photons(12) != problem.photons)
+      grid_pass = false;
+
+    if (grid_pass)
+      cout << "TEST PASSED: Benchmark_Problem rank grid and photons" << endl;
+    else {
+      cout << "TEST FAILED: Benchmark_Problem rank grid and photons" << endl;
+      nfail++;
+    }
+  }
+
+  // the generated XML text is read by Input without a file
+  {
+    bool input_pass = true;
+    MPI_Types mpi_types;
+    Benchmark_Problem problem;
+    problem.cells = 4;
+    problem.photons = 1000;
+    problem.steps = 3;
+    problem.tau = 2.0;
+    problem.dd_mode = "REPLICATED";
+    Input input(problem.make_input(8), mpi_types, true);
+    if (input.get_global_n_x_cells() != 8 || input.get_global_n_y_cells() != 8 ||
+        input.get_global_n_z_cells() != 8 || input.get_number_photons() != 8000 ||
+        input.get_dd_mode() != Constants::REPLICATED ||
+        !soft_equiv(input.get_time_finish(), 3 * input.get_dt()))
+      input_pass = false;
+
+    if (input_pass)
+      cout << "TEST PASSED: Input from benchmark XML text" << endl;
+    else {
+      cout << "TEST FAILED: Input from benchmark XML text" << endl;
+      nfail++;
+    }
+  }
+
+  MPI_Finalize();
+
+  return nfail;
+}
+//---------------------------------------------------------------------------//
+// end of test_benchmark_problem.cc
+//---------------------------------------------------------------------------//
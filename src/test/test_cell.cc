@@ -11,6 +11,7 @@
 
 #include "../cell.h"
 #include "../constants.h"
+#include "../opacity_rows.h"
 #include "testing_functions.h"
 #include <iostream>
 #include <vector>
@@ -223,6 +224,81 @@ int main(void) {
     }
   }
 
+  // group opacities come from shared rows, one per region and temperature bin
+  {
+    bool opacity_row_pass = true;
+    Cell row_cell;
+    row_cell.set_op_a(2.0);
+    row_cell.set_op_s(0.5);
+    // without a row every group sees the gray opacities
+    for (uint32_t g = 0; g < BRANSON_N_GROUPS; ++g) {
+      if (row_cell.get_op_a(g) != 2.0 || row_cell.get_op_s(g) != 0.5)
+        opacity_row_pass = false;
+    }
+
+    // ten bins per decade: temperatures within a bin share it, its center is in the bin
+    Opacity_Rows rows(10.0);
+    const int32_t bin = rows.get_bin(1.0);
+    if (bin != 0 || rows.get_bin(1.2) != bin || rows.get_bin(1.3) == bin ||
+        rows.get_bin(0.9) != -1 || rows.get_bin(rows.get_bin_T(bin)) != bin ||
+        rows.get_bin(0.0) >= rows.get_bin(1.0e-300))
+      opacity_row_pass = false;
+    if (Opacity_Rows::get_key(1, -1) == Opacity_Rows::get_key(0, -1) ||
+        Opacity_Rows::get_key(1, -1) == Opacity_Rows::get_key(1, 0))
+      opacity_row_pass = false;
+
+    Opacity_Rows::Row hot, cold;
+    for (uint32_t g = 0; g < BRANSON_N_GROUPS; ++g) {
+      hot[g] = 1.0 + g;
+      hot[BRANSON_N_GROUPS + g] = 0.1;
+      cold[g] = 10.0 + g;
+      cold[BRANSON_N_GROUPS + g] = 0.2;
+    }
+    const uint64_t hot_key = Opacity_Rows::get_key(0, rows.get_bin(2.0));
+    const uint64_t cold_key = Opacity_Rows::get_key(0, rows.get_bin(0.5));
+    if (rows.find(hot_key) != nullptr)
+      opacity_row_pass = false;
+    Opacity_Rows::State *hot_state = rows.add(hot_key, hot);
+    const double *hot_row = hot_state->row;
+    const double *cold_row = rows.add(cold_key, cold)->row;
+    // rows stay where they are as more are added
+    for (int32_t b = 100; b < 1000; ++b)
+      rows.add(Opacity_Rows::get_key(1, b), hot);
+    if (rows.find(hot_key) != hot_state || rows.find(hot_key)->row != hot_row ||
+        rows.find(cold_key)->row != cold_row || hot_row[0] != 1.0 ||
+        rows.get_n_rows() != 902 || hot_state->n_cells != 0 || hot_state->key != hot_key)
+      opacity_row_pass = false;
+    // the Planck mean weights every group equally
+    if (!soft_equiv(hot_state->planck_mean, 1.0 + 0.5 * (BRANSON_N_GROUPS - 1), 1.0e-12))
+      opacity_row_pass = false;
+
+    // a removed state's row is reused by the next new state
+    const uint64_t spare_key = Opacity_Rows::get_key(1, 100);
+    const double *spare_row = rows.find(spare_key)->row;
+    rows.remove(spare_key);
+    if (rows.find(spare_key) != nullptr || rows.get_n_rows() != 901)
+      opacity_row_pass = false;
+    if (rows.add(Opacity_Rows::get_key(2, 0), cold)->row != spare_row ||
+        spare_row[0] != 10.0 || rows.get_n_slots() != 902 || rows.get_n_rows() != 902)
+      opacity_row_pass = false;
+
+    row_cell.set_opacity_row(cold_row);
+    for (uint32_t g = 0; g < BRANSON_N_GROUPS; ++g) {
+      if (row_cell.get_op_a(g) != 10.0 + g || row_cell.get_op_s(g) != 0.2)
+        opacity_row_pass = false;
+    }
+    // the gray opacities are kept for the Fleck factor and emission
+    if (row_cell.get_op_a() != 2.0)
+      opacity_row_pass = false;
+
+    if (opacity_row_pass)
+      cout << "TEST PASSED: shared opacity rows" << endl;
+    else {
+      cout << "TEST FAILED: shared opacity rows" << endl;
+      nfail++;
+    }
+  }
+
   return nfail;
 }
 //---------------------------------------------------------------------------//
@@ -0,0 +1,204 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   test_census_store.cc
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Test spilling census photons to the mapped file and reading them back
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#include <iostream>
+#include <vector>
+
+#include "../census_store.h"
+#include "../photon.h"
+#include "testing_functions.h"
+
+int main(void) {
+
+  using std::cout;
+  using std::endl;
+
+  int nfail = 0;
+
+  // photons past the bound go to the file and come back in order, in bounded chunks
+  {
+    bool spill_pass = true;
+    const uint64_t max_in_memory = 4;
+    const uint64_t n_census = 11;
+    Photon_Vector census(n_census);
+    double total_E = 0.0;
+    for (uint64_t i = 0; i < n_census; ++i) {
+      census[i].set_E0(2.0 + i);
+      census[i].set_E(1.0 + i);
+      census[i].set_cell(i);
+      census[i].set_group(i % 3);
+      census[i].set_position({0.5 * i, 1.0, 2.0});
+      census[i].set_angle({0.0, 0.0, 1.0});
+      census[i].set_distance_to_census(3.0);
+      census[i].set_ddmc(i % 2);
+      census[i].set_source_type(0);
+      total_E += census[i].get_E();
+    }
+
+    Census_Store store(max_in_memory, ".", 0);
+    store.spill(census);
+    if (!store.is_enabled() || census.size() != max_in_memory ||
+        store.get_n_spilled() != n_census - max_in_memory)
+      spill_pass = false;
+    double in_memory_E = 0.0;
+    for (auto &p : census)
+      in_memory_E += p.get_E();
+    if (!soft_equiv(in_memory_E + store.get_spilled_E(), total_E, 1.0e-14))
+      spill_pass = false;
+    if (store.get_step_bytes_written() != (n_census - max_in_memory) * sizeof(Census_Store::Record) ||
+        sizeof(Census_Store::Record) >= sizeof(Photon))
+      spill_pass = false;
+
+    // the checkpoint copy, in two pieces, doesn't consume the store
+    Photon_Vector full_census(census);
+    store.append_spilled(0, 3, full_census);
+    store.append_spilled(3, n_census - max_in_memory - 3, full_census);
+    if (full_census.size() != n_census)
+      spill_pass = false;
+
+    Photon_Vector chunk;
+    uint64_t next_cell = max_in_memory;
+    uint64_t n_chunks = 0;
+    while (uint64_t n = store.read_chunk(chunk)) {
+      if (n > max_in_memory || n != chunk.size())
+        spill_pass = false;
+      for (auto &p : chunk) {
+        if (p.get_cell() != next_cell || full_census[next_cell].get_cell() != next_cell)
+          spill_pass = false;
+        // every field census transport needs comes back
+        if (p.get_E() != 1.0 + next_cell || p.get_E0() != 2.0 + next_cell ||
+            p.get_group() != next_cell % 3 || p.get_position()[0] != 0.5 * next_cell ||
+            p.get_angle()[2] != 1.0 || p.get_distance_remaining() != 3.0 ||
+            p.is_ddmc() != bool(next_cell % 2) || p.get_descriptor() != Constants::CENSUS)
+          spill_pass = false;
+        next_cell++;
+      }
+      n_chunks++;
+    }
+    if (next_cell != n_census || n_chunks != 2 || !chunk.empty())
+      spill_pass = false;
+    if (store.get_step_bytes_read() != store.get_step_bytes_written())
+      spill_pass = false;
+
+    // a census under the bound isn't spilled and clears the last spill
+    store.reset_step_io();
+    store.spill(census);
+    if (store.get_n_spilled() != 0 || store.get_spilled_E() != 0.0 || store.read_chunk(chunk) != 0)
+      spill_pass = false;
+
+    if (spill_pass)
+      cout << "TEST PASSED: Census_Store spill and chunked read" << endl;
+    else {
+      cout << "TEST FAILED: Census_Store spill and chunked read" << endl;
+      nfail++;
+    }
+  }
+
+  // census photons flushed during transport come back first, then the ones spilled at the end
+  // of the step, while the last step's spilled photons are still being read
+  {
+    bool flush_pass = true;
+    const uint64_t max_in_memory = 3;
+    auto make_census = [](uint32_t first, uint32_t n) {
+      Photon_Vector census(n);
+      for (uint32_t i = 0; i < n; ++i) {
+        census[i].set_cell(first + i);
+        census[i].set_E(1.0);
+      }
+      return census;
+    };
+
+    Census_Store store(max_in_memory, ".", 1);
+    Photon_Vector last_census = make_census(100, 7);
+    store.spill(last_census);
+    if (store.get_n_spilled() != 4 || store.get_n_flushed() != 0)
+      flush_pass = false;
+
+    // transport reads the old spill and flushes the new census as it fills
+    Photon_Vector chunk, census_list;
+    uint32_t next_old = 103, next_new = 0;
+    while (store.read_chunk(chunk)) {
+      for (auto &p : chunk) {
+        if (p.get_cell() != next_old++)
+          flush_pass = false;
+        Photon new_photon;
+        new_photon.set_cell(next_new++);
+        new_photon.set_E(2.0);
+        census_list.push_back(new_photon);
+        store.flush(census_list);
+        if (census_list.size() >= max_in_memory)
+          flush_pass = false;
+      }
+    }
+    if (next_old != 107 || store.get_n_flushed() != 3 || census_list.size() != 1 ||
+        !soft_equiv(store.get_flushed_E(), 6.0, 1.0e-14))
+      flush_pass = false;
+
+    // drop every other flushed photon, as combing would
+    store.process_flushed([](Photon_Vector &photons, uint64_t) {
+      uint64_t n_kept = 0;
+      for (uint64_t i = 0; i < photons.size(); i += 2)
+        photons[n_kept++] = photons[i];
+      photons.resize(n_kept);
+    });
+    if (store.get_n_flushed() != 2 || !soft_equiv(store.get_flushed_E(), 4.0, 1.0e-14))
+      flush_pass = false;
+
+    // the end of step spill adds the census past the bound after the flushed photons
+    Photon_Vector census = census_list;
+    Photon_Vector late = make_census(50, 4);
+    census.insert(census.end(), late.begin(), late.end());
+    store.spill(census);
+    if (census.size() != max_in_memory || store.get_n_spilled() != 4 ||
+        store.get_n_flushed() != 0)
+      flush_pass = false;
+    const uint32_t expected_cells[4] = {0, 2, 52, 53};
+    uint32_t n_seen = 0;
+    while (store.read_chunk(chunk)) {
+      for (auto &p : chunk) {
+        if (n_seen < 4 && p.get_cell() != expected_cells[n_seen])
+          flush_pass = false;
+        n_seen++;
+      }
+    }
+    if (n_seen != 4)
+      flush_pass = false;
+
+    if (flush_pass)
+      cout << "TEST PASSED: Census_Store flush during transport" << endl;
+    else {
+      cout << "TEST FAILED: Census_Store flush during transport" << endl;
+      nfail++;
+    }
+  }
+
+  // a zero bound never spills
+  {
+    bool disabled_pass = true;
+    Photon_Vector census(5);
+    Census_Store store(0, ".", 0);
+    store.spill(census);
+    if (store.is_enabled() || census.size() != 5 || store.get_n_spilled() != 0)
+      disabled_pass = false;
+
+    if (disabled_pass)
+      cout << "TEST PASSED: Census_Store disabled with zero bound" << endl;
+    else {
+      cout << "TEST FAILED: Census_Store disabled with zero bound" << endl;
+      nfail++;
+    }
+  }
+
+  return nfail;
+}
+//---------------------------------------------------------------------------//
+// end of test_census_store.cc
+//---------------------------------------------------------------------------//
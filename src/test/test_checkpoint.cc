@@ -0,0 +1,265 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   test_checkpoint.cc
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Test writing and reading checkpoints and redistribution to owning ranks
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../checkpoint.h"
+#include "../imc_parameters.h"
+#include "../mesh.h"
+#include "../mpi_types.h"
+#include "testing_functions.h"
+
+int main(int argc, char *argv[]) {
+
+  MPI_Init(&argc, &argv);
+
+  int rank, n_rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &n_rank);
+
+  using std::cout;
+  using std::endl;
+  using std::string;
+  using std::vector;
+
+  int nfail = 0;
+
+  // temperatures, census photons and the step state come back as they were written
+  {
+    const Info mpi_info;
+    MPI_Types mpi_types;
+    Input input(string("simple_input.xml"), mpi_types);
+    IMC_Parameters imc_p(input);
+    IMC_State imc_state(input, rank);
+    Mesh mesh(input, mpi_types, mpi_info, imc_p);
+    mesh.initialize_physical_properties(input);
+
+    bool round_trip_pass = true;
+    const bool replicated = false;
+    const uint32_t n_cell = mesh.get_n_local_cells();
+
+    // values that depend only on the undecomposed cell index
+    auto T_e_of = [](uint32_t silo_index) { return 1.0 + 1.0e-3 * silo_index; };
+    auto T_r_of = [](uint32_t silo_index) { return 2.0 + 1.0e-3 * silo_index; };
+    Photon_Vector census;
+    for (uint32_t i = 0; i < n_cell; ++i) {
+      const uint32_t silo_index = mesh.get_cell_ref(i).get_silo_index();
+      mesh.set_temperatures(i, T_e_of(silo_index), T_r_of(silo_index));
+      Photon photon;
+      photon.set_cell(mesh.get_offset() + i);
+      photon.set_E0(3.0 + silo_index);
+      photon.set_E(3.0 + silo_index);
+      census.push_back(photon);
+    }
+    IMC_State::Checkpoint_Data data = {0.5, 0.01, 4.0, 7, 11, 13};
+    imc_state.set_checkpoint_data(data);
+
+    const string file_name =
+        Checkpoint::write(".", mesh, imc_state, census, mpi_info, replicated);
+
+    // scramble the state then read it back
+    for (uint32_t i = 0; i < n_cell; ++i)
+      mesh.set_temperatures(i, 0.0, 0.0);
+    imc_state.set_checkpoint_data({0.0, 0.0, 0.0, 1, 0, 0});
+    Photon_Vector restored;
+    Checkpoint::read(file_name, mesh, imc_state, restored, mpi_info, replicated);
+
+    for (uint32_t i = 0; i < n_cell; ++i) {
+      const uint32_t silo_index = mesh.get_cell_ref(i).get_silo_index();
+      if (mesh.get_cell_ref(i).get_T_e() != T_e_of(silo_index) ||
+          mesh.get_T_r(i) != T_r_of(silo_index))
+        round_trip_pass = false;
+    }
+    if (restored.size() != census.size())
+      round_trip_pass = false;
+    for (size_t p = 0; p < restored.size() && round_trip_pass; ++p) {
+      if (restored[p].get_cell() != census[p].get_cell() ||
+          restored[p].get_E() != census[p].get_E())
+        round_trip_pass = false;
+    }
+    const IMC_State::Checkpoint_Data read_data = imc_state.get_checkpoint_data();
+    if (read_data.time != data.time || read_data.dt != data.dt || read_data.step != data.step ||
+        read_data.total_particles_sent != data.total_particles_sent)
+      round_trip_pass = false;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (rank == 0)
+      std::remove(file_name.c_str());
+
+    if (round_trip_pass)
+      cout << "TEST PASSED: checkpoint write and read" << endl;
+    else {
+      cout << "TEST FAILED: checkpoint write and read" << endl;
+      nfail++;
+    }
+  }
+
+  // a file from another rank count is read in even shares and sent to the owners, found
+  // through the distributed directory
+  {
+    const Info mpi_info;
+    MPI_Types mpi_types;
+    Input input(string("simple_input.xml"), mpi_types);
+    IMC_Parameters imc_p(input);
+    IMC_State imc_state(input, rank);
+    Mesh mesh(input, mpi_types, mpi_info, imc_p);
+    mesh.initialize_physical_properties(input);
+
+    bool directory_pass = true;
+    const bool replicated = false;
+    const uint32_t n_cell = mesh.get_n_local_cells();
+    const uint32_t n_global = mesh.get_n_global_cells();
+
+    // every index has one owner, indices outside the mesh have none
+    vector<uint32_t> wanted;
+    for (uint32_t s = 0; s <= n_global; ++s)
+      wanted.push_back(s);
+    const vector<int32_t> owners = Checkpoint::find_owners(wanted, mesh, rank, n_rank);
+    uint32_t n_mine = 0;
+    for (uint32_t s = 0; s < n_global; ++s) {
+      if (owners[s] < 0 || owners[s] >= n_rank)
+        directory_pass = false;
+      n_mine += owners[s] == rank;
+    }
+    if (owners[n_global] != -1 || n_mine != n_cell)
+      directory_pass = false;
+    for (uint32_t i = 0; i < n_cell; ++i) {
+      if (owners[mesh.get_cell_ref(i).get_silo_index()] != rank)
+        directory_pass = false;
+    }
+
+    // two photons in each cell
+    auto T_e_of = [](uint32_t silo_index) { return 1.0 + 1.0e-3 * silo_index; };
+    Photon_Vector census;
+    for (uint32_t i = 0; i < n_cell; ++i) {
+      const uint32_t silo_index = mesh.get_cell_ref(i).get_silo_index();
+      mesh.set_temperatures(i, T_e_of(silo_index), 0.5);
+      for (int k = 0; k < 2; ++k) {
+        Photon photon;
+        photon.set_cell(mesh.get_offset() + i);
+        photon.set_E(3.0 + silo_index);
+        census.push_back(photon);
+      }
+    }
+    const string file_name =
+        Checkpoint::write(".", mesh, imc_state, census, mpi_info, replicated);
+
+    // rewrite it as if one rank wrote the records of the last rank first, so an even share
+    // holds another rank's cells
+    if (rank == 0) {
+      std::FILE *in = std::fopen(file_name.c_str(), "rb");
+      Checkpoint::Header header;
+      directory_pass = directory_pass && std::fread(&header, sizeof(header), 1, in) == 1;
+      vector<Checkpoint::Rank_Entry> table(header.n_ranks);
+      directory_pass = directory_pass && std::fread(table.data(), sizeof(Checkpoint::Rank_Entry),
+                                                    table.size(), in) == table.size();
+      Checkpoint::Rank_Entry total = {0, 0};
+      for (auto const &entry : table) {
+        total.n_cells += entry.n_cells;
+        total.n_photons += entry.n_photons;
+      }
+      vector<Checkpoint::Cell_Record> cells(total.n_cells);
+      vector<Photon> photons(total.n_photons);
+      directory_pass = directory_pass &&
+                       std::fread(cells.data(), sizeof(Checkpoint::Cell_Record), cells.size(),
+                                  in) == cells.size() &&
+                       std::fread(photons.data(), sizeof(Photon), photons.size(), in) ==
+                           photons.size();
+      std::fclose(in);
+      const uint64_t last_cells = table.back().n_cells, last_photons = table.back().n_photons;
+      std::rotate(cells.begin(), cells.end() - last_cells, cells.end());
+      std::rotate(photons.begin(), photons.end() - last_photons, photons.end());
+      header.n_ranks = 1;
+      std::FILE *out = std::fopen(file_name.c_str(), "wb");
+      std::fwrite(&header, sizeof(header), 1, out);
+      std::fwrite(&total, sizeof(total), 1, out);
+      std::fwrite(cells.data(), sizeof(Checkpoint::Cell_Record), cells.size(), out);
+      std::fwrite(photons.data(), sizeof(Photon), photons.size(), out);
+      std::fclose(out);
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    for (uint32_t i = 0; i < n_cell; ++i)
+      mesh.set_temperatures(i, 0.0, 0.0);
+    Photon_Vector restored;
+    Checkpoint::read(file_name, mesh, imc_state, restored, mpi_info, replicated);
+
+    for (uint32_t i = 0; i < n_cell; ++i) {
+      if (mesh.get_cell_ref(i).get_T_e() != T_e_of(mesh.get_cell_ref(i).get_silo_index()))
+        directory_pass = false;
+    }
+    // photons come back to the rank owning their cell, two per cell
+    vector<int> n_in_cell(n_cell, 0);
+    for (auto const &photon : restored) {
+      const uint32_t local = photon.get_cell() - mesh.get_offset();
+      if (local >= n_cell ||
+          photon.get_E() != 3.0 + mesh.get_cell_ref(local).get_silo_index())
+        directory_pass = false;
+      else
+        n_in_cell[local]++;
+    }
+    if (std::count(n_in_cell.begin(), n_in_cell.end(), 2) != int(n_cell))
+      directory_pass = false;
+
+    int all_pass = directory_pass;
+    MPI_Allreduce(MPI_IN_PLACE, &all_pass, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    if (rank == 0)
+      std::remove(file_name.c_str());
+
+    if (all_pass)
+      cout << "TEST PASSED: checkpoint read with another rank count" << endl;
+    else {
+      cout << "TEST FAILED: checkpoint read with another rank count" << endl;
+      nfail++;
+    }
+  }
+
+  // items read on the wrong rank are sent to their owner in order
+  {
+    bool redistribute_pass = true;
+    vector<int> items;
+    for (int i = 0; i < 10; ++i)
+      items.push_back(rank * 100 + i);
+    // items go to rank i % n_rank
+    auto owner = [n_rank](int item) { return (item % 100) % n_rank; };
+    vector<int> received = Checkpoint::redistribute(items, owner, n_rank);
+    for (auto item : received) {
+      if (owner(item) != rank)
+        redistribute_pass = false;
+    }
+    int n_received = received.size();
+    MPI_Allreduce(MPI_IN_PLACE, &n_received, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (n_received != 10 * n_rank)
+      redistribute_pass = false;
+    for (size_t i = 1; i < received.size(); ++i) {
+      if (received[i] / 100 == received[i - 1] / 100 && received[i] < received[i - 1])
+        redistribute_pass = false;
+    }
+
+    if (redistribute_pass)
+      cout << "TEST PASSED: checkpoint redistribution to owning ranks" << endl;
+    else {
+      cout << "TEST FAILED: checkpoint redistribution to owning ranks" << endl;
+      nfail++;
+    }
+  }
+
+  MPI_Finalize();
+
+  return nfail;
+}
+//---------------------------------------------------------------------------//
+// end of test_checkpoint.cc
+//---------------------------------------------------------------------------//
@@ -0,0 +1,127 @@
+//----------------------------------*-C++-*-----------------------------------//
+/*!
+ * \file   test_comb_photons.cc
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Test census combing for cell energy conservation and photon count
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//----------------------------------------------------------------------------//
+
+#include <iostream>
+#include <mpi.h>
+#include <vector>
+
+#include "../RNG.h"
+#include "../comb_photons.h"
+#include "../photon.h"
+#include "testing_functions.h"
+
+int main(int argc, char *argv[]) {
+
+  MPI_Init(&argc, &argv);
+
+  using std::cout;
+  using std::endl;
+  using std::vector;
+
+  int nfail = 0;
+  constexpr uint32_t seed = 777U;
+
+  // comb a census spread unevenly over four cells with a cell offset, energy in each cell must be
+  // unchanged and the census should shrink to about the requested size
+  {
+    bool comb_pass = true;
+    constexpr uint32_t n_cells = 4;
+    constexpr uint32_t cell_offset = 10;
+    const vector<uint32_t> photons_per_cell = {1000, 10, 0, 4000};
+    RNG rng(seed, 1234UL);
+
+    Photon_Vector census;
+    vector<double> pre_comb_E(n_cells, 0.0);
+    for (uint32_t c = 0; c < n_cells; ++c) {
+      for (uint32_t p = 0; p < photons_per_cell[c]; ++p) {
+        Photon phtn;
+        phtn.set_cell(cell_offset + c);
+        phtn.set_E0(rng.generate_random_number() * (c + 1));
+        pre_comb_E[c] += phtn.get_E();
+        census.push_back(phtn);
+      }
+    }
+
+    constexpr uint64_t max_census_photons = 500;
+    comb_photons(census, max_census_photons, n_cells, cell_offset, seed, 1, 0);
+
+    vector<double> post_comb_E(n_cells, 0.0);
+    vector<uint32_t> post_comb_count(n_cells, 0);
+    for (auto const &phtn : census) {
+      post_comb_E[phtn.get_cell() - cell_offset] += phtn.get_E();
+      post_comb_count[phtn.get_cell() - cell_offset]++;
+    }
+    for (uint32_t c = 0; c < n_cells; ++c) {
+      if (!soft_equiv(post_comb_E[c], pre_comb_E[c], 1.0e-10 * (1.0 + pre_comb_E[c])))
+        comb_pass = false;
+      // cells with energy always keep at least one photon
+      if (pre_comb_E[c] > 0.0 && post_comb_count[c] == 0)
+        comb_pass = false;
+    }
+    cout << "Census size after comb: " << census.size() << endl;
+    if (census.size() < max_census_photons / 2 || census.size() > 2 * max_census_photons)
+      comb_pass = false;
+
+    // a census under the cap is left alone
+    const auto combed_size = census.size();
+    comb_photons(census, 2 * combed_size, n_cells, cell_offset, seed, 2, 0);
+    if (census.size() != combed_size)
+      comb_pass = false;
+
+    if (comb_pass)
+      cout << "TEST PASSED: comb_photons conserves cell energy and caps census" << endl;
+    else {
+      cout << "TEST FAILED: comb_photons conserves cell energy and caps census" << endl;
+      nfail++;
+    }
+  }
+
+  // the counting sort orders photons by cell, keeps each cell's photons in order and finds the
+  // start of each cell
+  {
+    bool sort_pass = true;
+    constexpr uint32_t n_cells = 5;
+    constexpr uint32_t cell_offset = 3;
+    const vector<uint32_t> cells = {7, 3, 5, 3, 7, 4, 3, 5, 7, 4};
+    Photon_Vector photons;
+    for (uint32_t i = 0; i < cells.size(); ++i) {
+      Photon phtn;
+      phtn.set_cell(cells[i]);
+      phtn.set_E0(1.0 + i);
+      photons.push_back(phtn);
+    }
+    vector<uint64_t> cell_start;
+    sort_by_cell(photons, n_cells, cell_offset, cell_start);
+
+    const vector<double> expected_E = {2.0, 4.0, 7.0, 6.0, 10.0, 3.0, 8.0, 1.0, 5.0, 9.0};
+    const vector<uint64_t> expected_start = {0, 3, 5, 7, 7, 10};
+    if (photons.size() != expected_E.size() || cell_start != expected_start)
+      sort_pass = false;
+    for (uint32_t i = 0; i < photons.size() && sort_pass; ++i) {
+      if (photons[i].get_E() != expected_E[i])
+        sort_pass = false;
+    }
+
+    if (sort_pass)
+      cout << "TEST PASSED: sort_by_cell stable counting sort" << endl;
+    else {
+      cout << "TEST FAILED: sort_by_cell stable counting sort" << endl;
+      nfail++;
+    }
+  }
+
+  MPI_Finalize();
+
+  return nfail;
+}
+//---------------------------------------------------------------------------//
+// end of test_comb_photons.cc
+//---------------------------------------------------------------------------//
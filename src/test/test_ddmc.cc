@@ -0,0 +1,136 @@
+//----------------------------------*-C++-*-----------------------------------//
+/*!
+ * \file   test_ddmc.cc
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Test DDMC leakage opacities and interface sampling
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//----------------------------------------------------------------------------//
+
+#include <iostream>
+#include <mpi.h>
+#include <vector>
+
+#include "../RNG.h"
+#include "../cell.h"
+#include "../ddmc.h"
+#include "testing_functions.h"
+
+int main(void) {
+
+  using std::cout;
+  using std::endl;
+  using std::vector;
+
+  int nfail = 0;
+  constexpr uint32_t seed = 777U;
+
+  // leakage opacities match the diffusion current and reduce to each other for equal cells
+  {
+    bool leakage_pass = true;
+    const double dx = 0.1;
+    const double sigma = 1000.0;
+    // two equal cells: 2 / (3 dx * 2 sigma dx) = 1 / (3 sigma dx^2)
+    if (!soft_equiv(get_ddmc_interior_leakage(dx, sigma, dx, sigma), 1.0 / (3.0 * sigma * dx * dx),
+                    1.0e-12))
+      leakage_pass = false;
+    // leakage is symmetric in the energy exchanged: dx_i L_ij = dx_j L_ji
+    const double L_ij = get_ddmc_interior_leakage(0.1, 1000.0, 0.3, 50.0);
+    const double L_ji = get_ddmc_interior_leakage(0.3, 50.0, 0.1, 1000.0);
+    if (!soft_equiv(0.1 * L_ij, 0.3 * L_ji, 1.0e-12))
+      leakage_pass = false;
+    // interface leakage is smaller than leakage to an equal DDMC cell when the cell is thin
+    // compared to the extrapolation distance and approaches half of it for thick cells
+    const double L_b = get_ddmc_interface_leakage(dx, sigma);
+    if (!soft_equiv(L_b, 2.0 / (3.0 * dx * (sigma * dx + 2.0 * ddmc_extrapolation)), 1.0e-12))
+      leakage_pass = false;
+    if (!soft_equiv(get_ddmc_interface_leakage(dx, 1.0e6) / get_ddmc_interior_leakage(dx, 1.0e6, dx, 1.0e6),
+                    2.0, 1.0e-4))
+      leakage_pass = false;
+
+    if (leakage_pass)
+      cout << "TEST PASSED: DDMC leakage opacities" << endl;
+    else {
+      cout << "TEST FAILED: DDMC leakage opacities" << endl;
+      nfail++;
+    }
+  }
+
+  // leakage faces are sampled in proportion to their opacities and never through closed faces
+  {
+    bool face_pass = true;
+    Cell cell;
+    cell.set_coor(0.0, 1.0, 0.0, 1.0, 0.0, 1.0);
+    cell.set_leakage_op({1.0, 0.0, 2.0, 0.0, 1.0, 4.0});
+    if (!soft_equiv(cell.get_total_leakage_op(), 8.0, 1.0e-14))
+      face_pass = false;
+    RNG rng(seed, 1UL);
+    constexpr uint32_t n_samples = 200000;
+    vector<uint32_t> counts(6, 0);
+    for (uint32_t i = 0; i < n_samples; ++i)
+      counts[sample_leakage_face(cell, rng)]++;
+    if (counts[1] != 0 || counts[3] != 0)
+      face_pass = false;
+    for (uint32_t face = 0; face < 6; ++face) {
+      const double expected = cell.get_leakage_op(face) / cell.get_total_leakage_op();
+      if (!soft_equiv(double(counts[face]) / n_samples, expected, 5.0e-3))
+        face_pass = false;
+    }
+
+    if (face_pass)
+      cout << "TEST PASSED: sample_leakage_face" << endl;
+    else {
+      cout << "TEST FAILED: sample_leakage_face" << endl;
+      nfail++;
+    }
+  }
+
+  // exit angles point out of the face with mean cosine of mu (1 + 3/2 mu), 17/24
+  {
+    bool exit_pass = true;
+    RNG rng(seed, 2UL);
+    constexpr uint32_t n_samples = 200000;
+    for (uint32_t face = 0; face < 6; ++face) {
+      double mean_mu = 0.0;
+      for (uint32_t i = 0; i < n_samples; ++i) {
+        const std::array<double, 3> angle = get_ddmc_exit_angle(face, rng);
+        const double mu = (face % 2) ? angle[face / 2] : -angle[face / 2];
+        const double norm = angle[0] * angle[0] + angle[1] * angle[1] + angle[2] * angle[2];
+        if (mu < 0.0 || !soft_equiv(norm, 1.0, 1.0e-12))
+          exit_pass = false;
+        mean_mu += mu;
+      }
+      mean_mu /= n_samples;
+      if (!soft_equiv(mean_mu, 17.0 / 24.0, 3.0e-3))
+        exit_pass = false;
+    }
+
+    // acceptance grows with the entering cosine and is capped at one for thin cells
+    if (get_ddmc_acceptance(0.2, 100.0, 1.0) >= get_ddmc_acceptance(0.8, 100.0, 1.0))
+      exit_pass = false;
+    if (get_ddmc_acceptance(1.0, 0.01, 1.0) != 1.0)
+      exit_pass = false;
+
+    // faces are found from positions on them
+    Cell cell;
+    cell.set_coor(0.0, 1.0, 0.0, 2.0, 0.0, 4.0);
+    if (get_face_at_position(cell, {1.0, 1.0, 2.0}) != 1 ||
+        get_face_at_position(cell, {0.5, 0.0, 2.0}) != 2 ||
+        get_face_at_position(cell, {0.5, 1.0, 4.0}) != 5)
+      exit_pass = false;
+
+    if (exit_pass)
+      cout << "TEST PASSED: DDMC interface angles and acceptance" << endl;
+    else {
+      cout << "TEST FAILED: DDMC interface angles and acceptance" << endl;
+      nfail++;
+    }
+  }
+
+  return nfail;
+}
+//---------------------------------------------------------------------------//
+// end of test_ddmc.cc
+//---------------------------------------------------------------------------//
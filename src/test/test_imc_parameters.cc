@@ -64,6 +64,10 @@ int main(int argc, char *argv[]) {
         simple_imc_parameters_pass = false;
       if(imc_parameters.get_use_gpu_transporter_flag() != false)
         simple_imc_parameters_pass = false;
+      if (imc_parameters.get_sampling_mode() != Constants::UNIFORM_SAMPLING)
+        simple_imc_parameters_pass = false;
+      if (imc_parameters.get_use_tilt_flag() != false)
+        simple_imc_parameters_pass = false;
 
       if (simple_imc_parameters_pass)
         cout << "TEST PASSED: simple IMC_Parameters get functions" << endl;
@@ -14,6 +14,7 @@
 #include "../message_counter.h"
 #include "testing_functions.h"
 #include <iostream>
+#include <sstream>
 #include <string>
 
 using std::cout;
@@ -183,6 +184,146 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  // test the packed conservation reduction against one reduction per quantity
+  {
+    MPI_Types mpi_types;
+    bool packed_reduction_pass = true;
+    // setup imc_state
+    string filename("simple_input.xml");
+    Input input(filename, mpi_types);
+    IMC_State imc_state(input, rank);
+
+    // rank dependent values, energies are not exactly representable
+    const double r = rank + 1.0;
+    const double absorbed_E = 0.1 * r;
+    const double emission_E = 0.3 * r;
+    const double source_E = 0.7 / r;
+    const double pre_census_E = 1.1 * r * r;
+    const double post_census_E = 0.9 * r * r;
+    const double pre_mat_E = 2.3 + r;
+    const double post_mat_E = 2.1 + r;
+    const double exit_E = 0.05 * r;
+    const double pop_ctrl_E = -0.01 * r;
+    const uint64_t trans_particles = 5000000000 + 11 * rank;
+    const uint64_t census_size = 3000000000 + 7 * rank;
+    const double transport_time = 1.5 + 0.25 * rank;
+
+    Message_Counter mctr;
+    mctr.reset_counters();
+    mctr.n_particles_sent = 4000000000 + 3 * rank;
+    mctr.n_particle_messages = 100 + rank;
+    mctr.n_sends_posted = 20 + 2 * rank;
+    mctr.n_sends_completed = 19 + 2 * rank;
+    mctr.n_receives_posted = 30 + 3 * rank;
+    mctr.n_receives_completed = 29 + 3 * rank;
+
+    imc_state.set_absorbed_E(absorbed_E);
+    imc_state.set_emission_E(emission_E);
+    imc_state.set_source_E(source_E);
+    imc_state.set_pre_census_E(pre_census_E);
+    imc_state.set_post_census_E(post_census_E);
+    imc_state.set_pre_mat_E(pre_mat_E);
+    imc_state.set_post_mat_E(post_mat_E);
+    imc_state.set_exit_E(exit_E);
+    imc_state.set_pop_ctrl_E(pop_ctrl_E);
+    imc_state.set_transported_particles(trans_particles);
+    imc_state.set_census_size(census_size);
+    imc_state.set_network_message_counts(mctr);
+    imc_state.set_rank_transport_runtime(transport_time);
+
+    // the per-quantity reductions the packed buffers replaced
+    double g_absorbed_E, g_emission_E, g_source_E, g_pre_census_E, g_post_census_E;
+    double g_pre_mat_E, g_post_mat_E, g_exit_E, g_pop_ctrl_E;
+    double max_transport_time, min_transport_time;
+    uint64_t g_trans_particles, g_census_size, g_particles_sent;
+    uint32_t g_particle_messages, g_sends_posted, g_sends_completed;
+    uint32_t g_receives_posted, g_receives_completed;
+    MPI_Allreduce(&absorbed_E, &g_absorbed_E, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&emission_E, &g_emission_E, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&source_E, &g_source_E, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&pre_census_E, &g_pre_census_E, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&post_census_E, &g_post_census_E, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&pre_mat_E, &g_pre_mat_E, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&post_mat_E, &g_post_mat_E, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&exit_E, &g_exit_E, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&pop_ctrl_E, &g_pop_ctrl_E, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&trans_particles, &g_trans_particles, 1, MPI_UINT64_T, MPI_SUM,
+                  MPI_COMM_WORLD);
+    MPI_Allreduce(&census_size, &g_census_size, 1, MPI_UINT64_T, MPI_SUM,
+                  MPI_COMM_WORLD);
+    MPI_Allreduce(&mctr.n_particles_sent, &g_particles_sent, 1, MPI_UINT64_T, MPI_SUM,
+                  MPI_COMM_WORLD);
+    MPI_Allreduce(&mctr.n_particle_messages, &g_particle_messages, 1, MPI_UINT32_T, MPI_SUM,
+                  MPI_COMM_WORLD);
+    MPI_Allreduce(&mctr.n_sends_posted, &g_sends_posted, 1, MPI_UINT32_T, MPI_SUM,
+                  MPI_COMM_WORLD);
+    MPI_Allreduce(&mctr.n_sends_completed, &g_sends_completed, 1, MPI_UINT32_T, MPI_SUM,
+                  MPI_COMM_WORLD);
+    MPI_Allreduce(&mctr.n_receives_posted, &g_receives_posted, 1, MPI_UINT32_T, MPI_SUM,
+                  MPI_COMM_WORLD);
+    MPI_Allreduce(&mctr.n_receives_completed, &g_receives_completed, 1, MPI_UINT32_T, MPI_SUM,
+                  MPI_COMM_WORLD);
+    MPI_Allreduce(&transport_time, &max_transport_time, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Allreduce(&transport_time, &min_transport_time, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+
+    // the report rank 0 printed before the reductions were packed
+    std::ostringstream expected;
+    expected << "Total Photons transported: " << g_trans_particles << endl;
+    expected << "Emission E: " << g_emission_E << ", Source E: " << g_source_E
+             << ", Absorption E: " << g_absorbed_E;
+    expected << ", Exit E: " << g_exit_E << ", Roulette E: " << g_pop_ctrl_E << endl;
+    expected << "Pre census E: " << g_pre_census_E << " Post census E: ";
+    expected << g_post_census_E << " Post census Size: " << g_census_size << endl;
+    expected << "Pre mat E: " << g_pre_mat_E << " Post mat E: " << g_post_mat_E << endl;
+    expected << "Radiation conservation: "
+             << (g_absorbed_E + g_post_census_E + g_exit_E) -
+                    (g_pre_census_E + g_emission_E + g_source_E + g_pop_ctrl_E)
+             << endl;
+    expected << "Material conservation: "
+             << g_post_mat_E - (g_pre_mat_E + g_absorbed_E - g_emission_E) << endl;
+    expected << "Sends posted: " << g_sends_posted;
+    expected << ", sends completed: " << g_sends_completed << endl;
+    expected << "Receives posted: " << g_receives_posted;
+    expected << ", receives completed: " << g_receives_completed << endl;
+    expected << "Step particles messages sent: " << g_particle_messages;
+    expected << ", Step particles sent: " << g_particles_sent << endl;
+    expected << "Transport time max/min: " << max_transport_time << "/";
+    expected << min_transport_time << endl;
+
+    // capture the report while the packed reduction completes
+    std::ostringstream printed;
+    std::streambuf *cout_buf = cout.rdbuf(printed.rdbuf());
+    imc_state.start_conservation_reduction();
+    imc_state.finish_conservation_reduction(Constants::PARTICLE_PASS);
+    cout.rdbuf(cout_buf);
+
+    if (rank == 0 && printed.str() != expected.str())
+      packed_reduction_pass = false;
+    if (rank != 0 && !printed.str().empty())
+      packed_reduction_pass = false;
+    if (imc_state.get_total_particles_sent() != g_particles_sent)
+      packed_reduction_pass = false;
+    if (imc_state.get_total_particle_messages() != g_particle_messages)
+      packed_reduction_pass = false;
+    // only rank 0 accumulates the transport time
+    if (rank == 0 && imc_state.get_total_transport_time() != max_transport_time)
+      packed_reduction_pass = false;
+
+    // a second finish without a start does nothing
+    imc_state.finish_conservation_reduction(Constants::PARTICLE_PASS);
+    if (imc_state.get_total_particles_sent() != g_particles_sent)
+      packed_reduction_pass = false;
+
+    if (packed_reduction_pass)
+      cout << "TEST PASSED: IMC_State packed conservation reduction" << endl;
+    else {
+      cout << "TEST FAILED: IMC_State packed conservation reduction" << endl;
+      if (rank == 0)
+        cout << "printed:" << endl << printed.str() << "expected:" << endl << expected.str();
+      nfail++;
+    }
+  }
+
   MPI_Finalize();
 
   return nfail;
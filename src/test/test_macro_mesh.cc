@@ -0,0 +1,178 @@
+//----------------------------------*-C++-*-----------------------------------//
+/*!
+ * \file   test_macro_mesh.cc
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Test macro box construction and tracking against cell-by-cell transport
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//----------------------------------------------------------------------------//
+
+#include <iostream>
+#include <mpi.h>
+#include <vector>
+
+#include "../RNG.h"
+#include "../cell.h"
+#include "../cell_tally.h"
+#include "../macro_mesh.h"
+#include "../photon.h"
+#include "../transport_photon.h"
+#include "testing_functions.h"
+
+//! Make a structured mesh of purely absorbing cells with uneven spacing and vacuum boundaries
+Cell_Vector make_cells(const std::vector<double> &x, const std::vector<double> &y,
+                             const std::vector<double> &z) {
+  using namespace Constants;
+  const uint32_t nx = x.size() - 1;
+  const uint32_t ny = y.size() - 1;
+  const uint32_t nz = z.size() - 1;
+  Cell_Vector cells;
+  for (uint32_t k = 0; k < nz; ++k) {
+    for (uint32_t j = 0; j < ny; ++j) {
+      for (uint32_t i = 0; i < nx; ++i) {
+        const uint32_t g = i + j * nx + k * nx * ny;
+        Cell cell;
+        cell.set_coor(x[i], x[i + 1], y[j], y[j + 1], z[k], z[k + 1]);
+        cell.set_global_index(g);
+        cell.set_silo_index(g);
+        cell.set_op_a(2.0);
+        cell.set_op_s(0.0);
+        cell.set_f(1.0);
+        const std::array<uint32_t, 6> next = {g - 1, g + 1, g - nx, g + nx, g - nx * ny, g + nx * ny};
+        const std::array<bool, 6> edge = {i == 0, i == nx - 1, j == 0, j == ny - 1, k == 0, k == nz - 1};
+        for (uint32_t face = 0; face < 6; ++face) {
+          cell.set_neighbor(dir_type(face), edge[face] ? g : next[face]);
+          cell.set_bc(dir_type(face), edge[face] ? VACUUM : ELEMENT);
+        }
+        cells.push_back(cell);
+      }
+    }
+  }
+  return cells;
+}
+
+int main(void) {
+
+  using std::cout;
+  using std::endl;
+  using std::vector;
+
+  int nfail = 0;
+
+  const vector<double> x = {0.0, 0.1, 0.3, 0.35, 0.6, 1.0};
+  const vector<double> y = {0.0, 0.2, 0.25, 0.7};
+  const vector<double> z = {0.0, 0.4, 0.5};
+
+  // identical cells are grouped greedily and different cells break up the boxes
+  {
+    bool build_pass = true;
+    Cell_Vector cells = make_cells(x, y, z);
+    Macro_Mesh uniform(cells, 5, 3, 2);
+    if (uniform.get_n_boxes() != 1 || uniform.get_box(0).n != std::array<uint32_t, 3>{5, 3, 2})
+      build_pass = false;
+    if (uniform.get_box(0).nodes != std::array<double, 6>{0.0, 1.0, 0.0, 0.7, 0.0, 0.5})
+      build_pass = false;
+
+    // a hotter cell in the middle of the bottom layer
+    cells[2 + 5].set_f(0.5);
+    Macro_Mesh split(cells, 5, 3, 2);
+    if (split.get_box_index(2 + 5) != Macro_Mesh::no_box)
+      build_pass = false;
+    if (split.get_box(0).n != std::array<uint32_t, 3>{5, 1, 2})
+      build_pass = false;
+    // boxes cover at least as much of the mesh as the bottom row and top layer box
+    uint32_t n_boxed = 0;
+    for (uint32_t i = 0; i < cells.size(); ++i) {
+      if (split.get_box_index(i) != Macro_Mesh::no_box)
+        n_boxed++;
+    }
+    if (n_boxed < 10 || n_boxed > 28)
+      build_pass = false;
+
+    // a rebuild with unchanged cells keeps the boxes, a changed cell regroups them
+    uniform.build(cells, 5, 3, 2);
+    if (uniform.get_n_boxes() != split.get_n_boxes() ||
+        uniform.get_box_index(2 + 5) != Macro_Mesh::no_box)
+      build_pass = false;
+    cells[2 + 5].set_f(1.0);
+    uniform.build(cells, 5, 3, 2);
+    if (uniform.get_n_boxes() != 1)
+      build_pass = false;
+
+    // a rank's cells are a subset of the mesh in any order, here the top layer reversed
+    Cell_Vector top(cells.rbegin(), cells.rbegin() + 15);
+    Macro_Mesh top_mesh(top, 5, 3, 2);
+    if (top_mesh.get_n_boxes() != 1 || top_mesh.get_box(0).n != std::array<uint32_t, 3>{5, 3, 1} ||
+        top_mesh.get_box(0).nodes != std::array<double, 6>{0.0, 1.0, 0.0, 0.7, 0.4, 0.5})
+      build_pass = false;
+
+    if (build_pass)
+      cout << "TEST PASSED: Macro_Mesh build" << endl;
+    else {
+      cout << "TEST FAILED: Macro_Mesh build" << endl;
+      nfail++;
+    }
+  }
+
+  // with no scattering the flight is deterministic, macro box tracking must give the same
+  // tallies, energy, position and cell as the cell-by-cell path
+  {
+    bool equivalence_pass = true;
+    Cell_Vector cells = make_cells(x, y, z);
+    cells[3].set_op_a(7.0); // a different cell on the way
+    Macro_Mesh macro_mesh(cells, 5, 3, 2);
+    const Population_Control pop_ctrl{0.0, 0.0, false};
+
+    const vector<std::array<double, 3>> angles = {
+        {0.8, 0.36, 0.48}, {-0.6, 0.28, 0.749399759798934}, {0.1, -0.989949493661167, 0.1}, {0.48, 0.6, -0.64}};
+    const vector<double> census_distances = {10.0, 0.3};
+    for (auto const &angle : angles) {
+      for (auto census_distance : census_distances) {
+        Cell_Tally_Vector cell_tallies(cells.size());
+        Cell_Tally_Vector macro_tallies(cells.size());
+        Photon phtn;
+        phtn.set_rng(RNG(777U, 3UL));
+        phtn.set_position({0.5, 0.22, 0.2});
+        phtn.set_angle(angle);
+        phtn.set_cell(3 + 5);
+        phtn.set_group(0);
+        phtn.set_E0(1.0);
+        phtn.set_E(1.0);
+        phtn.set_distance_to_census(census_distance);
+        Photon macro_phtn = phtn;
+        transport_photon<3>(0, phtn, cells.data(), cell_tallies.data(), pop_ctrl, nullptr, nullptr);
+        transport_photon<3>(0, macro_phtn, cells.data(), macro_tallies.data(), pop_ctrl, nullptr,
+                         &macro_mesh);
+        if (phtn.get_descriptor() != macro_phtn.get_descriptor() ||
+            phtn.get_cell() != macro_phtn.get_cell())
+          equivalence_pass = false;
+        if (!soft_equiv(phtn.get_E(), macro_phtn.get_E(), 1.0e-14))
+          equivalence_pass = false;
+        for (uint32_t d = 0; d < 3; ++d) {
+          if (!soft_equiv(phtn.get_position()[d], macro_phtn.get_position()[d], 1.0e-14))
+            equivalence_pass = false;
+        }
+        for (uint32_t i = 0; i < cells.size(); ++i) {
+          if (!soft_equiv(cell_tallies[i].get_abs_E(), macro_tallies[i].get_abs_E(),
+                          1.0e-14) ||
+              !soft_equiv(cell_tallies[i].get_track_E(), macro_tallies[i].get_track_E(), 1.0e-14))
+            equivalence_pass = false;
+        }
+      }
+    }
+
+    if (equivalence_pass)
+      cout << "TEST PASSED: macro box tracking matches cell-by-cell tracking" << endl;
+    else {
+      cout << "TEST FAILED: macro box tracking matches cell-by-cell tracking" << endl;
+      nfail++;
+    }
+  }
+
+  return nfail;
+}
+//---------------------------------------------------------------------------//
+// end of test_macro_mesh.cc
+//---------------------------------------------------------------------------//
@@ -0,0 +1,95 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   test_material_file.cc
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Test per-cell regions and temperatures from a binary material file
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../imc_parameters.h"
+#include "../material_file.h"
+#include "../mesh.h"
+#include "../mpi_types.h"
+#include "testing_functions.h"
+
+int main(int argc, char *argv[]) {
+
+  MPI_Init(&argc, &argv);
+
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+  using std::cout;
+  using std::endl;
+  using std::string;
+  using std::vector;
+
+  int nfail = 0;
+
+  // cells take their region and temperatures from the file, not the divisions
+  {
+    bool material_pass = true;
+
+    // material_file_input.xml is three_region_mesh_input.xml without the region map
+    const uint32_t n_global = 21 * 10;
+    const uint32_t region_IDs[3] = {230, 177, 11};
+    auto region_of = [&](uint32_t silo_index) { return region_IDs[(silo_index / 7) % 3]; };
+    auto T_e_of = [](uint32_t silo_index) { return 1.0 + 1.0e-3 * silo_index; };
+    auto T_r_of = [](uint32_t silo_index) { return 2.0 + 1.0e-3 * silo_index; };
+    if (rank == 0) {
+      vector<uint32_t> region_ID(n_global);
+      vector<double> T_e(n_global), T_r(n_global);
+      for (uint32_t i = 0; i < n_global; ++i) {
+        region_ID[i] = region_of(i);
+        T_e[i] = T_e_of(i);
+        T_r[i] = T_r_of(i);
+      }
+      Material_File::write("material_file_input.bin", region_ID, T_e, T_r);
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    const Info mpi_info;
+    MPI_Types mpi_types;
+    Input input(string("material_file_input.xml"), mpi_types);
+    IMC_Parameters imc_p(input);
+    Mesh mesh(input, mpi_types, mpi_info, imc_p);
+    mesh.initialize_physical_properties(input);
+
+    uint32_t n_cell = mesh.get_n_local_cells();
+    MPI_Allreduce(MPI_IN_PLACE, &n_cell, 1, MPI_UNSIGNED, MPI_SUM, MPI_COMM_WORLD);
+    if (n_cell != n_global)
+      material_pass = false;
+
+    for (uint32_t i = 0; i < mesh.get_n_local_cells(); ++i) {
+      const Cell &cell = mesh.get_cell_ref(i);
+      const uint32_t silo_index = cell.get_silo_index();
+      if (cell.get_region_ID() != region_of(silo_index) ||
+          cell.get_T_e() != T_e_of(silo_index) || cell.get_T_r() != T_r_of(silo_index))
+        material_pass = false;
+      // other physical properties still come from the region
+      if (cell.get_cV() != input.get_region(region_of(silo_index)).get_cV())
+        material_pass = false;
+    }
+
+    if (material_pass)
+      cout << "TEST PASSED: Mesh from material file" << endl;
+    else {
+      cout << "TEST FAILED: Mesh from material file" << endl;
+      nfail++;
+    }
+  }
+
+  MPI_Finalize();
+
+  return nfail;
+}
+//---------------------------------------------------------------------------//
+// end of test_material_file.cc
+//---------------------------------------------------------------------------//
@@ -0,0 +1,88 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   test_memory_tracker.cc
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Test allocation counting by subsystem and process memory
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#include <iostream>
+#include <vector>
+
+#include "../memory_tracker.h"
+#include "testing_functions.h"
+
+int main(void) {
+
+  using std::cout;
+  using std::endl;
+
+  int nfail = 0;
+
+  // tracked vectors count their capacity against their subsystem and release it when freed
+  {
+    bool tracking_pass = true;
+    const int64_t mesh_start = Memory::get_current_bytes(Memory::MESH);
+    const int64_t tally_start = Memory::get_current_bytes(Memory::TALLIES);
+    {
+      tracked_vector<double, Memory::MESH> mesh_data(1000);
+      if (Memory::get_current_bytes(Memory::MESH) - mesh_start !=
+          int64_t(mesh_data.capacity() * sizeof(double)))
+        tracking_pass = false;
+      if (Memory::get_current_bytes(Memory::TALLIES) != tally_start)
+        tracking_pass = false;
+      // copies are counted too
+      tracked_vector<double, Memory::MESH> copy(mesh_data);
+      if (Memory::get_current_bytes(Memory::MESH) - mesh_start !=
+          int64_t((mesh_data.capacity() + copy.capacity()) * sizeof(double)))
+        tracking_pass = false;
+    }
+    if (Memory::get_current_bytes(Memory::MESH) != mesh_start)
+      tracking_pass = false;
+    if (Memory::get_total_current_bytes() != 0)
+      tracking_pass = false;
+
+    if (tracking_pass)
+      cout << "TEST PASSED: tracked allocation counts" << endl;
+    else {
+      cout << "TEST FAILED: tracked allocation counts" << endl;
+      nfail++;
+    }
+  }
+
+  // high-water marks keep the largest allocation until they are reset
+  {
+    bool peak_pass = true;
+    Memory::reset_peaks();
+    {
+      tracked_vector<char, Memory::PHOTONS> big(1 << 20);
+    }
+    tracked_vector<char, Memory::PHOTONS> small(1 << 10);
+    if (Memory::get_peak_bytes(Memory::PHOTONS) < (1 << 20) ||
+        Memory::get_total_peak_bytes() < (1 << 20))
+      peak_pass = false;
+    Memory::reset_peaks();
+    if (Memory::get_peak_bytes(Memory::PHOTONS) != Memory::get_current_bytes(Memory::PHOTONS))
+      peak_pass = false;
+
+    // the process is resident
+    const Memory::Process_Memory process = Memory::get_process_memory();
+    if (process.rss <= 0 || process.hwm < process.rss)
+      peak_pass = false;
+
+    if (peak_pass)
+      cout << "TEST PASSED: memory high-water marks" << endl;
+    else {
+      cout << "TEST FAILED: memory high-water marks" << endl;
+      nfail++;
+    }
+  }
+
+  return nfail;
+}
+//---------------------------------------------------------------------------//
+// end of test_memory_tracker.cc
+//---------------------------------------------------------------------------//
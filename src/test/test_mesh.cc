@@ -9,16 +9,64 @@
  */
 //---------------------------------------------------------------------------//
 
+#include <cmath>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <vector>
 
+#include "../cell_tally.h"
 #include "../constants.h"
+#include "../imc_parameters.h"
+#include "../imc_state.h"
 #include "../input.h"
+#include "../mesh.h"
 #include "../mpi_types.h"
 #include "../proto_mesh.h"
 #include "testing_functions.h"
 
+//! Return an input deck with two regions side by side in x, the first with an integer opacity
+// exponent and the second with a non-integer one or, if a file is given, an opacity table
+std::string make_opacity_law_input(const std::string &table_file = "") {
+  std::ostringstream xml;
+  xml << "<prototype>\n  <common>\n    <t_start>0.0</t_start>\n    <t_stop>0.01</t_stop>\n"
+      << "    <dt_start>0.01</dt_start>\n    <t_mult>1.0</t_mult>\n    <dt_max>0.01</dt_max>\n"
+      << "    <photons>1000</photons>\n    <seed>14706</seed>\n"
+      << "    <use_gpu_transporter>FALSE</use_gpu_transporter>\n"
+      << "    <dd_transport_type>PARTICLE_PASS</dd_transport_type>\n  </common>\n"
+      << "  <debug_options>\n    <print_verbose>FALSE</print_verbose>\n"
+      << "    <print_mesh_info>FALSE</print_mesh_info>\n  </debug_options>\n  <spatial>\n"
+      << "    <x_division>\n      <x_start>0.0</x_start>\n      <x_end>1.0</x_end>\n"
+      << "      <n_x_cells>2</n_x_cells>\n    </x_division>\n"
+      << "    <x_division>\n      <x_start>1.0</x_start>\n      <x_end>3.0</x_end>\n"
+      << "      <n_x_cells>2</n_x_cells>\n    </x_division>\n"
+      << "    <y_division>\n      <y_start>0.0</y_start>\n      <y_end>1.0</y_end>\n"
+      << "      <n_y_cells>2</n_y_cells>\n    </y_division>\n"
+      << "    <z_division>\n      <z_start>0.0</z_start>\n      <z_end>0.5</z_end>\n"
+      << "      <n_z_cells>1</n_z_cells>\n    </z_division>\n";
+  for (int r = 0; r < 2; ++r) {
+    xml << "    <region_map>\n      <x_div_ID>" << r << "</x_div_ID>\n"
+        << "      <y_div_ID>0</y_div_ID>\n      <z_div_ID>0</z_div_ID>\n"
+        << "      <region_ID>" << r + 1 << "</region_ID>\n    </region_map>\n";
+  }
+  xml << "  </spatial>\n  <boundary>\n";
+  for (auto bc : {"left", "right", "down", "up", "bottom", "top"})
+    xml << "    <bc_" << bc << ">REFLECT</bc_" << bc << ">\n";
+  xml << "  </boundary>\n  <regions>\n"
+      << "    <region>\n      <ID>1</ID>\n      <density>2.0</density>\n      <CV>0.5</CV>\n"
+      << "      <opacA>1.0</opacA>\n      <opacB>10.0</opacB>\n      <opacC>-3.0</opacC>\n"
+      << "      <opacS>0.5</opacS>\n      <initial_T_e>0.8</initial_T_e>\n"
+      << "      <initial_T_r>0.7</initial_T_r>\n    </region>\n"
+      << "    <region>\n      <ID>2</ID>\n      <density>1.5</density>\n      <CV>0.3</CV>\n"
+      << "      <opacA>0.5</opacA>\n      <opacB>4.0</opacB>\n      <opacC>0.5</opacC>\n"
+      << "      <opacS>0.0</opacS>\n      <initial_T_e>1.3</initial_T_e>\n"
+      << "      <initial_T_r>1.1</initial_T_r>\n";
+  if (!table_file.empty())
+    xml << "      <opacity_table>" << table_file << "</opacity_table>\n";
+  xml << "    </region>\n  </regions>\n</prototype>\n";
+  return xml.str();
+}
+
 int main(int argc, char *argv[]) {
 
   MPI_Init(&argc, &argv);
@@ -112,6 +160,136 @@ int main(int argc, char *argv[]) {
       }
     }
 
+    // small integer exponents skip pow
+    {
+      bool integer_pow_pass = true;
+      for (double x : {0.37, 1.0, 2.5, 11.0}) {
+        for (int n = -Mesh::max_int_exponent; n <= Mesh::max_int_exponent; ++n) {
+          if (!soft_equiv(Mesh::integer_pow(x, n) / std::pow(x, n), 1.0, 1.0e-14))
+            integer_pow_pass = false;
+        }
+      }
+
+      if (integer_pow_pass)
+        cout << "TEST PASSED: integer_pow matches std::pow" << endl;
+      else {
+        cout << "TEST FAILED: integer_pow matches std::pow" << endl;
+        nfail++;
+      }
+    }
+
+    // opacity, Fleck factor, emission and the temperature update follow A + B * T^C in every
+    // cell, with an integer (-3) and a non-integer (0.5) exponent. With groups the opacity is
+    // the shared row's, evaluated at the center of the cell's temperature bin.
+    {
+      using Constants::a;
+      using Constants::c;
+      bool law_pass = true;
+      Input input(make_opacity_law_input(), mpi_types, true);
+      IMC_Parameters imc_p(input);
+      IMC_State imc_state(input, mpi_info.get_rank());
+      Mesh mesh(input, mpi_types, mpi_info, imc_p);
+      mesh.initialize_physical_properties(input);
+      mesh.calculate_photon_energy(imc_state, input.get_number_photons());
+      const Opacity_Rows bins(input.get_opacity_bins_per_decade());
+
+      const uint32_t n_cell = mesh.get_n_local_cells();
+      if (n_cell != 8)
+        law_pass = false;
+      const double dt = imc_state.get_dt();
+      const std::vector<double> emission_E = mesh.get_emission_E();
+      Energy_Tally_Vector abs_E(n_cell), track_E(n_cell);
+      std::vector<double> expected_T(n_cell);
+      for (uint32_t i = 0; i < n_cell; ++i) {
+        const Cell &cell = mesh.get_cell_ref(i);
+        const bool first = cell.get_region_ID() == 1;
+        const double A = first ? 1.0 : 0.5, B = first ? 10.0 : 4.0, C = first ? -3.0 : 0.5;
+        const double cV = first ? 0.5 : 0.3, rho = first ? 2.0 : 1.5, T = first ? 0.8 : 1.3;
+        const double T_op = (BRANSON_N_GROUPS > 1) ? bins.get_bin_T(bins.get_bin(T)) : T;
+        const double op_a = A + B * std::pow(T_op, C);
+        const double f = 1.0 / (1.0 + dt * op_a * c * 4.0 * a * T * T * T / (cV * rho));
+        const double emission = dt * cell.get_volume() * f * op_a * a * c * std::pow(T, 4);
+        if (!soft_equiv(cell.get_op_a() / op_a, 1.0, 1.0e-13) ||
+            !soft_equiv(cell.get_f() / f, 1.0, 1.0e-13) ||
+            !soft_equiv(emission_E[i] / emission, 1.0, 1.0e-13) ||
+            cell.get_op_s() != (first ? 0.5 : 0.0))
+          law_pass = false;
+        for (uint32_t g = 0; g < BRANSON_N_GROUPS; ++g) {
+          if (!soft_equiv(cell.get_op_a(g) / op_a, 1.0, 1.0e-13))
+            law_pass = false;
+        }
+        abs_E[i] = 0.25 * emission + 1.0e-3 * (i + 1);
+        track_E[i] = 1.0e-3;
+        expected_T[i] = T + (abs_E[i] - emission) / (cV * cell.get_volume() * rho);
+      }
+      mesh.update_temperature(abs_E, track_E, imc_state);
+      for (uint32_t i = 0; i < n_cell; ++i) {
+        if (!soft_equiv(mesh.get_cell_ref(i).get_T_e() / expected_T[i], 1.0, 1.0e-13))
+          law_pass = false;
+      }
+
+      if (law_pass)
+        cout << "TEST PASSED: analytic opacity law in photon energy and temperature update"
+             << endl;
+      else {
+        cout << "TEST FAILED: analytic opacity law in photon energy and temperature update"
+             << endl;
+        nfail++;
+      }
+    }
+
+    // a table with a value in every group fills the rows group by group, the Fleck factor and
+    // emission use the Planck mean of the groups
+    {
+      bool group_table_pass = true;
+      const std::string table_file("test_mesh_group_table.bin");
+      // power laws in T are exact under log-log interpolation
+      auto law = [](double T, uint32_t g) { return (g + 1.0) * 3.0 / (T * T); };
+      const uint32_t n_T = 11;
+      const double T_min = 0.1, T_max = 10.0;
+      std::vector<double> opacity;
+      for (uint32_t j = 0; j < n_T; ++j) {
+        const double T = Opacity_Table::get_grid_point(j, n_T, T_min, T_max);
+        for (uint32_t g = 0; g < BRANSON_N_GROUPS; ++g)
+          opacity.push_back(law(T, g));
+      }
+      if (mpi_info.get_rank() == 0)
+        Opacity_Table::write(table_file, n_T, T_min, T_max, 1, 1.0, 1.0, BRANSON_N_GROUPS,
+                             opacity);
+      MPI_Barrier(MPI_COMM_WORLD);
+
+      Input input(make_opacity_law_input(table_file), mpi_types, true);
+      IMC_Parameters imc_p(input);
+      IMC_State imc_state(input, mpi_info.get_rank());
+      Mesh mesh(input, mpi_types, mpi_info, imc_p);
+      mesh.initialize_physical_properties(input);
+      mesh.calculate_photon_energy(imc_state, input.get_number_photons());
+      const Opacity_Rows bins(input.get_opacity_bins_per_decade());
+
+      for (uint32_t i = 0; i < mesh.get_n_local_cells(); ++i) {
+        const Cell &cell = mesh.get_cell_ref(i);
+        if (cell.get_region_ID() != 2)
+          continue;
+        const double T = 1.3;
+        const double T_op = (BRANSON_N_GROUPS > 1) ? bins.get_bin_T(bins.get_bin(T)) : T;
+        double planck_mean = 0.0;
+        for (uint32_t g = 0; g < BRANSON_N_GROUPS; ++g) {
+          planck_mean += law(T_op, g) / BRANSON_N_GROUPS;
+          if (!soft_equiv(cell.get_op_a(g) / law(T_op, g), 1.0, 1.0e-12))
+            group_table_pass = false;
+        }
+        if (!soft_equiv(cell.get_op_a() / planck_mean, 1.0, 1.0e-12))
+          group_table_pass = false;
+      }
+
+      if (group_table_pass)
+        cout << "TEST PASSED: group opacity table rows and Planck mean" << endl;
+      else {
+        cout << "TEST FAILED: group opacity table rows and Planck mean" << endl;
+        nfail++;
+      }
+    }
+
   } // need to call destructors for mpi_types before MPI_Finalize
 
   MPI_Finalize();
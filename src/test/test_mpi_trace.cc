@@ -0,0 +1,135 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   test_mpi_trace.cc
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Test the traced MPI wrappers and the trace file they write
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../mpi_trace.h"
+#include "testing_functions.h"
+
+int main(int argc, char *argv[]) {
+
+  MPI_Init(&argc, &argv);
+
+  using std::cout;
+  using std::endl;
+  using std::vector;
+
+  int rank, n_rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &n_rank);
+  const int partner = (rank + 1) % n_rank;
+
+  int nfail = 0;
+
+  // the wrappers pass through and record nothing while tracing is off
+  {
+    bool disabled_pass = true;
+    int value = rank;
+    MPI_Trace::Allreduce(MPI_IN_PLACE, &value, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Trace::idle(0);
+    if (value != n_rank * (n_rank - 1) / 2 || MPI_Trace::is_enabled() ||
+        !MPI_Trace::get_state().records.empty())
+      disabled_pass = false;
+
+    if (disabled_pass)
+      cout << "TEST PASSED: MPI_Trace wrappers record nothing when disabled" << endl;
+    else {
+      cout << "TEST FAILED: MPI_Trace wrappers record nothing when disabled" << endl;
+      nfail++;
+    }
+  }
+
+  // exchange messages with a neighbor, each call and completion is recorded with its peer and
+  // size, received messages are sized by what arrived
+  {
+    bool record_pass = true;
+    MPI_Trace::enable();
+    MPI_Trace::set_phase(3);
+    vector<double> send_data(10 + rank, 1.0);
+    vector<double> recv_data(100);
+    MPI_Request reqs[2];
+    MPI_Trace::Irecv(recv_data.data(), recv_data.size(), MPI_DOUBLE, MPI_ANY_SOURCE, 7,
+                     MPI_COMM_WORLD, &reqs[0]);
+    MPI_Trace::Isend(send_data.data(), send_data.size(), MPI_DOUBLE, partner, 7, MPI_COMM_WORLD,
+                     &reqs[1]);
+    MPI_Trace::Waitall(2, reqs, MPI_STATUSES_IGNORE);
+    for (int i = 0; i < 3; ++i)
+      MPI_Trace::idle(MPI_Trace::now());
+    MPI_Trace::Barrier(MPI_COMM_WORLD);
+
+    using namespace MPI_Trace;
+    const vector<Record> &records = get_state().records;
+    const int source = (rank + n_rank - 1) % n_rank;
+    const uint64_t recv_bytes = (10 + source) * sizeof(double);
+    if (records.size() != 7)
+      record_pass = false;
+    else {
+      // the completions follow the wait in request order
+      const Op expected_ops[7] = {IRECV, ISEND, WAIT, RECV_COMPLETE, SEND_COMPLETE, IDLE, BARRIER};
+      for (uint32_t i = 0; i < 7; ++i)
+        record_pass = record_pass && records[i].op == expected_ops[i] && records[i].phase == 3 &&
+                      records[i].end >= records[i].begin;
+      record_pass = record_pass && records[0].peer == -1 && records[0].bytes == 800 &&
+                    records[1].peer == partner && records[1].bytes == send_data.size() * 8 &&
+                    records[3].peer == source && records[3].bytes == recv_bytes &&
+                    records[3].begin == records[0].begin && records[5].count == 3 &&
+                    get_state().pending.empty();
+    }
+
+    if (record_pass)
+      cout << "TEST PASSED: MPI_Trace records calls and completions" << endl;
+    else {
+      cout << "TEST FAILED: MPI_Trace records calls and completions" << endl;
+      nfail++;
+    }
+  }
+
+  // finalize writes the header and every record
+  {
+    bool file_pass = true;
+    MPI_Trace::finalize();
+    const std::string file_name = "mpi_trace_" + std::to_string(rank) + ".bin";
+    std::ifstream trace(file_name, std::ios::binary);
+    char magic[8];
+    uint32_t header[4];
+    trace.read(magic, 8);
+    trace.read(reinterpret_cast<char *>(header), sizeof(header));
+    vector<MPI_Trace::Record> records(8);
+    trace.read(reinterpret_cast<char *>(records.data()), records.size() * sizeof(MPI_Trace::Record));
+    const size_t n_read = trace.gcount() / sizeof(MPI_Trace::Record);
+    if (std::strncmp(magic, "BRNTRCE", 8) != 0 || header[0] != 1 || header[1] != uint32_t(rank) ||
+        header[2] != uint32_t(n_rank) || header[3] != sizeof(MPI_Trace::Record) || n_read != 7 ||
+        records[1].op != MPI_Trace::ISEND || records[6].op != MPI_Trace::BARRIER ||
+        MPI_Trace::is_enabled())
+      file_pass = false;
+    trace.close();
+    std::remove(file_name.c_str());
+
+    if (file_pass)
+      cout << "TEST PASSED: MPI_Trace file output" << endl;
+    else {
+      cout << "TEST FAILED: MPI_Trace file output" << endl;
+      nfail++;
+    }
+  }
+
+  MPI_Finalize();
+
+  return nfail;
+}
+//---------------------------------------------------------------------------//
+// end of test_mpi_trace.cc
+//---------------------------------------------------------------------------//
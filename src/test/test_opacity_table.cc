@@ -0,0 +1,117 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   test_opacity_table.cc
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Test opacity table reading, interpolation and node sharing
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../opacity_table.h"
+#include "testing_functions.h"
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+int main(int argc, char *argv[]) {
+
+  MPI_Init(&argc, &argv);
+
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+  int nfail = 0;
+
+  // power laws are exact under log-log interpolation: 10 T^-3 rho^2 in group 0 and 2 T^-1
+  // in group 1
+  const uint32_t n_T = 21, n_rho = 5, n_groups = 2;
+  const double T_min = 0.01, T_max = 10.0, rho_min = 0.1, rho_max = 100.0;
+  auto law = [](double T, double rho, uint32_t g) {
+    return g == 0 ? 10.0 * std::pow(T, -3.0) * rho * rho : 2.0 / T;
+  };
+  const string file_name("test_opacity_table.bin");
+  if (rank == 0) {
+    vector<double> opacity;
+    for (uint32_t k = 0; k < n_rho; ++k) {
+      const double rho = Opacity_Table::get_grid_point(k, n_rho, rho_min, rho_max);
+      for (uint32_t j = 0; j < n_T; ++j) {
+        const double T = Opacity_Table::get_grid_point(j, n_T, T_min, T_max);
+        for (uint32_t g = 0; g < n_groups; ++g)
+          opacity.push_back(law(T, rho, g));
+      }
+    }
+    Opacity_Table::write(file_name, n_T, T_min, T_max, n_rho, rho_min, rho_max, n_groups,
+                         opacity);
+  }
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  // interpolation between and at grid points, every rank reads the node's shared copy
+  {
+    bool interpolation_pass = true;
+    Opacity_Table table(file_name);
+    if (table.get_n_groups() != n_groups)
+      interpolation_pass = false;
+
+    const vector<double> T_values = {0.01, 0.0137, 0.5, 1.0, 3.3, 9.99};
+    const vector<double> rho_values = {0.1, 0.42, 7.0, 100.0};
+    for (auto rho : rho_values) {
+      const Opacity_Table::Density_Point point = table.get_density_point(rho);
+      for (auto T : T_values) {
+        for (uint32_t g = 0; g < n_groups; ++g) {
+          const double expected = law(T, rho, g);
+          if (!soft_equiv(table.get_absorption_opacity(T, point, g) / expected, 1.0, 1.0e-10))
+            interpolation_pass = false;
+        }
+      }
+    }
+
+    if (interpolation_pass)
+      cout << "TEST PASSED: Opacity_Table log-log interpolation" << endl;
+    else {
+      cout << "TEST FAILED: Opacity_Table log-log interpolation" << endl;
+      nfail++;
+    }
+  }
+
+  // values off the grid are clamped to the edge
+  {
+    bool clamp_pass = true;
+    Opacity_Table table(file_name);
+    const Opacity_Table::Density_Point low_rho = table.get_density_point(1.0e-3);
+    const Opacity_Table::Density_Point high_rho = table.get_density_point(1.0e3);
+    if (!soft_equiv(table.get_absorption_opacity(1.0e-4, low_rho) / law(T_min, rho_min, 0), 1.0,
+                    1.0e-10))
+      clamp_pass = false;
+    if (!soft_equiv(table.get_absorption_opacity(100.0, high_rho) / law(T_max, rho_max, 0), 1.0,
+                    1.0e-10))
+      clamp_pass = false;
+
+    if (clamp_pass)
+      cout << "TEST PASSED: Opacity_Table clamping outside the grid" << endl;
+    else {
+      cout << "TEST FAILED: Opacity_Table clamping outside the grid" << endl;
+      nfail++;
+    }
+  }
+
+  MPI_Barrier(MPI_COMM_WORLD);
+  if (rank == 0)
+    std::remove(file_name.c_str());
+
+  MPI_Finalize();
+
+  return nfail;
+}
+//---------------------------------------------------------------------------//
+// end of test_opacity_table.cc
+//---------------------------------------------------------------------------//
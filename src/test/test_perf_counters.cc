@@ -0,0 +1,118 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   test_perf_counters.cc
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Test phase attribution and the fallback of the hardware counters
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#include <iostream>
+
+#include "../perf_counters.h"
+#include "testing_functions.h"
+
+int main(int argc, char *argv[]) {
+
+  MPI_Init(&argc, &argv);
+
+  using std::cout;
+  using std::endl;
+
+  int nfail = 0;
+
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+  // nothing is counted or reduced until the counters are enabled
+  {
+    bool disabled_pass = true;
+    {
+      Perf_Counters::Scope scope(Perf_Counters::TRANSPORT);
+    }
+    Perf_Counters::start_reduction(1);
+    Perf_Counters::finish_reduction(rank);
+    if (Perf_Counters::is_enabled() || Perf_Counters::get_state().pending)
+      disabled_pass = false;
+
+    if (disabled_pass)
+      cout << "TEST PASSED: Perf_Counters records nothing when disabled" << endl;
+    else {
+      cout << "TEST FAILED: Perf_Counters records nothing when disabled" << endl;
+      nfail++;
+    }
+  }
+
+  // counts between readings accumulate and multiplexed counts are scaled up
+  {
+    bool scale_pass = true;
+    Perf_Counters::Reading begin{10, 5, {100, 200, 0, 0, 0}};
+    Perf_Counters::Reading end{30, 15, {400, 800, 0, 0, 0}};
+    Perf_Counters::Phase_Counts counts{};
+    if (counts.get_scaled(Perf_Counters::CYCLES) != 0.0)
+      scale_pass = false;
+    counts.add(begin, end);
+    counts.add(begin, end);
+    // enabled 40, running 20: on the hardware half of the time
+    if (!soft_equiv(counts.get_scaled(Perf_Counters::CYCLES), 1200.0) ||
+        !soft_equiv(counts.get_scaled(Perf_Counters::INSTRUCTIONS), 2400.0))
+      scale_pass = false;
+
+    if (scale_pass)
+      cout << "TEST PASSED: Perf_Counters phase counts and multiplex scaling" << endl;
+    else {
+      cout << "TEST FAILED: Perf_Counters phase counts and multiplex scaling" << endl;
+      nfail++;
+    }
+  }
+
+  // enable falls back cleanly without counters, nested phases are charged exclusively with them
+  {
+    bool enable_pass = true;
+    const bool enabled = Perf_Counters::enable(rank, 0);
+    if (enabled != Perf_Counters::is_enabled())
+      enable_pass = false;
+    if (enabled) {
+      Perf_Counters::Thread_Counters &t = Perf_Counters::get_thread_counters();
+      {
+        Perf_Counters::Scope outer(Perf_Counters::TALLY_REDUCTION);
+        double sum = 0.0;
+        for (int i = 0; i < 100000; ++i)
+          sum += i * 0.5;
+        {
+          Perf_Counters::Scope inner(Perf_Counters::COMMUNICATION);
+          for (int i = 0; i < 100000; ++i)
+            sum += i * 0.25;
+        }
+        if (sum <= 0.0 || t.open_phases.size() != 1)
+          enable_pass = false;
+      }
+      if (!t.open_phases.empty() ||
+          t.counts[Perf_Counters::TALLY_REDUCTION].get_scaled(Perf_Counters::CYCLES) <= 0.0 ||
+          t.counts[Perf_Counters::COMMUNICATION].get_scaled(Perf_Counters::CYCLES) <= 0.0 ||
+          t.counts[Perf_Counters::TRANSPORT].time_enabled != 0)
+        enable_pass = false;
+    }
+    Perf_Counters::start_reduction(1);
+    Perf_Counters::finish_reduction(rank);
+    Perf_Counters::finalize(rank);
+    if (Perf_Counters::get_state().pending)
+      enable_pass = false;
+
+    if (enable_pass)
+      cout << "TEST PASSED: Perf_Counters enable, nested phases and reduction" << endl;
+    else {
+      cout << "TEST FAILED: Perf_Counters enable, nested phases and reduction" << endl;
+      nfail++;
+    }
+  }
+
+  MPI_Finalize();
+
+  return nfail;
+}
+//---------------------------------------------------------------------------//
+// end of test_perf_counters.cc
+//---------------------------------------------------------------------------//
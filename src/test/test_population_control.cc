@@ -0,0 +1,143 @@
+//----------------------------------*-C++-*-----------------------------------//
+/*!
+ * \file   test_population_control.cc
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Test roulette and weight window splitting
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//----------------------------------------------------------------------------//
+
+#include <iostream>
+#include <mpi.h>
+#include <vector>
+
+#include "../RNG.h"
+#include "../cell_tally.h"
+#include "../photon.h"
+#include "../population_control.h"
+#include "testing_functions.h"
+
+int main(void) {
+
+  using std::cout;
+  using std::endl;
+  using std::vector;
+
+  int nfail = 0;
+  constexpr uint32_t seed = 777U;
+
+  // roulette keeps the expected energy and the tally records the energy made and lost exactly
+  {
+    bool roulette_pass = true;
+    constexpr uint32_t n_photons = 100000;
+    constexpr double fraction = 0.004;
+    constexpr double survival_fraction = 0.05;
+    Cell_Tally tally;
+    double pre_E = 0.0;
+    double post_E = 0.0;
+    uint32_t n_survived = 0;
+    for (uint32_t i = 0; i < n_photons; ++i) {
+      Photon phtn;
+      phtn.set_rng(RNG(seed, i));
+      phtn.set_E0(1.0);
+      phtn.set_E(fraction);
+      pre_E += phtn.get_E();
+      if (play_roulette(phtn, survival_fraction, tally)) {
+        n_survived++;
+        if (!soft_equiv(phtn.get_E(), survival_fraction, 1.0e-14))
+          roulette_pass = false;
+      } else if (phtn.get_E() != 0.0)
+        roulette_pass = false;
+      post_E += phtn.get_E();
+    }
+    // survival probability is 0.08, 3 sigma on the survivor count is about 1%
+    if (!soft_equiv(post_E / pre_E, 1.0, 0.03))
+      roulette_pass = false;
+    if (!soft_equiv(tally.get_pop_ctrl_E(), post_E - pre_E, 1.0e-8))
+      roulette_pass = false;
+    cout << "Roulette survivors: " << n_survived << " of " << n_photons << endl;
+
+    if (roulette_pass)
+      cout << "TEST PASSED: play_roulette" << endl;
+    else {
+      cout << "TEST FAILED: play_roulette" << endl;
+      nfail++;
+    }
+  }
+
+  // split counts follow the importance and are limited by the completion token
+  {
+    bool n_split_pass = true;
+    Photon phtn;
+    phtn.set_E0(1.0);
+    Population_Control pop_ctrl{0.01, 0.05, false};
+    if (get_n_split(phtn, pop_ctrl, 4.0) != 1)
+      n_split_pass = false;
+    pop_ctrl.use_weight_windows = true;
+    if (get_n_split(phtn, pop_ctrl, 1.0) != 1)
+      n_split_pass = false;
+    if (get_n_split(phtn, pop_ctrl, 4.0) != 4)
+      n_split_pass = false;
+    if (get_n_split(phtn, pop_ctrl, 1000.0) != max_n_split)
+      n_split_pass = false;
+    phtn.set_token(3);
+    if (get_n_split(phtn, pop_ctrl, 4.0) != 3)
+      n_split_pass = false;
+
+    if (n_split_pass)
+      cout << "TEST PASSED: get_n_split" << endl;
+    else {
+      cout << "TEST FAILED: get_n_split" << endl;
+      nfail++;
+    }
+  }
+
+  // splitting conserves energy and the completion token and gives copies their own streams
+  {
+    bool split_pass = true;
+    Photon parent;
+    parent.set_rng(RNG(seed, 42UL));
+    parent.set_E0(2.0);
+    parent.set_cell(7);
+    parent.set_token(Constants::history_token + 1);
+    parent.set_n_split(3);
+    parent.set_descriptor(Constants::SPLIT);
+
+    Photon_Vector copies;
+    split_photon(parent, copies);
+    if (copies.size() != 2)
+      split_pass = false;
+
+    double total_E = parent.get_E();
+    uint64_t total_token = parent.get_token();
+    vector<double> first_numbers = {parent.get_rng().generate_random_number()};
+    for (auto &copy : copies) {
+      total_E += copy.get_E();
+      total_token += copy.get_token();
+      if (copy.get_cell() != 7 || copy.get_E0() != 2.0)
+        split_pass = false;
+      first_numbers.push_back(copy.get_rng().generate_random_number());
+    }
+    if (!soft_equiv(total_E, 2.0, 1.0e-14) || total_token != Constants::history_token + 1)
+      split_pass = false;
+    if (parent.get_descriptor() == Constants::SPLIT || parent.get_n_split() != 1)
+      split_pass = false;
+    if (first_numbers[0] == first_numbers[1] || first_numbers[0] == first_numbers[2] ||
+        first_numbers[1] == first_numbers[2])
+      split_pass = false;
+
+    if (split_pass)
+      cout << "TEST PASSED: split_photon" << endl;
+    else {
+      cout << "TEST FAILED: split_photon" << endl;
+      nfail++;
+    }
+  }
+
+  return nfail;
+}
+//---------------------------------------------------------------------------//
+// end of test_population_control.cc
+//---------------------------------------------------------------------------//
@@ -0,0 +1,124 @@
+//----------------------------------*-C++-*----------------------------------//
+/*!
+ * \file   test_profiler.cc
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Test nesting, merging and trace output of the region profiler
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//---------------------------------------------------------------------------//
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "../profiler.h"
+#include "testing_functions.h"
+
+int main(int argc, char *argv[]) {
+
+  MPI_Init(&argc, &argv);
+
+  using std::cout;
+  using std::endl;
+
+  int nfail = 0;
+
+  // nothing is recorded until the profiler is enabled
+  {
+    bool disabled_pass = true;
+    {
+      Profiler::Scope scope(Profiler::STEP);
+    }
+    if (Profiler::is_enabled() || !Profiler::get_state().buffers.empty())
+      disabled_pass = false;
+
+    if (disabled_pass)
+      cout << "TEST PASSED: Profiler records nothing when disabled" << endl;
+    else {
+      cout << "TEST FAILED: Profiler records nothing when disabled" << endl;
+      nfail++;
+    }
+  }
+
+  // scopes nest, back-to-back scopes merge and each thread has its own buffer
+  {
+    bool scope_pass = true;
+    Profiler::enable();
+    {
+      Profiler::Scope step(Profiler::STEP);
+      for (int i = 0; i < 5; ++i) {
+        Profiler::Scope poll(Profiler::MPI_PROGRESS);
+      }
+      Profiler::Scope output(Profiler::OUTPUT);
+      {
+        Profiler::Scope inner_output(Profiler::OUTPUT);
+      }
+      output.stop();
+      std::thread worker([] { Profiler::Scope thread_scope(Profiler::TRANSPORT_THREAD); });
+      worker.join();
+    }
+
+    Profiler::State &state = Profiler::get_state();
+    if (state.buffers.size() != 2)
+      scope_pass = false;
+    else {
+      // events are stored as they finish, inner scopes first
+      const std::vector<Profiler::Event> &events = state.buffers[0]->events;
+      if (events.size() != 4 || events[0].region != Profiler::MPI_PROGRESS ||
+          events[0].calls != 5 || events[0].depth != 1 || events[1].region != Profiler::OUTPUT ||
+          !events[1].nested || events[1].depth != 2 || events[2].region != Profiler::OUTPUT ||
+          events[2].nested || events[3].region != Profiler::STEP || events[3].depth != 0 ||
+          events[3].begin > events[0].begin || events[3].end < events[2].end)
+        scope_pass = false;
+      const std::vector<Profiler::Event> &thread_events = state.buffers[1]->events;
+      if (thread_events.size() != 1 || thread_events[0].region != Profiler::TRANSPORT_THREAD ||
+          state.buffers[1]->thread_id != 1)
+        scope_pass = false;
+    }
+
+    if (scope_pass)
+      cout << "TEST PASSED: Profiler nested, merged and per-thread scopes" << endl;
+    else {
+      cout << "TEST FAILED: Profiler nested, merged and per-thread scopes" << endl;
+      nfail++;
+    }
+  }
+
+  // finalize writes a Chrome trace with one complete event per recorded event
+  {
+    bool trace_pass = true;
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    Profiler::finalize(rank);
+    std::ifstream trace("profile_" + std::to_string(rank) + ".json");
+    std::stringstream contents;
+    contents << trace.rdbuf();
+    const std::string json = contents.str();
+    size_t n_events = 0;
+    for (size_t pos = json.find("\"ph\":\"X\""); pos != std::string::npos;
+         pos = json.find("\"ph\":\"X\"", pos + 1))
+      n_events++;
+    if (!trace || json.find("{\"displayTimeUnit\"") != 0 || n_events != 5 ||
+        json.find("\"name\":\"MPI progress\"") == std::string::npos ||
+        json.find("\"calls\":5") == std::string::npos || Profiler::is_enabled())
+      trace_pass = false;
+
+    if (trace_pass)
+      cout << "TEST PASSED: Profiler trace output" << endl;
+    else {
+      cout << "TEST FAILED: Profiler trace output" << endl;
+      nfail++;
+    }
+  }
+
+  MPI_Finalize();
+
+  return nfail;
+}
+//---------------------------------------------------------------------------//
+// end of test_profiler.cc
+//---------------------------------------------------------------------------//
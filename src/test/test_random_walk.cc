@@ -0,0 +1,139 @@
+//----------------------------------*-C++-*-----------------------------------//
+/*!
+ * \file   test_random_walk.cc
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Test random walk escape time table and sampling functions
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//----------------------------------------------------------------------------//
+
+#include <iostream>
+#include <mpi.h>
+#include <vector>
+
+#include "../RNG.h"
+#include "../cell.h"
+#include "../random_walk.h"
+#include "../sampling_functions.h"
+#include "testing_functions.h"
+
+int main(void) {
+
+  using std::cout;
+  using std::endl;
+  using std::vector;
+
+  int nfail = 0;
+  constexpr uint32_t seed = 777U;
+
+  // escape probability is a CDF and sampled escape times have the diffusion mean R^2/(6D)
+  {
+    bool escape_pass = true;
+    Random_Walk random_walk(5.0);
+    if (random_walk.get_escape_probability(0.0) != 0.0)
+      escape_pass = false;
+    if (!soft_equiv(random_walk.get_escape_probability(10.0), 1.0, 1.0e-8))
+      escape_pass = false;
+    double last_p = 0.0;
+    for (uint32_t i = 1; i <= 200; ++i) {
+      const double p = random_walk.get_escape_probability(i * 0.01);
+      if (p < last_p)
+        escape_pass = false;
+      last_p = p;
+    }
+    // P(s) = 1 - 2 exp(-pi^2 s) to double precision for s = 1
+    if (!soft_equiv(random_walk.get_escape_probability(1.0),
+                    1.0 - 2.0 * exp(-Constants::pi * Constants::pi), 1.0e-9))
+      escape_pass = false;
+
+    RNG rng(seed, 1UL);
+    constexpr uint32_t n_samples = 200000;
+    double mean_s = 0.0;
+    for (uint32_t i = 0; i < n_samples; ++i)
+      mean_s += random_walk.sample_escape_time(rng.generate_random_number());
+    mean_s /= n_samples;
+    cout << "Mean reduced escape time: " << mean_s << " (expected 1/6)" << endl;
+    if (!soft_equiv(mean_s, 1.0 / 6.0, 2.0e-3))
+      escape_pass = false;
+
+    // sphere radius follows the closest face and the census time, zero when too thin
+    const double sigma_s = 100.0;
+    const double D = Constants::c / (3.0 * sigma_s);
+    if (random_walk.get_radius(0.01, sigma_s, D, 1.0) != 0.0)
+      escape_pass = false;
+    const double R = random_walk.get_radius(0.2, sigma_s, D, 1.0);
+    if (!(R > 0.19 && R < 0.2))
+      escape_pass = false;
+    const double t_short = 0.3 * 0.1 * 0.1 / D;
+    if (!soft_equiv(random_walk.get_radius(0.2, sigma_s, D, t_short), 0.1, 1.0e-12))
+      escape_pass = false;
+
+    if (escape_pass)
+      cout << "TEST PASSED: random walk escape time table" << endl;
+    else {
+      cout << "TEST FAILED: random walk escape time table" << endl;
+      nfail++;
+    }
+  }
+
+  // census radius follows x sin(pi x) and exit angles leave the sphere cosine distributed
+  {
+    bool sampling_pass = true;
+    Random_Walk random_walk(5.0);
+    RNG rng(seed, 2UL);
+    constexpr uint32_t n_samples = 200000;
+    double mean_x = 0.0;
+    double mean_mu = 0.0;
+    for (uint32_t i = 0; i < n_samples; ++i) {
+      mean_x += random_walk.sample_census_radius(rng);
+      const std::array<double, 3> normal = get_uniform_angle(rng);
+      const std::array<double, 3> angle = get_sphere_exit_angle(normal, rng);
+      const double mu = angle[0] * normal[0] + angle[1] * normal[1] + angle[2] * normal[2];
+      const double norm = angle[0] * angle[0] + angle[1] * angle[1] + angle[2] * angle[2];
+      if (mu <= 0.0 || !soft_equiv(norm, 1.0, 1.0e-12))
+        sampling_pass = false;
+      mean_mu += mu;
+    }
+    mean_x /= n_samples;
+    mean_mu /= n_samples;
+    const double pi2 = Constants::pi * Constants::pi;
+    if (!soft_equiv(mean_x, (pi2 - 4.0) / pi2, 2.0e-3))
+      sampling_pass = false;
+    if (!soft_equiv(mean_mu, 2.0 / 3.0, 2.0e-3))
+      sampling_pass = false;
+
+    if (sampling_pass)
+      cout << "TEST PASSED: random walk census radius and exit angle" << endl;
+    else {
+      cout << "TEST FAILED: random walk census radius and exit angle" << endl;
+      nfail++;
+    }
+  }
+
+  // distance to the closest face of a cell
+  {
+    bool nearest_face_pass = true;
+    Cell cell;
+    cell.set_coor(0.0, 1.0, 0.0, 2.0, 0.0, 4.0);
+    if (!soft_equiv(cell.get_distance_to_nearest_face({0.5, 1.0, 2.0}), 0.5, 1.0e-14))
+      nearest_face_pass = false;
+    if (!soft_equiv(cell.get_distance_to_nearest_face({0.5, 1.9, 2.0}), 0.1, 1.0e-14))
+      nearest_face_pass = false;
+    if (!soft_equiv(cell.get_distance_to_nearest_face({0.5, 1.0, 0.05}), 0.05, 1.0e-14))
+      nearest_face_pass = false;
+
+    if (nearest_face_pass)
+      cout << "TEST PASSED: get_distance_to_nearest_face" << endl;
+    else {
+      cout << "TEST FAILED: get_distance_to_nearest_face" << endl;
+      nfail++;
+    }
+  }
+
+  return nfail;
+}
+//---------------------------------------------------------------------------//
+// end of test_random_walk.cc
+//---------------------------------------------------------------------------//
@@ -17,6 +17,7 @@
 #include "../sampling_functions.h"
 #include "../RNG.h"
 #include "../cell.h"
+#include "../source_sampler.h"
 
 int main(void) {
 
@@ -159,6 +160,76 @@ int main(void) {
     }
   }
 
+  // test tilted coordinate sampling, the mean of the PDF 1 + b(t - 1/2) is 1/2 + b/12
+  {
+    bool test_tilted_coordinate = true;
+    RNG rng(seed, 72412UL);
+    constexpr int n_samples = 40000;
+    for (double b : {-2.0, -0.5, 0.0, 1.0, 2.0}) {
+      double avg_t = 0.0;
+      for (int i = 0; i < n_samples; ++i) {
+        double t = get_tilted_coordinate(rng.generate_random_number(), b);
+        if (t < 0.0 || t > 1.0)
+          test_tilted_coordinate = false;
+        avg_t += t / n_samples;
+      }
+      if (!soft_equiv(avg_t, 0.5 + b / 12.0, 5.0e-3))
+        test_tilted_coordinate = false;
+    }
+
+    if (test_tilted_coordinate)
+      cout << "TEST PASSED: Sampling Functions--tilted coordinate" << endl;
+    else {
+      cout << "TEST FAILED: Sampling Functions--tilted coordinate" << endl;
+      nfail++;
+    }
+  }
+
+  // test stratified and Sobol source samplers: every census time stratum (one per sample) and
+  // every position stratum should be hit exactly once and the mean should be the cell center
+  for (auto mode : {Constants::STRATIFIED_SAMPLING, Constants::SOBOL_SAMPLING}) {
+    bool test_source_sampler = true;
+    RNG rng(seed, 72412UL);
+
+    constexpr uint32_t n_samples = 64;
+    constexpr uint32_t n_position_dims = 3;
+    Source_Sampler sampler(mode, n_position_dims, n_samples, seed, 1234UL);
+
+    vector<int> time_strata(n_samples, 0);
+    vector<int> x_strata(4, 0);
+    std::array<double, n_source_sample_dims> avg_u;
+    avg_u.fill(0.0);
+    for (uint32_t i = 0; i < n_samples; ++i) {
+      auto u = sampler.get_sample(i, rng);
+      for (uint32_t d = 0; d < n_source_sample_dims; ++d) {
+        if (u[d] <= 0.0 || u[d] >= 1.0)
+          test_source_sampler = false;
+        avg_u[d] += u[d] / n_samples;
+      }
+      time_strata[static_cast<int>(u[5] * n_samples)]++;
+      x_strata[static_cast<int>(u[0] * 4.0)]++;
+    }
+    for (auto count : time_strata) {
+      if (count != 1)
+        test_source_sampler = false;
+    }
+    for (auto count : x_strata) {
+      if (count != static_cast<int>(n_samples / 4))
+        test_source_sampler = false;
+    }
+    constexpr double tolerance = 5.0e-2;
+    for (auto u_d : avg_u) {
+      if (!soft_equiv(u_d, 0.5, tolerance))
+        test_source_sampler = false;
+    }
+
+    if (test_source_sampler)
+      cout << "TEST PASSED: Source_Sampler--mode " << mode << endl;
+    else {
+      cout << "TEST FAILED: Source_Sampler--mode " << mode << endl;
+      nfail++;
+    }
+  }
 
   return nfail;
 }
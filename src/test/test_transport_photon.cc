@@ -0,0 +1,202 @@
+//----------------------------------*-C++-*-----------------------------------//
+/*!
+ * \file   test_transport_photon.cc
+ * \author Alex Long
+ * \date   October 17 2026
+ * \brief  Test the 1D and 2D transport kernels against the 3D kernel and event counting
+ * \note   Copyright (C) 2017 Los Alamos National Security, LLC.
+ *         All rights reserved
+ */
+//----------------------------------------------------------------------------//
+
+#include <iostream>
+#include <mpi.h>
+#include <vector>
+
+#include "../RNG.h"
+#include "../cell.h"
+#include "../cell_tally.h"
+#include "../event_counters.h"
+#include "../macro_mesh.h"
+#include "../photon.h"
+#include "../transport_photon.h"
+#include "testing_functions.h"
+
+//! Make a structured mesh of purely absorbing cells, vacuum in x and reflecting in y and z
+Cell_Vector make_cells(const std::vector<double> &x, const std::vector<double> &y,
+                             const std::vector<double> &z) {
+  using namespace Constants;
+  const uint32_t nx = x.size() - 1;
+  const uint32_t ny = y.size() - 1;
+  const uint32_t nz = z.size() - 1;
+  Cell_Vector cells;
+  for (uint32_t k = 0; k < nz; ++k) {
+    for (uint32_t j = 0; j < ny; ++j) {
+      for (uint32_t i = 0; i < nx; ++i) {
+        const uint32_t g = i + j * nx + k * nx * ny;
+        Cell cell;
+        cell.set_coor(x[i], x[i + 1], y[j], y[j + 1], z[k], z[k + 1]);
+        cell.set_global_index(g);
+        cell.set_silo_index(g);
+        cell.set_op_a(1.0 + i);
+        cell.set_op_s(0.0);
+        cell.set_f(1.0);
+        const std::array<uint32_t, 6> next = {g - 1, g + 1, g - nx, g + nx, g - nx * ny, g + nx * ny};
+        const std::array<bool, 6> edge = {i == 0, i == nx - 1, j == 0, j == ny - 1, k == 0, k == nz - 1};
+        for (uint32_t face = 0; face < 6; ++face) {
+          cell.set_neighbor(dir_type(face), edge[face] ? g : next[face]);
+          if (!edge[face])
+            cell.set_bc(dir_type(face), ELEMENT);
+          else
+            cell.set_bc(dir_type(face), face < 2 ? VACUUM : REFLECT);
+        }
+        cells.push_back(cell);
+      }
+    }
+  }
+  return cells;
+}
+
+//! Transport one purely absorbing photon with the n_dim and 3D kernels, return true if they agree
+template <uint32_t n_dim>
+bool kernels_agree(const Cell_Vector &cells, const Macro_Mesh *macro_mesh,
+                   const std::array<double, 3> &angle, const double census_distance) {
+  const Population_Control pop_ctrl{0.0, 0.0, false};
+  Cell_Tally_Vector tallies_3d(cells.size());
+  Cell_Tally_Vector tallies_n(cells.size());
+  Photon phtn;
+  phtn.set_rng(RNG(777U, 5UL));
+  phtn.set_position({0.32, 0.11, 0.3});
+  phtn.set_angle(angle);
+  phtn.set_cell(2);
+  phtn.set_group(0);
+  phtn.set_E0(1.0);
+  phtn.set_E(1.0);
+  phtn.set_distance_to_census(census_distance);
+  Photon phtn_n = phtn;
+  transport_photon<3>(0, phtn, cells.data(), tallies_3d.data(), pop_ctrl, nullptr, nullptr);
+  transport_photon<n_dim>(0, phtn_n, cells.data(), tallies_n.data(), pop_ctrl, nullptr, macro_mesh);
+
+  bool agree = phtn.get_descriptor() == phtn_n.get_descriptor() &&
+               phtn.get_cell() == phtn_n.get_cell() && soft_equiv(phtn.get_E(), phtn_n.get_E(), 1.0e-13);
+  for (uint32_t d = 0; d < n_dim; ++d)
+    agree = agree && soft_equiv(phtn.get_position()[d], phtn_n.get_position()[d], 1.0e-13);
+  for (uint32_t i = 0; i < cells.size(); ++i) {
+    agree = agree && soft_equiv(tallies_3d[i].get_abs_E(), tallies_n[i].get_abs_E(), 1.0e-13) &&
+            soft_equiv(tallies_3d[i].get_track_E(), tallies_n[i].get_track_E(), 1.0e-13);
+  }
+  return agree;
+}
+
+int main(void) {
+
+  using std::cout;
+  using std::endl;
+  using std::vector;
+
+  int nfail = 0;
+
+  const vector<double> x = {0.0, 0.1, 0.3, 0.35, 0.6, 1.0};
+  const vector<std::array<double, 3>> angles = {
+      {0.8, 0.36, 0.48}, {-0.6, 0.28, 0.749399759798934}, {0.1, -0.1, 0.989949493661167}};
+  const vector<double> census_distances = {20.0, 0.9};
+
+  // reflecting z faces of a single z cell are never crossed, so the 2D kernel gives the same
+  // answer as the 3D kernel, with and without macro boxes
+  {
+    bool kernel_2d_pass = true;
+    const Cell_Vector cells = make_cells(x, {0.0, 0.2, 0.25, 0.7}, {0.0, 0.5});
+    const Macro_Mesh macro_mesh(cells, 5, 3, 1);
+    for (auto const &angle : angles) {
+      for (auto census_distance : census_distances) {
+        kernel_2d_pass = kernel_2d_pass && kernels_agree<2>(cells, nullptr, angle, census_distance);
+        kernel_2d_pass = kernel_2d_pass && kernels_agree<2>(cells, &macro_mesh, angle, census_distance);
+      }
+    }
+
+    if (kernel_2d_pass)
+      cout << "TEST PASSED: 2D transport kernel" << endl;
+    else {
+      cout << "TEST FAILED: 2D transport kernel" << endl;
+      nfail++;
+    }
+  }
+
+  // the same for the 1D kernel with a single reflecting cell in y and z
+  {
+    bool kernel_1d_pass = true;
+    const Cell_Vector cells = make_cells(x, {0.0, 0.7}, {0.0, 0.5});
+    for (auto const &angle : angles) {
+      for (auto census_distance : census_distances)
+        kernel_1d_pass = kernel_1d_pass && kernels_agree<1>(cells, nullptr, angle, census_distance);
+    }
+
+    if (kernel_1d_pass)
+      cout << "TEST PASSED: 1D transport kernel" << endl;
+    else {
+      cout << "TEST FAILED: 1D transport kernel" << endl;
+      nfail++;
+    }
+  }
+
+  // counting events doesn't change the history, each flight in these absorbing cells ends in one
+  // counted event and the flights add up to the distance travelled
+  {
+    bool count_events_pass = true;
+    const Cell_Vector cells = make_cells(x, {0.0, 0.2, 0.25, 0.7}, {0.0, 0.5});
+    const Population_Control pop_ctrl{0.0, 0.0, false};
+    for (auto const &angle : angles) {
+      for (auto census_distance : census_distances) {
+        Cell_Tally_Vector tallies(cells.size());
+        Cell_Tally_Vector count_tallies(cells.size());
+        Event_Counters counters(cells.size());
+        Photon phtn;
+        phtn.set_rng(RNG(777U, 5UL));
+        phtn.set_position({0.32, 0.11, 0.3});
+        phtn.set_angle(angle);
+        phtn.set_cell(2);
+        phtn.set_group(0);
+        phtn.set_E0(1.0);
+        phtn.set_E(1.0);
+        phtn.set_distance_to_census(census_distance);
+        Photon count_phtn = phtn;
+        transport_photon<3>(0, phtn, cells.data(), tallies.data(), pop_ctrl, nullptr, nullptr);
+        transport_photon<3, true>(0, count_phtn, cells.data(), count_tallies.data(), pop_ctrl,
+                                  nullptr, nullptr, &counters);
+
+        count_events_pass = count_events_pass &&
+                            phtn.get_descriptor() == count_phtn.get_descriptor() &&
+                            phtn.get_cell() == count_phtn.get_cell() &&
+                            phtn.get_E() == count_phtn.get_E();
+        uint64_t n_events = 0;
+        for (uint32_t e = 0; e < Event_Counters::N_EVENTS; ++e)
+          n_events += counters.events[e];
+        uint64_t n_cell_events = 0;
+        for (auto n : counters.cell_events)
+          n_cell_events += n;
+        uint64_t n_binned = 0;
+        for (uint32_t b = 0; b < Event_Counters::n_flight_bins; ++b)
+          n_binned += counters.flight_hist[b];
+        count_events_pass =
+            count_events_pass && counters.n_histories == 1 &&
+            counters.events[Event_Counters::EXIT] + counters.events[Event_Counters::CENSUS] == 1 &&
+            counters.events[Event_Counters::SCATTER] == 0 && counters.n_flights == n_events &&
+            n_cell_events == n_events && n_binned == n_events &&
+            soft_equiv(counters.flight_length,
+                       census_distance - count_phtn.get_distance_remaining(), 1.0e-12);
+      }
+    }
+
+    if (count_events_pass)
+      cout << "TEST PASSED: transport kernel event counting" << endl;
+    else {
+      cout << "TEST FAILED: transport kernel event counting" << endl;
+      nfail++;
+    }
+  }
+
+  return nfail;
+}
+//---------------------------------------------------------------------------//
+// end of test_transport_photon.cc
+//---------------------------------------------------------------------------//
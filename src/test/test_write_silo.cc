@@ -94,6 +94,33 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  // each group gathers its blocks into a group file and rank zero writes the index
+  {
+    // put MPI_Types in scope so it's destructor is called before MPI_Finalize
+    MPI_Types mpi_types;
+    string filename("three_region_mesh_input.xml");
+    Input input(filename, mpi_types);
+    IMC_Parameters imc_p(input);
+
+    Mesh mesh(input, mpi_types, mpi_info, imc_p);
+
+    bool multiblock_silo_write_pass = true;
+
+    double time = 3.0;
+    int step = 2;
+    double transport_runtime = 7.0;
+    double mpi_time = 2.0;
+    const uint32_t n_silo_files = 1;
+    write_silo(mesh, time, step, transport_runtime, mpi_time, rank, n_rank, false, n_silo_files);
+
+    if (multiblock_silo_write_pass) {
+      cout << "TEST PASSED: writing multi-block silo file" << endl;
+    } else {
+      cout << "TEST FAILED:  writing multi-block silo file" << endl;
+      nfail++;
+    }
+  }
+
   MPI_Finalize();
 
   return nfail;
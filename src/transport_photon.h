@@ -21,11 +21,19 @@
 #include "config.h"
 #include "RNG.h"
 #include "cell_tally.h"
+#include "census_store.h"
 #include "constants.h"
+#include "ddmc.h"
+#include "event_counters.h"
+#include "macro_mesh.h"
+#include "perf_counters.h"
 #include "photon.h"
+#include "population_control.h"
+#include "profiler.h"
+#include "random_walk.h"
 #include "sampling_functions.h"
 
-void post_process_photons(const double next_dt, std::vector<Photon> &all_photons, std::vector<Photon> &census_list, double &census_E, double &exit_E) {
+void post_process_photons(const double next_dt, Photon_Vector &all_photons, Photon_Vector &census_list, double &census_E, double &exit_E, Census_Store *census_store = nullptr) {
   for ( auto & phtn : all_photons) {
     auto descriptor{phtn.get_descriptor()};
     switch (descriptor) {
@@ -33,7 +41,7 @@ void post_process_photons(const double next_dt, std::vector<Photon> &all_photons
       // handle in other function
       break;
     case Constants::event_type::KILLED:
-      // note: for now killed particles go into the material so separate conservation issues here
+      // energy lost to roulette is in the population control tally
       break;
     case Constants::event_type::EXIT:
       exit_E+=phtn.get_E();
@@ -42,6 +50,12 @@ void post_process_photons(const double next_dt, std::vector<Photon> &all_photons
       phtn.set_distance_to_census(Constants::c*next_dt);
       census_list.push_back(phtn);
       census_E+=phtn.get_E();
+      if (census_store)
+        census_store->flush(census_list);
+      break;
+    case Constants::event_type::SPLIT:
+      // transport finishes split photons with their copies before returning
+      Insist(false, "photon still marked SPLIT after transport");
       break;
     } //switch(descriptor)
   } // phtn : all_photons
@@ -49,9 +63,18 @@ void post_process_photons(const double next_dt, std::vector<Photon> &all_photons
 
 //----------------------------------------------------------------------------//
 //! Transport a photon when the mesh is always available
+//
+// Meshes with one cell and reflecting faces in z (2D) or in y and z (1D) use n_dim = 2 or 1.
+// Photons never cross the collapsed dimensions so their faces aren't checked and the position
+// in them isn't updated, the path length is still from the full 3D direction.
+// With count_events the events and flights of the history are added to counters, otherwise the
+// counting compiles away.
+template <uint32_t n_dim, bool count_events = false>
 GPU_HOST_DEVICE
 void transport_photon(const uint32_t rank_cell_offset,
-    Photon &phtn, const Cell *cells, Cell_Tally *cell_tallies) {
+    Photon &phtn, const Cell *cells, Cell_Tally *cell_tallies, const Population_Control pop_ctrl,
+    const Random_Walk *random_walk, const Macro_Mesh *macro_mesh,
+    Event_Counters *counters = nullptr) {
 
   using Constants::bc_type;
   using Constants::c;
@@ -65,25 +88,208 @@ void transport_photon(const uint32_t rank_cell_offset,
   uint32_t local_cell_index =  phtn.get_cell() - rank_cell_offset;
   Cell const * cell = &cells[local_cell_index];
   bool active = true;
+  // check the weight window when the photon starts and when it enters a new cell
+  bool check_window = true;
 
   // keep a thread local copy of these tallies and do the atomic add when the particle leaves the
   // cell or it's otherwise terminated (try to reduce atomic contention with post-move tally)
   double thread_absorbed_E{0.0};
   double thread_track_E{0.0};
 
+  // count an event in the current cell
+  auto count = [&](const Event_Counters::Event event) {
+    if (count_events)
+      counters->count(event, local_cell_index);
+  };
+
   // transport this photon
   while (active) {
+    if (check_window) {
+      check_window = false;
+      const uint32_t n_split = get_n_split(phtn, pop_ctrl, cell->get_importance());
+      if (n_split > 1) {
+        // stop here, the photon and its copies are transported again by the host
+        phtn.set_n_split(n_split);
+        phtn.set_descriptor(Constants::SPLIT);
+        count(Event_Counters::SPLIT);
+        cell_tallies[local_cell_index].accumulate_absorbed_E(thread_absorbed_E);
+        cell_tallies[local_cell_index].accumulate_track_E(thread_track_E);
+        break;
+      }
+    }
+
+    // photons start in DDMC cells as DDMC photons unless they sit on a face, in which case they
+    // are entering and the interface condition applies. Photons that changed cells between time
+    // steps leave discrete diffusion uniformly in their cell.
+    if (cell->is_ddmc() != phtn.is_ddmc()) {
+      if (phtn.is_ddmc()) {
+        phtn.set_ddmc(false);
+        phtn.set_position(get_uniform_position_in_cell(*cell, rng));
+        phtn.set_angle(get_uniform_angle(rng));
+      } else {
+        const double min_dx = min(cell->get_dx(0), min(cell->get_dx(1), cell->get_dx(2)));
+        const uint32_t face = get_face_at_position(*cell, phtn.get_position());
+        const auto face_bc = cell->get_bc(face);
+        const double sigma = cell->get_op_a() + cell->get_op_s();
+        if (cell->get_distance_to_nearest_face(phtn.get_position()) > 1.0e-8 * min_dx ||
+            face_bc == Constants::REFLECT ||
+            rng.generate_random_number() <
+                get_ddmc_acceptance(std::abs(phtn.get_angle()[face / 2]), sigma,
+                                    cell->get_dx(face / 2))) {
+          phtn.set_ddmc(true);
+        } else {
+          // rejected photons reflect back where they came from
+          phtn.reflect(face);
+          if (face_bc == Constants::ELEMENT) {
+            count(Event_Counters::REFLECT);
+            phtn.set_cell(cell->get_next_cell(face));
+            local_cell_index = phtn.get_cell() - rank_cell_offset;
+            cell = &cells[local_cell_index];
+            phtn.set_descriptor(Constants::BOUND);
+            check_window = true;
+            continue;
+          }
+          active = false;
+          if (face_bc == Constants::PROCESSOR) {
+            count(Event_Counters::RANK_PASS);
+            phtn.set_cell(cell->get_next_cell(face));
+            phtn.set_descriptor(Constants::PASS);
+          } else {
+            count(Event_Counters::EXIT);
+            phtn.set_descriptor(Constants::EXIT);
+          }
+          break;
+        }
+      }
+    }
+
+    // DDMC photons leak between cells at the face leakage rates and absorb continuously
+    if (phtn.is_ddmc()) {
+      const double sigma_a = cell->get_op_a();
+      const double f = cell->get_f();
+      const double total_leakage = cell->get_total_leakage_op();
+      const double dist_to_leak = (total_leakage > 0.0) ?
+        -log(rng.generate_random_number()) / total_leakage : 1.0e100;
+      const double dist_to_census = phtn.get_distance_remaining();
+      const double dist_to_event = min(dist_to_leak, dist_to_census);
+
+      const double absorbed_E = phtn.get_E() * (1.0 - exp(-sigma_a * f * dist_to_event));
+      thread_absorbed_E += absorbed_E;
+      thread_track_E += absorbed_E / (sigma_a * f);
+      phtn.set_E(phtn.get_E() - absorbed_E);
+      phtn.set_distance_to_census(dist_to_census - dist_to_event);
+
+      const double importance = cell->get_importance();
+      if (phtn.below_cutoff(pop_ctrl.roulette_fraction / importance) &&
+          !play_roulette(phtn, pop_ctrl.survival_fraction / importance,
+                         cell_tallies[local_cell_index])) {
+        active = false;
+        phtn.set_descriptor(Constants::KILLED);
+        count(Event_Counters::ROULETTE_KILL);
+      } else if (dist_to_event == dist_to_census) {
+        active = false;
+        phtn.set_descriptor(Constants::CENSUS);
+        count(Event_Counters::CENSUS);
+      } else {
+        const uint32_t face = sample_leakage_face(*cell, rng);
+        const auto face_bc = cell->get_bc(face);
+        // stay a DDMC photon if the next cell is DDMC, otherwise leave through the face
+        if (face_bc != Constants::ELEMENT ||
+            !cells[cell->get_next_cell(face) - rank_cell_offset].is_ddmc()) {
+          const double u[2] = {rng.generate_random_number(), rng.generate_random_number()};
+          phtn.set_position(get_position_on_face(*cell, u, face));
+          phtn.set_angle(get_ddmc_exit_angle(face, rng));
+          phtn.set_ddmc(false);
+        }
+        if (face_bc == Constants::ELEMENT) {
+          count(Event_Counters::DDMC_LEAK);
+          cell_tallies[local_cell_index].accumulate_absorbed_E(thread_absorbed_E);
+          cell_tallies[local_cell_index].accumulate_track_E(thread_track_E);
+          phtn.set_cell(cell->get_next_cell(face));
+          local_cell_index = phtn.get_cell() - rank_cell_offset;
+          cell = &cells[local_cell_index];
+          phtn.set_descriptor(Constants::BOUND);
+          thread_absorbed_E = 0.0;
+          thread_track_E = 0.0;
+          check_window = true;
+        } else if (face_bc == Constants::PROCESSOR) {
+          active = false;
+          count(Event_Counters::RANK_PASS);
+          phtn.set_cell(cell->get_next_cell(face));
+          phtn.set_descriptor(Constants::PASS);
+        } else {
+          active = false;
+          count(Event_Counters::EXIT);
+          phtn.set_descriptor(Constants::EXIT);
+        }
+      }
+      if (!active) {
+        cell_tallies[local_cell_index].accumulate_absorbed_E(thread_absorbed_E);
+        cell_tallies[local_cell_index].accumulate_track_E(thread_track_E);
+      }
+      continue;
+    }
+
     const double sigma_s = cell->get_op_s(phtn.get_group());
     const double sigma_a = cell->get_op_a(phtn.get_group());
     const double f = cell->get_f();
     const double total_sigma_s = (1.0 - f) * sigma_a + sigma_s;
 
+    // deep in a thick cell, jump to the surface of a sphere around the photon in one step
+    if (random_walk && total_sigma_s > 0.0) {
+      const double D = c / (3.0 * total_sigma_s);
+      const double t_census = phtn.get_distance_remaining() / c;
+      const double R = random_walk->get_radius(
+          cell->get_distance_to_nearest_face(phtn.get_position()), total_sigma_s, D, t_census);
+      if (R > 0.0) {
+        const double xi = rng.generate_random_number();
+        const bool escaped = xi < random_walk->get_escape_probability(D * t_census / (R * R));
+        const double walk_dist = escaped ? c * random_walk->sample_escape_time(xi) * R * R / D
+                                         : phtn.get_distance_remaining();
+        count(Event_Counters::RANDOM_WALK);
+        const double absorbed_E = phtn.get_E() * (1.0 - exp(-sigma_a * f * walk_dist));
+        thread_absorbed_E += absorbed_E;
+        thread_track_E += absorbed_E / (sigma_a * f);
+        phtn.set_E(phtn.get_E() - absorbed_E);
+        phtn.set_distance_to_census(phtn.get_distance_remaining() - walk_dist);
+        // end on the sphere surface or, at census, inside it
+        const double r = escaped ? R : R * random_walk->sample_census_radius(rng);
+        const std::array<double, 3> normal = get_uniform_angle(rng);
+        std::array<double, 3> pos = phtn.get_position();
+        for (uint32_t i = 0; i < 3; ++i)
+          pos[i] += r * normal[i];
+        phtn.set_position(pos);
+        // many effective scatters happened, the group is from the emission spectrum
+        if (BRANSON_N_GROUPS > 1 && (1.0 - f) * sigma_a > 0.0)
+          phtn.set_group(sample_emission_group(rng, *cell));
+        if (escaped) {
+          phtn.set_angle(get_sphere_exit_angle(normal, rng));
+          phtn.set_descriptor(Constants::SCATTER);
+        } else {
+          phtn.set_angle(get_uniform_angle(rng));
+          active = false;
+          phtn.set_descriptor(Constants::CENSUS);
+          count(Event_Counters::CENSUS);
+          cell_tallies[local_cell_index].accumulate_absorbed_E(thread_absorbed_E);
+          cell_tallies[local_cell_index].accumulate_track_E(thread_track_E);
+        }
+        continue;
+      }
+    }
+
     // get distance to event
     const double dist_to_scatter = (total_sigma_s > 0.0) ?
       -log(rng.generate_random_number()) / total_sigma_s : 1.0e100;
 
-    const double dist_to_boundary = cell->get_distance_to_boundary(
-        phtn.get_position(), phtn.get_angle(), surface_cross);
+    // in a macro box the flight can cross many identical cells in one step
+    const uint32_t box_index =
+        macro_mesh ? macro_mesh->get_box_index(local_cell_index) : Macro_Mesh::no_box;
+    const double dist_to_boundary =
+        (box_index != Macro_Mesh::no_box)
+            ? macro_mesh->get_distance_to_boundary<n_dim>(box_index, phtn.get_position(),
+                                                   phtn.get_angle(), surface_cross)
+            : cell->get_distance_to_boundary<n_dim>(phtn.get_position(), phtn.get_angle(),
+                                             surface_cross);
     const double dist_to_census = phtn.get_distance_remaining();
 
     // select minimum distance event
@@ -91,23 +297,50 @@ void transport_photon(const uint32_t rank_cell_offset,
 
     // calculate energy absorbed by material, update photon and material energy
     // and update the path-length weighted tally for T_r
-    const double absorbed_E = phtn.get_E() * (1.0 - exp(-sigma_a * f * dist_to_event));
-
-    thread_absorbed_E += absorbed_E;
-    thread_track_E += absorbed_E / (sigma_a * f);
-
-    phtn.set_E(phtn.get_E() - absorbed_E);
+    if (box_index != Macro_Mesh::no_box) {
+      // deposit in each cell crossed, the photon ends the flight in the last one
+      const uint32_t end_cell = macro_mesh->trace<n_dim>(
+          local_cell_index, phtn.get_position(), phtn.get_angle(), dist_to_event,
+          [&](const uint32_t cell_index, const double length) {
+            if (cell_index != local_cell_index) {
+              count(Event_Counters::CELL_CROSS);
+              cell_tallies[local_cell_index].accumulate_absorbed_E(thread_absorbed_E);
+              cell_tallies[local_cell_index].accumulate_track_E(thread_track_E);
+              thread_absorbed_E = 0.0;
+              thread_track_E = 0.0;
+              local_cell_index = cell_index;
+            }
+            const double absorbed_E = phtn.get_E() * (1.0 - exp(-sigma_a * f * length));
+            thread_absorbed_E += absorbed_E;
+            thread_track_E += absorbed_E / (sigma_a * f);
+            phtn.set_E(phtn.get_E() - absorbed_E);
+          });
+      cell = &cells[end_cell];
+      phtn.set_cell(end_cell + rank_cell_offset);
+    } else {
+      const double absorbed_E = phtn.get_E() * (1.0 - exp(-sigma_a * f * dist_to_event));
+
+      thread_absorbed_E += absorbed_E;
+      thread_track_E += absorbed_E / (sigma_a * f);
+
+      phtn.set_E(phtn.get_E() - absorbed_E);
+    }
 
     // update position
-    phtn.move(dist_to_event);
+    phtn.move<n_dim>(dist_to_event);
+    if (count_events)
+      counters->add_flight(dist_to_event, dist_to_event * (sigma_a + sigma_s));
 
     // apply variance/runtime reduction
-    if (phtn.below_cutoff(Constants::cutoff_fraction)) {
-      thread_absorbed_E += phtn.get_E();
+    const double importance = cell->get_importance();
+    if (phtn.below_cutoff(pop_ctrl.roulette_fraction / importance) &&
+        !play_roulette(phtn, pop_ctrl.survival_fraction / importance,
+                       cell_tallies[local_cell_index])) {
       cell_tallies[local_cell_index].accumulate_absorbed_E(thread_absorbed_E);
       cell_tallies[local_cell_index].accumulate_track_E(thread_track_E);
       active = false;
       phtn.set_descriptor(Constants::KILLED);
+      count(Event_Counters::ROULETTE_KILL);
     }
     // or apply event
     else {
@@ -117,11 +350,26 @@ void transport_photon(const uint32_t rank_cell_offset,
         if (rng.generate_random_number() > (sigma_s / ((1.0 - f) * sigma_a + sigma_s)))
           phtn.set_group(sample_emission_group(rng, *cell));
         phtn.set_descriptor(Constants::SCATTER);
+        count(Event_Counters::SCATTER);
       }
       // EVENT TYPE: BOUNDARY CROSS
       else if (dist_to_event == dist_to_boundary) {
         auto boundary_event = cell->get_bc(surface_cross);
+        const Cell *next_cell = (boundary_event == Constants::ELEMENT)
+                                    ? &cells[cell->get_next_cell(surface_cross) - rank_cell_offset]
+                                    : nullptr;
+        // photons entering a DDMC cell are kept with the interface probability or reflected
+        if (next_cell && next_cell->is_ddmc()) {
+          const double mu = std::abs(phtn.get_angle()[surface_cross / 2]);
+          if (rng.generate_random_number() <
+              get_ddmc_acceptance(mu, next_cell->get_op_a() + next_cell->get_op_s(),
+                                  next_cell->get_dx(surface_cross / 2)))
+            phtn.set_ddmc(true);
+          else
+            boundary_event = Constants::REFLECT;
+        }
         if (boundary_event == Constants::ELEMENT) {
+          count(Event_Counters::CELL_CROSS);
           // dump thread energy into this cell's indexi before updating it
           cell_tallies[local_cell_index].accumulate_absorbed_E(thread_absorbed_E);
           cell_tallies[local_cell_index].accumulate_track_E(thread_track_E);
@@ -132,8 +380,10 @@ void transport_photon(const uint32_t rank_cell_offset,
           phtn.set_descriptor(Constants::BOUND);
           thread_absorbed_E = 0.0;
           thread_track_E = 0.0;
+          check_window = true;
         } else if (boundary_event == Constants::PROCESSOR) {
           active = false;
+          count(Event_Counters::RANK_PASS);
           // set correct cell index with global cell ID
           phtn.set_cell(cell->get_next_cell(surface_cross));
           phtn.set_descriptor(Constants::PASS);
@@ -141,10 +391,12 @@ void transport_photon(const uint32_t rank_cell_offset,
           cell_tallies[local_cell_index].accumulate_track_E(thread_track_E);
         } else if (boundary_event == Constants::VACUUM || boundary_event == Constants::SOURCE) {
           active = false;
+          count(Event_Counters::EXIT);
           phtn.set_descriptor(Constants::EXIT);
           cell_tallies[local_cell_index].accumulate_absorbed_E(thread_absorbed_E);
           cell_tallies[local_cell_index].accumulate_track_E(thread_track_E);
         } else {
+          count(Event_Counters::REFLECT);
           phtn.reflect(surface_cross);
           phtn.set_descriptor(Constants::BOUND);
         }
@@ -153,23 +405,29 @@ void transport_photon(const uint32_t rank_cell_offset,
       else if (dist_to_event == dist_to_census) {
         active = false;
         phtn.set_descriptor(Constants::CENSUS);
+        count(Event_Counters::CENSUS);
         cell_tallies[local_cell_index].accumulate_absorbed_E(thread_absorbed_E);
         cell_tallies[local_cell_index].accumulate_track_E(thread_track_E);
       }
     } // end event loop
   } // end while alive
+  if (count_events)
+    counters->end_history();
 }
 //----------------------------------------------------------------------------//
 
 //----------------------------------------------------------------------------//
+template <uint32_t n_dim>
 GPU_KERNEL
 void gpu_no_accel_transport(const uint32_t rank_cell_offset,
-    Photon *all_photons, const Cell *cells, Cell_Tally *cell_tallies, const uint32_t n_batch_particles) {
+    Photon *all_photons, const Cell *cells, Cell_Tally *cell_tallies, const uint32_t n_batch_particles,
+    const Population_Control pop_ctrl) {
 
 #ifdef USE_CUDA
   int32_t particle_id = threadIdx.x + blockIdx.x * blockDim.x;
   if (particle_id < n_batch_particles) {
-    transport_photon(rank_cell_offset, all_photons[particle_id], cells, cell_tallies);
+    transport_photon<n_dim>(rank_cell_offset, all_photons[particle_id], cells, cell_tallies, pop_ctrl,
+                            nullptr, nullptr); // random walk and macro box tables are in host memory
   } // if particle id is valid
   __syncthreads();
 
@@ -178,42 +436,112 @@ void gpu_no_accel_transport(const uint32_t rank_cell_offset,
 //------------------------------------------------------------------------------------------------//
 
 //------------------------------------------------------------------------------------------------//
-void cpu_transport_photons(const uint32_t rank_cell_offset,
-    std::vector<Photon> &photons, const std::vector<Cell> &cells, std::vector<Cell_Tally> &cell_tallies, int n_omp_threads) {
+//! Transport photons on the CPU with the kernel for an n_dim mesh, counting events if
+// count_events is set
+template <uint32_t n_dim, bool count_events>
+void cpu_transport_kernel(const uint32_t rank_cell_offset,
+    Photon_Vector &photons, const Cell_Vector &cells, Cell_Tally_Vector &cell_tallies, int n_omp_threads,
+    const Population_Control &pop_ctrl, const Random_Walk *random_walk,
+    const Macro_Mesh *macro_mesh, Event_Counters *counters) {
 
   auto cpu_cells_ptr{cells.data()};
   const auto n_cells = cell_tallies.size();
 #ifdef USE_OPENMP
   // this is set earlier based on input variable
-  std::vector<std::vector<Cell_Tally>> thread_tallies(n_omp_threads);
+  std::vector<Cell_Tally_Vector> thread_tallies(n_omp_threads);
+  std::vector<Event_Counters> thread_counters(count_events ? n_omp_threads : 0);
 #pragma omp parallel
   {
+    Profiler::Scope thread_scope(Profiler::TRANSPORT_THREAD);
+    Perf_Counters::Scope thread_perf_counters(Perf_Counters::TRANSPORT);
     thread_tallies[omp_get_thread_num()].resize(n_cells);
     auto thread_tally_ptr = thread_tallies[omp_get_thread_num()].data();
+    Event_Counters *thread_counters_ptr = nullptr;
+    if (count_events) {
+      thread_counters_ptr = &thread_counters[omp_get_thread_num()];
+      thread_counters_ptr->resize(n_cells);
+    }
 #pragma omp for schedule(guided)
     for (int i=0; i<photons.size(); ++i) {
-      transport_photon(rank_cell_offset, photons[i], cpu_cells_ptr, thread_tally_ptr);
+      transport_photon<n_dim, count_events>(rank_cell_offset, photons[i], cpu_cells_ptr,
+                                            thread_tally_ptr, pop_ctrl, random_walk, macro_mesh,
+                                            thread_counters_ptr);
     }
   } // end parallel region
 
   // reduce tallies if using openmp
-  for(size_t cell=0; cell<n_cells; ++cell) {
-    auto &cell_tally{cell_tallies[cell]};
-    for(int thread =0; thread<n_omp_threads;++thread)
-      cell_tally.merge_in_tally(thread_tallies[thread][cell]);
-  }
+  merge_thread_tallies(cell_tallies, thread_tallies);
+  for (auto &thread_counter : thread_counters)
+    counters->merge(thread_counter);
 #else
   // normal serial version
+  Profiler::Scope thread_scope(Profiler::TRANSPORT_THREAD);
+  Perf_Counters::Scope thread_perf_counters(Perf_Counters::TRANSPORT);
   for (auto &photon : photons)
-    transport_photon(rank_cell_offset, photon, cpu_cells_ptr, cell_tallies.data());
+    transport_photon<n_dim, count_events>(rank_cell_offset, photon, cpu_cells_ptr,
+                                          cell_tallies.data(), pop_ctrl, random_walk, macro_mesh,
+                                          counters);
 #endif
 }
 //------------------------------------------------------------------------------------------------//
+//! Transport photons on the CPU, events are counted in counters if it isn't null
+void cpu_transport_photons(const uint32_t rank_cell_offset,
+    Photon_Vector &photons, const Cell_Vector &cells, Cell_Tally_Vector &cell_tallies, int n_omp_threads,
+    const Population_Control &pop_ctrl, const Random_Walk *random_walk,
+    const Macro_Mesh *macro_mesh, const uint32_t n_dim, Event_Counters *counters = nullptr) {
+
+  if (counters) {
+    if (n_dim == 1)
+      cpu_transport_kernel<1, true>(rank_cell_offset, photons, cells, cell_tallies, n_omp_threads,
+                                    pop_ctrl, random_walk, macro_mesh, counters);
+    else if (n_dim == 2)
+      cpu_transport_kernel<2, true>(rank_cell_offset, photons, cells, cell_tallies, n_omp_threads,
+                                    pop_ctrl, random_walk, macro_mesh, counters);
+    else
+      cpu_transport_kernel<3, true>(rank_cell_offset, photons, cells, cell_tallies, n_omp_threads,
+                                    pop_ctrl, random_walk, macro_mesh, counters);
+  } else if (n_dim == 1)
+    cpu_transport_kernel<1, false>(rank_cell_offset, photons, cells, cell_tallies, n_omp_threads,
+                                   pop_ctrl, random_walk, macro_mesh, nullptr);
+  else if (n_dim == 2)
+    cpu_transport_kernel<2, false>(rank_cell_offset, photons, cells, cell_tallies, n_omp_threads,
+                                   pop_ctrl, random_walk, macro_mesh, nullptr);
+  else
+    cpu_transport_kernel<3, false>(rank_cell_offset, photons, cells, cell_tallies, n_omp_threads,
+                                   pop_ctrl, random_walk, macro_mesh, nullptr);
+
+  // photons that stopped to split on entering an important cell are finished with their copies in
+  // another pass, the copies are appended to the photon list
+  if (pop_ctrl.use_weight_windows) {
+    std::vector<uint64_t> split_index;
+    for (uint64_t i = 0; i < photons.size(); ++i) {
+      if (photons[i].get_descriptor() == Constants::SPLIT)
+        split_index.push_back(i);
+    }
+    if (!split_index.empty()) {
+      Photon_Vector split_list;
+      Photon_Vector split_copies;
+      for (auto i : split_index) {
+        split_list.push_back(photons[i]);
+        split_photon(split_list.back(), split_copies);
+      }
+      const uint64_t n_parents = split_list.size();
+      split_list.insert(split_list.end(), split_copies.begin(), split_copies.end());
+      cpu_transport_photons(rank_cell_offset, split_list, cells, cell_tallies, n_omp_threads, pop_ctrl, random_walk,
+                            macro_mesh, n_dim, counters);
+      for (uint64_t k = 0; k < n_parents; ++k)
+        photons[split_index[k]] = split_list[k];
+      photons.insert(photons.end(), split_list.begin() + n_parents, split_list.end());
+    }
+  }
+}
+//------------------------------------------------------------------------------------------------//
 
 
 //------------------------------------------------------------------------------------------------//
 void gpu_transport_photons(const uint32_t rank_cell_offset,
-    std::vector<Photon> &cpu_photons, const Cell *device_cells_ptr, std::vector<Cell_Tally> &cpu_cell_tallies) {
+    Photon_Vector &cpu_photons, const Cell *device_cells_ptr, Cell_Tally_Vector &cpu_cell_tallies,
+    const Population_Control &pop_ctrl, const uint32_t n_dim) {
 
 #ifdef USE_CUDA
   uint32_t n_batch_photons = static_cast<uint32_t>(cpu_photons.size());
@@ -251,12 +579,26 @@ void gpu_transport_photons(const uint32_t rank_cell_offset,
   int n_blocks = (n_batch_photons + Constants::n_threads_per_block - 1) /
                  Constants::n_threads_per_block;
 
+  // splitting needs host memory for the new photons, only roulette runs on the device
+  Population_Control device_pop_ctrl = pop_ctrl;
+  device_pop_ctrl.use_weight_windows = false;
+
   cudaDeviceSynchronize();
 
   std::cout << "Launching with " << n_blocks << " blocks and ";
   std::cout << n_batch_photons << " photons" << std::endl;
-  gpu_no_accel_transport<<<n_blocks, Constants::n_threads_per_block>>>(
-      rank_cell_offset, device_photons_ptr, device_cells_ptr, device_cell_tallies_ptr, n_batch_photons);
+  if (n_dim == 1)
+    gpu_no_accel_transport<1><<<n_blocks, Constants::n_threads_per_block>>>(
+        rank_cell_offset, device_photons_ptr, device_cells_ptr, device_cell_tallies_ptr, n_batch_photons,
+        device_pop_ctrl);
+  else if (n_dim == 2)
+    gpu_no_accel_transport<2><<<n_blocks, Constants::n_threads_per_block>>>(
+        rank_cell_offset, device_photons_ptr, device_cells_ptr, device_cell_tallies_ptr, n_batch_photons,
+        device_pop_ctrl);
+  else
+    gpu_no_accel_transport<3><<<n_blocks, Constants::n_threads_per_block>>>(
+        rank_cell_offset, device_photons_ptr, device_cells_ptr, device_cell_tallies_ptr, n_batch_photons,
+        device_pop_ctrl);
 
 
   Insist(!(cudaGetLastError()), "CUDA error in transport kernel launch");
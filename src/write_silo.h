@@ -12,8 +12,13 @@
 #ifndef write_silo_h_
 #define write_silo_h_
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
+#include <functional>
 #include <iomanip>
+#include <memory>
+#include <numeric>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -22,49 +27,300 @@
 #include <silo.h>
 #endif
 
+#include "async_writer.h"
 #include "config.h"
 #include "constants.h"
 #include "imc_state.h"
+#include "mesh.h"
+#include "profiler.h"
+
+//! Output data of one cell, copied from the mesh so it can be written later
+struct Silo_Cell {
+  double nodes[6];     //!< Low and high x, y and z faces
+  double T_e;          //!< Material temperature
+  double T_r;          //!< Radiation temperature
+  uint32_t silo_index; //!< Index in the global rectangular mesh
+  int material;        //!< Region ID
+};
+
+//! Cells of one rank staged for output, owned so the I/O thread can write them
+struct Silo_Block {
+  int rank;                     //!< Rank that owns the cells
+  double transport_time;        //!< Transport time of the rank
+  double mpi_time;              //!< MPI time of the rank
+  std::vector<Silo_Cell> cells; //!< Local cells
+};
+
+//! Copy this rank's cells into a block
+inline Silo_Block make_silo_block(const Mesh &mesh, const double r_transport_time,
+                                  const double r_mpi_time, const int rank) {
+  Silo_Block block;
+  block.rank = rank;
+  block.transport_time = r_transport_time;
+  block.mpi_time = r_mpi_time;
+  const uint32_t n_local = mesh.get_n_local_cells();
+  block.cells.resize(n_local);
+  for (uint32_t i = 0; i < n_local; ++i) {
+    const Cell &cell = mesh.get_cell_ref(i);
+    Silo_Cell &silo_cell = block.cells[i];
+    std::copy(cell.get_node_array(), cell.get_node_array() + 6, silo_cell.nodes);
+    silo_cell.T_e = cell.get_T_e();
+    silo_cell.T_r = mesh.get_T_r(i);
+    silo_cell.silo_index = cell.get_silo_index();
+    silo_cell.material = cell.get_region_ID();
+  }
+  return block;
+}
 
-//! All ranks perform reductions to produce global arrays and rank zero
-// writes the SILO file for visualization
-void write_silo(const Mesh &mesh, const double &arg_time, const uint32_t &step,
-                const double &r_transport_time, const double &r_mpi_time,
-                const int &rank, const int &n_rank, const bool replicated_flag) {
+//! Gather the blocks of every rank in comm onto its rank zero, the others get an empty vector.
+// Only local cells are sent, nothing global is reduced.
+inline std::vector<Silo_Block> gather_silo_blocks(const Silo_Block &block, MPI_Comm comm) {
+  using std::vector;
+  int comm_rank, comm_size;
+  MPI_Comm_rank(comm, &comm_rank);
+  MPI_Comm_size(comm, &comm_size);
+
+  // rank, cell count and times of each block
+  const double info[4] = {static_cast<double>(block.rank),
+                          static_cast<double>(block.cells.size()), block.transport_time,
+                          block.mpi_time};
+  vector<double> all_info(comm_rank == 0 ? 4 * comm_size : 0);
+  MPI_Gather(info, 4, MPI_DOUBLE, all_info.data(), 4, MPI_DOUBLE, 0, comm);
+
+  vector<int> counts, offsets;
+  vector<Silo_Cell> all_cells;
+  if (comm_rank == 0) {
+    counts.resize(comm_size);
+    offsets.resize(comm_size, 0);
+    for (int r = 0; r < comm_size; ++r)
+      counts[r] = static_cast<int>(all_info[4 * r + 1]);
+    std::partial_sum(counts.begin(), counts.end() - 1, offsets.begin() + 1);
+    all_cells.resize(offsets.back() + counts.back());
+  }
+  MPI_Datatype cell_type;
+  MPI_Type_contiguous(sizeof(Silo_Cell), MPI_BYTE, &cell_type);
+  MPI_Type_commit(&cell_type);
+  MPI_Gatherv(block.cells.data(), static_cast<int>(block.cells.size()), cell_type,
+              all_cells.data(), counts.data(), offsets.data(), cell_type, 0, comm);
+  MPI_Type_free(&cell_type);
+
+  vector<Silo_Block> blocks(comm_rank == 0 ? comm_size : 0);
+  for (int r = 0; r < static_cast<int>(blocks.size()); ++r) {
+    blocks[r].rank = static_cast<int>(all_info[4 * r]);
+    blocks[r].transport_time = all_info[4 * r + 2];
+    blocks[r].mpi_time = all_info[4 * r + 3];
+    blocks[r].cells.assign(all_cells.begin() + offsets[r],
+                           all_cells.begin() + offsets[r] + counts[r]);
+  }
+  return blocks;
+}
+
+//! Return the file that a rank's block is written to, ranks are split into n_files contiguous
+// groups
+inline int get_silo_group(const int rank, const int n_rank, const int n_files) {
+  return static_cast<int>(static_cast<int64_t>(rank) * n_files / n_rank);
+}
+
+//! Return the name of a multi-block group file
+inline std::string get_silo_group_file(const uint32_t step, const int group) {
+  return "output_" + std::to_string(step) + "_" + std::to_string(group) + ".silo";
+}
+
+//! Return the directory of a rank's block in its group file
+inline std::string get_silo_block_dir(const int rank) { return "domain_" + std::to_string(rank); }
+
+//! Use a 2D mesh for one z cell (2 faces), otherwise a 3D mesh
+inline int get_silo_ndims(const Mesh &mesh) {
+  return (mesh.get_global_n_z_faces() == 2) ? 2 : 3;
+}
+
+//! Staged data for one single-file SILO dump, owned so the file can be written by the I/O thread
+struct Silo_Snapshot {
+  std::string file;               //!< Name of the SILO file
+  double time;                    //!< Simulation time (shakes)
+  int ndims;                      //!< Dimensions of the mesh
+  int nx, ny, nz;                 //!< Global number of faces in each dimension
+  int n_rank;                     //!< Number of ranks
+  std::vector<float> x, y, z;     //!< Face coordinates
+  std::vector<Silo_Block> blocks; //!< Cells of every rank
+};
 
 #ifdef VIZ_LIBRARIES_FOUND
-  using Constants::ELEMENT;
-  using Constants::X_NEG;
-  using Constants::X_POS;
-  using Constants::Y_NEG;
-  using Constants::Y_POS;
-  using std::array;
+//! Write one block as an unstructured mesh in the current directory of dbfile, nodes are not
+// shared between cells so any decomposition can be written. Makes no MPI calls.
+inline void write_silo_block(DBfile *dbfile, const Silo_Block &block, double time,
+                             const int ndims) {
+  using std::vector;
+  const int n_local = static_cast<int>(block.cells.size());
+  const int nodes_per_cell = (ndims == 2) ? 4 : 8;
+  // corner order of quads and hexes, as x, y, z low (0) or high (1)
+  const int corners[8][3] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0},
+                             {0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}};
+
+  vector<vector<float>> xyz(ndims, vector<float>(n_local * nodes_per_cell));
+  vector<int> nodelist(n_local * nodes_per_cell);
+  vector<double> T_e(n_local), T_r(n_local);
+  vector<double> transport_time(n_local, block.transport_time);
+  vector<double> mpi_time(n_local, block.mpi_time);
+  vector<int> rank_data(n_local, block.rank), material(n_local);
+  for (int i = 0; i < n_local; ++i) {
+    const Silo_Cell &cell = block.cells[i];
+    for (int n = 0; n < nodes_per_cell; ++n) {
+      const int node = i * nodes_per_cell + n;
+      for (int d = 0; d < ndims; ++d)
+        xyz[d][node] = cell.nodes[2 * d + corners[n][d]];
+      nodelist[node] = node;
+    }
+    T_e[i] = cell.T_e;
+    T_r[i] = cell.T_r;
+    material[i] = cell.material;
+  }
+
+  float *coords[3];
+  for (int d = 0; d < ndims; ++d)
+    coords[d] = xyz[d].data();
+  int shape_type = (ndims == 2) ? DB_ZONETYPE_QUAD : DB_ZONETYPE_HEX;
+  int shape_size = nodes_per_cell;
+  int shape_count = n_local;
+  DBPutZonelist2(dbfile, "zonelist", n_local, ndims, nodelist.data(), nodelist.size(), 0, 0, 0,
+                 &shape_type, &shape_size, &shape_count, 1, NULL);
+  DBoptlist *optlist = DBMakeOptlist(1);
+  DBAddOption(optlist, DBOPT_DTIME, &time);
+  DBPutUcdmesh(dbfile, "quadmesh", ndims, NULL, coords, n_local * nodes_per_cell, n_local,
+               "zonelist", NULL, DB_FLOAT, optlist);
+
+  int mat_dims = n_local;
+  int rank = block.rank;
+  DBPutMaterial(dbfile, "Rank_ID", "quadmesh", 1, &rank, rank_data.data(), &mat_dims, 1, 0, 0,
+                0, 0, 0, DB_INT, NULL);
+  auto unique_mats = material;
+  std::sort(unique_mats.begin(), unique_mats.end());
+  unique_mats.erase(std::unique(unique_mats.begin(), unique_mats.end()), unique_mats.end());
+  DBPutMaterial(dbfile, "material", "quadmesh", unique_mats.size(), unique_mats.data(),
+                material.data(), &mat_dims, 1, 0, 0, 0, 0, 0, DB_INT, NULL);
+
+  DBPutUcdvar1(dbfile, "T_e", "quadmesh", T_e.data(), n_local, NULL, 0, DB_DOUBLE, DB_ZONECENT,
+               optlist);
+  DBPutUcdvar1(dbfile, "T_r", "quadmesh", T_r.data(), n_local, NULL, 0, DB_DOUBLE, DB_ZONECENT,
+               optlist);
+  DBPutUcdvar1(dbfile, "transport_time", "quadmesh", transport_time.data(), n_local, NULL, 0,
+               DB_DOUBLE, DB_ZONECENT, optlist);
+  DBPutUcdvar1(dbfile, "mpi_time", "quadmesh", mpi_time.data(), n_local, NULL, 0, DB_DOUBLE,
+               DB_ZONECENT, optlist);
+  DBFreeOptlist(optlist);
+}
+
+//! Write the blocks of one group into their own directories of a group file
+inline void write_silo_group(const std::string &file_name, const std::vector<Silo_Block> &blocks,
+                             const double time, const int ndims) {
+  Profiler::Scope output_scope(Profiler::OUTPUT);
+  DBfile *dbfile = DBCreate(file_name.c_str(), DB_CLOBBER, DB_LOCAL, NULL, DB_PDB);
+  for (const Silo_Block &block : blocks) {
+    const std::string dir_name = get_silo_block_dir(block.rank);
+    DBMkDir(dbfile, dir_name.c_str());
+    DBSetDir(dbfile, dir_name.c_str());
+    write_silo_block(dbfile, block, time, ndims);
+    DBSetDir(dbfile, "..");
+  }
+  DBClose(dbfile);
+}
+
+//! Write the multi-block index output_<step>.silo, it only names the blocks so no rank data is
+// needed
+inline void write_silo_index(double time, const uint32_t step, const int n_rank,
+                             const int n_files) {
+  using std::string;
+  using std::vector;
+  Profiler::Scope output_scope(Profiler::OUTPUT);
+
+  const string index_name = "output_" + std::to_string(step) + ".silo";
+  DBfile *index_file = DBCreate(index_name.c_str(), DB_CLOBBER, DB_LOCAL, NULL, DB_PDB);
+  vector<string> block_paths(n_rank);
+  for (int r = 0; r < n_rank; ++r)
+    block_paths[r] = get_silo_group_file(step, get_silo_group(r, n_rank, n_files)) + ":/" +
+                     get_silo_block_dir(r) + "/";
+  auto put_multi = [&](const string &name, const int type, DBoptlist *optlist) {
+    vector<string> paths(n_rank);
+    vector<char *> names(n_rank);
+    vector<int> types(n_rank, type);
+    for (int r = 0; r < n_rank; ++r) {
+      paths[r] = block_paths[r] + name;
+      names[r] = &paths[r][0];
+    }
+    if (type == DB_MATERIAL)
+      DBPutMultimat(index_file, name.c_str(), n_rank, names.data(), optlist);
+    else if (type == DB_UCDMESH)
+      DBPutMultimesh(index_file, name.c_str(), n_rank, names.data(), types.data(), optlist);
+    else
+      DBPutMultivar(index_file, name.c_str(), n_rank, names.data(), types.data(), optlist);
+  };
+
+  DBoptlist *optlist = DBMakeOptlist(1);
+  DBAddOption(optlist, DBOPT_DTIME, &time);
+  put_multi("quadmesh", DB_UCDMESH, optlist);
+  for (const string var : {"T_e", "T_r", "transport_time", "mpi_time"})
+    put_multi(var, DB_UCDVAR, optlist);
+  DBFreeOptlist(optlist);
+
+  // every block has one rank material, list them all so the legend is complete
+  vector<int> rank_ids(n_rank);
+  for (int r = 0; r < n_rank; ++r)
+    rank_ids[r] = r;
+  int n_rank_ids = n_rank;
+  DBoptlist *mat_optlist = DBMakeOptlist(3);
+  DBAddOption(mat_optlist, DBOPT_MMESH_NAME, const_cast<char *>("quadmesh"));
+  DBAddOption(mat_optlist, DBOPT_NMATNOS, &n_rank_ids);
+  DBAddOption(mat_optlist, DBOPT_MATNOS, rank_ids.data());
+  put_multi("Rank_ID", DB_MATERIAL, mat_optlist);
+  DBFreeOptlist(mat_optlist);
+
+  DBoptlist *region_optlist = DBMakeOptlist(1);
+  DBAddOption(region_optlist, DBOPT_MMESH_NAME, const_cast<char *>("quadmesh"));
+  put_multi("material", DB_MATERIAL, region_optlist);
+  DBFreeOptlist(region_optlist);
+
+  DBClose(index_file);
+}
+
+//! Write a snapshot to one SILO file, the blocks are placed in global arrays here so the copy
+// runs on the I/O thread. Makes no MPI calls.
+inline void write_silo_snapshot(Silo_Snapshot &snapshot) {
   using std::string;
   using std::stringstream;
   using std::vector;
 
-  // need a non-const double to pass to SILO
-  double time = arg_time;
+  // shows up on the I/O thread when written in the background
+  Profiler::Scope output_scope(Profiler::OUTPUT);
 
-  //generate name for this silo file
-  stringstream ss;
-  ss.setf(std::ios::showpoint);
-  ss << std::setprecision(3);
-  ss << "output_" << step << ".silo";
-  string file = ss.str();
-
-  int nx = mesh.get_global_n_x_faces();
-  int ny = mesh.get_global_n_y_faces();
-  int nz = mesh.get_global_n_z_faces();
-
-  // set number of dimensions
-  int ndims;
-  // Use a 2D mesh for one z cell (2 faces)
-  if (nz == 2)
-    ndims = 2;
-  // Otherwise use 3D mesh for 3 or more z faces
+  const int ndims = snapshot.ndims;
+  const int nx = snapshot.nx, ny = snapshot.ny, nz = snapshot.nz;
+  const int n_rank = snapshot.n_rank;
+  double &time = snapshot.time;
+
+  // get total cells of the global mesh
+  uint32_t n_xyz_cells;
+  if (ndims == 2)
+    n_xyz_cells = (nx - 1) * (ny - 1);
   else
-    ndims = 3;
+    n_xyz_cells = (nx - 1) * (ny - 1) * (nz - 1);
+
+  // map values from each block to their SILO ID
+  vector<int> rank_data(n_xyz_cells, 0), material(n_xyz_cells, 0);
+  vector<double> T_e(n_xyz_cells, 0.0), T_r(n_xyz_cells, 0.0);
+  vector<double> transport_time(n_xyz_cells, 0.0), mpi_time(n_xyz_cells, 0.0);
+  for (const Silo_Block &block : snapshot.blocks) {
+    for (const Silo_Cell &cell : block.cells) {
+      const uint32_t silo_index = cell.silo_index;
+      rank_data[silo_index] = block.rank;
+      T_e[silo_index] = cell.T_e;
+      T_r[silo_index] = cell.T_r;
+      transport_time[silo_index] = block.transport_time;
+      mpi_time[silo_index] = block.mpi_time;
+      material[silo_index] = cell.material;
+    }
+  }
+  // the cells are in the global arrays now
+  vector<Silo_Block>().swap(snapshot.blocks);
 
   // generate title of plot
   stringstream tt;
@@ -76,191 +332,175 @@ void write_silo(const Mesh &mesh, const double &arg_time, const uint32_t &step,
     tt << "3D rectangular mesh, t = " << time << " (sh)";
   string title = tt.str();
 
-  // get total cells for MPI all_reduce calls
-  uint32_t n_xyz_cells;
-  if (ndims == 2)
-    n_xyz_cells = (nx - 1) * (ny - 1);
-  else
-    n_xyz_cells = (nx - 1) * (ny - 1) * (nz - 1);
-
-  // make vectors of data for plotting
-  vector<int> rank_data(n_xyz_cells, 0);
-  vector<double> T_e(n_xyz_cells, 0.0);
-  vector<double> T_r(n_xyz_cells, 0.0);
-  vector<double> transport_time(n_xyz_cells, 0.0);
-  vector<double> mpi_time(n_xyz_cells, 0.0);
-  vector<int> material(n_xyz_cells, 0);
-
-  // get rank data, map values from from global ID to SILO ID
-  uint32_t n_local = mesh.get_n_local_cells();
-  uint32_t silo_index;
-  for (uint32_t i = 0; i < n_local; i++) {
-    const auto &cell = mesh.get_cell_ref(i);
-    silo_index = cell.get_silo_index();
-    rank_data[silo_index] = rank;
-    // set silo plot variables
-    T_e[silo_index] = cell.get_T_e();
-    T_r[silo_index] = mesh.get_T_r(i);
-    transport_time[silo_index] = r_transport_time;
-    mpi_time[silo_index] = r_mpi_time;
-    material[silo_index] = cell.get_region_ID();
+  // write the global mesh
+  int dims[3] = {nx, ny, nz};
+  float *coords[3] = {snapshot.x.data(), snapshot.y.data(), snapshot.z.data()};
+  int cell_dims[3] = {nx - 1, ny - 1, nz - 1};
+
+  //create SILO file for this mesh
+  DBfile *dbfile = NULL;
+  dbfile = DBCreate(snapshot.file.c_str(), 0, DB_LOCAL, NULL, DB_PDB);
+
+  // make the correct potion list for 2D and 3D meshes
+  DBoptlist *optlist;
+  if (ndims == 2) {
+    optlist = DBMakeOptlist(4);
+    DBAddOption(optlist, DBOPT_XLABEL, (void *)"x");
+    DBAddOption(optlist, DBOPT_XUNITS, (void *)"cm");
+    DBAddOption(optlist, DBOPT_YLABEL, (void *)"y");
+    DBAddOption(optlist, DBOPT_YUNITS, (void *)"cm");
+  }
+  if (ndims == 3) {
+    optlist = DBMakeOptlist(6);
+    DBAddOption(optlist, DBOPT_XLABEL, (void *)"x");
+    DBAddOption(optlist, DBOPT_XUNITS, (void *)"cm");
+    DBAddOption(optlist, DBOPT_YLABEL, (void *)"y");
+    DBAddOption(optlist, DBOPT_YUNITS, (void *)"cm");
+    DBAddOption(optlist, DBOPT_ZLABEL, (void *)"z");
+    DBAddOption(optlist, DBOPT_ZUNITS, (void *)"cm");
   }
 
-  // replicated doesn't need to do this reduction
-  if (!replicated_flag) {
-    // reduce to get rank of each cell across all ranks
-    MPI_Allreduce(MPI_IN_PLACE, &rank_data[0], n_xyz_cells, MPI_INT, MPI_SUM,
-                  MPI_COMM_WORLD);
+  DBPutQuadmesh(dbfile, "quadmesh", NULL, coords, dims, ndims, DB_FLOAT,
+                DB_COLLINEAR, optlist);
+
+  // write rank IDs xy to 1D array
+  vector<int> rank_ids(n_rank);
+  for (int i = 0; i < n_rank; i++)
+    rank_ids[i] = i;
+
+  // get unique materials
+  auto unique_mats = material;
+  std::sort(unique_mats.begin(), unique_mats.end());
+  auto last = std::unique(unique_mats.begin(), unique_mats.end());
+  unique_mats.erase(last, unique_mats.end());
+
+  DBPutMaterial(dbfile, "Rank_ID", "quadmesh", n_rank, rank_ids.data(),
+                &rank_data[0], cell_dims, ndims, 0, 0, 0, 0, 0, DB_INT, NULL);
+
+  DBPutMaterial(dbfile, "material", "quadmesh", unique_mats.size(), unique_mats.data(),
+                &material[0], cell_dims, ndims, 0, 0, 0, 0, 0, DB_INT, NULL);
+
+  // write the material temperature scalar field
+  DBoptlist *Te_optlist = DBMakeOptlist(2);
+  DBAddOption(Te_optlist, DBOPT_UNITS, (void *)"keV");
+  DBAddOption(Te_optlist, DBOPT_DTIME, &time);
+  DBPutQuadvar1(dbfile, "T_e", "quadmesh", &T_e[0], cell_dims, ndims, NULL, 0,
+                DB_DOUBLE, DB_ZONECENT, Te_optlist);
+
+  // write the radiation temperature scalar field
+  DBoptlist *Tr_optlist = DBMakeOptlist(2);
+  DBAddOption(Tr_optlist, DBOPT_UNITS, (void *)"keV");
+  DBAddOption(Tr_optlist, DBOPT_DTIME, &time);
+  DBPutQuadvar1(dbfile, "T_r", "quadmesh", &T_r[0], cell_dims, ndims, NULL, 0,
+                DB_DOUBLE, DB_ZONECENT, Tr_optlist);
+
+  // write the transport time scalar field
+  DBoptlist *t_time_optlist = DBMakeOptlist(2);
+  DBAddOption(t_time_optlist, DBOPT_UNITS, (void *)"seconds");
+  DBAddOption(t_time_optlist, DBOPT_DTIME, &time);
+  DBPutQuadvar1(dbfile, "transport_time", "quadmesh", &transport_time[0],
+                cell_dims, ndims, NULL, 0, DB_DOUBLE, DB_ZONECENT,
+                t_time_optlist);
+
+  // write the mpi time scalar field
+  DBoptlist *mpi_time_optlist = DBMakeOptlist(2);
+  DBAddOption(mpi_time_optlist, DBOPT_UNITS, (void *)"seconds");
+  DBAddOption(mpi_time_optlist, DBOPT_DTIME, &time);
+  DBPutQuadvar1(dbfile, "mpi_time", "quadmesh", &mpi_time[0], cell_dims,
+                ndims, NULL, 0, DB_DOUBLE, DB_ZONECENT, mpi_time_optlist);
+
+  // free option lists
+  DBFreeOptlist(optlist);
+  DBFreeOptlist(Te_optlist);
+  DBFreeOptlist(Tr_optlist);
+  DBFreeOptlist(t_time_optlist);
+  DBFreeOptlist(mpi_time_optlist);
+
+  // close file
+  DBClose(dbfile);
+}
+#endif
 
-    // reduce to get T_e across all ranks
-    MPI_Allreduce(MPI_IN_PLACE, &T_e[0], n_xyz_cells, MPI_DOUBLE, MPI_SUM,
-                  MPI_COMM_WORLD);
+//! Each rank copies its cells into a block and the blocks are written by I/O threads. By
+// default the blocks are gathered to rank zero, which writes one rectangular mesh. With
+// n_silo_files > 0 in domain decomposed mode the ranks are split into that many I/O groups,
+// the first rank of each group writes its group's blocks to output_<step>_<group>.silo and
+// rank zero writes the multi-block index. Only local cells are communicated, and with a
+// writer all Silo calls are made on its thread, so the driver only waits for a full queue.
+void write_silo(const Mesh &mesh, const double &arg_time, const uint32_t &step,
+                const double &r_transport_time, const double &r_mpi_time,
+                const int &rank, const int &n_rank, const bool replicated_flag,
+                const uint32_t n_silo_files = 0, Async_Writer *writer = nullptr) {
 
-    // reduce to get T_r across all ranks
-    MPI_Allreduce(MPI_IN_PLACE, &T_r[0], n_xyz_cells, MPI_DOUBLE, MPI_SUM,
-                  MPI_COMM_WORLD);
+#ifdef VIZ_LIBRARIES_FOUND
+  auto run = [writer](std::function<void()> task) {
+    if (writer)
+      writer->submit(std::move(task));
+    else
+      task();
+  };
+  const int ndims = get_silo_ndims(mesh);
+  const double time = arg_time;
+
+  if (n_silo_files > 0 && !replicated_flag) {
+    const int n_files = std::min(static_cast<int>(n_silo_files), n_rank);
+    const int group = get_silo_group(rank, n_rank, n_files);
+    MPI_Comm io_comm;
+    MPI_Comm_split(MPI_COMM_WORLD, group, rank, &io_comm);
+    auto blocks = std::make_shared<std::vector<Silo_Block>>(gather_silo_blocks(
+        make_silo_block(mesh, r_transport_time, r_mpi_time, rank), io_comm));
+    int io_rank;
+    MPI_Comm_rank(io_comm, &io_rank);
+    MPI_Comm_free(&io_comm);
+
+    if (io_rank == 0) {
+      const std::string file_name = get_silo_group_file(step, group);
+      run([file_name, blocks, time, ndims] {
+        write_silo_group(file_name, *blocks, time, ndims);
+      });
+    }
+    // root only writes the names of the blocks
+    if (rank == 0) {
+      const uint32_t index_step = step;
+      run([time, index_step, n_rank, n_files] {
+        write_silo_index(time, index_step, n_rank, n_files);
+      });
+    }
+    return;
+  }
 
-    // reduce to get transport runtime from all ranks
-    MPI_Allreduce(MPI_IN_PLACE, &transport_time[0], n_xyz_cells, MPI_DOUBLE,
-                  MPI_SUM, MPI_COMM_WORLD);
+  // replicated ranks all have every cell, rank zero writes its own
+  if (replicated_flag && rank != 0)
+    return;
 
-    // reduce to get mpi time from all ranks
-    MPI_Allreduce(MPI_IN_PLACE, &mpi_time[0], n_xyz_cells, MPI_DOUBLE, MPI_SUM,
-                  MPI_COMM_WORLD);
+  auto snapshot = std::make_shared<Silo_Snapshot>();
 
-    // reduce to get material ID across all ranks
-    MPI_Allreduce(MPI_IN_PLACE, &material[0], n_xyz_cells, MPI_INT, MPI_SUM,
-                  MPI_COMM_WORLD);
-  }
+  //generate name for this silo file
+  std::stringstream ss;
+  ss.setf(std::ios::showpoint);
+  ss << std::setprecision(3);
+  ss << "output_" << step << ".silo";
+  snapshot->file = ss.str();
+
+  snapshot->time = time;
+  snapshot->n_rank = n_rank;
+  snapshot->ndims = ndims;
+  snapshot->nx = mesh.get_global_n_x_faces();
+  snapshot->ny = mesh.get_global_n_y_faces();
+  snapshot->nz = mesh.get_global_n_z_faces();
+  snapshot->x.assign(mesh.get_silo_x(), mesh.get_silo_x() + snapshot->nx);
+  snapshot->y.assign(mesh.get_silo_y(), mesh.get_silo_y() + snapshot->ny);
+  snapshot->z.assign(mesh.get_silo_z(), mesh.get_silo_z() + snapshot->nz);
+
+  Silo_Block block = make_silo_block(mesh, r_transport_time, r_mpi_time, rank);
+  if (replicated_flag)
+    snapshot->blocks.push_back(std::move(block));
+  else
+    snapshot->blocks = gather_silo_blocks(block, MPI_COMM_WORLD);
 
   // First rank writes the SILO file
-  if (rank == 0) {
-
-    // write the global mesh
-    float *x = mesh.get_silo_x();
-    float *y = mesh.get_silo_y();
-    float *z = mesh.get_silo_z();
-
-    int *dims;
-    float **coords;
-    int *cell_dims;
-
-    // do 2D write
-    if (ndims == 2) {
-      dims = new int[2];
-      dims[0] = nx;
-      dims[1] = ny;
-      coords = new float *[2];
-      coords[0] = x;
-      coords[1] = y;
-      cell_dims = new int[2];
-      cell_dims[0] = nx - 1;
-      cell_dims[1] = ny - 1;
-    }
-    // do 3D write
-    else {
-      dims = new int[3];
-      dims[0] = nx;
-      dims[1] = ny;
-      dims[2] = nz;
-      coords = new float *[3];
-      coords[0] = x;
-      coords[1] = y;
-      coords[2] = z;
-      cell_dims = new int[3];
-      cell_dims[0] = nx - 1;
-      cell_dims[1] = ny - 1;
-      cell_dims[2] = nz - 1;
-    }
-
-    //create SILO file for this mesh
-    DBfile *dbfile = NULL;
-    dbfile = DBCreate(file.c_str(), 0, DB_LOCAL, NULL, DB_PDB);
-
-    // make the correct potion list for 2D and 3D meshes
-    DBoptlist *optlist;
-    if (ndims == 2) {
-      optlist = DBMakeOptlist(4);
-      DBAddOption(optlist, DBOPT_XLABEL, (void *)"x");
-      DBAddOption(optlist, DBOPT_XUNITS, (void *)"cm");
-      DBAddOption(optlist, DBOPT_YLABEL, (void *)"y");
-      DBAddOption(optlist, DBOPT_YUNITS, (void *)"cm");
-    }
-    if (ndims == 3) {
-      optlist = DBMakeOptlist(6);
-      DBAddOption(optlist, DBOPT_XLABEL, (void *)"x");
-      DBAddOption(optlist, DBOPT_XUNITS, (void *)"cm");
-      DBAddOption(optlist, DBOPT_YLABEL, (void *)"y");
-      DBAddOption(optlist, DBOPT_YUNITS, (void *)"cm");
-      DBAddOption(optlist, DBOPT_ZLABEL, (void *)"z");
-      DBAddOption(optlist, DBOPT_ZUNITS, (void *)"cm");
-    }
-
-    DBPutQuadmesh(dbfile, "quadmesh", NULL, coords, dims, ndims, DB_FLOAT,
-                  DB_COLLINEAR, optlist);
-
-    // write rank IDs xy to 1D array
-    int *rank_ids = new int[n_rank];
-    for (uint32_t i = 0; i < n_rank; i++)
-      rank_ids[i] = i;
-
-    // get unique materials
-    auto unique_mats = material;
-    std::sort(unique_mats.begin(), unique_mats.end());
-    auto last = std::unique(unique_mats.begin(), unique_mats.end());
-    unique_mats.erase(last, unique_mats.end());
-
-    DBPutMaterial(dbfile, "Rank_ID", "quadmesh", n_rank, rank_ids,
-                  &rank_data[0], cell_dims, ndims, 0, 0, 0, 0, 0, DB_INT, NULL);
-
-    DBPutMaterial(dbfile, "material", "quadmesh", unique_mats.size(), unique_mats.data(),
-                  &material[0], cell_dims, ndims, 0, 0, 0, 0, 0, DB_INT, NULL);
-
-    // write the material temperature scalar field
-    DBoptlist *Te_optlist = DBMakeOptlist(2);
-    DBAddOption(Te_optlist, DBOPT_UNITS, (void *)"keV");
-    DBAddOption(Te_optlist, DBOPT_DTIME, &time);
-    DBPutQuadvar1(dbfile, "T_e", "quadmesh", &T_e[0], cell_dims, ndims, NULL, 0,
-                  DB_DOUBLE, DB_ZONECENT, Te_optlist);
-
-    // write the radiation temperature scalar field
-    DBoptlist *Tr_optlist = DBMakeOptlist(2);
-    DBAddOption(Tr_optlist, DBOPT_UNITS, (void *)"keV");
-    DBAddOption(Tr_optlist, DBOPT_DTIME, &time);
-    DBPutQuadvar1(dbfile, "T_r", "quadmesh", &T_r[0], cell_dims, ndims, NULL, 0,
-                  DB_DOUBLE, DB_ZONECENT, Tr_optlist);
-
-    // write the transport time scalar field
-    DBoptlist *t_time_optlist = DBMakeOptlist(2);
-    DBAddOption(t_time_optlist, DBOPT_UNITS, (void *)"seconds");
-    DBAddOption(t_time_optlist, DBOPT_DTIME, &time);
-    DBPutQuadvar1(dbfile, "transport_time", "quadmesh", &transport_time[0],
-                  cell_dims, ndims, NULL, 0, DB_DOUBLE, DB_ZONECENT,
-                  t_time_optlist);
-
-    // write the mpi time scalar field
-    DBoptlist *mpi_time_optlist = DBMakeOptlist(2);
-    DBAddOption(mpi_time_optlist, DBOPT_UNITS, (void *)"seconds");
-    DBAddOption(mpi_time_optlist, DBOPT_DTIME, &time);
-    DBPutQuadvar1(dbfile, "mpi_time", "quadmesh", &mpi_time[0], cell_dims,
-                  ndims, NULL, 0, DB_DOUBLE, DB_ZONECENT, mpi_time_optlist);
-
-    // free option lists
-    DBFreeOptlist(optlist);
-    DBFreeOptlist(Te_optlist);
-    DBFreeOptlist(Tr_optlist);
-    DBFreeOptlist(t_time_optlist);
-    DBFreeOptlist(mpi_time_optlist);
-
-    // free data
-    delete[] rank_ids;
-    delete[] cell_dims;
-    delete[] coords;
-    delete[] dims;
-
-    // close file
-    DBClose(dbfile);
-  } // end rank==0
+  if (rank == 0)
+    run([snapshot] { write_silo_snapshot(*snapshot); });
 #endif
 }
 